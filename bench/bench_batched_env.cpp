@@ -0,0 +1,96 @@
+// Compares BatchedSnakeEnv with N independent SnakeGame instances stepping the same
+// random-turn policy in lockstep. Reports game ticks per second for each.
+
+#include "BatchedSnakeEnv.h"
+#include "SnakeGame.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+namespace
+{
+// Cheap stateless action source shared by both contenders: keep going, turn 20% of the time
+uint8_t PolicyAction(uint32_t game, uint32_t tick, int current)
+{
+    uint32_t h = game * 0x9E3779B1u ^ (tick + 0x7F4A7C15u) * 0x85EBCA77u;
+    h ^= h >> 15;
+    h *= 0x2C1B3C6Du;
+    h ^= h >> 12;
+    return static_cast<uint8_t>((h % 10) < 2 ? (h >> 8) & 3 : current);
+}
+
+double BenchBatched(int games, int width, int height, int steps)
+{
+    BatchedSnakeEnv env(games, width, height, 1);
+    std::vector<uint8_t> actions(games);
+
+    auto start = std::chrono::steady_clock::now();
+    for (int tick = 0; tick < steps; ++tick)
+    {
+        const int32_t* dirs = env.GetDirections();
+        for (int i = 0; i < games; ++i)
+            actions[i] = PolicyAction(i, tick, dirs[i]);
+        env.Step(actions.data());
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return static_cast<double>(games) * steps / seconds;
+}
+
+double BenchSeparate(int games, int width, int height, int steps)
+{
+    std::vector<std::unique_ptr<SnakeGame>> instances;
+    instances.reserve(games);
+    for (int i = 0; i < games; ++i)
+    {
+        instances.emplace_back(new SnakeGame(width, height, 1 + i));
+        instances.back()->StartGame();
+    }
+    uint64_t nextSeed = 1 + games;
+
+    auto start = std::chrono::steady_clock::now();
+    for (int tick = 0; tick < steps; ++tick)
+    {
+        for (int i = 0; i < games; ++i)
+        {
+            SnakeGame& game = *instances[i];
+            game.SetDirection(static_cast<Direction>(PolicyAction(i, tick, static_cast<int>(game.GetDirection()))));
+            game.Step();
+            if (game.IsGameOver())
+            {
+                game.Reset(nextSeed++);
+                game.StartGame();
+            }
+        }
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return static_cast<double>(games) * steps / seconds;
+}
+}
+
+int main(int argc, char** argv)
+{
+    int width = 20, height = 20, steps = 200;
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        if (std::strcmp(argv[i], "--width") == 0)
+            width = std::atoi(argv[i + 1]);
+        else if (std::strcmp(argv[i], "--height") == 0)
+            height = std::atoi(argv[i + 1]);
+        else if (std::strcmp(argv[i], "--steps") == 0)
+            steps = std::atoi(argv[i + 1]);
+    }
+
+    std::printf("grid %dx%d, %d steps per batch\n", width, height, steps);
+    std::printf("%8s %16s %16s %9s\n", "games", "batched tick/s", "separate tick/s", "speedup");
+    const int batchSizes[] = { 4096, 16384, 65536 };
+    for (int games : batchSizes)
+    {
+        double batched = BenchBatched(games, width, height, steps);
+        double separate = BenchSeparate(games, width, height, steps);
+        std::printf("%8d %16.0f %16.0f %8.2fx\n", games, batched, separate, batched / separate);
+    }
+    return 0;
+}
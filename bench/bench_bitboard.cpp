@@ -0,0 +1,148 @@
+// Compares the compile-time bitboard engine (SnakeBoard<W, H>) with the runtime-sized
+// SnakeGame on the 20x20 and 32x32 boards: whole greedy games, policy included, and
+// the bare tick with the snake circling in place among a few obstacles.
+
+#include "Policies.h"
+#include "SnakeBoard.h"
+#include "SnakeGame.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+namespace
+{
+using Clock = std::chrono::steady_clock;
+
+const int MAX_TICKS = 100000;
+
+// Keeps the snake circling a 2x2 square, so only the obstacles can end a game
+const Direction LOOP[4] = { Direction::DOWN, Direction::LEFT, Direction::UP, Direction::RIGHT };
+
+struct Result
+{
+    uint64_t ticks = 0;
+    uint64_t score = 0;
+    int games = 0;
+    double seconds = 0.0;
+
+    double NanosPerTick() const { return ticks ? seconds * 1e9 / ticks : 0.0; }
+};
+
+Result GreedyGames(int width, int height, int games)
+{
+    Result result;
+    SnakeGame game(width, height);
+    Clock::time_point start = Clock::now();
+    for (int i = 1; i <= games; ++i)
+    {
+        game.Reset(i);
+        game.StartGame();
+        while (!game.IsGameOver() && game.GetTick() < static_cast<uint64_t>(MAX_TICKS))
+        {
+            game.SetDirection(GreedyPolicy(game));
+            game.Step();
+        }
+        result.ticks += game.GetTick();
+        result.score += game.GetScore();
+        ++result.games;
+    }
+    result.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    return result;
+}
+
+template <int W, int H>
+Result GreedyGames(int games)
+{
+    Result result;
+    SnakeBoard<W, H> board;
+    Clock::time_point start = Clock::now();
+    for (int i = 1; i <= games; ++i)
+    {
+        board.Reset(i);
+        while (!board.IsGameOver() && board.GetTick() < static_cast<uint64_t>(MAX_TICKS))
+        {
+            board.SetDirection(BoardGreedyPolicy(board));
+            board.Step();
+        }
+        result.ticks += board.GetTick();
+        result.score += board.GetScore();
+        ++result.games;
+    }
+    result.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    return result;
+}
+
+Result LoopTicks(int width, int height, int obstacles, uint64_t ticks)
+{
+    Result result;
+    SnakeGame game(width, height);
+    game.SetObstacleCount(obstacles);
+    uint64_t seed = 1;
+    Clock::time_point start = Clock::now();
+    while (result.ticks < ticks)
+    {
+        game.Reset(seed++);
+        game.StartGame();
+        ++result.games;
+        while (!game.IsGameOver() && result.ticks < ticks)
+        {
+            game.SetDirection(LOOP[game.GetTick() % 4]);
+            game.Step();
+            ++result.ticks;
+        }
+    }
+    result.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    return result;
+}
+
+template <int W, int H>
+Result LoopTicks(int obstacles, uint64_t ticks)
+{
+    Result result;
+    SnakeBoard<W, H> board;
+    board.SetObstacleCount(obstacles);
+    uint64_t seed = 1;
+    Clock::time_point start = Clock::now();
+    while (result.ticks < ticks)
+    {
+        board.Reset(seed++);
+        ++result.games;
+        while (!board.IsGameOver() && result.ticks < ticks)
+        {
+            board.SetDirection(LOOP[board.GetTick() % 4]);
+            board.Step();
+            ++result.ticks;
+        }
+    }
+    result.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    return result;
+}
+
+void Print(const char* name, const char* board, const Result& game, const Result& bitboard)
+{
+    std::printf("%-8s %-6s %14.1f %14.1f %8.2fx %12.1f %12.1f\n", name, board, game.NanosPerTick(),
+        bitboard.NanosPerTick(), bitboard.NanosPerTick() > 0.0 ? game.NanosPerTick() / bitboard.NanosPerTick() : 0.0,
+        game.games ? static_cast<double>(game.ticks) / game.games : 0.0,
+        bitboard.games ? static_cast<double>(bitboard.ticks) / bitboard.games : 0.0);
+}
+}
+
+int main(int argc, char** argv)
+{
+    int games = argc > 1 ? std::atoi(argv[1]) : 20000;
+    uint64_t loopTicks = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 5000000;
+
+    // The engines place food differently, so the same seeds play different games;
+    // the comparison is per tick, with the average game length alongside
+    std::printf("%d greedy games and %llu looping ticks per run\n", games, static_cast<unsigned long long>(loopTicks));
+    std::printf("%-8s %-6s %14s %14s %9s %12s %12s\n", "run", "board", "SnakeGame ns", "SnakeBoard ns", "speedup",
+        "game ticks", "board ticks");
+
+    Print("greedy", "20x20", GreedyGames(20, 20, games), GreedyGames<20, 20>(games));
+    Print("greedy", "32x32", GreedyGames(32, 32, games), GreedyGames<32, 32>(games));
+    Print("loop", "20x20", LoopTicks(20, 20, 1, loopTicks), LoopTicks<20, 20>(1, loopTicks));
+    Print("loop", "32x32", LoopTicks(32, 32, 1, loopTicks), LoopTicks<32, 32>(1, loopTicks));
+    Print("loop-16", "20x20", LoopTicks(20, 20, 16, loopTicks), LoopTicks<20, 20>(16, loopTicks));
+    Print("loop-16", "32x32", LoopTicks(32, 32, 16, loopTicks), LoopTicks<32, 32>(16, loopTicks));
+    return 0;
+}
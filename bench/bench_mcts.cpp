@@ -0,0 +1,85 @@
+// Plays the same seeds with the MCTS bot at several per-move time budgets and reports
+// the mean score against the budget, with simulations per second and per move, next
+// to the greedy policy and the BFS autopilot as references.
+
+#include "Autopilot.h"
+#include "MctsBot.h"
+#include "Policies.h"
+#include "SnakeGame.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+
+namespace
+{
+const int BOARD_SIZE = 20;
+const int MAX_TICKS = 2000;  // A bot that circles without eating ends here
+const double BUDGETS_MS[] = { 1.0, 2.0, 5.0, 10.0, 20.0 };
+
+struct Result
+{
+    double meanScore = 0.0;
+    int maxScore = 0;
+    double meanTicks = 0.0;
+    double seconds = 0.0;
+};
+
+Result Play(int games, const std::function<Direction(const SnakeGame&)>& policy)
+{
+    Result result;
+    SnakeGame game(BOARD_SIZE, BOARD_SIZE);
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 1; i <= games; ++i)
+    {
+        game.Reset(i);
+        game.StartGame();
+        while (!game.IsGameOver() && game.GetTick() < static_cast<uint64_t>(MAX_TICKS))
+        {
+            game.SetDirection(policy(game));
+            game.Step();
+        }
+        result.meanScore += game.GetScore();
+        result.meanTicks += static_cast<double>(game.GetTick());
+        if (game.GetScore() > result.maxScore)
+            result.maxScore = game.GetScore();
+    }
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    result.meanScore /= games;
+    result.meanTicks /= games;
+    return result;
+}
+
+void PrintRow(const char* name, const Result& result, double simsPerSecond, double simsPerMove)
+{
+    std::printf("%-14s %10.1f %8d %10.1f %14.0f %12.1f %9.1f\n", name, result.meanScore, result.maxScore,
+        result.meanTicks, simsPerSecond, simsPerMove, result.seconds);
+}
+}
+
+int main(int argc, char** argv)
+{
+    int games = argc > 1 ? std::atoi(argv[1]) : 10;
+    int threads = argc > 2 ? std::atoi(argv[2]) : 0;
+
+    std::printf("%d games on %dx%d with 1 obstacle, at most %d ticks each\n", games, BOARD_SIZE, BOARD_SIZE, MAX_TICKS);
+    std::printf("%-14s %10s %8s %10s %14s %12s %9s\n", "player", "mean score", "max", "mean ticks", "sims/s",
+        "sims/move", "seconds");
+
+    PrintRow("greedy", Play(games, GreedyPolicy), 0.0, 0.0);
+    Autopilot autopilot;
+    PrintRow("autopilot", Play(games, [&autopilot](const SnakeGame& game) { return autopilot.Plan(game); }), 0.0, 0.0);
+
+    for (double budget : BUDGETS_MS)
+    {
+        MctsConfig config;
+        config.threads = threads;
+        config.budgetMs = budget;
+        MctsBot bot(config);
+        Result result = Play(games, [&bot](const SnakeGame& game) { return bot.Plan(game); });
+        char name[32];
+        std::snprintf(name, sizeof(name), "mcts %.0f ms x%d", budget, bot.GetThreadCount());
+        PrintRow(name, result, bot.GetSimulationsPerSecond(), bot.GetAverageSimulations());
+    }
+    return 0;
+}
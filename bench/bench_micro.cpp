@@ -0,0 +1,358 @@
+// Micro-benchmarks for the simulation and render hot paths: SnakeGame::Update and the
+// MoveSnake, CheckCollisions and SpawnFood phases of a tick, swept over grid size and
+// board fill, plus SnakeRenderer::Render into an offscreen ImDrawList when the ImGui
+// sources are available (SNAKE_BENCH_RENDER). Results are written as JSON so runs of
+// two versions can be diffed for regressions. Runs headless; no window or GPU needed.
+
+#include "SnakeGame.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+#ifdef SNAKE_BENCH_RENDER
+#include "SnakeRenderer.h"
+#endif
+
+// Friend of SnakeGame: the single-phase entry points the benchmarks time
+struct SnakeGameBench
+{
+    static void MoveSnake(SnakeGame& game, Direction dir)
+    {
+        game.snakes[0].direction = dir;
+        game.MoveSnake(game.snakes[0]);
+    }
+    static void CheckCollisions(SnakeGame& game) { game.CheckCollisions(); }
+    static void SpawnFood(SnakeGame& game) { game.SpawnFood(); }
+};
+
+namespace
+{
+const int SAMPLES = 5;        // Timed samples per case; the median and the best are reported
+const int BATCH_OPS = 256;    // Operations between clock reads
+const double FILLS[] = { 0.10, 0.50, 0.90, 0.99 };
+
+struct Options
+{
+    std::vector<int> sizes = { 20, 64, 256, 1024 };
+    double minSeconds = 0.25;  // Per case, split over the samples
+    const char* outPath = nullptr;
+};
+
+struct Timing
+{
+    double medianNs;
+    double bestNs;
+    uint64_t ops;
+};
+
+// Times op(maxOps), which performs up to maxOps operations and returns how many it did.
+// When it returns fewer the case has run out of board and rewind() restores the start
+// position outside the timed region.
+template <typename Op, typename Rewind>
+Timing Measure(double minSeconds, Op op, Rewind rewind)
+{
+    double samples[SAMPLES];
+    uint64_t totalOps = 0;
+    for (double& sample : samples)
+    {
+        double seconds = 0.0;
+        uint64_t ops = 0;
+        while (seconds < minSeconds / SAMPLES)
+        {
+            auto start = std::chrono::steady_clock::now();
+            int done = op(BATCH_OPS);
+            seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            ops += static_cast<uint64_t>(done);
+            if (done < BATCH_OPS)
+                rewind();
+        }
+        sample = ops > 0 ? seconds * 1e9 / static_cast<double>(ops) : 0.0;
+        totalOps += ops;
+    }
+    std::sort(samples, samples + SAMPLES);
+    return { samples[SAMPLES / 2], samples[0], totalOps };
+}
+
+// A square board with a serpentine snake covering the given fraction of it. The head
+// can keep following the serpentine until the board is full, so every tick is an
+// ordinary move (or a meal) with no collision. No obstacles, so nothing ends the game.
+class Fixture
+{
+public:
+    Fixture(int size, double fill) : game(size, size, 1)
+    {
+        game.SetObstacleCount(0);
+        game.Reset(1);
+
+        int cellCount = size * size;
+        path.reserve(cellCount);
+        for (int y = 0; y < size; ++y)
+        {
+            for (int i = 0; i < size; ++i)
+                path.push_back({ (y % 2 == 0) ? i : size - 1 - i, y });
+        }
+        headings.resize(cellCount);
+        for (int i = 0; i + 1 < cellCount; ++i)
+            headings[i] = Heading(path[i], path[i + 1]);
+        headings[cellCount - 1] = headings[cellCount - 2];
+
+        length = std::min(std::max(3, static_cast<int>(fill * cellCount)), cellCount - 1);
+        std::vector<Segment> body(path.begin(), path.begin() + length);
+        std::reverse(body.begin(), body.end());
+        game.ArrangeSnake(body.data(), length, headings[length - 2]);
+        game.StartGame();
+
+        start.reset(new SnakeSnapshot(game));
+        game.Snapshot(start->Data());
+        Rewind();
+    }
+
+    void Rewind()
+    {
+        game.Restore(start->Data());
+        next = length;
+    }
+
+    // Heading that enters the next serpentine cell, or false once the board is full
+    bool NextHeading(Direction& dir)
+    {
+        if (next >= static_cast<int>(path.size()) || game.IsGameOver())
+            return false;
+        dir = headings[next - 1];
+        ++next;
+        return true;
+    }
+
+    SnakeGame game;
+    int length;
+
+private:
+    static Direction Heading(Segment from, Segment to)
+    {
+        if (to.x > from.x) return Direction::RIGHT;
+        if (to.x < from.x) return Direction::LEFT;
+        return to.y > from.y ? Direction::DOWN : Direction::UP;
+    }
+
+    std::vector<Segment> path;
+    std::vector<Direction> headings;
+    std::unique_ptr<SnakeSnapshot> start;
+    int next = 0;
+};
+
+struct Case
+{
+    std::string name;
+    int grid;
+    double fill;
+    int length;
+    Timing timing;
+};
+
+void RunSimulationCases(const Options& options, std::vector<Case>& cases)
+{
+    for (int size : options.sizes)
+    {
+        for (double fill : FILLS)
+        {
+            Fixture fixture(size, fill);
+            SnakeGame& game = fixture.game;
+            auto rewind = [&]() { fixture.Rewind(); };
+
+            // One whole tick through the real-time driver
+            Timing update = Measure(options.minSeconds, [&](int maxOps)
+            {
+                int done = 0;
+                Direction dir;
+                while (done < maxOps && fixture.NextHeading(dir))
+                {
+                    game.SetDirection(dir);
+                    game.Update(game.GetMoveDelay());
+                    ++done;
+                }
+                return done;
+            }, rewind);
+            cases.push_back({ "SnakeGame::Update", size, fill, fixture.length, update });
+            fixture.Rewind();
+
+            Timing move = Measure(options.minSeconds, [&](int maxOps)
+            {
+                int done = 0;
+                Direction dir;
+                while (done < maxOps && fixture.NextHeading(dir))
+                {
+                    SnakeGameBench::MoveSnake(game, dir);
+                    ++done;
+                }
+                return done;
+            }, rewind);
+            cases.push_back({ "SnakeGame::MoveSnake", size, fill, fixture.length, move });
+            fixture.Rewind();
+
+            // Both read the board without changing it, so one position serves every call
+            Timing check = Measure(options.minSeconds, [&](int maxOps)
+            {
+                for (int i = 0; i < maxOps; ++i)
+                    SnakeGameBench::CheckCollisions(game);
+                return maxOps;
+            }, rewind);
+            cases.push_back({ "SnakeGame::CheckCollisions", size, fill, fixture.length, check });
+
+            Timing spawn = Measure(options.minSeconds, [&](int maxOps)
+            {
+                for (int i = 0; i < maxOps; ++i)
+                    SnakeGameBench::SpawnFood(game);
+                return maxOps;
+            }, rewind);
+            cases.push_back({ "SnakeGame::SpawnFood", size, fill, fixture.length, spawn });
+        }
+    }
+}
+
+#ifdef SNAKE_BENCH_RENDER
+const ImVec2 CANVAS_POS(0.0f, 0.0f);
+const ImVec2 CANVAS_SIZE(800.0f, 800.0f);
+
+// Headless ImGui context: no backend and nothing presented. One frame stays open so
+// the renderer can read colours and the draw list shared data.
+void BeginHeadlessFrame()
+{
+    ImGui::CreateContext();
+    ImGuiIO& io = ImGui::GetIO();
+    io.DisplaySize = ImVec2(CANVAS_SIZE.x, CANVAS_SIZE.y);
+    io.DeltaTime = 1.0f / 60.0f;
+    unsigned char* pixels = nullptr;
+    int width = 0, height = 0;
+    io.Fonts->GetTexDataAsRGBA32(&pixels, &width, &height);
+    ImGui::NewFrame();
+}
+
+void EndHeadlessFrame()
+{
+    ImGui::EndFrame();
+    ImGui::DestroyContext();
+}
+
+void RunRenderCases(const Options& options, std::vector<Case>& cases)
+{
+    BeginHeadlessFrame();
+    ImDrawList drawList(ImGui::GetDrawListSharedData());
+
+    for (int batched = 1; batched >= 0; --batched)
+    {
+        const char* name = batched ? "SnakeRenderer::Render(batched)" : "SnakeRenderer::Render(legacy)";
+        for (int size : options.sizes)
+        {
+            for (double fill : FILLS)
+            {
+                Fixture fixture(size, fill);
+                SnakeRenderer renderer;
+                renderer.SetBatched(batched != 0);
+                // Whole board in view, down to the minimum zoom
+                renderer.GetCamera().cellSize = SnakeRenderer::FitCellSize(fixture.game, CANVAS_SIZE);
+                renderer.GetCamera().followHead = false;
+
+                Timing render = Measure(options.minSeconds, [&](int maxOps)
+                {
+                    // A few frames per batch, each into an emptied draw list; a short
+                    // batch only triggers the (empty) rewind
+                    int frames = std::max(1, maxOps / 64);
+                    for (int i = 0; i < frames; ++i)
+                    {
+                        drawList._ResetForNewFrame();
+                        drawList.PushClipRectFullScreen();
+                        renderer.Render(fixture.game, &drawList, CANVAS_POS, CANVAS_SIZE);
+                    }
+                    return frames;
+                }, [] {});
+                cases.push_back({ name, size, fill, fixture.length, render });
+            }
+        }
+    }
+
+    drawList._ClearFreeMemory();
+    EndHeadlessFrame();
+}
+#endif
+
+void WriteJson(std::FILE* out, const Options& options, const std::vector<Case>& cases)
+{
+#ifdef NDEBUG
+    const char* build = "release";
+#else
+    const char* build = "debug";
+#endif
+    std::fprintf(out, "{\n  \"suite\": \"snake_micro\",\n  \"format\": 1,\n  \"build\": \"%s\",\n", build);
+    std::fprintf(out, "  \"min_seconds_per_case\": %g,\n  \"samples\": %d,\n  \"results\": [\n", options.minSeconds, SAMPLES);
+    for (size_t i = 0; i < cases.size(); ++i)
+    {
+        const Case& c = cases[i];
+        std::fprintf(out,
+            "    { \"name\": \"%s\", \"grid\": %d, \"fill\": %.2f, \"length\": %d, "
+            "\"ns_per_op\": %.3f, \"best_ns_per_op\": %.3f, \"ops\": %llu }%s\n",
+            c.name.c_str(), c.grid, c.fill, c.length, c.timing.medianNs, c.timing.bestNs,
+            static_cast<unsigned long long>(c.timing.ops), i + 1 < cases.size() ? "," : "");
+    }
+    std::fprintf(out, "  ]\n}\n");
+}
+
+bool ParseOptions(int argc, char** argv, Options& options)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        bool hasValue = i + 1 < argc;
+        if (std::strcmp(argv[i], "--out") == 0 && hasValue)
+            options.outPath = argv[++i];
+        else if (std::strcmp(argv[i], "--min-time") == 0 && hasValue)
+            options.minSeconds = std::atof(argv[++i]);
+        else if (std::strcmp(argv[i], "--sizes") == 0 && hasValue)
+        {
+            // Comma-separated list of square board sizes
+            options.sizes.clear();
+            for (const char* p = argv[++i]; *p;)
+            {
+                char* end = nullptr;
+                long size = std::strtol(p, &end, 10);
+                if (end == p || size < 8)
+                    return false;
+                options.sizes.push_back(static_cast<int>(size));
+                p = *end == ',' ? end + 1 : end;
+            }
+        }
+        else
+            return false;
+    }
+    return !options.sizes.empty() && options.minSeconds > 0.0;
+}
+}
+
+int main(int argc, char** argv)
+{
+    Options options;
+    if (!ParseOptions(argc, argv, options))
+    {
+        std::fprintf(stderr, "Usage: bench_micro [--out FILE.json] [--min-time SECONDS] [--sizes 20,64,256,1024]\n");
+        return 1;
+    }
+
+    std::vector<Case> cases;
+    RunSimulationCases(options, cases);
+#ifdef SNAKE_BENCH_RENDER
+    RunRenderCases(options, cases);
+#endif
+
+    std::FILE* out = options.outPath ? std::fopen(options.outPath, "w") : stdout;
+    if (!out)
+    {
+        std::fprintf(stderr, "cannot create %s\n", options.outPath);
+        return 1;
+    }
+    WriteJson(out, options, cases);
+    if (out != stdout)
+        std::fclose(out);
+    return 0;
+}
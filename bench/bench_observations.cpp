@@ -0,0 +1,220 @@
+// Measures the shared-memory observation export: the cost per frame of serializing the
+// game with SaveState, rasterizing every frame and the incremental exporter on greedy
+// games, then frames per second through the ring with a reader thread that opens it by
+// name, sleeps on the futex and sums every plane it reads.
+
+#include "ObservationExport.h"
+#include "Policies.h"
+#include "SnakeGame.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+namespace
+{
+using Clock = std::chrono::steady_clock;
+
+// Only this benchmark uses the name, so a ring an interrupted run left behind is replaced
+const char* RING_NAME = "snake_bench_observations";
+
+enum class Export { NONE, SAVE_STATE, RASTER, INCREMENTAL };
+
+const int ROUNDS = 3;
+
+const char* ExportName(Export mode)
+{
+    switch (mode)
+    {
+    case Export::NONE: return "game only";
+    case Export::SAVE_STATE: return "SaveState";
+    case Export::RASTER: return "raster";
+    case Export::INCREMENTAL: return "incremental";
+    }
+    return "";
+}
+
+// Plays greedy games with `obstacles` obstacles for `frames` ticks, exporting each one
+double Run(int size, int obstacles, Export mode, uint64_t frames, ObservationExportStats& stats)
+{
+    SnakeGame game(size, size);
+    game.SetObstacleCount(obstacles);
+    ObservationExporter exporter;
+    if (mode == Export::RASTER || mode == Export::INCREMENTAL)
+    {
+        if (!exporter.Create(RING_NAME, size, size, ObservationExporter::DEFAULT_CAPACITY, true))
+        {
+            std::fprintf(stderr, "cannot create the shared-memory ring\n");
+            std::exit(1);
+        }
+        exporter.SetIncremental(mode == Export::INCREMENTAL);
+        game.AddListener(&exporter);
+    }
+    std::vector<uint8_t> state;
+    uint64_t seed = 1;
+    uint64_t done = 0;
+
+    Clock::time_point start = Clock::now();
+    while (done < frames)
+    {
+        game.Reset(seed++);
+        game.StartGame();
+        if (exporter.IsOpen())
+            exporter.Publish(game);
+        while (!game.IsGameOver() && done < frames)
+        {
+            game.SetDirection(GreedyPolicy(game));
+            game.Step();
+            if (mode == Export::SAVE_STATE)
+                game.SaveState(state);
+            ++done;
+        }
+    }
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    game.RemoveListener(&exporter);
+    stats = exporter.GetStats();
+    return seconds;
+}
+
+void ExportCosts(int size, int obstacles, uint64_t frames)
+{
+    std::printf("\n%dx%d board, %d obstacle(s), %llu frames\n", size, size, obstacles,
+        static_cast<unsigned long long>(frames));
+    std::printf("%-12s %14s %16s %10s %10s %10s\n", "export", "frames/s", "ns/frame export", "raster", "replay", "copy");
+    const Export modes[] = { Export::NONE, Export::SAVE_STATE, Export::RASTER, Export::INCREMENTAL };
+    const int MODE_COUNT = sizeof(modes) / sizeof(modes[0]);
+    // Whichever mode runs later runs slower, so the modes take turns and keep their best
+    double best[MODE_COUNT];
+    ObservationExportStats stats[MODE_COUNT];
+    for (int round = 0; round < ROUNDS; ++round)
+    {
+        for (int i = 0; i < MODE_COUNT; ++i)
+        {
+            double seconds = Run(size, obstacles, modes[i], frames, stats[i]);
+            best[i] = round == 0 ? seconds : std::min(best[i], seconds);
+        }
+    }
+    double baseline = best[0];
+    for (int i = 0; i < MODE_COUNT; ++i)
+    {
+        Export mode = modes[i];
+        double seconds = best[i];
+        double exportNanos = (seconds - baseline) * 1e9 / frames;
+        std::printf("%-12s %14.0f %16.1f", ExportName(mode), frames / seconds, mode == Export::NONE ? 0.0 : exportNanos);
+        if (mode == Export::RASTER || mode == Export::INCREMENTAL)
+            std::printf(" %10llu %10llu %10llu", static_cast<unsigned long long>(stats[i].rasterized),
+                static_cast<unsigned long long>(stats[i].replayed), static_cast<unsigned long long>(stats[i].copied));
+        std::printf("\n");
+    }
+}
+
+// Writer on this thread, reader on another opening the ring by name as a trainer would
+void Throughput(int size, uint64_t frames)
+{
+    ObservationExporter exporter;
+    if (!exporter.Create(RING_NAME, size, size, 64, true))
+    {
+        std::fprintf(stderr, "cannot create the shared-memory ring\n");
+        std::exit(1);
+    }
+
+    std::atomic<bool> ready(false);
+    uint64_t read = 0, lost = 0, torn = 0, checksum = 0;
+    std::thread reader([&]
+    {
+        ObservationReader ring;
+        if (!ring.Open(RING_NAME))
+        {
+            std::fprintf(stderr, "cannot open the shared-memory ring\n");
+            std::exit(1);
+        }
+        ready = true;
+        size_t cells = static_cast<size_t>(size) * size;
+        uint64_t next = 0;
+        for (;;)
+        {
+            uint64_t published = ring.Wait(next, 100);
+            if (published <= next)
+            {
+                if (ring.IsWriterClosed())
+                    break;
+                continue;
+            }
+            // Frames the writer lapped are gone; skip to the oldest still in the ring
+            if (published - next > static_cast<uint64_t>(ring.GetCapacity()) - 1)
+            {
+                uint64_t oldest = published - (ring.GetCapacity() - 1);
+                lost += oldest - next;
+                next = oldest;
+            }
+            for (; next < published; ++next)
+            {
+                ObservationView view;
+                if (!ring.Read(next, view))
+                {
+                    ++lost;
+                    continue;
+                }
+                uint64_t sum = 0;
+                for (int plane = 0; plane < OBSERVATION_PLANES; ++plane)
+                {
+                    for (size_t cell = 0; cell < cells; ++cell)
+                        sum += view.planes[plane][cell];
+                }
+                if (!ring.Validate(view))
+                {
+                    ++torn;
+                    continue;
+                }
+                checksum += sum;
+                ++read;
+            }
+        }
+    });
+    while (!ready)
+        std::this_thread::yield();
+
+    SnakeGame game(size, size);
+    game.AddListener(&exporter);
+    uint64_t seed = 1;
+    Clock::time_point start = Clock::now();
+    while (exporter.GetStats().published < frames)
+    {
+        game.Reset(seed++);
+        game.StartGame();
+        exporter.Publish(game);
+        while (!game.IsGameOver() && exporter.GetStats().published < frames)
+        {
+            game.SetDirection(GreedyPolicy(game));
+            game.Step();
+        }
+    }
+    double writeSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+    game.RemoveListener(&exporter);
+    exporter.Close();
+    reader.join();
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    std::printf("%dx%d  written %10.0f frames/s  read %10.0f frames/s  read %llu lost %llu torn %llu (checksum %llu)\n",
+        size, size, frames / writeSeconds, read / seconds, static_cast<unsigned long long>(read),
+        static_cast<unsigned long long>(lost), static_cast<unsigned long long>(torn),
+        static_cast<unsigned long long>(checksum));
+}
+}
+
+int main(int argc, char** argv)
+{
+    uint64_t frames = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+
+    ExportCosts(20, 1, frames);
+    ExportCosts(64, 1, frames);
+    ExportCosts(64, 16, frames);
+
+    std::printf("\nRing throughput, one reader thread\n");
+    Throughput(20, frames);
+    Throughput(64, frames);
+    return 0;
+}
@@ -0,0 +1,108 @@
+// Measures SnakeGame tick time against the number of moving obstacles, moving them on
+// the calling thread and in parallel chunks on a thread pool, and checks that both
+// updates produce the same game.
+
+#include "SnakeGame.h"
+#include "ThreadPool.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+namespace
+{
+const int BOARD_SIZE = 1024;
+const int CHECK_TICKS = 200;
+
+// Keeps the snake circling a 2x2 square in the middle of the board so only the
+// obstacles can end a game
+const Direction LOOP[4] = { Direction::DOWN, Direction::LEFT, Direction::UP, Direction::RIGHT };
+
+void StartGame(SnakeGame& game, uint64_t seed)
+{
+    game.Reset(seed);
+    game.StartGame();
+}
+
+void StepLooping(SnakeGame& game)
+{
+    game.SetDirection(LOOP[game.GetTick() % 4]);
+    game.Step();
+}
+
+struct Result
+{
+    double microsPerTick;
+    int gamesLost;  // Games an obstacle ended; resets are not timed
+};
+
+Result Bench(int obstacleCount, ThreadPool* pool, uint64_t ticks)
+{
+    SnakeGame game(BOARD_SIZE, BOARD_SIZE, 1);
+    game.SetObstacleCount(obstacleCount);
+    game.SetObstaclePool(pool);
+    uint64_t seed = 1;
+    StartGame(game, seed);
+
+    Result result = { 0.0, 0 };
+    double seconds = 0.0;
+    uint64_t done = 0;
+    while (done < ticks)
+    {
+        if (game.IsGameOver())
+        {
+            ++result.gamesLost;
+            StartGame(game, ++seed);
+        }
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < 64 && done < ticks && !game.IsGameOver(); ++i, ++done)
+            StepLooping(game);
+        seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+    result.microsPerTick = seconds * 1e6 / static_cast<double>(ticks);
+    return result;
+}
+
+// Plays the same seed with and without the pool and compares the saved states
+bool SameGame(int obstacleCount, ThreadPool& pool)
+{
+    SnakeGame serial(BOARD_SIZE, BOARD_SIZE, 7);
+    SnakeGame parallel(BOARD_SIZE, BOARD_SIZE, 7);
+    serial.SetObstacleCount(obstacleCount);
+    parallel.SetObstacleCount(obstacleCount);
+    parallel.SetObstaclePool(&pool);
+    StartGame(serial, 7);
+    StartGame(parallel, 7);
+    for (int i = 0; i < CHECK_TICKS; ++i)
+    {
+        StepLooping(serial);
+        StepLooping(parallel);
+    }
+
+    std::vector<uint8_t> a, b;
+    serial.SaveState(a);
+    parallel.SaveState(b);
+    return a == b;
+}
+}
+
+int main(int argc, char** argv)
+{
+    uint64_t ticks = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 2000;
+    ThreadPool pool;
+
+    std::printf("%dx%d board, %llu ticks per run, %d threads\n", BOARD_SIZE, BOARD_SIZE,
+        static_cast<unsigned long long>(ticks), pool.GetThreadCount());
+    std::printf("%10s %14s %14s %9s %6s %6s\n", "obstacles", "serial us/tick", "pooled us/tick", "speedup", "lost", "same");
+
+    const int counts[] = { 1, 16, 256, 4096, 16384, 65536, 262144 };
+    for (int count : counts)
+    {
+        Result serial = Bench(count, nullptr, ticks);
+        Result pooled = Bench(count, &pool, ticks);
+        std::printf("%10d %14.3f %14.3f %8.2fx %6d %6s\n", count, serial.microsPerTick, pooled.microsPerTick,
+            pooled.microsPerTick > 0.0 ? serial.microsPerTick / pooled.microsPerTick : 0.0, serial.gamesLost,
+            SameGame(count, pool) ? "yes" : "NO");
+    }
+    return 0;
+}
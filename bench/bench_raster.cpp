@@ -0,0 +1,192 @@
+// Frame time and fill rate of the software rasterizer drawing the play area, over board
+// sizes and thread counts. With the ImGui sources (SNAKE_BENCH_RENDER) each frame is
+// SnakeRenderer's draw data for a headless Play Area canvas; without them it is the same
+// picture built by BoardQuadScene from the quads the renderer emits (grid lines, body
+// runs, food), so the rasterizer can be measured on machines with neither ImGui nor a GPU.
+//
+// Boards hold a serpentine snake over half their cells and are fitted to the canvas
+// down to one pixel per cell, so the 1024 board shows its top-left 800x800 cells.
+
+#include "SnakeGame.h"
+#include "SoftwareRasterizer.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <vector>
+#ifdef SNAKE_BENCH_RENDER
+#include "DrawDataRasterizer.h"
+#include "SnakeRenderer.h"
+#else
+#include "BoardQuadScene.h"
+#endif
+
+namespace
+{
+const int GRID_SIZES[] = { 20, 64, 256, 1024 };
+const double FILL = 0.5;
+const int CANVAS_SIZE = 800;
+const uint32_t CLEAR_COLOR = 0xFF190C0C;  // main.cpp's clear colour
+
+struct Report
+{
+    double frameMs = 0.0, setupMs = 0.0, rasterMs = 0.0;  // Medians
+    RasterStats stats;  // Of the last frame; every frame draws the same
+};
+
+double Median(std::vector<double>& values)
+{
+    std::sort(values.begin(), values.end());
+    return values.empty() ? 0.0 : values[values.size() / 2];
+}
+
+// Clears the image and draws a frame with draw(), which returns the frame's statistics,
+// until `seconds` have gone by
+template <typename Draw>
+Report Measure(double seconds, RasterImage& image, Draw draw)
+{
+    std::vector<double> frame, setup, raster;
+    Report report;
+    auto start = std::chrono::steady_clock::now();
+    while (std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() < seconds || frame.size() < 3)
+    {
+        auto frameStart = std::chrono::steady_clock::now();
+        image.Clear(CLEAR_COLOR);
+        report.stats = draw();
+        frame.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - frameStart).count());
+        setup.push_back(report.stats.setupSeconds * 1000.0);
+        raster.push_back(report.stats.rasterSeconds * 1000.0);
+    }
+    report.frameMs = Median(frame);
+    report.setupMs = Median(setup);
+    report.rasterMs = Median(raster);
+    return report;
+}
+
+// A snake along a serpentine path over FILL of the board, head last
+void ArrangeBoard(SnakeGame& game, int size)
+{
+    game.SetObstacleCount(0);
+    game.Reset(1);
+    int length = static_cast<int>(FILL * size * size);
+    std::vector<Segment> body;
+    body.reserve(length);
+    for (int i = 0; i < length; ++i)
+    {
+        int y = i / size, x = i % size;
+        body.push_back({ (y % 2 == 0) ? x : size - 1 - x, y });
+    }
+    std::reverse(body.begin(), body.end());
+    Segment head = body[0], neck = body[1];
+    Direction heading = head.x > neck.x ? Direction::RIGHT : head.x < neck.x ? Direction::LEFT
+        : head.y > neck.y ? Direction::DOWN : Direction::UP;
+    game.ArrangeSnake(body.data(), length, heading);
+    game.StartGame();
+}
+
+#ifdef SNAKE_BENCH_RENDER
+// Headless ImGui context with the font atlas built and registered with the rasterizer
+void BeginHeadless(DrawDataRasterizer& rasterizer)
+{
+    ImGui::CreateContext();
+    ImGuiIO& io = ImGui::GetIO();
+    io.IniFilename = nullptr;
+    io.DisplaySize = ImVec2(static_cast<float>(CANVAS_SIZE), static_cast<float>(CANVAS_SIZE));
+    io.DeltaTime = 1.0f / 60.0f;
+    unsigned char* pixels = nullptr;
+    int width = 0, height = 0;
+    io.Fonts->GetTexDataAsRGBA32(&pixels, &width, &height);
+    ImTextureID fontId = (ImTextureID)(intptr_t)1;
+    io.Fonts->SetTexID(fontId);
+    RasterTexture font;
+    font.pixels = reinterpret_cast<const uint32_t*>(pixels);
+    font.width = width;
+    font.height = height;
+    rasterizer.SetTexture(fontId, font);
+}
+
+// One frame with a borderless window filled by the play area canvas
+const ImDrawData& BuildFrame(SnakeRenderer& renderer, const SnakeGame& game)
+{
+    ImGui::NewFrame();
+    ImGui::SetNextWindowPos(ImVec2(0.0f, 0.0f));
+    ImGui::SetNextWindowSize(ImGui::GetIO().DisplaySize);
+    ImGui::Begin("Play Area", nullptr, ImGuiWindowFlags_NoDecoration);
+    ImVec2 canvasPos = ImGui::GetCursorScreenPos();
+    ImVec2 canvasSize = ImGui::GetContentRegionAvail();
+    renderer.GetCamera().cellSize = SnakeRenderer::FitCellSize(game, canvasSize);
+    renderer.GetCamera().followHead = false;
+    renderer.GetCamera().center = ImVec2(0.0f, 0.0f);  // Clamped to the top-left corner
+    renderer.Render(game, ImGui::GetWindowDrawList(), canvasPos, canvasSize);
+    ImGui::End();
+    ImGui::Render();
+    return *ImGui::GetDrawData();
+}
+#endif
+}
+
+int main(int argc, char** argv)
+{
+    double seconds = argc > 1 ? std::atof(argv[1]) : 1.0;
+    int maxThreads = argc > 2 ? std::atoi(argv[2]) : ThreadPool::HardwareThreads();
+    std::vector<int> threadCounts = { 1 };
+    if (maxThreads > 1)
+        threadCounts.push_back(maxThreads);
+
+#ifdef SNAKE_BENCH_RENDER
+    const char* source = "SnakeRenderer draw data";
+#else
+    const char* source = "renderer-equivalent quads (no ImGui)";
+#endif
+    std::printf("%dx%d canvas, %.0f%% board fill, %s, %d px tiles, %.1f s per case\n", CANVAS_SIZE, CANVAS_SIZE,
+        FILL * 100.0, source, SoftwareRasterizer::TILE_SIZE, seconds);
+    std::printf("%6s %7s %9s %9s %10s %9s %9s %9s %11s %10s\n", "grid", "threads", "prims", "binned",
+        "pixels", "frame ms", "setup ms", "raster ms", "fill Mpx/s", "frames/s");
+
+    RasterImage image;
+    image.Resize(CANVAS_SIZE, CANVAS_SIZE);
+    for (int threads : threadCounts)
+    {
+        std::unique_ptr<ThreadPool> pool(threads > 1 ? new ThreadPool(threads) : nullptr);
+#ifdef SNAKE_BENCH_RENDER
+        DrawDataRasterizer rasterizer(pool.get());
+        BeginHeadless(rasterizer);
+#else
+        SoftwareRasterizer rasterizer(pool.get());
+        BoardQuadScene scene;
+#endif
+        for (int size : GRID_SIZES)
+        {
+            SnakeGame game(size, size, 1);
+            ArrangeBoard(game, size);
+#ifdef SNAKE_BENCH_RENDER
+            SnakeRenderer renderer;
+            const ImDrawData& drawData = BuildFrame(renderer, game);
+            Report report = Measure(seconds, image, [&]
+            {
+                rasterizer.Render(drawData, image);
+                return rasterizer.GetLastStats();
+            });
+#else
+            scene.Build(game, CANVAS_SIZE);
+            Report report = Measure(seconds, image, [&]
+            {
+                rasterizer.Draw(&scene.GetCall(), 1, image);
+                return rasterizer.GetLastStats();
+            });
+#endif
+            const RasterStats& stats = report.stats;
+            std::printf("%6d %7d %9llu %9llu %10llu %9.3f %9.3f %9.3f %11.1f %10.1f\n", size, threads,
+                static_cast<unsigned long long>(stats.primitives), static_cast<unsigned long long>(stats.binnedPrimitives),
+                static_cast<unsigned long long>(stats.pixels), report.frameMs, report.setupMs, report.rasterMs,
+                stats.pixels / (report.frameMs * 1000.0), 1000.0 / report.frameMs);
+        }
+#ifdef SNAKE_BENCH_RENDER
+        ImGui::DestroyContext();
+#endif
+    }
+    return 0;
+}
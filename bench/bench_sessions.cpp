@@ -0,0 +1,63 @@
+// Soak test of the session host: opens 1k, 10k and 100k greedy sessions spread over the
+// three speeds, lets them run for a while and reports how late their ticks ran against
+// their deadlines, with the tick rate achieved against the rate the sessions ask for.
+// Statistics start after a warm-up, once every session has been set up and ticked.
+
+#include "Policies.h"
+#include "SessionHost.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+
+namespace
+{
+const int SESSION_COUNTS[] = { 1000, 10000, 100000 };
+const SessionSpeed SPEEDS[] = { SessionSpeed::SLOW, SessionSpeed::NORMAL, SessionSpeed::FAST };
+const double WARM_UP_SECONDS = 1.0;
+
+void Soak(int sessions, double seconds, int threads)
+{
+    SessionHostConfig config;
+    config.threads = threads;
+    config.policy = GreedyPolicy;
+    SessionHost host(config);
+
+    // Ticks per second the sessions are owed, from the game's move delay at each speed
+    double demand = 0.0;
+    double moveDelay = SnakeGame().GetMoveDelay();
+    for (int i = 0; i < sessions; ++i)
+    {
+        SessionSpeed speed = SPEEDS[i % 3];
+        host.Open(static_cast<uint64_t>(i) + 1, speed);
+        demand += 1.0 / (moveDelay * SessionSpeedFactor(speed));
+    }
+
+    host.Start();
+    std::this_thread::sleep_for(std::chrono::duration<double>(WARM_UP_SECONDS));
+    host.ResetStats();
+    std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+    host.Stop();
+
+    SessionHostStats stats = host.GetStats();
+    const Distribution& late = stats.lateness;
+    std::printf("%9d %7d %12.0f %12.0f %8.1f%% %8d %8d %8d %8d %9llu %10llu %8llu\n", sessions, host.GetShardCount(),
+        demand, stats.ticks / seconds, 100.0 * stats.busySeconds / (seconds * host.GetShardCount()),
+        late.Percentile(0.5), late.Percentile(0.9), late.Percentile(0.99), late.Percentile(0.999),
+        static_cast<unsigned long long>(stats.maxLatenessMicros), static_cast<unsigned long long>(stats.skippedTicks),
+        static_cast<unsigned long long>(stats.games));
+}
+}
+
+int main(int argc, char** argv)
+{
+    double seconds = argc > 1 ? std::atof(argv[1]) : 10.0;
+    int threads = argc > 2 ? std::atoi(argv[2]) : 0;
+
+    std::printf("%.0f s per run, 20x20 boards with 1 obstacle, lateness in microseconds\n", seconds);
+    std::printf("%9s %7s %12s %12s %9s %8s %8s %8s %8s %9s %10s %8s\n", "sessions", "shards", "ticks/s owed",
+        "ticks/s run", "busy", "p50", "p90", "p99", "p99.9", "max", "skipped", "games");
+    for (int sessions : SESSION_COUNTS)
+        Soak(sessions, seconds, threads);
+    return 0;
+}
@@ -0,0 +1,118 @@
+// Measures SnakeGame::Snapshot/Restore throughput for snakes from the starting length up
+// to a full board, and counts heap allocations inside the timed clone/step/restore loop.
+
+#include "SnakeGame.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <vector>
+
+namespace
+{
+std::atomic<uint64_t> g_allocations(0);
+}
+
+void* operator new(std::size_t size)
+{
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+namespace
+{
+// Serpentine layout of the first `length` cells, head first, ending at the origin. The
+// head sits on the last row so it can move straight on along the next free cell.
+std::vector<Segment> Serpentine(int width, int height, int length)
+{
+    std::vector<Segment> path;
+    path.reserve(static_cast<size_t>(width) * height);
+    for (int y = 0; y < height; ++y)
+    {
+        for (int i = 0; i < width; ++i)
+            path.push_back({ (y % 2 == 0) ? i : width - 1 - i, y });
+    }
+    std::vector<Segment> body(path.begin(), path.begin() + length);
+    return std::vector<Segment>(body.rbegin(), body.rend());
+}
+
+struct Result
+{
+    double clonesPerSecond;  // Snapshot + Restore pairs
+    double cyclesPerSecond;  // Snapshot + Step + Restore
+    uint64_t allocations;
+};
+
+Result Bench(int width, int height, int length, int iterations)
+{
+    SnakeGame game(width, height, 1);
+    std::vector<Segment> body = Serpentine(width, height, length);
+    game.ArrangeSnake(body.data(), length, Direction::RIGHT);
+    game.StartGame();
+    SnakeSnapshot snapshot(game);
+
+    Result result;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i)
+    {
+        game.Snapshot(snapshot.Data());
+        game.Restore(snapshot.Data());
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    result.clonesPerSecond = iterations / seconds;
+
+    uint64_t allocationsBefore = g_allocations.load();
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i)
+    {
+        game.Snapshot(snapshot.Data());
+        game.SetDirection(static_cast<Direction>(i & 3));
+        game.Step();
+        game.Restore(snapshot.Data());
+    }
+    seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    result.cyclesPerSecond = iterations / seconds;
+    result.allocations = g_allocations.load() - allocationsBefore;
+    return result;
+}
+}
+
+int main(int argc, char** argv)
+{
+    int width = 20, height = 20, iterations = 200000;
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        if (std::strcmp(argv[i], "--width") == 0)
+            width = std::atoi(argv[i + 1]);
+        else if (std::strcmp(argv[i], "--height") == 0)
+            height = std::atoi(argv[i + 1]);
+        else if (std::strcmp(argv[i], "--iterations") == 0)
+            iterations = std::atoi(argv[i + 1]);
+    }
+    if (width < 8 || height < 8 || iterations <= 0)
+    {
+        std::printf("Usage: bench_snapshot [--width W] [--height H] [--iterations N]\n");
+        return 1;
+    }
+
+    SnakeGame probe(width, height, 1);
+    std::printf("grid %dx%d, snapshot %zu bytes, %d iterations\n", width, height, probe.GetSnapshotSize(), iterations);
+    std::printf("%8s %14s %14s %8s\n", "length", "clones/s", "cycles/s", "allocs");
+
+    const int capacity = width * height;
+    const int lengths[] = { 3, capacity / 8, capacity / 4, capacity / 2, capacity * 3 / 4, capacity };
+    for (int length : lengths)
+    {
+        Result result = Bench(width, height, length, iterations);
+        std::printf("%8d %14.0f %14.0f %8llu\n", length, result.clonesPerSecond, result.cyclesPerSecond,
+            static_cast<unsigned long long>(result.allocations));
+    }
+    return 0;
+}
@@ -0,0 +1,443 @@
+#include "Autopilot.h"
+#include "Policies.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+
+namespace
+{
+const int UNREACHABLE = 0x3FFFFFFF;  // Distance of blocked and cut-off cells; +1 cannot overflow
+
+bool SameCell(const Segment& a, const Segment& b)
+{
+    return a.x == b.x && a.y == b.y;
+}
+
+// An obstacle could step onto the cell next tick
+bool NextToObstacle(const OccupancyGrid& occupancy, const Segment& cell)
+{
+    return occupancy.HasObstacle(cell.x - 1, cell.y) || occupancy.HasObstacle(cell.x + 1, cell.y) ||
+        occupancy.HasObstacle(cell.x, cell.y - 1) || occupancy.HasObstacle(cell.x, cell.y + 1);
+}
+}
+
+Autopilot::Autopilot()
+    : width(0), height(0), generation(1), foodCell(-1), valid(false), lastSeed(0), lastTick(0), lastFood{ 0, 0 },
+    lastHead{ 0, 0 }, lastTail{ 0, 0 }, lastPlanSeconds(0.0), totalPlanSeconds(0.0), planCount(0),
+    fullRebuilds(0)
+{
+}
+
+Direction Autopilot::Plan(const SnakeGame& game)
+{
+    SNAKE_PROFILE_SCOPE("Autopilot::Plan");
+    auto start = std::chrono::steady_clock::now();
+
+    Direction dir = game.GetDirection();
+    if (game.IsGameOver())
+        valid = false;
+    else
+    {
+        Sync(game);
+        dir = ChooseMove(game);
+    }
+
+    lastPlanSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    totalPlanSeconds += lastPlanSeconds;
+    ++planCount;
+    return dir;
+}
+
+int Autopilot::GetDistance(int x, int y) const
+{
+    if (x < 0 || x >= width || y < 0 || y >= height || !valid)
+        return -1;
+    int d = dist[Index(x, y)];
+    return d < UNREACHABLE ? d : -1;
+}
+
+Direction Autopilot::ChooseMove(const SnakeGame& game)
+{
+    struct Candidate
+    {
+        Direction dir;
+        Segment next;
+        int key;
+    };
+
+    const SnakeBody& body = game.GetBody();
+    const OccupancyGrid& occupancy = game.GetOccupancy();
+    const Segment& head = body.Head();
+    const Segment& tail = body.Tail();
+    const Segment& food = game.GetFood();
+    Direction current = game.GetDirection();
+    const Direction order[4] = { Direction::UP, Direction::DOWN, Direction::LEFT, Direction::RIGHT };
+
+    Candidate candidates[4];
+    int candidateCount = 0;
+    for (Direction dir : order)
+    {
+        if (IsOppositeDirection(dir, current))
+            continue;
+        Segment next = StepCell(head, dir);
+        if (!occupancy.InBounds(next.x, next.y) || occupancy.HasObstacle(next.x, next.y))
+            continue;
+        // The tail cell is vacated this tick unless the snake eats
+        if (occupancy.HasBody(next.x, next.y) && !(SameCell(next, tail) && body.Size() > 1))
+            continue;
+
+        // Shorter paths first, then stay clear of the obstacles' reach, then keep going straight
+        int d = dist[Index(next.x, next.y)];
+        if (d < UNREACHABLE && NextToObstacle(occupancy, next))
+            d += 2;
+        candidates[candidateCount++] = { dir, next, d * 2 + (dir == current ? 0 : 1) };
+    }
+    for (int i = 1; i < candidateCount; ++i)
+    {
+        for (int j = i; j > 0 && candidates[j].key < candidates[j - 1].key; --j)
+            std::swap(candidates[j], candidates[j - 1]);
+    }
+
+    Direction fallback = current;
+    int fallbackArea = -1;
+    for (int i = 0; i < candidateCount; ++i)
+    {
+        bool reachesTail = false;
+        int area = FloodAfterMove(game, candidates[i].next, SameCell(candidates[i].next, food), reachesTail);
+        if (reachesTail)
+            return candidates[i].dir;
+        if (area > fallbackArea)
+        {
+            fallback = candidates[i].dir;
+            fallbackArea = area;
+        }
+    }
+    return fallback;
+}
+
+void Autopilot::Sync(const SnakeGame& game)
+{
+    if (game.GetGridWidth() != width || game.GetGridHeight() != height)
+    {
+        width = game.GetGridWidth();
+        height = game.GetGridHeight();
+        size_t cellCount = static_cast<size_t>(width) * height;
+        dist.assign(cellCount, UNREACHABLE);
+        blocked.assign(cellCount, 0);
+        queue.assign(cellCount, 0);
+        seeds.assign(cellCount, 0);
+        mark.assign(cellCount, 0);
+        generation = 1;
+        valid = false;
+    }
+
+    const Segment& head = game.GetBody().Head();
+    const Segment& tail = game.GetBody().Tail();
+    const Segment& food = game.GetFood();
+    const MovingBlock* obstacles = game.GetObstacles();
+    int obstacleCount = game.GetObstacleCount();
+    uint64_t tick = game.GetTick();
+
+    bool sameObstacles = obstacleCount == static_cast<int>(lastObstacles.size());
+    for (int i = 0; i < obstacleCount && sameObstacles; ++i)
+        sameObstacles = obstacles[i].x == lastObstacles[i].x && obstacles[i].y == lastObstacles[i].y;
+    bool unchanged = valid && tick == lastTick && game.GetSeed() == lastSeed && SameCell(head, lastHead) &&
+        SameCell(tail, lastTail) && sameObstacles && SameCell(food, lastFood);
+    if (unchanged)
+        return;
+
+    // One ordinary tick moves the head by one cell and keeps the food and the obstacle
+    // count; anything else (eating, reset, load, skipped ticks) takes a full rebuild
+    bool nextTick = valid && tick == lastTick + 1 && game.GetSeed() == lastSeed && SameCell(food, lastFood) &&
+        obstacleCount == static_cast<int>(lastObstacles.size()) &&
+        std::abs(head.x - lastHead.x) + std::abs(head.y - lastHead.y) == 1;
+    if (!nextTick)
+    {
+        Rebuild(game);
+        lastObstacles.resize(obstacleCount);
+        for (int i = 0; i < obstacleCount; ++i)
+            lastObstacles[i] = { obstacles[i].x, obstacles[i].y };
+    }
+    else
+    {
+        const Segment touched[4] = { lastTail, tail, lastHead, head };
+        for (const Segment& cell : touched)
+            Patch(game, cell);
+        for (int i = 0; i < obstacleCount; ++i)
+        {
+            Segment cell = { obstacles[i].x, obstacles[i].y };
+            if (SameCell(cell, lastObstacles[i]))
+                continue;
+            Patch(game, lastObstacles[i]);
+            Patch(game, cell);
+            lastObstacles[i] = cell;
+        }
+    }
+
+    valid = true;
+    lastSeed = game.GetSeed();
+    lastTick = tick;
+    lastFood = food;
+    lastHead = head;
+    lastTail = tail;
+}
+
+void Autopilot::Patch(const SnakeGame& game, Segment cell)
+{
+    if (cell.x < 0 || cell.x >= width || cell.y < 0 || cell.y >= height)
+        return;
+    int index = Index(cell.x, cell.y);
+    bool nowBlocked = IsBlockedIn(game, index);
+    if (nowBlocked != (blocked[index] != 0))
+    {
+        if (nowBlocked)
+            Block(index);
+        else
+            Unblock(index);
+    }
+}
+
+void Autopilot::Rebuild(const SnakeGame& game)
+{
+    ++fullRebuilds;
+    int cellCount = width * height;
+    for (int i = 0; i < cellCount; ++i)
+    {
+        dist[i] = UNREACHABLE;
+        blocked[i] = IsBlockedIn(game, i) ? 1 : 0;
+    }
+
+    const Segment& food = game.GetFood();
+    foodCell = Index(food.x, food.y);
+    if (!blocked[foodCell])
+    {
+        dist[foodCell] = 0;
+        seeds[0] = foodCell;
+        Relax(1);
+    }
+}
+
+void Autopilot::Block(int cell)
+{
+    blocked[cell] = 1;
+    int blockedDistance = dist[cell];
+    if (blockedDistance >= UNREACHABLE)
+        return;  // Nothing was routed through an unreachable cell
+    dist[cell] = UNREACHABLE;
+    if (cell == foodCell)
+    {
+        std::fill(dist.begin(), dist.end(), UNREACHABLE);
+        return;
+    }
+
+    // Invalidate every cell that has lost all its neighbours one step closer to the food.
+    // mark[] flags cells currently on the stack; a cell is re-checked each time one of its
+    // supports is invalidated.
+    NextGeneration();
+    int neighbours[4];
+    int stackSize = 0;
+    int count = NeighbourCount(cell, neighbours);
+    for (int i = 0; i < count; ++i)
+    {
+        if (dist[neighbours[i]] == blockedDistance + 1)
+        {
+            queue[stackSize++] = neighbours[i];
+            mark[neighbours[i]] = generation;
+        }
+    }
+
+    int invalidated = 0;
+    while (stackSize > 0)
+    {
+        int current = queue[--stackSize];
+        mark[current] = 0;
+        int d = dist[current];
+        if (d >= UNREACHABLE)
+            continue;
+
+        bool supported = false;
+        count = NeighbourCount(current, neighbours);
+        for (int i = 0; i < count && !supported; ++i)
+            supported = dist[neighbours[i]] == d - 1;
+        if (supported)
+            continue;
+
+        dist[current] = UNREACHABLE;
+        seeds[invalidated++] = current;
+        for (int i = 0; i < count; ++i)
+        {
+            int next = neighbours[i];
+            if (dist[next] == d + 1 && mark[next] != generation)
+            {
+                queue[stackSize++] = next;
+                mark[next] = generation;
+            }
+        }
+    }
+
+    // Re-seed the invalidated region from its valid border, nearest first
+    for (int i = 0; i < invalidated; ++i)
+    {
+        int best = UNREACHABLE;
+        count = NeighbourCount(seeds[i], neighbours);
+        for (int j = 0; j < count; ++j)
+            best = std::min(best, dist[neighbours[j]] + 1);
+        dist[seeds[i]] = std::min(best, UNREACHABLE);
+    }
+    std::sort(seeds.begin(), seeds.begin() + invalidated, [this](int a, int b) { return dist[a] < dist[b]; });
+    Relax(invalidated);
+}
+
+void Autopilot::Unblock(int cell)
+{
+    blocked[cell] = 0;
+    int best = UNREACHABLE;
+    if (cell == foodCell)
+        best = 0;
+    else
+    {
+        int neighbours[4];
+        int count = NeighbourCount(cell, neighbours);
+        for (int i = 0; i < count; ++i)
+            best = std::min(best, dist[neighbours[i]] + 1);
+    }
+    if (best >= UNREACHABLE)
+        return;
+    dist[cell] = best;
+    seeds[0] = cell;
+    Relax(1);
+}
+
+void Autopilot::Relax(int seedCount)
+{
+    // Two-queue multi-source BFS: seeds come pre-sorted by distance, cells reached from
+    // them go to a FIFO whose distances are non-decreasing, and the nearer head is popped
+    // first. The FIFO is a ring; mark[] keeps a cell in it at most once.
+    NextGeneration();
+    int cellCount = width * height;
+    int seedHead = 0, queueHead = 0, queueSize = 0;
+    int neighbours[4];
+    while (seedHead < seedCount || queueSize > 0)
+    {
+        int current;
+        if (queueSize > 0 && (seedHead >= seedCount || dist[queue[queueHead]] <= dist[seeds[seedHead]]))
+        {
+            current = queue[queueHead];
+            queueHead = queueHead + 1 == cellCount ? 0 : queueHead + 1;
+            --queueSize;
+            mark[current] = 0;
+        }
+        else
+            current = seeds[seedHead++];
+
+        int d = dist[current];
+        if (d >= UNREACHABLE)
+            continue;
+        int count = NeighbourCount(current, neighbours);
+        for (int i = 0; i < count; ++i)
+        {
+            int next = neighbours[i];
+            if (blocked[next] || dist[next] <= d + 1)
+                continue;
+            dist[next] = d + 1;
+            if (mark[next] != generation)
+            {
+                mark[next] = generation;
+                int tailSlot = queueHead + queueSize;
+                queue[tailSlot >= cellCount ? tailSlot - cellCount : tailSlot] = next;
+                ++queueSize;
+            }
+        }
+    }
+}
+
+int Autopilot::FloodAfterMove(const SnakeGame& game, Segment next, bool eats, bool& reachesTail)
+{
+    const SnakeBody& body = game.GetBody();
+    const OccupancyGrid& occupancy = game.GetOccupancy();
+    int bodySize = body.Size();
+
+    // After the move the old tail cell is free unless the snake grows, and the segment
+    // before it becomes the new tail
+    const Segment& oldTail = body.Tail();
+    const Segment& newTail = eats || bodySize < 2 ? oldTail : body[bodySize - 2];
+    int oldTailCell = Index(oldTail.x, oldTail.y);
+    int newTailCell = Index(newTail.x, newTail.y);
+    bool oldTailFreed = !eats && occupancy.BodyCount(oldTail.x, oldTail.y) == 1;
+
+    // Best-first search towards the tail. With the Manhattan distance as the estimate a
+    // step either keeps f = steps + estimate or raises it by 2, so two buckets make the
+    // priority queue: the current one is worked as a stack, the other waits for f + 2.
+    // Usually only a narrow band along the body is touched; a failed search still covers
+    // the whole reachable region, which is the fallback score.
+    NextGeneration();
+    int start = Index(next.x, next.y);
+    mark[start] = generation;
+    queue[0] = start;
+    int currentSize = 1, laterSize = 0, reached = 1;
+    int neighbours[4];
+    reachesTail = false;
+    while (currentSize > 0)
+    {
+        int current = queue[--currentSize];
+        int currentEstimate = std::abs(current % width - newTail.x) + std::abs(current / width - newTail.y);
+        int count = NeighbourCount(current, neighbours);
+        for (int i = 0; i < count; ++i)
+        {
+            int cell = neighbours[i];
+            if (cell == newTailCell && cell != start)
+            {
+                reachesTail = true;
+                return reached;
+            }
+            if (mark[cell] == generation)
+                continue;
+            if (blocked[cell] && !(oldTailFreed && cell == oldTailCell))
+                continue;
+            mark[cell] = generation;
+            ++reached;
+            int estimate = std::abs(cell % width - newTail.x) + std::abs(cell / width - newTail.y);
+            if (estimate < currentEstimate)
+                queue[currentSize++] = cell;
+            else
+                seeds[laterSize++] = cell;
+        }
+
+        if (currentSize == 0 && laterSize > 0)
+        {
+            queue.swap(seeds);
+            currentSize = laterSize;
+            laterSize = 0;
+        }
+    }
+    return reached;
+}
+
+bool Autopilot::IsBlockedIn(const SnakeGame& game, int cell) const
+{
+    const OccupancyGrid& occupancy = game.GetOccupancy();
+    int x = cell % width, y = cell / width;
+    return occupancy.HasBody(x, y) || occupancy.HasObstacle(x, y);
+}
+
+int Autopilot::NeighbourCount(int cell, int* out) const
+{
+    int x = cell % width, y = cell / width;
+    int count = 0;
+    if (y > 0) out[count++] = cell - width;
+    if (y + 1 < height) out[count++] = cell + width;
+    if (x > 0) out[count++] = cell - 1;
+    if (x + 1 < width) out[count++] = cell + 1;
+    return count;
+}
+
+void Autopilot::NextGeneration()
+{
+    // 0 means "unmarked", so on wrap-around the stamps are cleared once
+    if (++generation == 0)
+    {
+        std::fill(mark.begin(), mark.end(), 0u);
+        generation = 1;
+    }
+}
@@ -0,0 +1,71 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "SnakeGame.h"
+
+// Stateful planner that steers one game towards the food.
+//
+// It keeps a BFS distance-to-food field over the free cells. Between consecutive ticks
+// only the head, tail and moved obstacle cells change, so the field is patched in place: a
+// newly blocked cell invalidates the cells whose shortest path ran through it and
+// re-seeds them from the surrounding valid distances, and a newly freed cell relaxes
+// outwards. The field is rebuilt from scratch only when the food respawns or the game
+// jumps (reset, load, skipped ticks).
+//
+// A move is only taken if the tail stays reachable from the new head afterwards, so the
+// snake keeps an escape route; when no move passes, the one with the most room wins.
+class Autopilot
+{
+public:
+    Autopilot();
+
+    // Direction for the next tick. Call once per tick, before Step(), on the same game.
+    Direction Plan(const SnakeGame& game);
+    // Forces a full rebuild on the next Plan
+    void Invalidate() { valid = false; }
+
+    // BFS steps from (x, y) to the food over free cells, or -1 if unreachable
+    int GetDistance(int x, int y) const;
+
+    double GetLastPlanMicros() const { return lastPlanSeconds * 1e6; }
+    double GetAveragePlanMicros() const { return planCount > 0 ? totalPlanSeconds * 1e6 / planCount : 0.0; }
+    double GetTotalPlanSeconds() const { return totalPlanSeconds; }
+    uint64_t GetPlanCount() const { return planCount; }
+    uint64_t GetFullRebuilds() const { return fullRebuilds; }
+
+private:
+    Direction ChooseMove(const SnakeGame& game);
+    void Sync(const SnakeGame& game);
+    void Rebuild(const SnakeGame& game);
+    // Brings one cell of the field in line with the game, if its blocked state changed
+    void Patch(const SnakeGame& game, Segment cell);
+    void Block(int cell);
+    void Unblock(int cell);
+    void Relax(int seedCount);
+    // Flood fill from the cell entered by a move; returns the cells reached and whether
+    // the tail (after the move) is among their neighbours
+    int FloodAfterMove(const SnakeGame& game, Segment next, bool eats, bool& reachesTail);
+
+    int Index(int x, int y) const { return y * width + x; }
+    bool IsBlockedIn(const SnakeGame& game, int cell) const;
+    int NeighbourCount(int cell, int* out) const;
+    void NextGeneration();
+
+    int width, height;
+    std::vector<int> dist;         // Distance to the food per cell, a large sentinel when unreachable
+    std::vector<uint8_t> blocked;  // Mirror of the body/obstacle cells the field was built for
+    std::vector<int> queue;        // BFS queue and scratch lists, sized once per board
+    std::vector<int> seeds;
+    std::vector<uint32_t> mark;    // Per-cell generation stamps, so scratch sets never need clearing
+    uint32_t generation;
+    int foodCell;
+
+    // Game state the field currently reflects
+    bool valid;
+    uint64_t lastSeed, lastTick;
+    Segment lastFood, lastHead, lastTail;
+    std::vector<Segment> lastObstacles;
+
+    double lastPlanSeconds, totalPlanSeconds;
+    uint64_t planCount, fullRebuilds;
+};
@@ -0,0 +1,154 @@
+#include "BatchRunner.h"
+#include "ThreadPool.h"
+#include <chrono>
+#include <memory>
+
+void Distribution::Add(int value)
+{
+    if (value < 0)
+        value = 0;
+    if (static_cast<size_t>(value) >= counts.size())
+        counts.resize(value + 1, 0);
+    ++counts[value];
+}
+
+void Distribution::Merge(const Distribution& other)
+{
+    if (other.counts.size() > counts.size())
+        counts.resize(other.counts.size(), 0);
+    for (size_t i = 0; i < other.counts.size(); ++i)
+        counts[i] += other.counts[i];
+}
+
+uint64_t Distribution::Total() const
+{
+    uint64_t total = 0;
+    for (uint64_t count : counts)
+        total += count;
+    return total;
+}
+
+double Distribution::Mean() const
+{
+    uint64_t total = 0;
+    double sum = 0.0;
+    for (size_t i = 0; i < counts.size(); ++i)
+    {
+        total += counts[i];
+        sum += static_cast<double>(i) * counts[i];
+    }
+    return total > 0 ? sum / total : 0.0;
+}
+
+int Distribution::Min() const
+{
+    for (size_t i = 0; i < counts.size(); ++i)
+    {
+        if (counts[i] > 0)
+            return static_cast<int>(i);
+    }
+    return 0;
+}
+
+int Distribution::Max() const
+{
+    for (size_t i = counts.size(); i > 0; --i)
+    {
+        if (counts[i - 1] > 0)
+            return static_cast<int>(i - 1);
+    }
+    return 0;
+}
+
+int Distribution::Percentile(double fraction) const
+{
+    uint64_t total = Total();
+    if (total == 0)
+        return 0;
+    uint64_t rank = static_cast<uint64_t>(fraction * (total - 1));
+    uint64_t seen = 0;
+    for (size_t i = 0; i < counts.size(); ++i)
+    {
+        seen += counts[i];
+        if (seen > rank)
+            return static_cast<int>(i);
+    }
+    return Max();
+}
+
+BatchResult RunBatch(const BatchConfig& config, const SnakePolicy& policy, ThreadPool& pool)
+{
+    return RunBatch(config, SnakePolicyFactory([&policy]() { return policy; }), pool);
+}
+
+BatchResult RunBatch(const BatchConfig& config, const SnakePolicyFactory& makePolicy, ThreadPool& pool)
+{
+    struct WorkerState
+    {
+        std::unique_ptr<SnakeGame> game;
+        SnakePolicy policy;
+        BatchResult partial;
+    };
+
+    // Games and policies are created up front so the timed loop only simulates
+    std::vector<WorkerState> workers(pool.GetThreadCount());
+    for (auto& worker : workers)
+    {
+        worker.game.reset(new SnakeGame(config.gridWidth, config.gridHeight, config.firstSeed));
+        worker.game->SetObstacleCount(config.obstacleCount);
+        worker.policy = makePolicy();
+    }
+
+    // Each game writes only its own slot, so workers share no result state
+    std::vector<BatchGame> gameResults(config.keepGames ? config.gameCount : 0);
+
+    auto start = std::chrono::steady_clock::now();
+    pool.ParallelFor(config.gameCount, config.grain, [&](int begin, int end, int workerIndex)
+    {
+        WorkerState& worker = workers[workerIndex];
+        SnakeGame& game = *worker.game;
+        const SnakePolicy& policy = worker.policy;
+        for (int i = begin; i < end; ++i)
+        {
+            game.Reset(config.firstSeed + static_cast<uint64_t>(i));
+            game.StartGame();
+            while (!game.IsGameOver() && game.GetTick() < static_cast<uint64_t>(config.maxTicks))
+            {
+                game.SetDirection(policy(game));
+                game.Step();
+            }
+
+            BatchResult& partial = worker.partial;
+            ++partial.games;
+            partial.ticks += game.GetTick();
+            if (game.IsGameWon())
+                ++partial.wins;
+            partial.scores.Add(game.GetScore());
+            partial.lengths.Add(game.GetBody().Size());
+            if (config.keepGames)
+            {
+                BatchGame& outcome = gameResults[i];
+                outcome.seed = game.GetSeed();
+                outcome.ticks = game.GetTick();
+                outcome.score = game.GetScore();
+                outcome.length = game.GetBody().Size();
+                outcome.won = game.IsGameWon();
+            }
+        }
+    });
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    BatchResult result;
+    result.seconds = seconds;
+    result.threads = pool.GetThreadCount();
+    for (const auto& worker : workers)
+    {
+        result.games += worker.partial.games;
+        result.wins += worker.partial.wins;
+        result.ticks += worker.partial.ticks;
+        result.scores.Merge(worker.partial.scores);
+        result.lengths.Merge(worker.partial.lengths);
+    }
+    result.gameResults.swap(gameResults);
+    return result;
+}
@@ -0,0 +1,71 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <vector>
+#include "SnakeGame.h"
+
+class ThreadPool;
+
+// Chooses the next direction for a game. Called concurrently from several worker
+// threads, so it must not touch shared mutable state.
+using SnakePolicy = std::function<Direction(const SnakeGame&)>;
+// Makes one policy per worker, for policies that keep per-game state (see Autopilot).
+// Called on the calling thread before any game starts.
+using SnakePolicyFactory = std::function<SnakePolicy()>;
+
+struct BatchConfig
+{
+    int gridWidth = 20;
+    int gridHeight = 20;
+    int obstacleCount = 1;
+    int gameCount = 1000;
+    uint64_t firstSeed = 1;  // Game i is seeded with firstSeed + i, independent of scheduling
+    int maxTicks = 100000;   // Per-game cap so a looping policy can't stall a worker
+    int grain = 16;          // Games taken per work-queue pop
+    bool keepGames = false;  // Fill BatchResult::gameResults with every game's outcome
+};
+
+// Counts of a non-negative integer quantity, indexed by value
+struct Distribution
+{
+    std::vector<uint64_t> counts;
+
+    void Add(int value);
+    void Merge(const Distribution& other);
+    uint64_t Total() const;
+    double Mean() const;
+    int Min() const;
+    int Max() const;
+    int Percentile(double fraction) const;
+};
+
+// Outcome of one game of a batch
+struct BatchGame
+{
+    uint64_t seed = 0;
+    uint64_t ticks = 0;
+    int score = 0;
+    int length = 0;
+    bool won = false;
+};
+
+struct BatchResult
+{
+    int games = 0;
+    int wins = 0;
+    uint64_t ticks = 0;
+    double seconds = 0.0;
+    int threads = 0;
+    Distribution scores;
+    Distribution lengths;
+    std::vector<BatchGame> gameResults;  // Indexed by game, when BatchConfig::keepGames is set
+
+    double GamesPerSecond() const { return seconds > 0.0 ? games / seconds : 0.0; }
+    double TicksPerSecond() const { return seconds > 0.0 ? ticks / seconds : 0.0; }
+};
+
+// Plays config.gameCount independent games spread over the pool's workers. Each
+// worker owns one SnakeGame (and so its own PRNG) and its own partial result; the
+// partials are merged after the parallel loop, so no mutable state is shared.
+BatchResult RunBatch(const BatchConfig& config, const SnakePolicy& policy, ThreadPool& pool);
+BatchResult RunBatch(const BatchConfig& config, const SnakePolicyFactory& makePolicy, ThreadPool& pool);
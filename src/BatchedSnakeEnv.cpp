@@ -0,0 +1,206 @@
+#include "BatchedSnakeEnv.h"
+#include <cassert>
+
+BatchedSnakeEnv::BatchedSnakeEnv(int gameCount, int gridWidth, int gridHeight, uint64_t seed)
+    : gameCount(gameCount), gridWidth(gridWidth), gridHeight(gridHeight), cellCount(gridWidth * gridHeight),
+    nextSeed(seed), episodesCompleted(0),
+    headX(gameCount), headY(gameCount), direction(gameCount), nextX(gameCount), nextY(gameCount),
+    headSlot(gameCount), length(gameCount), foodCell(gameCount), obstacleCell(gameCount), obstacleTimer(gameCount),
+    score(gameCount), finalScore(gameCount), done(gameCount), rng(gameCount),
+    bodyArena(static_cast<size_t>(gameCount) * cellCount), occupancyArena(static_cast<size_t>(gameCount) * cellCount)
+{
+    ResetAll();
+}
+
+void BatchedSnakeEnv::ResetAll()
+{
+    for (int game = 0; game < gameCount; ++game)
+    {
+        ResetGame(game);
+        done[game] = 0;
+        finalScore[game] = 0;
+    }
+}
+
+void BatchedSnakeEnv::ResetGame(int game)
+{
+    rng[game].Seed(nextSeed++);
+
+    size_t base = static_cast<size_t>(game) * cellCount;
+    uint8_t* occupancy = &occupancyArena[base];
+    for (int cell = 0; cell < cellCount; ++cell)
+        occupancy[cell] = 0;
+
+    // Same opening as SnakeGame: three segments in the middle row heading right
+    int32_t* body = &bodyArena[base];
+    int y = gridHeight / 2;
+    for (int i = 0; i < 3; ++i)
+    {
+        int cell = y * gridWidth + gridWidth / 2 - i;
+        body[i] = cell;
+        occupancy[cell] = 1;
+    }
+    headSlot[game] = 0;
+    length[game] = 3;
+    headX[game] = gridWidth / 2;
+    headY[game] = y;
+    direction[game] = static_cast<int32_t>(Direction::RIGHT);
+    score[game] = 0;
+    obstacleCell[game] = 5 * gridWidth + 5;
+    obstacleTimer[game] = 0;
+    SpawnFood(game);
+}
+
+void BatchedSnakeEnv::SpawnFood(int game)
+{
+    const uint8_t* occupancy = &occupancyArena[static_cast<size_t>(game) * cellCount];
+    int obstacle = obstacleCell[game];
+    int freeCount = cellCount - length[game] - (occupancy[obstacle] ? 0 : 1);
+    if (freeCount <= 0)
+    {
+        foodCell[game] = -1;
+        return;
+    }
+
+    // A few rejection samples are cheap while the board is sparse...
+    Pcg32& random = rng[game];
+    for (int attempt = 0; attempt < 4; ++attempt)
+    {
+        int cell = static_cast<int>(random.NextBounded(static_cast<uint32_t>(cellCount)));
+        if (!occupancy[cell] && cell != obstacle)
+        {
+            foodCell[game] = cell;
+            return;
+        }
+    }
+
+    // ...and an exact pick of the k-th free cell keeps a crowded board bounded
+    int target = static_cast<int>(random.NextBounded(static_cast<uint32_t>(freeCount)));
+    for (int cell = 0; cell < cellCount; ++cell)
+    {
+        if (occupancy[cell] || cell == obstacle)
+            continue;
+        if (target-- == 0)
+        {
+            foodCell[game] = cell;
+            return;
+        }
+    }
+    assert(false);
+}
+
+void BatchedSnakeEnv::MoveObstacle(int game)
+{
+    int x = obstacleCell[game] % gridWidth;
+    int y = obstacleCell[game] / gridWidth;
+    switch (static_cast<Direction>(rng[game].NextBounded(4)))
+    {
+    case Direction::UP:    y = y > 0 ? y - 1 : gridHeight - 1; break;
+    case Direction::DOWN:  y = y + 1 < gridHeight ? y + 1 : 0; break;
+    case Direction::LEFT:  x = x > 0 ? x - 1 : gridWidth - 1; break;
+    case Direction::RIGHT: x = x + 1 < gridWidth ? x + 1 : 0; break;
+    }
+    obstacleCell[game] = y * gridWidth + x;
+}
+
+void BatchedSnakeEnv::Step(const uint8_t* actions)
+{
+    const int n = gameCount;
+    const int width = gridWidth;
+    const int height = gridHeight;
+    int32_t* dir = direction.data();
+    const int32_t* hx = headX.data();
+    const int32_t* hy = headY.data();
+    int32_t* nx = nextX.data();
+    int32_t* ny = nextY.data();
+    uint8_t* finished = done.data();
+
+    // Phase 1, branch-free over the whole batch: reversal guard, next head, wall test.
+    // Direction values are UP=0, DOWN=1, LEFT=2, RIGHT=3, so opposites differ only in bit 0.
+    for (int i = 0; i < n; ++i)
+    {
+        int32_t action = actions[i];
+        int32_t reverse = (action ^ dir[i]) == 1;
+        int32_t d = reverse ? dir[i] : action;
+        dir[i] = d;
+        int32_t x = hx[i] + (d == 3) - (d == 2);
+        int32_t y = hy[i] + (d == 1) - (d == 0);
+        nx[i] = x;
+        ny[i] = y;
+        finished[i] = (x < 0) | (x >= width) | (y < 0) | (y >= height);
+    }
+
+    // Phase 2, per game: ring buffer and occupancy updates in the shared arenas
+    for (int i = 0; i < n; ++i)
+    {
+        if (finished[i])
+            continue;
+
+        size_t base = static_cast<size_t>(i) * cellCount;
+        int32_t* body = &bodyArena[base];
+        uint8_t* occupancy = &occupancyArena[base];
+        int cell = ny[i] * width + nx[i];
+
+        bool ate = cell == foodCell[i];
+        if (!ate)
+        {
+            int tailSlot = headSlot[i] + length[i] - 1;
+            if (tailSlot >= cellCount)
+                tailSlot -= cellCount;
+            occupancy[body[tailSlot]] = 0;
+            --length[i];
+        }
+
+        // Self collision: the cell is still occupied after the tail moved away
+        if (occupancy[cell])
+        {
+            finished[i] = 1;
+            continue;
+        }
+
+        int slot = headSlot[i] - 1;
+        if (slot < 0)
+            slot = cellCount - 1;
+        headSlot[i] = slot;
+        body[slot] = cell;
+        occupancy[cell] = 1;
+        ++length[i];
+        headX[i] = nx[i];
+        headY[i] = ny[i];
+
+        if (ate)
+        {
+            score[i] += 10;
+            SpawnFood(i);
+            if (foodCell[i] < 0)
+                finished[i] = 1;  // Board filled: a win, reset like any other finished game
+        }
+
+        // Obstacle collision against any body segment
+        if (occupancy[obstacleCell[i]])
+            finished[i] = 1;
+    }
+
+    // Phase 3: obstacle timers for live games, then wander on the tick they expire
+    int32_t* timer = obstacleTimer.data();
+    for (int i = 0; i < n; ++i)
+        timer[i] += 1 - finished[i];
+    for (int i = 0; i < n; ++i)
+    {
+        if (timer[i] >= OBSTACLE_TICKS)
+        {
+            timer[i] = 0;
+            MoveObstacle(i);
+        }
+    }
+
+    // Phase 4: auto-reset
+    for (int i = 0; i < n; ++i)
+    {
+        if (!finished[i])
+            continue;
+        finalScore[i] = score[i];
+        ++episodesCompleted;
+        ResetGame(i);
+    }
+}
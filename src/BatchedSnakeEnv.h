@@ -0,0 +1,67 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "Random.h"
+#include "SnakeGame.h"
+
+// Structure-of-arrays environment that steps many games in lockstep for RL training.
+// Per-game scalars (head, direction, food, obstacle, score, done) live in parallel
+// arrays, and all bodies and occupancy bitmaps live in two shared arenas with a fixed
+// slice per game, so a batch step walks memory linearly instead of chasing one heap
+// allocation per game. The rules match SnakeGame (reversal guard, walls, self and
+// obstacle collisions, obstacle wandering every OBSTACLE_TICKS ticks); finished games
+// are reset automatically at the end of the step that ended them.
+class BatchedSnakeEnv
+{
+public:
+    BatchedSnakeEnv(int gameCount, int gridWidth = 20, int gridHeight = 20, uint64_t seed = 0);
+
+    // Applies one action per game (Direction values) and advances every game one tick
+    void Step(const uint8_t* actions);
+    void ResetAll();
+
+    int GetGameCount() const { return gameCount; }
+    int GetGridWidth() const { return gridWidth; }
+    int GetGridHeight() const { return gridHeight; }
+
+    // Per-game state, indexed by game. Cells are y * gridWidth + x.
+    const int32_t* GetHeadX() const { return headX.data(); }
+    const int32_t* GetHeadY() const { return headY.data(); }
+    const int32_t* GetDirections() const { return direction.data(); }
+    const int32_t* GetFoodCells() const { return foodCell.data(); }
+    const int32_t* GetObstacleCells() const { return obstacleCell.data(); }
+    const int32_t* GetLengths() const { return length.data(); }
+    const int32_t* GetScores() const { return score.data(); }
+    // 1 when the game ended during the last Step (it has already been reset since)
+    const uint8_t* GetDoneFlags() const { return done.data(); }
+    // Score each game finished with during the last Step, valid where done is set
+    const int32_t* GetFinalScores() const { return finalScore.data(); }
+    // gridWidth * gridHeight bytes, non-zero where the snake body is
+    const uint8_t* GetBodyPlane(int game) const { return &occupancyArena[static_cast<size_t>(game) * cellCount]; }
+
+    uint64_t GetEpisodesCompleted() const { return episodesCompleted; }
+
+private:
+    static const int OBSTACLE_TICKS = 2;
+
+    void ResetGame(int game);
+    void SpawnFood(int game);
+    void MoveObstacle(int game);
+
+    int gameCount, gridWidth, gridHeight, cellCount;
+    uint64_t nextSeed;
+    uint64_t episodesCompleted;
+
+    // Parallel per-game arrays
+    std::vector<int32_t> headX, headY, direction;
+    std::vector<int32_t> nextX, nextY;  // Scratch for the vectorised move phase
+    std::vector<int32_t> headSlot, length;
+    std::vector<int32_t> foodCell, obstacleCell, obstacleTimer;
+    std::vector<int32_t> score, finalScore;
+    std::vector<uint8_t> done;
+    std::vector<Pcg32> rng;
+
+    // Shared arenas: game g owns [g * cellCount, (g + 1) * cellCount)
+    std::vector<int32_t> bodyArena;       // Ring buffer of body cells per game
+    std::vector<uint8_t> occupancyArena;  // Body occupancy per cell per game
+};
@@ -0,0 +1,75 @@
+#pragma once
+#include <cstdint>
+#if defined(_MSC_VER) && defined(_M_X64)
+#include <intrin.h>
+#endif
+#if defined(__BMI2__)
+#include <immintrin.h>
+#endif
+
+// Single-word bit operations on 64-bit masks, using the compiler's intrinsics where
+// they exist and portable bit twiddling elsewhere.
+namespace BitOps
+{
+inline int PopCount(uint64_t word)
+{
+#if defined(_MSC_VER) && defined(_M_X64)
+    return static_cast<int>(__popcnt64(word));
+#elif defined(__GNUC__)
+    return __builtin_popcountll(word);
+#else
+    word = word - ((word >> 1) & 0x5555555555555555ULL);
+    word = (word & 0x3333333333333333ULL) + ((word >> 2) & 0x3333333333333333ULL);
+    word = (word + (word >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+    return static_cast<int>((word * 0x0101010101010101ULL) >> 56);
+#endif
+}
+
+// Index of the lowest set bit; word must not be zero
+inline int CountTrailingZeros(uint64_t word)
+{
+#if defined(_MSC_VER) && defined(_M_X64)
+    unsigned long index;
+    _BitScanForward64(&index, word);
+    return static_cast<int>(index);
+#elif defined(__GNUC__)
+    return __builtin_ctzll(word);
+#else
+    int index = 0;
+    while ((word & 1) == 0)
+    {
+        word >>= 1;
+        ++index;
+    }
+    return index;
+#endif
+}
+
+// Index of the n-th lowest set bit (n from 0); word must have more than n bits set.
+// With BMI2 this is one PDEP that deposits a single bit onto the n-th set position;
+// otherwise popcounts of the low half, quarter and eighth narrow it to a byte first.
+inline int SelectBit(uint64_t word, int n)
+{
+#if defined(__BMI2__)
+    return CountTrailingZeros(_pdep_u64(uint64_t(1) << n, word));
+#else
+    int base = 0;
+    for (int width = 32; width >= 8; width /= 2)
+    {
+        uint64_t low = word & ((uint64_t(1) << width) - 1);
+        int count = PopCount(low);
+        if (n >= count)
+        {
+            n -= count;
+            word >>= width;
+            base += width;
+        }
+        else
+            word = low;
+    }
+    for (; n > 0; --n)
+        word &= word - 1;
+    return base + CountTrailingZeros(word);
+#endif
+}
+}
@@ -0,0 +1,67 @@
+#include "BoardQuadScene.h"
+#include "SnakeGame.h"
+#include <algorithm>
+
+const uint32_t BoardQuadScene::WINDOW_COLOR;
+const uint32_t BoardQuadScene::GRID_COLOR;
+const uint32_t BoardQuadScene::SNAKE_COLOR;
+const uint32_t BoardQuadScene::FOOD_COLOR;
+
+void BoardQuadScene::Build(const SnakeGame& game, int canvasSize)
+{
+    vertices.clear();
+    indices.clear();
+    float canvas = static_cast<float>(canvasSize);
+    int gridWidth = game.GetGridWidth(), gridHeight = game.GetGridHeight();
+    float cellSize = std::max(std::min(canvas / gridWidth, canvas / gridHeight), 1.0f);
+    int maxX = std::min(gridWidth, static_cast<int>(canvas / cellSize));
+    int maxY = std::min(gridHeight, static_cast<int>(canvas / cellSize));
+    float right = maxX * cellSize, bottom = maxY * cellSize;
+
+    AddQuad(0.0f, 0.0f, canvas, canvas, WINDOW_COLOR);
+    int lineStep = 1;
+    while (lineStep * cellSize < 8.0f)
+        lineStep *= 2;
+    for (int i = 0; i <= maxX; i += lineStep)
+        AddQuad(i * cellSize - 0.5f, 0.0f, i * cellSize + 0.5f, bottom, GRID_COLOR);
+    for (int i = 0; i <= maxY; i += lineStep)
+        AddQuad(0.0f, i * cellSize - 0.5f, right, i * cellSize + 0.5f, GRID_COLOR);
+
+    const OccupancyGrid& occupancy = game.GetOccupancy();
+    for (int y = 0; y < maxY; ++y)
+    {
+        for (int x = 0; x < maxX;)
+        {
+            if (!occupancy.HasBody(x, y))
+            {
+                ++x;
+                continue;
+            }
+            int start = x;
+            while (x < maxX && occupancy.HasBody(x, y))
+                ++x;
+            AddQuad(start * cellSize, y * cellSize, x * cellSize, (y + 1) * cellSize, SNAKE_COLOR);
+        }
+    }
+    Segment food = game.GetFood();
+    if (food.x < maxX && food.y < maxY)
+        AddQuad(food.x * cellSize, food.y * cellSize, (food.x + 1) * cellSize, (food.y + 1) * cellSize, FOOD_COLOR);
+
+    call = RasterDrawCall();
+    call.vertices = vertices.data();
+    call.indices = indices.data();
+    call.indexSize = 4;
+    call.indexCount = static_cast<int>(indices.size());
+    call.clipMaxX = call.clipMaxY = canvas;
+}
+
+void BoardQuadScene::AddQuad(float x0, float y0, float x1, float y1, uint32_t color)
+{
+    uint32_t base = static_cast<uint32_t>(vertices.size());
+    vertices.push_back({ x0, y0, 0.0f, 0.0f, color });
+    vertices.push_back({ x1, y0, 0.0f, 0.0f, color });
+    vertices.push_back({ x1, y1, 0.0f, 0.0f, color });
+    vertices.push_back({ x0, y1, 0.0f, 0.0f, color });
+    const uint32_t quad[6] = { base, base + 1, base + 2, base, base + 2, base + 3 };
+    indices.insert(indices.end(), quad, quad + 6);
+}
@@ -0,0 +1,34 @@
+#pragma once
+#include "SoftwareRasterizer.h"
+#include <cstdint>
+#include <vector>
+
+class SnakeGame;
+
+// The play area as SnakeRenderer draws it, built without ImGui as one draw call for the
+// software rasterizer: the window background, grid lines thinned out to at least 8
+// pixels apart, one quad per horizontal run of body cells and the food, in the
+// renderer's colours. The board is fitted to a square canvas down to one pixel per
+// cell, so a board too big for the canvas shows its top-left corner. Quads are indexed
+// (a, b, c), (a, c, d) as ImGui writes rectangles. bench_raster measures it and
+// snake_raster_check compares it with a golden image.
+class BoardQuadScene
+{
+public:
+    void Build(const SnakeGame& game, int canvasSize);
+
+    // Valid until the next Build
+    const RasterDrawCall& GetCall() const { return call; }
+
+private:
+    static const uint32_t WINDOW_COLOR = 0xF00F0F0F;
+    static const uint32_t GRID_COLOR = 0xFF4D4D4D;
+    static const uint32_t SNAKE_COLOR = 0xFF00FF00;
+    static const uint32_t FOOD_COLOR = 0xFF0000FF;
+
+    void AddQuad(float x0, float y0, float x1, float y1, uint32_t color);
+
+    std::vector<RasterVertex> vertices;
+    std::vector<uint32_t> indices;
+    RasterDrawCall call;
+};
@@ -0,0 +1,132 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Little-endian encoding helpers shared by the state serializer and the replay format.
+// Every multi-byte value is written byte by byte so files are portable across platforms.
+class ByteWriter
+{
+public:
+    explicit ByteWriter(std::vector<uint8_t>& buffer) : buffer(buffer) {}
+
+    void PutU8(uint8_t value) { buffer.push_back(value); }
+
+    void PutU16(uint16_t value)
+    {
+        PutU8(static_cast<uint8_t>(value));
+        PutU8(static_cast<uint8_t>(value >> 8));
+    }
+
+    void PutU32(uint32_t value)
+    {
+        for (int i = 0; i < 4; ++i)
+            PutU8(static_cast<uint8_t>(value >> (8 * i)));
+    }
+
+    void PutU64(uint64_t value)
+    {
+        for (int i = 0; i < 8; ++i)
+            PutU8(static_cast<uint8_t>(value >> (8 * i)));
+    }
+
+    // LEB128: 7 bits per byte, high bit set on every byte but the last
+    void PutVarU64(uint64_t value)
+    {
+        while (value >= 0x80)
+        {
+            PutU8(static_cast<uint8_t>(value | 0x80));
+            value >>= 7;
+        }
+        PutU8(static_cast<uint8_t>(value));
+    }
+
+    void PutBytes(const uint8_t* data, size_t size) { buffer.insert(buffer.end(), data, data + size); }
+
+    size_t Size() const { return buffer.size(); }
+
+private:
+    std::vector<uint8_t>& buffer;
+};
+
+// Bounds-checked reader over a byte range. A read past the end returns zero and
+// latches Ok() to false, so callers can decode a whole structure and check once.
+class ByteReader
+{
+public:
+    ByteReader(const uint8_t* data, size_t size) : begin(data), cursor(data), end(data + size), ok(true) {}
+
+    uint8_t GetU8()
+    {
+        if (cursor >= end)
+        {
+            ok = false;
+            return 0;
+        }
+        return *cursor++;
+    }
+
+    uint16_t GetU16()
+    {
+        uint16_t value = GetU8();
+        value |= static_cast<uint16_t>(GetU8()) << 8;
+        return value;
+    }
+
+    uint32_t GetU32()
+    {
+        uint32_t value = 0;
+        for (int i = 0; i < 4; ++i)
+            value |= static_cast<uint32_t>(GetU8()) << (8 * i);
+        return value;
+    }
+
+    uint64_t GetU64()
+    {
+        uint64_t value = 0;
+        for (int i = 0; i < 8; ++i)
+            value |= static_cast<uint64_t>(GetU8()) << (8 * i);
+        return value;
+    }
+
+    uint64_t GetVarU64()
+    {
+        uint64_t value = 0;
+        for (int shift = 0; shift < 64; shift += 7)
+        {
+            uint8_t byte = GetU8();
+            value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+            if ((byte & 0x80) == 0)
+                return value;
+        }
+        ok = false;
+        return 0;
+    }
+
+    const uint8_t* GetBytes(size_t size)
+    {
+        if (static_cast<size_t>(end - cursor) < size)
+        {
+            ok = false;
+            cursor = end;
+            return nullptr;
+        }
+        const uint8_t* data = cursor;
+        cursor += size;
+        return data;
+    }
+
+    bool Ok() const { return ok; }
+    bool AtEnd() const { return cursor >= end; }
+    size_t Offset() const { return static_cast<size_t>(cursor - begin); }
+    void Seek(size_t offset)
+    {
+        cursor = begin + (offset <= static_cast<size_t>(end - begin) ? offset : static_cast<size_t>(end - begin));
+    }
+
+private:
+    const uint8_t* begin;
+    const uint8_t* cursor;
+    const uint8_t* end;
+    bool ok;
+};
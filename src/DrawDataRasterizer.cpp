@@ -0,0 +1,52 @@
+#include "DrawDataRasterizer.h"
+#include <cstddef>
+
+static_assert(sizeof(ImDrawVert) == sizeof(RasterVertex) && offsetof(ImDrawVert, pos) == offsetof(RasterVertex, x) &&
+    offsetof(ImDrawVert, uv) == offsetof(RasterVertex, u) && offsetof(ImDrawVert, col) == offsetof(RasterVertex, color),
+    "ImDrawVert must keep ImGui's default layout to be rasterized in place");
+
+void DrawDataRasterizer::SetTexture(ImTextureID id, const RasterTexture& texture)
+{
+    for (auto& entry : textures)
+    {
+        if (entry.first == id)
+        {
+            entry.second = texture;
+            return;
+        }
+    }
+    textures.emplace_back(id, texture);
+}
+
+void DrawDataRasterizer::Render(const ImDrawData& drawData, RasterImage& target)
+{
+    calls.clear();
+    for (int n = 0; n < drawData.CmdListsCount; ++n)
+    {
+        const ImDrawList* list = drawData.CmdLists[n];
+        for (const ImDrawCmd& cmd : list->CmdBuffer)
+        {
+            if (cmd.UserCallback || cmd.ElemCount == 0)
+                continue;
+            RasterDrawCall call;
+            call.vertices = reinterpret_cast<const RasterVertex*>(list->VtxBuffer.Data + cmd.VtxOffset);
+            call.indices = list->IdxBuffer.Data + cmd.IdxOffset;
+            call.indexSize = static_cast<int>(sizeof(ImDrawIdx));
+            call.indexCount = static_cast<int>(cmd.ElemCount);
+            // Into the image's space, as the backend's projection and scissor do
+            call.offsetX = -drawData.DisplayPos.x;
+            call.offsetY = -drawData.DisplayPos.y;
+            call.clipMinX = cmd.ClipRect.x - drawData.DisplayPos.x;
+            call.clipMinY = cmd.ClipRect.y - drawData.DisplayPos.y;
+            call.clipMaxX = cmd.ClipRect.z - drawData.DisplayPos.x;
+            call.clipMaxY = cmd.ClipRect.w - drawData.DisplayPos.y;
+            for (const auto& entry : textures)
+            {
+                if (entry.first == cmd.GetTexID())
+                    call.texture = &entry.second;
+            }
+            calls.push_back(call);
+        }
+    }
+    rasterizer.Draw(calls.data(), static_cast<int>(calls.size()), target);
+}
@@ -0,0 +1,29 @@
+#pragma once
+#include <imgui.h>
+#include <utility>
+#include <vector>
+#include "SoftwareRasterizer.h"
+
+// ImGui adapter for the software rasterizer: draws an ImDrawData the way
+// ImGui_ImplDX9_RenderDrawData would, into a RasterImage instead of a device. Vertex and
+// index buffers are handed over in place; ImDrawVert must keep its default layout.
+//
+// Textures are looked up by ImTextureID, so the font atlas has to be registered (its
+// RGBA32 pixels under the ID the atlas was given); draws with an unknown texture use
+// their vertex colours alone. User callbacks are skipped.
+class DrawDataRasterizer
+{
+public:
+    explicit DrawDataRasterizer(ThreadPool* pool = nullptr) : rasterizer(pool) {}
+
+    void SetTexture(ImTextureID id, const RasterTexture& texture);
+    // Draws on top of what the image holds; size it to the display and clear it first
+    void Render(const ImDrawData& drawData, RasterImage& target);
+
+    const RasterStats& GetLastStats() const { return rasterizer.GetLastStats(); }
+
+private:
+    SoftwareRasterizer rasterizer;
+    std::vector<std::pair<ImTextureID, RasterTexture>> textures;
+    std::vector<RasterDrawCall> calls;
+};
@@ -0,0 +1,56 @@
+#include "FrameScheduler.h"
+#include <algorithm>
+
+const int FrameScheduler::SETTLE_FRAMES;
+
+void FrameScheduler::ObserveState(uint64_t newStamp)
+{
+    if (hasStamp && newStamp == stamp)
+        return;
+    stamp = newStamp;
+    hasStamp = true;
+    Request();
+}
+
+void FrameScheduler::Request(int frames)
+{
+    pending = std::max(pending, frames);
+}
+
+void FrameScheduler::WakeAt(Clock::time_point time)
+{
+    wakeTime = std::min(wakeTime, time);
+}
+
+bool FrameScheduler::ShouldRender(Clock::time_point now) const
+{
+    return continuous || pending > 0 || now >= wakeTime;
+}
+
+FrameScheduler::Clock::duration FrameScheduler::TimeToWait(Clock::time_point now) const
+{
+    if (ShouldRender(now))
+        return Clock::duration::zero();
+    if (wakeTime == Clock::time_point::max())
+        return Clock::duration::max();
+    return wakeTime - now;
+}
+
+void FrameScheduler::FrameRendered(Clock::time_point now)
+{
+    ++stats.rendered;
+    if (pending > 0)
+        --pending;
+    if (now >= wakeTime)
+        wakeTime = Clock::time_point::max();
+
+    // A loop drawing every frame presents once per interval; the gaps count the rest
+    if (hasLastFrame && frameInterval > Clock::duration::zero())
+    {
+        int64_t intervals = (now - lastFrame) / frameInterval;
+        if (intervals > 1)
+            stats.skipped += static_cast<uint64_t>(intervals - 1);
+    }
+    lastFrame = now;
+    hasLastFrame = true;
+}
@@ -0,0 +1,65 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+
+struct FrameSchedulerStats
+{
+    uint64_t rendered = 0;
+    // Display frames that went by without one being built, at the frame interval
+    uint64_t skipped = 0;
+    uint64_t wakeups = 0;  // Loop passes that found nothing to draw
+};
+
+// Decides when the render loop builds and presents a frame, so a game that is waiting,
+// paused or over leaves the CPU alone. A frame is due when input arrived (and for a few
+// frames after, while ImGui settles hover and focus), when the game's state stamp
+// changed, when the UI asked for one, when a wake-up time it set has come, or on every
+// pass while continuous redraw is on (animation). Otherwise the loop may block until
+// the next wake-up time or the next input event.
+//
+// Nothing here waits or reads a clock: times come in from the caller and the wait
+// itself is the platform's, so the rules can be driven headless with made-up times.
+class FrameScheduler
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    static const int SETTLE_FRAMES = 3;
+
+    explicit FrameScheduler(Clock::duration frameInterval = std::chrono::microseconds(16667))
+        : frameInterval(frameInterval) {}
+
+    // Input arrived (a key, the mouse, a resize)
+    void OnInput() { Request(SETTLE_FRAMES); }
+    // A stamp of the game state on screen (tick, seed, flags); a new value is a redraw
+    void ObserveState(uint64_t stamp);
+    void Request(int frames = 1);
+    // Redraw on every pass while set, e.g. while ticks are being interpolated
+    void SetContinuous(bool enabled) { continuous = enabled; }
+    bool IsContinuous() const { return continuous; }
+    // A frame is due at `time` even without input; the earliest pending time wins
+    void WakeAt(Clock::time_point time);
+
+    bool ShouldRender(Clock::time_point now) const;
+    // How long the loop may block: zero if a frame is due, Clock::duration::max() if
+    // nothing but input can make one due
+    Clock::duration TimeToWait(Clock::time_point now) const;
+
+    // After presenting a frame
+    void FrameRendered(Clock::time_point now);
+    // After a pass that woke up and found no frame due
+    void FrameSkipped() { ++stats.wakeups; }
+
+    const FrameSchedulerStats& GetStats() const { return stats; }
+
+private:
+    Clock::duration frameInterval;
+    bool continuous = false;
+    int pending = 1;  // The first frame is always drawn
+    Clock::time_point wakeTime = Clock::time_point::max();
+    uint64_t stamp = 0;
+    bool hasStamp = false;
+    Clock::time_point lastFrame;
+    bool hasLastFrame = false;
+    FrameSchedulerStats stats;
+};
@@ -0,0 +1,91 @@
+#pragma once
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <vector>
+
+// Indexed set of free cell ids (y * gridWidth + x): a dense array of members plus a
+// cell-to-slot map. Insert, Remove and random picks are O(1); removal swaps the last
+// member into the vacated slot. Storage is sized once in Init().
+class FreeCellSet
+{
+public:
+    FreeCellSet() : count(0) {}
+
+    void Init(int cellCount)
+    {
+        dense.assign(cellCount, 0);
+        slotOf.assign(cellCount, -1);
+        Fill();
+    }
+
+    // Marks every cell as free
+    void Fill()
+    {
+        count = static_cast<int>(dense.size());
+        for (int i = 0; i < count; ++i)
+        {
+            dense[i] = i;
+            slotOf[i] = i;
+        }
+    }
+
+    void Insert(int cell)
+    {
+        if (slotOf[cell] >= 0)
+            return;
+        dense[count] = cell;
+        slotOf[cell] = count;
+        ++count;
+    }
+
+    void Remove(int cell)
+    {
+        int slot = slotOf[cell];
+        if (slot < 0)
+            return;
+        int last = dense[--count];
+        dense[slot] = last;
+        slotOf[last] = slot;
+        slotOf[cell] = -1;
+    }
+
+    bool Contains(int cell) const { return slotOf[cell] >= 0; }
+    int Size() const { return count; }
+    bool Empty() const { return count == 0; }
+
+    // Rebuilds the set from a saved member list, preserving slot order so later
+    // random picks match the original game
+    void Assign(const int* cells, int cellCount)
+    {
+        std::fill(slotOf.begin(), slotOf.end(), -1);
+        count = cellCount;
+        for (int i = 0; i < count; ++i)
+        {
+            dense[i] = cells[i];
+            slotOf[cells[i]] = i;
+        }
+    }
+
+    const int* Data() const { return dense.data(); }
+    const int* SlotData() const { return slotOf.data(); }
+
+    // Restores both arrays verbatim (denseData holds cellCount members)
+    void AssignRaw(const int* denseData, int cellCount, const int* slotData)
+    {
+        count = cellCount;
+        std::memcpy(dense.data(), denseData, sizeof(int) * cellCount);
+        std::memcpy(slotOf.data(), slotData, sizeof(int) * slotOf.size());
+    }
+
+    int At(int slot) const
+    {
+        assert(slot >= 0 && slot < count);
+        return dense[slot];
+    }
+
+private:
+    std::vector<int> dense;   // Free cells in slots [0, count)
+    std::vector<int> slotOf;  // Slot of each cell in dense, -1 when occupied
+    int count;
+};
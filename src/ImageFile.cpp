@@ -0,0 +1,309 @@
+#include "ImageFile.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <vector>
+
+namespace
+{
+const int WINDOW_SIZE = 32768;
+const int MIN_MATCH = 3;
+const int MAX_MATCH = 258;
+const int HASH_BITS = 15;
+const int MAX_CHAIN = 16;  // Candidates tried per position
+
+const uint16_t LENGTH_BASE[29] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83,
+    99, 115, 131, 163, 195, 227, 258 };
+const uint8_t LENGTH_EXTRA[29] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+const uint16_t DISTANCE_BASE[30] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769,
+    1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+const uint8_t DISTANCE_EXTRA[30] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11,
+    12, 12, 13, 13 };
+
+// Deflate's bit order: values least significant bit first, Huffman codes most
+// significant bit first
+class BitWriter
+{
+public:
+    explicit BitWriter(std::vector<uint8_t>& out) : out(out) {}
+
+    void Bits(uint32_t value, int count)
+    {
+        buffer |= value << used;
+        used += count;
+        while (used >= 8)
+        {
+            out.push_back(static_cast<uint8_t>(buffer));
+            buffer >>= 8;
+            used -= 8;
+        }
+    }
+
+    void Code(uint32_t code, int length)
+    {
+        uint32_t reversed = 0;
+        for (int i = 0; i < length; ++i)
+            reversed |= ((code >> i) & 1) << (length - 1 - i);
+        Bits(reversed, length);
+    }
+
+    void Flush()
+    {
+        if (used > 0)
+            out.push_back(static_cast<uint8_t>(buffer));
+        buffer = 0;
+        used = 0;
+    }
+
+private:
+    std::vector<uint8_t>& out;
+    uint32_t buffer = 0;
+    int used = 0;
+};
+
+// The fixed literal/length code of RFC 1951 section 3.2.6
+void WriteLiteral(BitWriter& bits, int symbol)
+{
+    if (symbol < 144)
+        bits.Code(0x30 + symbol, 8);
+    else if (symbol < 256)
+        bits.Code(0x190 + symbol - 144, 9);
+    else if (symbol < 280)
+        bits.Code(symbol - 256, 7);
+    else
+        bits.Code(0xC0 + symbol - 280, 8);
+}
+
+void WriteMatch(BitWriter& bits, int length, int distance)
+{
+    int code = 28;
+    while (LENGTH_BASE[code] > length)
+        --code;
+    WriteLiteral(bits, 257 + code);
+    bits.Bits(length - LENGTH_BASE[code], LENGTH_EXTRA[code]);
+
+    code = 29;
+    while (DISTANCE_BASE[code] > distance)
+        --code;
+    bits.Code(code, 5);
+    bits.Bits(distance - DISTANCE_BASE[code], DISTANCE_EXTRA[code]);
+}
+
+// A zlib stream holding one fixed-Huffman block, with greedy LZ77 matching over hash
+// chains of three-byte prefixes
+std::vector<uint8_t> Deflate(const std::vector<uint8_t>& data)
+{
+    std::vector<uint8_t> out = { 0x78, 0x01 };
+    BitWriter bits(out);
+    bits.Bits(1, 1);  // Final block
+    bits.Bits(1, 2);  // Fixed Huffman codes
+
+    const int size = static_cast<int>(data.size());
+    std::vector<int> head(1 << HASH_BITS, -1);
+    std::vector<int> previous(WINDOW_SIZE, -1);
+    auto hash = [&data](int i)
+    {
+        uint32_t key = data[i] | (data[i + 1] << 8) | (data[i + 2] << 16);
+        return static_cast<int>((key * 2654435761u) >> (32 - HASH_BITS));
+    };
+    auto insert = [&](int i)
+    {
+        if (i + MIN_MATCH > size)
+            return;
+        int h = hash(i);
+        previous[i % WINDOW_SIZE] = head[h];
+        head[h] = i;
+    };
+
+    int i = 0;
+    while (i < size)
+    {
+        int bestLength = 0, bestDistance = 0;
+        if (i + MIN_MATCH <= size)
+        {
+            int candidate = head[hash(i)];
+            int limit = std::min(MAX_MATCH, size - i);
+            for (int chain = 0; chain < MAX_CHAIN && candidate >= 0 && i - candidate <= WINDOW_SIZE - 1; ++chain)
+            {
+                int length = 0;
+                while (length < limit && data[candidate + length] == data[i + length])
+                    ++length;
+                if (length > bestLength)
+                {
+                    bestLength = length;
+                    bestDistance = i - candidate;
+                    if (length == limit)
+                        break;
+                }
+                int next = previous[candidate % WINDOW_SIZE];
+                if (next >= candidate)
+                    break;
+                candidate = next;
+            }
+        }
+
+        if (bestLength >= MIN_MATCH)
+        {
+            WriteMatch(bits, bestLength, bestDistance);
+            for (int end = i + bestLength; i < end; ++i)
+                insert(i);
+        }
+        else
+        {
+            WriteLiteral(bits, data[i]);
+            insert(i);
+            ++i;
+        }
+    }
+    WriteLiteral(bits, 256);
+    bits.Flush();
+
+    uint32_t a = 1, b = 0;
+    for (uint8_t byte : data)
+    {
+        a = (a + byte) % 65521;
+        b = (b + a) % 65521;
+    }
+    uint32_t adler = (b << 16) | a;
+    for (int shift = 24; shift >= 0; shift -= 8)
+        out.push_back(static_cast<uint8_t>(adler >> shift));
+    return out;
+}
+
+uint32_t Crc32(const uint8_t* data, size_t size, uint32_t crc = 0)
+{
+    static uint32_t table[256];
+    static bool built = false;
+    if (!built)
+    {
+        for (uint32_t n = 0; n < 256; ++n)
+        {
+            uint32_t c = n;
+            for (int k = 0; k < 8; ++k)
+                c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            table[n] = c;
+        }
+        built = true;
+    }
+    crc = ~crc;
+    for (size_t i = 0; i < size; ++i)
+        crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+}
+
+void PutBigEndian(std::vector<uint8_t>& out, uint32_t value)
+{
+    for (int shift = 24; shift >= 0; shift -= 8)
+        out.push_back(static_cast<uint8_t>(value >> shift));
+}
+
+void WriteChunk(std::vector<uint8_t>& out, const char* type, const std::vector<uint8_t>& data)
+{
+    PutBigEndian(out, static_cast<uint32_t>(data.size()));
+    size_t start = out.size();
+    out.insert(out.end(), type, type + 4);
+    out.insert(out.end(), data.begin(), data.end());
+    PutBigEndian(out, Crc32(&out[start], out.size() - start));
+}
+
+bool WriteFile(const char* path, const std::vector<uint8_t>& bytes)
+{
+    std::FILE* file = std::fopen(path, "wb");
+    if (!file)
+        return false;
+    bool ok = std::fwrite(bytes.data(), 1, bytes.size(), file) == bytes.size();
+    return std::fclose(file) == 0 && ok;
+}
+
+// Next header field of a PPM, skipping whitespace and comments
+bool ReadPpmNumber(std::FILE* file, int& value)
+{
+    int c = std::fgetc(file);
+    while (c != EOF && (std::isspace(c) || c == '#'))
+    {
+        if (c == '#')
+        {
+            while (c != EOF && c != '\n')
+                c = std::fgetc(file);
+        }
+        c = std::fgetc(file);
+    }
+    if (c == EOF || !std::isdigit(c))
+        return false;
+    value = 0;
+    while (c != EOF && std::isdigit(c))
+    {
+        value = value * 10 + (c - '0');
+        c = std::fgetc(file);
+    }
+    // The single whitespace byte after the last field is consumed with it
+    return c != EOF && std::isspace(c);
+}
+}
+
+bool WritePpm(const char* path, const RasterImage& image)
+{
+    char header[64];
+    int headerSize = std::snprintf(header, sizeof(header), "P6\n%d %d\n255\n", image.width, image.height);
+    std::vector<uint8_t> bytes(header, header + headerSize);
+    bytes.reserve(bytes.size() + image.pixels.size() * 3);
+    for (uint32_t pixel : image.pixels)
+    {
+        bytes.push_back(static_cast<uint8_t>(pixel));
+        bytes.push_back(static_cast<uint8_t>(pixel >> 8));
+        bytes.push_back(static_cast<uint8_t>(pixel >> 16));
+    }
+    return WriteFile(path, bytes);
+}
+
+bool ReadPpm(const char* path, RasterImage& image)
+{
+    std::FILE* file = std::fopen(path, "rb");
+    if (!file)
+        return false;
+    int width = 0, height = 0, maxValue = 0;
+    bool ok = std::fgetc(file) == 'P' && std::fgetc(file) == '6' && ReadPpmNumber(file, width) &&
+        ReadPpmNumber(file, height) && ReadPpmNumber(file, maxValue) && maxValue == 255 && width > 0 && height > 0;
+    std::vector<uint8_t> rgb;
+    if (ok)
+    {
+        rgb.resize(static_cast<size_t>(width) * height * 3);
+        ok = std::fread(rgb.data(), 1, rgb.size(), file) == rgb.size();
+    }
+    std::fclose(file);
+    if (!ok)
+        return false;
+
+    image.Resize(width, height);
+    for (size_t i = 0; i < image.pixels.size(); ++i)
+        image.pixels[i] = rgb[i * 3] | (rgb[i * 3 + 1] << 8) | (rgb[i * 3 + 2] << 16) | 0xFF000000u;
+    return true;
+}
+
+bool WritePng(const char* path, const RasterImage& image)
+{
+    // Rows of RGBA bytes, each behind filter type 0 (none)
+    std::vector<uint8_t> raw;
+    raw.reserve(static_cast<size_t>(image.height) * (image.width * 4 + 1));
+    for (int y = 0; y < image.height; ++y)
+    {
+        raw.push_back(0);
+        for (int x = 0; x < image.width; ++x)
+        {
+            uint32_t pixel = image.At(x, y);
+            for (int shift = 0; shift < 32; shift += 8)
+                raw.push_back(static_cast<uint8_t>(pixel >> shift));
+        }
+    }
+
+    const uint8_t signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+    std::vector<uint8_t> bytes(signature, signature + 8);
+    std::vector<uint8_t> header;
+    PutBigEndian(header, static_cast<uint32_t>(image.width));
+    PutBigEndian(header, static_cast<uint32_t>(image.height));
+    header.insert(header.end(), { 8, 6, 0, 0, 0 });  // 8-bit RGBA, deflate, no interlace
+    WriteChunk(bytes, "IHDR", header);
+    WriteChunk(bytes, "IDAT", Deflate(raw));
+    WriteChunk(bytes, "IEND", std::vector<uint8_t>());
+    return WriteFile(path, bytes);
+}
@@ -0,0 +1,10 @@
+#pragma once
+#include "SoftwareRasterizer.h"
+
+// Image files for the software rasterizer's output. PPM (binary P6, 8 bits) is read and
+// written; it keeps no alpha, so golden images are compared on colour. PNG is written
+// as 8-bit RGBA with a self-contained deflate encoder (fixed Huffman codes with LZ77
+// matches), which is small on the flat colours of the play area.
+bool WritePpm(const char* path, const RasterImage& image);
+bool ReadPpm(const char* path, RasterImage& image);
+bool WritePng(const char* path, const RasterImage& image);
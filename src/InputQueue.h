@@ -0,0 +1,69 @@
+#pragma once
+#include <cassert>
+#include <cstdint>
+
+enum class Direction;
+
+// Direction changes waiting for a tick, oldest first. A fixed array with no heap storage,
+// so it can be copied into a snapshot as-is.
+class InputQueue
+{
+public:
+    static const int CAPACITY = 4;  // A power of two
+
+    struct Entry
+    {
+        Direction direction;
+        uint64_t tick;  // GetTick() when the input arrived
+        float timer;    // Time since the last tick when it arrived, in simulated seconds
+    };
+
+    InputQueue() : head(0), count(0) {}
+
+    void Clear()
+    {
+        head = 0;
+        count = 0;
+    }
+
+    bool Empty() const { return count == 0; }
+    bool Full() const { return count == CAPACITY; }
+    int Size() const { return count; }
+
+    const Entry& Front() const
+    {
+        assert(count > 0);
+        return entries[head];
+    }
+
+    const Entry& Back() const
+    {
+        assert(count > 0);
+        return entries[(head + count - 1) & (CAPACITY - 1)];
+    }
+
+    const Entry& operator[](int index) const
+    {
+        assert(index >= 0 && index < count);
+        return entries[(head + index) & (CAPACITY - 1)];
+    }
+
+    void PushBack(const Entry& entry)
+    {
+        assert(count < CAPACITY);
+        entries[(head + count) & (CAPACITY - 1)] = entry;
+        ++count;
+    }
+
+    void PopFront()
+    {
+        assert(count > 0);
+        head = (head + 1) & (CAPACITY - 1);
+        --count;
+    }
+
+private:
+    Entry entries[CAPACITY];
+    int head;
+    int count;
+};
@@ -0,0 +1,516 @@
+#include "Leaderboard.h"
+#include "ByteStream.h"
+#include <algorithm>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+const uint32_t LOG_MAGIC = 0x4C4B4E53;    // "SNKL"
+const uint32_t INDEX_MAGIC = 0x584B4E53;  // "SNKX"
+const uint16_t LOG_VERSION = 1;
+const uint16_t INDEX_VERSION = 1;
+const size_t LOG_HEADER_SIZE = 16;
+const size_t RECORD_SIZE = 40;
+const size_t RECORD_CRC_OFFSET = 36;
+const size_t INDEX_HEADER_SIZE = 48;
+const size_t INDEX_TOP_ENTRY_SIZE = 4;
+const size_t INDEX_SEED_ENTRY_SIZE = 12;
+const uint8_t FLAG_WON = 1;
+
+uint32_t Crc32(const uint8_t* data, size_t size)
+{
+    struct Table
+    {
+        uint32_t entries[256];
+        Table()
+        {
+            for (uint32_t i = 0; i < 256; ++i)
+            {
+                uint32_t crc = i;
+                for (int bit = 0; bit < 8; ++bit)
+                    crc = (crc >> 1) ^ ((crc & 1) ? 0xEDB88320u : 0u);
+                entries[i] = crc;
+            }
+        }
+    };
+    static const Table table;
+
+    uint32_t crc = 0xFFFFFFFFu;
+    for (size_t i = 0; i < size; ++i)
+        crc = table.entries[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    return crc ^ 0xFFFFFFFFu;
+}
+
+void EncodeRecord(const LeaderboardEntry& entry, ByteWriter& writer, std::vector<uint8_t>& buffer)
+{
+    size_t start = buffer.size();
+    writer.PutU32(entry.score);
+    writer.PutU32(entry.length);
+    writer.PutU64(entry.ticks);
+    writer.PutU64(entry.seed);
+    writer.PutU64(entry.timestamp);
+    writer.PutU8(entry.speed);
+    writer.PutU8(entry.won ? FLAG_WON : 0);
+    writer.PutU16(0);
+    writer.PutU32(Crc32(buffer.data() + start, RECORD_CRC_OFFSET));
+}
+
+// False if the record fails its CRC
+bool DecodeRecord(const uint8_t* data, uint64_t record, LeaderboardEntry& entry)
+{
+    ByteReader reader(data, RECORD_SIZE);
+    entry.score = reader.GetU32();
+    entry.length = reader.GetU32();
+    entry.ticks = reader.GetU64();
+    entry.seed = reader.GetU64();
+    entry.timestamp = reader.GetU64();
+    entry.speed = reader.GetU8();
+    entry.won = (reader.GetU8() & FLAG_WON) != 0;
+    reader.GetU16();
+    entry.record = record;
+    return reader.GetU32() == Crc32(data, RECORD_CRC_OFFSET);
+}
+
+uint32_t RecordCrc(const uint8_t* data)
+{
+    ByteReader reader(data + RECORD_CRC_OFFSET, 4);
+    return reader.GetU32();
+}
+
+void PutLogHeader(ByteWriter& writer)
+{
+    writer.PutU32(LOG_MAGIC);
+    writer.PutU16(LOG_VERSION);
+    writer.PutU16(0);
+    writer.PutU32(static_cast<uint32_t>(RECORD_SIZE));
+    writer.PutU32(0);
+}
+
+bool CheckLogHeader(const uint8_t* data, size_t size)
+{
+    if (size < LOG_HEADER_SIZE)
+        return false;
+    ByteReader reader(data, LOG_HEADER_SIZE);
+    return reader.GetU32() == LOG_MAGIC && reader.GetU16() == LOG_VERSION && reader.GetU16() == 0 &&
+        reader.GetU32() == RECORD_SIZE;
+}
+
+// Hands buffered writes to the OS and waits until it has them on the disk
+bool FlushToDisk(std::FILE* file)
+{
+    if (std::fflush(file) != 0)
+        return false;
+#ifdef _WIN32
+    return _commit(_fileno(file)) == 0;
+#else
+    return ::fsync(fileno(file)) == 0;
+#endif
+}
+
+// The file is on the disk when this returns true, so a rename can publish it
+bool WriteSyncedFile(const std::string& path, const std::vector<uint8_t>& bytes)
+{
+    std::FILE* file = std::fopen(path.c_str(), "wb");
+    if (!file)
+        return false;
+    bool ok = std::fwrite(bytes.data(), 1, bytes.size(), file) == bytes.size() && FlushToDisk(file);
+    return std::fclose(file) == 0 && ok;
+}
+
+// Atomically swaps `to` for the synced file `from`, so a crash leaves the old file or
+// the new one, never neither. On POSIX the directory is synced too, so the rename itself
+// survives a power cut. (Not ReplaceFile: windows.h defines that as a macro.)
+bool RenameOver(const std::string& from, const std::string& to)
+{
+#ifdef _WIN32
+    return ::MoveFileExA(from.c_str(), to.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+    if (std::rename(from.c_str(), to.c_str()) != 0)
+        return false;
+    size_t slash = to.find_last_of('/');
+    std::string directory = slash == std::string::npos ? "." : slash == 0 ? "/" : to.substr(0, slash);
+    int fd = ::open(directory.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+    bool synced = ::fsync(fd) == 0;
+    ::close(fd);
+    return synced;
+#endif
+}
+
+int64_t FileEnd(std::FILE* file)
+{
+#ifdef _WIN32
+    if (_fseeki64(file, 0, SEEK_END) != 0)
+        return -1;
+    return _ftelli64(file);
+#else
+    if (fseeko(file, 0, SEEK_END) != 0)
+        return -1;
+    return ftello(file);
+#endif
+}
+}
+
+bool LeaderboardEntry::RanksAbove(const LeaderboardEntry& other) const
+{
+    if (score != other.score)
+        return score > other.score;
+    if (ticks != other.ticks)
+        return ticks < other.ticks;
+    return record < other.record;
+}
+
+std::string LeaderboardIndexPath(const char* path)
+{
+    return std::string(path) + ".idx";
+}
+
+bool LeaderboardWriter::Open(const char* path)
+{
+    Close();
+    // Append mode: every write lands at the end, whatever other writers have added
+    file = std::fopen(path, "ab");
+    if (!file)
+        return false;
+
+    int64_t size = FileEnd(file);
+    if (size < 0)
+    {
+        Close();
+        return false;
+    }
+    buffer.clear();
+    if (size == 0)
+    {
+        ByteWriter writer(buffer);
+        PutLogHeader(writer);
+        size = static_cast<int64_t>(LOG_HEADER_SIZE);
+    }
+    else
+    {
+        uint8_t header[LOG_HEADER_SIZE];
+        std::FILE* existing = std::fopen(path, "rb");
+        bool valid = existing && std::fread(header, 1, sizeof(header), existing) == sizeof(header) &&
+            CheckLogHeader(header, sizeof(header));
+        if (existing)
+            std::fclose(existing);
+        if (!valid)
+        {
+            Close();
+            return false;
+        }
+    }
+
+    // Zeros never pass the CRC, so a padded torn record reads as damaged
+    size_t torn = static_cast<size_t>(size - static_cast<int64_t>(LOG_HEADER_SIZE)) % RECORD_SIZE;
+    if (torn != 0)
+    {
+        buffer.insert(buffer.end(), RECORD_SIZE - torn, 0);
+        size += static_cast<int64_t>(RECORD_SIZE - torn);
+    }
+    recordCount = static_cast<uint64_t>(size - static_cast<int64_t>(LOG_HEADER_SIZE)) / RECORD_SIZE;
+    if (!buffer.empty() && (std::fwrite(buffer.data(), 1, buffer.size(), file) != buffer.size() || !FlushToDisk(file)))
+    {
+        Close();
+        return false;
+    }
+    return true;
+}
+
+void LeaderboardWriter::Close()
+{
+    if (file)
+        std::fclose(file);
+    file = nullptr;
+    recordCount = 0;
+}
+
+bool LeaderboardWriter::Append(const LeaderboardEntry* entries, size_t count)
+{
+    if (!file)
+        return false;
+    buffer.clear();
+    ByteWriter writer(buffer);
+    for (size_t i = 0; i < count; ++i)
+        EncodeRecord(entries[i], writer, buffer);
+    if (std::fwrite(buffer.data(), 1, buffer.size(), file) != buffer.size() || !FlushToDisk(file))
+        return false;
+    recordCount += count;
+    return true;
+}
+
+bool LeaderboardReader::Open(const char* path)
+{
+    Close();
+    if (!log.Open(path) || !CheckLogHeader(log.Data(), log.Size()))
+    {
+        Close();
+        return false;
+    }
+    recordCount = (log.Size() - LOG_HEADER_SIZE) / RECORD_SIZE;
+    if (!OpenIndex(LeaderboardIndexPath(path).c_str()))
+    {
+        index.Close();
+        indexedCount = 0;
+        topCapacity = UINT32_MAX;
+        indexTopCount = 0;
+        indexSeedCount = 0;
+    }
+
+    std::vector<LeaderboardEntry> tail;
+    tail.reserve(static_cast<size_t>(recordCount - indexedCount));
+    for (uint64_t record = indexedCount; record < recordCount; ++record)
+    {
+        LeaderboardEntry entry;
+        if (DecodeRecord(log.Data() + LOG_HEADER_SIZE + record * RECORD_SIZE, record, entry))
+            tail.push_back(entry);
+        else
+            ++corruptCount;
+    }
+    std::sort(tail.begin(), tail.end(),
+        [](const LeaderboardEntry& a, const LeaderboardEntry& b) { return a.RanksAbove(b); });
+    for (const LeaderboardEntry& entry : tail)
+    {
+        tailTop.push_back(entry.record);
+        tailSeeds.push_back({ entry.seed, entry.record });
+    }
+    std::sort(tailSeeds.begin(), tailSeeds.end(), [](const SeedRecord& a, const SeedRecord& b)
+    {
+        return a.seed != b.seed ? a.seed < b.seed : a.record < b.record;
+    });
+    return true;
+}
+
+bool LeaderboardReader::OpenIndex(const char* path)
+{
+    if (!index.Open(path) || index.Size() < INDEX_HEADER_SIZE)
+        return false;
+    ByteReader reader(index.Data(), INDEX_HEADER_SIZE);
+    if (reader.GetU32() != INDEX_MAGIC || reader.GetU16() != INDEX_VERSION)
+        return false;
+    reader.GetU16();
+    indexedCount = reader.GetU64();
+    uint32_t lastCrc = reader.GetU32();
+    topCapacity = reader.GetU32();
+    indexTopCount = reader.GetU32();
+    reader.GetU32();
+    indexSeedCount = reader.GetU64();
+
+    // The index must describe a prefix of this log: a log rewritten since no longer matches
+    if (indexedCount > recordCount || indexTopCount > indexSeedCount || indexSeedCount > indexedCount)
+        return false;
+    if (indexedCount > 0 && RecordCrc(log.Data() + LOG_HEADER_SIZE + (indexedCount - 1) * RECORD_SIZE) != lastCrc)
+        return false;
+    if (index.Size() != INDEX_HEADER_SIZE + indexTopCount * INDEX_TOP_ENTRY_SIZE + indexSeedCount * INDEX_SEED_ENTRY_SIZE)
+        return false;
+    indexTop = index.Data() + INDEX_HEADER_SIZE;
+    indexSeeds = indexTop + indexTopCount * INDEX_TOP_ENTRY_SIZE;
+    return true;
+}
+
+void LeaderboardReader::Close()
+{
+    log.Close();
+    index.Close();
+    recordCount = indexedCount = corruptCount = 0;
+    topCapacity = indexTopCount = 0;
+    indexSeedCount = 0;
+    indexTop = indexSeeds = nullptr;
+    tailTop.clear();
+    tailSeeds.clear();
+}
+
+bool LeaderboardReader::GetRecord(uint64_t record, LeaderboardEntry& entry) const
+{
+    return record < recordCount && DecodeRecord(log.Data() + LOG_HEADER_SIZE + record * RECORD_SIZE, record, entry);
+}
+
+void LeaderboardReader::Top(size_t k, std::vector<LeaderboardEntry>& entries) const
+{
+    // Merge of the index's best records with the tail's, both already in rank order
+    entries.clear();
+    size_t fromIndex = 0, fromTail = 0;
+    LeaderboardEntry indexed, unindexed;
+    bool haveIndexed = false, haveUnindexed = false;
+    while (entries.size() < k)
+    {
+        // Records damaged since they were indexed fail their CRC and are passed over
+        while (!haveIndexed && fromIndex < indexTopCount)
+        {
+            ByteReader reader(indexTop + fromIndex++ * INDEX_TOP_ENTRY_SIZE, INDEX_TOP_ENTRY_SIZE);
+            haveIndexed = GetRecord(reader.GetU32(), indexed);
+        }
+        if (!haveUnindexed && fromTail < tailTop.size())
+            haveUnindexed = GetRecord(tailTop[fromTail++], unindexed);
+        if (!haveIndexed && !haveUnindexed)
+            break;
+        if (haveIndexed && (!haveUnindexed || indexed.RanksAbove(unindexed)))
+        {
+            entries.push_back(indexed);
+            haveIndexed = false;
+        }
+        else
+        {
+            entries.push_back(unindexed);
+            haveUnindexed = false;
+        }
+    }
+}
+
+void LeaderboardReader::FindSeed(uint64_t seed, std::vector<LeaderboardEntry>& entries) const
+{
+    entries.clear();
+    uint64_t low = 0, high = indexSeedCount;
+    while (low < high)
+    {
+        uint64_t middle = low + (high - low) / 2;
+        if (IndexSeed(middle).seed < seed)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+    LeaderboardEntry entry;
+    for (uint64_t i = low; i < indexSeedCount; ++i)
+    {
+        SeedRecord found = IndexSeed(i);
+        if (found.seed != seed)
+            break;
+        if (GetRecord(found.record, entry))
+            entries.push_back(entry);
+    }
+
+    auto first = std::lower_bound(tailSeeds.begin(), tailSeeds.end(), seed,
+        [](const SeedRecord& a, uint64_t value) { return a.seed < value; });
+    for (auto it = first; it != tailSeeds.end() && it->seed == seed; ++it)
+    {
+        if (GetRecord(it->record, entry))
+            entries.push_back(entry);
+    }
+}
+
+LeaderboardReader::SeedRecord LeaderboardReader::IndexSeed(uint64_t i) const
+{
+    ByteReader reader(indexSeeds + i * INDEX_SEED_ENTRY_SIZE, INDEX_SEED_ENTRY_SIZE);
+    SeedRecord found;
+    found.seed = reader.GetU64();
+    found.record = reader.GetU32();
+    return found;
+}
+
+bool CompactLeaderboard(const char* path, uint32_t topCapacity, LeaderboardCompactResult& result)
+{
+    result = LeaderboardCompactResult();
+    std::vector<LeaderboardEntry> entries;
+    std::vector<uint8_t> kept;
+    {
+        MappedFile log;
+        if (!log.Open(path) || !CheckLogHeader(log.Data(), log.Size()))
+        {
+            result.error = "cannot read the log";
+            return false;
+        }
+        uint64_t count = (log.Size() - LOG_HEADER_SIZE) / RECORD_SIZE;
+        bool torn = (log.Size() - LOG_HEADER_SIZE) % RECORD_SIZE != 0;
+        entries.reserve(static_cast<size_t>(count));
+        for (uint64_t record = 0; record < count; ++record)
+        {
+            LeaderboardEntry entry;
+            if (DecodeRecord(log.Data() + LOG_HEADER_SIZE + record * RECORD_SIZE, entries.size(), entry))
+                entries.push_back(entry);
+            else
+                ++result.dropped;
+        }
+        if (torn)
+            ++result.dropped;
+
+        // Only a damaged log is rewritten; otherwise the index alone changes
+        if (result.dropped > 0)
+        {
+            ByteWriter writer(kept);
+            PutLogHeader(writer);
+            for (const LeaderboardEntry& entry : entries)
+                EncodeRecord(entry, writer, kept);
+        }
+    }
+    if (entries.size() > UINT32_MAX)
+    {
+        result.error = "too many records for the index";
+        return false;
+    }
+    if (!kept.empty())
+    {
+        std::string temporary = std::string(path) + ".tmp";
+        if (!WriteSyncedFile(temporary, kept) || !RenameOver(temporary, path))
+        {
+            result.error = "cannot rewrite the log";
+            return false;
+        }
+    }
+
+    std::vector<uint32_t> top(entries.size());
+    for (size_t i = 0; i < top.size(); ++i)
+        top[i] = static_cast<uint32_t>(i);
+    size_t topCount = std::min<size_t>(topCapacity, top.size());
+    std::partial_sort(top.begin(), top.begin() + topCount, top.end(),
+        [&](uint32_t a, uint32_t b) { return entries[a].RanksAbove(entries[b]); });
+    top.resize(topCount);
+
+    std::vector<uint32_t> bySeed(entries.size());
+    for (size_t i = 0; i < bySeed.size(); ++i)
+        bySeed[i] = static_cast<uint32_t>(i);
+    std::sort(bySeed.begin(), bySeed.end(), [&](uint32_t a, uint32_t b)
+    {
+        return entries[a].seed != entries[b].seed ? entries[a].seed < entries[b].seed : a < b;
+    });
+
+    std::vector<uint8_t> bytes;
+    bytes.reserve(INDEX_HEADER_SIZE + top.size() * INDEX_TOP_ENTRY_SIZE + bySeed.size() * INDEX_SEED_ENTRY_SIZE);
+    ByteWriter writer(bytes);
+    uint32_t lastCrc = 0;
+    if (!entries.empty())
+    {
+        std::vector<uint8_t> last;
+        ByteWriter lastWriter(last);
+        EncodeRecord(entries.back(), lastWriter, last);
+        lastCrc = RecordCrc(last.data());
+    }
+    writer.PutU32(INDEX_MAGIC);
+    writer.PutU16(INDEX_VERSION);
+    writer.PutU16(0);
+    writer.PutU64(entries.size());
+    writer.PutU32(lastCrc);
+    writer.PutU32(topCapacity);
+    writer.PutU32(static_cast<uint32_t>(top.size()));
+    writer.PutU32(0);
+    writer.PutU64(entries.size());
+    writer.PutU64(0);
+    for (uint32_t record : top)
+        writer.PutU32(record);
+    for (uint32_t record : bySeed)
+    {
+        writer.PutU64(entries[record].seed);
+        writer.PutU32(record);
+    }
+
+    std::string indexPath = LeaderboardIndexPath(path);
+    std::string temporary = indexPath + ".tmp";
+    if (!WriteSyncedFile(temporary, bytes) || !RenameOver(temporary, indexPath))
+    {
+        result.error = "cannot write the index";
+        return false;
+    }
+    result.records = entries.size();
+    result.topCount = static_cast<uint32_t>(top.size());
+    return true;
+}
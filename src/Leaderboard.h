@@ -0,0 +1,122 @@
+#pragma once
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "MappedFile.h"
+
+// Leaderboard store: an append-only log of finished games plus an index over it.
+//
+//   Log    "SNKL" magic, version, record size, then fixed-size records:
+//            u32 score, u32 length, u64 ticks, u64 seed, u64 timestamp (Unix seconds),
+//            u8 speed, u8 flags (bit 0: won), u16 zero, u32 CRC-32 of the 36 bytes before
+//   Index  <log>.idx, written by CompactLeaderboard. "SNKX" magic, version, the number of
+//          log records it covers and the CRC of the last one, then the best records
+//          (record numbers in rank order, up to the top capacity) and every valid record
+//          as a (seed, record number) pair sorted by seed.
+//
+// Records are only ever appended, each with one write synced to the disk, so a crash
+// loses at most the record being written; a torn or damaged record fails its CRC and is
+// skipped. Compaction writes the new log and index to temporary files, syncs them and
+// renames them over the old ones, so a crash leaves either version whole. Records rank
+// by score, then fewer ticks, then age.
+struct LeaderboardEntry
+{
+    uint32_t score = 0;
+    uint32_t length = 0;
+    uint64_t ticks = 0;
+    uint64_t seed = 0;
+    uint64_t timestamp = 0;
+    uint8_t speed = 0;       // 1 slow, 2 normal, 3 fast; 0 for headless batch games
+    bool won = false;
+    uint64_t record = 0;     // Position in the log; set by the reader
+
+    // True if this entry ranks above `other`
+    bool RanksAbove(const LeaderboardEntry& other) const;
+};
+
+class LeaderboardWriter
+{
+public:
+    LeaderboardWriter() = default;
+    ~LeaderboardWriter() { Close(); }
+
+    LeaderboardWriter(const LeaderboardWriter&) = delete;
+    LeaderboardWriter& operator=(const LeaderboardWriter&) = delete;
+
+    // Creates the log if it is missing. A record torn by an earlier crash is padded out
+    // so the next one starts on a record boundary.
+    bool Open(const char* path);
+    void Close();
+    bool IsOpen() const { return file != nullptr; }
+
+    // Writes the entries in one block and waits until they are on the disk
+    bool Append(const LeaderboardEntry* entries, size_t count);
+    bool Append(const LeaderboardEntry& entry) { return Append(&entry, 1); }
+    uint64_t GetRecordCount() const { return recordCount; }
+
+private:
+    std::FILE* file = nullptr;
+    uint64_t recordCount = 0;
+    std::vector<uint8_t> buffer;
+};
+
+// Memory-mapped view of a log and its index, as of Open. Records appended since the
+// index was written (the tail) are checked and sorted on Open, so queries never scan
+// the log: Top costs O(k) and FindSeed a binary search.
+class LeaderboardReader
+{
+public:
+    bool Open(const char* path);
+    void Close();
+
+    uint64_t GetRecordCount() const { return recordCount; }
+    uint64_t GetIndexedCount() const { return indexedCount; }
+    uint64_t GetCorruptCount() const { return corruptCount; }
+    // How many best records the index keeps; Top is exact up to this many
+    uint32_t GetTopCapacity() const { return topCapacity; }
+
+    bool GetRecord(uint64_t record, LeaderboardEntry& entry) const;
+    // The best k entries, best first
+    void Top(size_t k, std::vector<LeaderboardEntry>& entries) const;
+    // Every entry played with the seed, oldest first
+    void FindSeed(uint64_t seed, std::vector<LeaderboardEntry>& entries) const;
+
+private:
+    struct SeedRecord
+    {
+        uint64_t seed;
+        uint64_t record;
+    };
+
+    bool OpenIndex(const char* path);
+    SeedRecord IndexSeed(uint64_t i) const;
+
+    MappedFile log;
+    MappedFile index;
+    uint64_t recordCount = 0;
+    uint64_t indexedCount = 0;
+    uint64_t corruptCount = 0;
+    uint32_t topCapacity = 0;
+    uint32_t indexTopCount = 0;
+    uint64_t indexSeedCount = 0;
+    const uint8_t* indexTop = nullptr;
+    const uint8_t* indexSeeds = nullptr;
+    std::vector<uint64_t> tailTop;       // Unindexed valid records in rank order
+    std::vector<SeedRecord> tailSeeds;   // ... and by seed
+};
+
+struct LeaderboardCompactResult
+{
+    uint64_t records = 0;    // Valid records kept
+    uint64_t dropped = 0;    // Damaged or torn records removed from the log
+    uint32_t topCount = 0;
+    const char* error = "";
+};
+
+// Rebuilds the index over the whole log. If the log holds damaged records it is first
+// rewritten without them, which renumbers records, so no writer may have it open then.
+// Both files are replaced by renaming a finished temporary file over them.
+bool CompactLeaderboard(const char* path, uint32_t topCapacity, LeaderboardCompactResult& result);
+
+std::string LeaderboardIndexPath(const char* path);
@@ -0,0 +1,352 @@
+#include "LockstepServer.h"
+#include "Profiler.h"
+#include <algorithm>
+
+namespace
+{
+const int SOCKET_BUFFER_BYTES = 4 << 20;  // Room for a tick's worth of packets from hundreds of clients
+
+// Frames from the first to the second, when the second is not earlier
+bool NotBefore(uint32_t frame, uint32_t other) { return static_cast<int32_t>(frame - other) >= 0; }
+}
+
+LockstepServer::LockstepServer(const LockstepServerConfig& config)
+    : config(config), game(config.gridWidth, config.gridHeight, config.seed), clients(config.slots),
+    records(config.rollbackFrames + 1), history(HISTORY_FRAMES), packet(), receiveBuffer(NET_MAX_PACKET)
+{
+    tickSamples.reserve(TICK_SAMPLES);
+    game.SetSnakeCount(config.slots);
+    game.SetObstacleCount(config.obstacles);
+}
+
+bool LockstepServer::Open()
+{
+    if (!socket.Open(config.port, SOCKET_BUFFER_BYTES))
+        return false;
+    game.Reset(config.seed);
+    game.StartGame();
+    StartMatch();
+    nextTick = Clock::now();
+    return true;
+}
+
+void LockstepServer::Update(int maxWaitMs)
+{
+    Clock::time_point now = Clock::now();
+    if (now < nextTick)
+    {
+        auto wait = std::chrono::duration_cast<std::chrono::milliseconds>(nextTick - now).count();
+        socket.Wait(static_cast<int>(std::min<long long>(wait, maxWaitMs)));
+    }
+    Receive();
+
+    now = Clock::now();
+    if (now < nextTick)
+        return;
+    Tick();
+    // Skip ticks missed during a stall rather than running them back to back
+    std::chrono::milliseconds period(config.tickMillis);
+    nextTick += period;
+    if (nextTick < now)
+        nextTick = now + period;
+    DropIdleClients(now);
+}
+
+const LockstepServerStats& LockstepServer::GetStats()
+{
+    stats.frames = frame;
+    stats.matches = match + 1;
+    stats.clients = static_cast<uint32_t>(std::count_if(clients.begin(), clients.end(),
+        [](const Client& client) { return client.connected; }));
+    stats.meanTickMicros = tickCount ? tickMicrosTotal / tickCount : 0.0;
+    std::vector<double> sorted(tickSamples);
+    std::sort(sorted.begin(), sorted.end());
+    stats.p99TickMicros = sorted.empty() ? 0.0 : sorted[std::min(sorted.size() - 1, sorted.size() * 99 / 100)];
+    return stats;
+}
+
+void LockstepServer::Receive()
+{
+    NetAddress from;
+    int size;
+    while ((size = socket.ReceiveFrom(from, receiveBuffer.data(), receiveBuffer.size())) > 0)
+    {
+        ++stats.packetsReceived;
+        stats.bytesReceived += static_cast<uint64_t>(size);
+        Handle(from, receiveBuffer.data(), static_cast<size_t>(size));
+    }
+}
+
+void LockstepServer::Handle(const NetAddress& from, const uint8_t* data, size_t size)
+{
+    ByteReader reader(data, size);
+    NetPacketType type;
+    if (!GetNetHeader(reader, type))
+        return;
+
+    switch (type)
+    {
+    case NetPacketType::JOIN:
+        HandleJoin(from, reader);
+        break;
+    case NetPacketType::INPUT:
+        HandleInput(from, reader);
+        break;
+    case NetPacketType::LEAVE:
+    {
+        uint16_t slot = reader.GetU16();
+        if (reader.Ok() && slot < clients.size() && clients[slot].address == from)
+            clients[slot].connected = false;
+        break;
+    }
+    case NetPacketType::STATS_REQUEST:
+        HandleStatsRequest(from);
+        break;
+    default:
+        break;
+    }
+}
+
+void LockstepServer::HandleJoin(const NetAddress& from, ByteReader& reader)
+{
+    uint32_t nonce = reader.GetU32();
+    if (!reader.Ok())
+        return;
+
+    // A repeated JOIN (the WELCOME was lost) gets the same slot back
+    auto found = std::find_if(clients.begin(), clients.end(),
+        [&](const Client& client) { return client.connected && client.address == from; });
+    if (found == clients.end())
+    {
+        found = std::find_if(clients.begin(), clients.end(), [](const Client& client) { return !client.connected; });
+        if (found != clients.end())
+        {
+            *found = Client();
+            found->address = from;
+            found->connected = true;
+        }
+    }
+    if (found != clients.end())
+        found->lastHeard = Clock::now();
+
+    packet.clear();
+    ByteWriter writer(packet);
+    PutNetHeader(writer, NetPacketType::WELCOME);
+    writer.PutU32(nonce);
+    writer.PutU16(found != clients.end() ? static_cast<uint16_t>(found - clients.begin()) : NET_NO_SLOT);
+    writer.PutU16(static_cast<uint16_t>(config.gridWidth));
+    writer.PutU16(static_cast<uint16_t>(config.gridHeight));
+    writer.PutU16(static_cast<uint16_t>(config.tickMillis));
+    Send(from, packet);
+}
+
+void LockstepServer::HandleInput(const NetAddress& from, ByteReader& reader)
+{
+    uint16_t slot = reader.GetU16();
+    uint32_t ackFrame = reader.GetU32();
+    uint32_t firstSeq = reader.GetU32();
+    int count = reader.GetU8();
+    if (!reader.Ok() || slot >= clients.size() || !clients[slot].connected || clients[slot].address != from)
+        return;
+
+    Client& client = clients[slot];
+    client.lastHeard = Clock::now();
+    // Packets can arrive out of order; only a newer acknowledgement moves the delta base
+    if (ackFrame != NET_NO_FRAME && (client.ackFrame == NET_NO_FRAME || NotBefore(ackFrame, client.ackFrame)) &&
+        NotBefore(frame, ackFrame))
+        client.ackFrame = ackFrame;
+
+    for (int i = 0; i < count; ++i)
+    {
+        uint32_t seq = firstSeq + static_cast<uint32_t>(i);
+        Direction direction = static_cast<Direction>(reader.GetU8() & 3);
+        int offset = static_cast<int8_t>(reader.GetU8());
+        // Resent inputs the server already has are skipped by sequence number
+        if (!reader.Ok() || static_cast<int32_t>(seq - client.lastSeq) <= 0)
+            continue;
+        client.lastSeq = seq;
+        if (slot >= game.GetSnakeCount())
+            continue;
+        ++stats.inputs;
+
+        // Inputs take effect on the frame their sender saw. One still inside the window
+        // rewinds to it; anything later, or from before this match, counts from now.
+        uint32_t target = ackFrame == NET_NO_FRAME ? frame : ackFrame + static_cast<uint32_t>(offset);
+        if (NotBefore(target, frame))
+            target = frame;
+        FrameRecord* record = Record(target);
+        if (!record)
+        {
+            ++stats.lateInputs;
+            target = frame;
+            record = Record(frame);
+        }
+        record->inputs.push_back({ slot, direction });
+        if (target != frame && (rewindFrom == NET_NO_FRAME || NotBefore(rewindFrom, target)))
+            rewindFrom = target;
+    }
+}
+
+void LockstepServer::HandleStatsRequest(const NetAddress& from)
+{
+    const LockstepServerStats& current = GetStats();
+    packet.clear();
+    ByteWriter writer(packet);
+    PutNetHeader(writer, NetPacketType::STATS);
+    writer.PutU64(current.frames);
+    writer.PutU32(current.matches);
+    writer.PutU32(current.clients);
+    writer.PutU32(static_cast<uint32_t>(current.meanTickMicros * 1000.0));
+    writer.PutU32(static_cast<uint32_t>(current.p99TickMicros * 1000.0));
+    writer.PutU32(static_cast<uint32_t>(current.maxTickMicros * 1000.0));
+    writer.PutU64(current.rollbacks);
+    writer.PutU64(current.resimulatedFrames);
+    writer.PutU64(current.inputs);
+    writer.PutU64(current.lateInputs);
+    writer.PutU64(current.bytesSent);
+    writer.PutU64(current.bytesReceived);
+    writer.PutU64(current.packetsSent);
+    writer.PutU64(current.packetsReceived);
+    Send(from, packet);
+}
+
+void LockstepServer::Tick()
+{
+    SNAKE_PROFILE_SCOPE("LockstepServer::Tick");
+    Clock::time_point start = Clock::now();
+
+    if (rewindFrom != NET_NO_FRAME)
+        Rewind();
+    Simulate(*Record(frame), true);
+    ++frame;
+
+    if (game.IsGameOver() && ++gameOverFrames > config.restartFrames)
+    {
+        game.Reset();
+        game.StartGame();
+        ++match;
+        StartMatch();
+    }
+    else
+    {
+        FrameRecord& next = records[frame % records.size()];
+        next.frame = frame;
+        next.inputs.clear();
+    }
+    Broadcast();
+
+    double micros = std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+    if (tickSamples.size() < TICK_SAMPLES)
+        tickSamples.push_back(micros);
+    else
+        tickSamples[tickCount % TICK_SAMPLES] = micros;
+    ++tickCount;
+    tickMicrosTotal += micros;
+    stats.maxTickMicros = std::max(stats.maxTickMicros, micros);
+}
+
+void LockstepServer::StartMatch()
+{
+    // Snapshots are sized for the match's snake and obstacle counts
+    matchStart = frame;
+    gameOverFrames = 0;
+    rewindFrom = NET_NO_FRAME;
+    for (FrameRecord& record : records)
+    {
+        record.frame = NET_NO_FRAME;
+        record.inputs.clear();
+        record.snapshot = SnakeSnapshot(game);
+    }
+    FrameRecord& first = records[frame % records.size()];
+    first.frame = frame;
+}
+
+void LockstepServer::Rewind()
+{
+    SNAKE_PROFILE_SCOPE("LockstepServer::Rewind");
+    ++stats.rollbacks;
+    stats.resimulatedFrames += frame - rewindFrom;
+    game.Restore(Record(rewindFrom)->snapshot.Data());
+    for (uint32_t replayed = rewindFrom; replayed != frame; ++replayed)
+        Simulate(*Record(replayed), replayed != rewindFrom);
+    rewindFrom = NET_NO_FRAME;
+    // A late input can undo the game over the restart countdown was counting from
+    if (!game.IsGameOver())
+        gameOverFrames = 0;
+}
+
+void LockstepServer::Simulate(FrameRecord& record, bool takeSnapshot)
+{
+    if (takeSnapshot)
+        game.Snapshot(record.snapshot.Data());
+    for (const Input& input : record.inputs)
+        game.SetDirection(input.slot, input.direction);
+    game.Step();
+}
+
+void LockstepServer::Broadcast()
+{
+    SNAKE_PROFILE_SCOPE("LockstepServer::Broadcast");
+    NetFrame& current = history[frame % HISTORY_FRAMES];
+    current.CopyFrom(game, frame, match);
+
+    // Most clients acknowledge the same recent frame, so each base is encoded once
+    struct Encoded
+    {
+        uint32_t base;
+        std::vector<uint8_t> bytes;
+    };
+    std::vector<Encoded> encoded;
+    for (Client& client : clients)
+    {
+        if (!client.connected)
+            continue;
+        const NetFrame* base = nullptr;
+        if (client.ackFrame != NET_NO_FRAME && frame - client.ackFrame < HISTORY_FRAMES &&
+            history[client.ackFrame % HISTORY_FRAMES].frame == client.ackFrame)
+            base = &history[client.ackFrame % HISTORY_FRAMES];
+        uint32_t baseFrame = base ? base->frame : NET_NO_FRAME;
+
+        auto found = std::find_if(encoded.begin(), encoded.end(), [&](const Encoded& e) { return e.base == baseFrame; });
+        if (found == encoded.end())
+        {
+            encoded.push_back({ baseFrame, std::vector<uint8_t>() });
+            ByteWriter writer(encoded.back().bytes);
+            EncodeFrame(base, current, writer);
+            found = encoded.end() - 1;
+        }
+
+        packet.clear();
+        ByteWriter writer(packet);
+        PutNetHeader(writer, NetPacketType::STATE);
+        writer.PutU32(client.lastSeq);
+        writer.PutBytes(found->bytes.data(), found->bytes.size());
+        Send(client.address, packet);
+    }
+}
+
+void LockstepServer::DropIdleClients(Clock::time_point now)
+{
+    for (Client& client : clients)
+    {
+        if (client.connected && now - client.lastHeard > std::chrono::milliseconds(config.clientTimeoutMs))
+            client.connected = false;
+    }
+}
+
+LockstepServer::FrameRecord* LockstepServer::Record(uint32_t target)
+{
+    // Only frames of this match that are still in the window
+    if (!NotBefore(target, matchStart) || !NotBefore(frame, target))
+        return nullptr;
+    FrameRecord& record = records[target % records.size()];
+    return record.frame == target ? &record : nullptr;
+}
+
+void LockstepServer::Send(const NetAddress& to, const std::vector<uint8_t>& data)
+{
+    if (!socket.SendTo(to, data.data(), data.size()))
+        return;
+    ++stats.packetsSent;
+    stats.bytesSent += data.size();
+}
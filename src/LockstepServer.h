@@ -0,0 +1,125 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <vector>
+#include "NetProtocol.h"
+#include "SnakeGame.h"
+#include "UdpSocket.h"
+
+struct LockstepServerConfig
+{
+    uint16_t port = 0;         // 0 picks a free port
+    int gridWidth = 64;
+    int gridHeight = 64;
+    int slots = 16;            // Snakes per match, one per client; unclaimed snakes run straight
+    int obstacles = 0;
+    int tickMillis = 50;
+    int rollbackFrames = 8;    // How late an input may be and still land on its own frame
+    uint64_t seed = 1;         // Seed of the first match; each reset draws the next one
+    int clientTimeoutMs = 5000;
+    int restartFrames = 20;    // Frames a finished match stays on screen
+};
+
+struct LockstepServerStats
+{
+    uint64_t frames = 0;
+    uint32_t matches = 0;
+    uint32_t clients = 0;
+    // Time spent per tick on rollback, simulation, encoding and sending, in microseconds
+    double meanTickMicros = 0.0, p99TickMicros = 0.0, maxTickMicros = 0.0;
+    uint64_t rollbacks = 0;         // Ticks that rewound for a late input
+    uint64_t resimulatedFrames = 0;
+    uint64_t inputs = 0;
+    uint64_t lateInputs = 0;        // Beyond the rollback window; applied on arrival
+    uint64_t bytesSent = 0, bytesReceived = 0;
+    uint64_t packetsSent = 0, packetsReceived = 0;
+};
+
+// Authoritative multiplayer host on the loopback interface. It owns one SnakeGame with a
+// snake per client slot and ticks it at a fixed rate. Clients send one INPUT packet per
+// frame they receive, acknowledging that frame and repeating their unacknowledged turns,
+// each tagged with the frame the client saw when it made it; every tick each client
+// gets a STATE packet holding the new frame delta-encoded against the one it last
+// acknowledged.
+//
+// An input arriving after its frame was simulated rewinds the game: the server keeps a
+// snapshot of the last rollbackFrames frames and their inputs, restores the one the
+// input belongs to and re-runs the ticks since. Clients learn of the corrected state
+// through the next delta like any other change.
+class LockstepServer
+{
+public:
+    explicit LockstepServer(const LockstepServerConfig& config);
+
+    LockstepServer(const LockstepServer&) = delete;
+    LockstepServer& operator=(const LockstepServer&) = delete;
+
+    bool Open();
+    uint16_t GetPort() const { return socket.GetPort(); }
+
+    // Handles packets until the next tick is due (at most maxWaitMs), then runs it
+    void Update(int maxWaitMs = 100);
+    const LockstepServerStats& GetStats();
+    const SnakeGame& GetGame() const { return game; }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Client
+    {
+        NetAddress address;
+        bool connected = false;
+        uint32_t lastSeq = 0;      // Newest input sequence number taken
+        uint32_t ackFrame = NET_NO_FRAME;
+        Clock::time_point lastHeard;
+    };
+
+    struct Input
+    {
+        uint16_t slot;
+        Direction direction;
+    };
+
+    // Inputs for one frame and the game state the frame started from
+    struct FrameRecord
+    {
+        uint32_t frame = NET_NO_FRAME;
+        std::vector<Input> inputs;
+        SnakeSnapshot snapshot;
+    };
+
+    static const int HISTORY_FRAMES = 64;  // Sent frames kept as delta bases
+    static const int TICK_SAMPLES = 1024;
+
+    void Receive();
+    void Handle(const NetAddress& from, const uint8_t* data, size_t size);
+    void HandleJoin(const NetAddress& from, ByteReader& reader);
+    void HandleInput(const NetAddress& from, ByteReader& reader);
+    void HandleStatsRequest(const NetAddress& from);
+    void Tick();
+    void StartMatch();
+    void Rewind();
+    void Simulate(FrameRecord& record, bool takeSnapshot);
+    void Broadcast();
+    void DropIdleClients(Clock::time_point now);
+    FrameRecord* Record(uint32_t frame);
+    void Send(const NetAddress& to, const std::vector<uint8_t>& packet);
+
+    LockstepServerConfig config;
+    UdpSocket socket;
+    SnakeGame game;
+    std::vector<Client> clients;      // Indexed by slot
+    std::vector<FrameRecord> records; // Ring of frames still open to late inputs
+    std::vector<NetFrame> history;    // Ring of frames as they were sent
+    uint32_t frame = 0;               // Frame the game is at; the next tick makes frame + 1
+    uint32_t matchStart = 0;          // First frame of the current match
+    uint32_t match = 0;
+    uint32_t rewindFrom = NET_NO_FRAME;
+    int gameOverFrames = 0;
+    Clock::time_point nextTick;
+    LockstepServerStats stats;
+    std::vector<double> tickSamples;  // Ring of recent tick times, in microseconds
+    double tickMicrosTotal = 0.0;
+    uint64_t tickCount = 0;
+    std::vector<uint8_t> packet, receiveBuffer;
+};
@@ -0,0 +1,288 @@
+#include "MctsBot.h"
+#include <cmath>
+#include "Policies.h"
+#include "Profiler.h"
+#include "ThreadPool.h"
+
+namespace
+{
+const Direction DIRECTIONS[4] = { Direction::UP, Direction::DOWN, Direction::LEFT, Direction::RIGHT };
+
+// Snake 0's playout is over once it dies, even if other snakes play on
+bool IsFinished(const SnakeGame& game)
+{
+    return game.IsGameOver() || !game.GetSnake(0).alive;
+}
+}
+
+MctsBot::MctsBot(const MctsConfig& newConfig) : config(newConfig)
+{
+    int threads = config.threads > 0 ? config.threads : ThreadPool::HardwareThreads();
+    pool.reset(new ThreadPool(threads));
+    trees.resize(pool->GetThreadCount());
+    for (size_t i = 0; i < trees.size(); ++i)
+    {
+        Tree& tree = trees[i];
+        tree.rng.Seed(config.seed, i);
+        // Both pools are sized once, so node references stay valid while a tree grows
+        tree.nodes.reserve(config.maxNodes);
+        tree.spare.reserve(config.maxNodes);
+    }
+}
+
+MctsBot::~MctsBot() = default;
+
+int MctsBot::GetThreadCount() const
+{
+    return pool->GetThreadCount();
+}
+
+Direction MctsBot::Plan(const SnakeGame& game)
+{
+    SNAKE_PROFILE_SCOPE("MctsBot::Plan");
+    if (IsFinished(game))
+        return game.GetDirection();
+    if (!Prepare(game))
+        return GreedyPolicy(game);
+
+    Clock::time_point start = Clock::now();
+    Clock::time_point deadline = start + std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double, std::milli>(config.budgetMs));
+    pool->ParallelFor(static_cast<int>(trees.size()), 1, [this, deadline](int begin, int end, int)
+    {
+        // The copies' ticks are not the game's, so they stay out of the tick statistics
+        Profiler::SetThreadMuted(true);
+        for (int i = begin; i < end; ++i)
+            Search(trees[i], deadline);
+        Profiler::SetThreadMuted(false);
+    });
+    searchSeconds += std::chrono::duration<double>(Clock::now() - start).count();
+
+    // Visits summed over the trees pick the move; the mean return breaks ties
+    uint64_t visits[4] = {};
+    double values[4] = {};
+    lastSimulations = 0;
+    for (const Tree& tree : trees)
+    {
+        lastSimulations += tree.simulations;
+        const Node& rootNode = tree.nodes[0];
+        for (int i = 0; i < rootNode.childCount; ++i)
+        {
+            const Node& child = tree.nodes[rootNode.firstChild + i];
+            visits[static_cast<int>(child.move)] += child.visits;
+            values[static_cast<int>(child.move)] += child.value;
+        }
+    }
+    totalSimulations += lastSimulations;
+    ++planCount;
+    valid = true;
+    lastSeed = game.GetSeed();
+    lastTick = game.GetTick();
+
+    int best = -1;
+    for (int i = 0; i < 4; ++i)
+    {
+        if (visits[i] == 0)
+            continue;
+        if (best < 0 || visits[i] > visits[best] ||
+            (visits[i] == visits[best] && values[i] / visits[i] > values[best] / visits[best]))
+            best = i;
+    }
+    return best < 0 ? GreedyPolicy(game) : DIRECTIONS[best];
+}
+
+bool MctsBot::Prepare(const SnakeGame& game)
+{
+    // Restore needs copies with the same board, obstacle count and snake count
+    for (Tree& tree : trees)
+    {
+        SnakeGame* copy = tree.game.get();
+        if (copy && copy->GetGridWidth() == game.GetGridWidth() && copy->GetGridHeight() == game.GetGridHeight() &&
+            copy->GetObstacleCount() == game.GetObstacleCount() && copy->GetSnakeCount() == game.GetSnakeCount())
+            continue;
+        tree.game.reset(new SnakeGame(game.GetGridWidth(), game.GetGridHeight()));
+        tree.game->SetObstacleCount(game.GetObstacleCount());
+        tree.game->SetSnakeCount(game.GetSnakeCount());
+        tree.game->Reset(0);
+        if (tree.game->GetObstacleCount() != game.GetObstacleCount() || tree.game->GetSnakeCount() != game.GetSnakeCount())
+        {
+            tree.game.reset();
+            valid = false;
+            return false;
+        }
+        valid = false;
+    }
+    for (Tree& tree : trees)
+        tree.game->SetBufferedInput(game.IsBufferedInput());
+
+    if (rootSize != game.GetSnapshotSize())
+    {
+        root = SnakeSnapshot(game);
+        rootSize = game.GetSnapshotSize();
+    }
+    game.Snapshot(root.Data());
+
+    // The trees carry on if the game went one tick on from the position they searched;
+    // the heading it took picks the subtree
+    bool carryOn = valid && game.GetSeed() == lastSeed && game.GetTick() == lastTick + 1;
+    lastReusedNodes = 0;
+    for (Tree& tree : trees)
+    {
+        if (carryOn && !tree.nodes.empty())
+            Reroot(tree, game.GetDirection());
+        else
+            ResetTree(tree, game.GetDirection());
+        lastReusedNodes += tree.nodes.size() - 1;
+    }
+    return true;
+}
+
+void MctsBot::Reroot(Tree& tree, Direction move)
+{
+    const Node& rootNode = tree.nodes[0];
+    int child = -1;
+    for (int i = 0; i < rootNode.childCount; ++i)
+    {
+        if (tree.nodes[rootNode.firstChild + i].move == move)
+            child = rootNode.firstChild + i;
+    }
+    if (child < 0 || tree.nodes[child].visits == 0)
+    {
+        ResetTree(tree, move);
+        return;
+    }
+
+    // Breadth-first copy, so every node's children stay contiguous in the new pool
+    std::vector<Node>& spare = tree.spare;
+    spare.clear();
+    spare.push_back(tree.nodes[child]);
+    for (size_t i = 0; i < spare.size(); ++i)
+    {
+        int first = spare[i].firstChild;
+        int count = spare[i].childCount;
+        if (first < 0)
+            continue;
+        spare[i].firstChild = static_cast<int32_t>(spare.size());
+        for (int k = 0; k < count; ++k)
+            spare.push_back(tree.nodes[first + k]);
+    }
+    tree.nodes.swap(spare);
+}
+
+void MctsBot::ResetTree(Tree& tree, Direction heading)
+{
+    tree.nodes.clear();
+    tree.nodes.push_back({ -1, 0, 0.0f, heading, 0 });
+}
+
+void MctsBot::Search(Tree& tree, Clock::time_point deadline)
+{
+    tree.simulations = 0;
+    do
+    {
+        Simulate(tree);
+        ++tree.simulations;
+    } while (Clock::now() < deadline);
+}
+
+void MctsBot::Simulate(Tree& tree)
+{
+    SnakeGame& game = *tree.game;
+    game.Restore(root.Data());
+    game.ReseedGenerators(tree.rng.NextU64());
+
+    int score = game.GetScore();
+    float weight = 1.0f;
+    float total = 0.0f;
+    auto step = [&](Direction dir)
+    {
+        game.SetDirection(dir);
+        game.Step();
+        if (game.GetScore() > score)
+        {
+            total += weight;
+            score = game.GetScore();
+        }
+        if (!game.GetSnake(0).alive)
+            total -= weight;
+        weight *= config.discount;
+    };
+
+    // Down the tree to a node not visited before, expanding a visited leaf on the way
+    std::vector<int>& path = tree.path;
+    path.clear();
+    path.push_back(0);
+    int node = 0;
+    while (!IsFinished(game))
+    {
+        if (tree.nodes[node].firstChild < 0)
+        {
+            bool fresh = node != 0 && tree.nodes[node].visits == 0;
+            if (fresh || !Expand(tree, node))
+                break;
+        }
+        node = SelectChild(tree, node);
+        step(tree.nodes[node].move);
+        path.push_back(node);
+        if (tree.nodes[node].visits == 0)
+            break;
+    }
+
+    for (int tick = 0; tick < config.rolloutTicks && !IsFinished(game); ++tick)
+        step(RolloutMove(tree));
+
+    for (int visited : path)
+    {
+        ++tree.nodes[visited].visits;
+        tree.nodes[visited].value += total;
+    }
+}
+
+bool MctsBot::Expand(Tree& tree, int node)
+{
+    if (tree.nodes.size() + 3 > static_cast<size_t>(config.maxNodes))
+        return false;
+    Direction heading = tree.nodes[node].move;
+    tree.nodes[node].firstChild = static_cast<int32_t>(tree.nodes.size());
+    uint8_t count = 0;
+    for (Direction dir : DIRECTIONS)
+    {
+        if (IsOppositeDirection(dir, heading))
+            continue;
+        tree.nodes.push_back({ -1, 0, 0.0f, dir, 0 });
+        ++count;
+    }
+    tree.nodes[node].childCount = count;
+    return true;
+}
+
+int MctsBot::SelectChild(const Tree& tree, int node) const
+{
+    const Node& parent = tree.nodes[node];
+    float logVisits = std::log(static_cast<float>(parent.visits > 0 ? parent.visits : 1));
+    int best = parent.firstChild;
+    float bestScore = -1e30f;
+    for (int i = 0; i < parent.childCount; ++i)
+    {
+        int index = parent.firstChild + i;
+        const Node& child = tree.nodes[index];
+        if (child.visits == 0)
+            return index;
+        float score = child.value / child.visits + config.exploration * std::sqrt(logVisits / child.visits);
+        if (score > bestScore)
+        {
+            best = index;
+            bestScore = score;
+        }
+    }
+    return best;
+}
+
+Direction MctsBot::RolloutMove(Tree& tree) const
+{
+    const SnakeGame& game = *tree.game;
+    if (tree.rng.NextBounded(5) != 0)
+        return GreedyPolicy(game);
+    Direction dir = DIRECTIONS[tree.rng.NextBounded(4)];
+    return IsOppositeDirection(dir, game.GetDirection()) ? game.GetDirection() : dir;
+}
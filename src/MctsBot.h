@@ -0,0 +1,110 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "Random.h"
+#include "SnakeGame.h"
+
+class ThreadPool;
+
+struct MctsConfig
+{
+    int threads = 0;          // Search threads, one tree each; 0 uses every hardware thread
+    double budgetMs = 10.0;   // Search time per move
+    int rolloutTicks = 40;    // Playout length past the tree
+    int maxNodes = 1 << 16;   // Node pool per tree
+    float exploration = 1.0f; // UCB1 constant
+    float discount = 0.95f;   // Per-tick discount of food and death
+    uint64_t seed = 1;        // Seeds the playouts' generators
+};
+
+// Monte Carlo tree search player for snake 0, run root-parallel: every search thread
+// grows its own tree from the same position for the move's time budget, and the move
+// with the most visits summed over the trees is played.
+//
+// The obstacles and food are random as far as the bot is concerned. Each simulation
+// restores a copy of the game from a snapshot and reseeds its generators, so the tree
+// is open-loop: a node stands for a sequence of moves, and its statistics average over
+// the obstacle moves and food spawns seen below it. A simulation walks the tree by
+// UCB1, adds the children of the first visited leaf it meets, then plays on with the
+// greedy policy (one move in five random) for rolloutTicks ticks. Food scores 1 and
+// death -1, discounted per tick.
+//
+// Nodes live in a fixed pool per tree. After a move, the subtree under it is copied to
+// the front of the tree's spare pool, which then becomes the live one, so the search
+// carries on from where the last move left it and never allocates once warmed up.
+class MctsBot
+{
+public:
+    explicit MctsBot(const MctsConfig& config = MctsConfig());
+    ~MctsBot();
+
+    MctsBot(const MctsBot&) = delete;
+    MctsBot& operator=(const MctsBot&) = delete;
+
+    // Direction for the next tick, searched for the configured budget. Call once per
+    // tick, before Step(), on the same game; a tree survives only consecutive ticks.
+    Direction Plan(const SnakeGame& game);
+    // Drops the trees; the next Plan starts from scratch
+    void Invalidate() { valid = false; }
+
+    void SetBudgetMs(double budgetMs) { config.budgetMs = budgetMs; }
+    const MctsConfig& GetConfig() const { return config; }
+    int GetThreadCount() const;
+
+    uint64_t GetLastSimulations() const { return lastSimulations; }
+    double GetSimulationsPerSecond() const { return searchSeconds > 0.0 ? totalSimulations / searchSeconds : 0.0; }
+    double GetAverageSimulations() const { return planCount > 0 ? static_cast<double>(totalSimulations) / planCount : 0.0; }
+    // Nodes carried over into the last move's search, summed over the trees
+    uint64_t GetLastReusedNodes() const { return lastReusedNodes; }
+    uint64_t GetPlanCount() const { return planCount; }
+
+private:
+    struct Node
+    {
+        int32_t firstChild;  // Children are contiguous; -1 until expanded
+        uint32_t visits;
+        float value;         // Sum of the returns through this node
+        Direction move;      // Heading after the move into this node
+        uint8_t childCount;
+    };
+
+    struct Tree
+    {
+        std::vector<Node> nodes;
+        std::vector<Node> spare;  // Re-rooting target, swapped in afterwards
+        std::unique_ptr<SnakeGame> game;
+        Pcg32 rng;
+        std::vector<int> path;
+        uint64_t simulations = 0;
+    };
+
+    using Clock = std::chrono::steady_clock;
+
+    // Sets up the game copies and the trees for this position; false if a copy can't
+    // match the game
+    bool Prepare(const SnakeGame& game);
+    void Reroot(Tree& tree, Direction move);
+    void ResetTree(Tree& tree, Direction heading);
+    void Search(Tree& tree, Clock::time_point deadline);
+    void Simulate(Tree& tree);
+    bool Expand(Tree& tree, int node);
+    int SelectChild(const Tree& tree, int node) const;
+    Direction RolloutMove(Tree& tree) const;
+
+    MctsConfig config;
+    std::unique_ptr<ThreadPool> pool;
+    std::vector<Tree> trees;
+    SnakeSnapshot root;  // The position being searched
+    size_t rootSize = 0;
+
+    // Position the trees were searched from
+    bool valid = false;
+    uint64_t lastSeed = 0, lastTick = 0;
+
+    uint64_t lastSimulations = 0, totalSimulations = 0;
+    uint64_t lastReusedNodes = 0;
+    uint64_t planCount = 0;
+    double searchSeconds = 0.0;
+};
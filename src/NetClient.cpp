@@ -0,0 +1,180 @@
+#include "NetClient.h"
+#include <algorithm>
+
+namespace
+{
+const int JOIN_RETRY_MS = 100;
+}
+
+bool NetClient::Connect(uint16_t serverPort, int timeoutMs)
+{
+    Disconnect();
+    if (!socket.Open())
+        return false;
+    server = NetAddress::Loopback(serverPort);
+    receiveBuffer.resize(NET_MAX_PACKET);
+    uint32_t nonce = static_cast<uint32_t>(Clock::now().time_since_epoch().count()) ^ socket.GetPort();
+
+    Clock::time_point deadline = Clock::now() + std::chrono::milliseconds(timeoutMs);
+    while (Clock::now() < deadline)
+    {
+        packet.clear();
+        ByteWriter writer(packet);
+        PutNetHeader(writer, NetPacketType::JOIN);
+        writer.PutU32(nonce);
+        socket.SendTo(server, packet.data(), packet.size());
+        ++stats.packetsSent;
+        stats.bytesSent += packet.size();
+
+        // Anything other than our WELCOME (a STATE that raced it) is dropped
+        if (!socket.Wait(JOIN_RETRY_MS))
+            continue;
+        NetAddress from;
+        int size;
+        while ((size = socket.ReceiveFrom(from, receiveBuffer.data(), receiveBuffer.size())) > 0)
+        {
+            ++stats.packetsReceived;
+            stats.bytesReceived += static_cast<uint64_t>(size);
+            ByteReader reader(receiveBuffer.data(), static_cast<size_t>(size));
+            NetPacketType type;
+            if (from != server || !GetNetHeader(reader, type) || type != NetPacketType::WELCOME || reader.GetU32() != nonce)
+                continue;
+            uint16_t assigned = reader.GetU16();
+            reader.GetU16();  // Grid size; every frame carries it too
+            reader.GetU16();
+            tickMillis = reader.GetU16();
+            if (!reader.Ok() || assigned == NET_NO_SLOT)
+                return false;
+            slot = assigned;
+            return true;
+        }
+    }
+    return false;
+}
+
+void NetClient::Disconnect()
+{
+    if (IsConnected())
+    {
+        packet.clear();
+        ByteWriter writer(packet);
+        PutNetHeader(writer, NetPacketType::LEAVE);
+        writer.PutU16(slot);
+        socket.SendTo(server, packet.data(), packet.size());
+    }
+    socket.Close();
+    slot = NET_NO_SLOT;
+    pending.clear();
+    delayed.clear();
+    for (NetFrame& frame : frames)
+        frame.frame = NET_NO_FRAME;
+}
+
+bool NetClient::Poll()
+{
+    FlushDelayed();
+    uint32_t before = GetFrame().frame;
+    NetAddress from;
+    int size;
+    while ((size = socket.ReceiveFrom(from, receiveBuffer.data(), receiveBuffer.size())) > 0)
+    {
+        ++stats.packetsReceived;
+        stats.bytesReceived += static_cast<uint64_t>(size);
+        ByteReader reader(receiveBuffer.data(), static_cast<size_t>(size));
+        NetPacketType type;
+        if (from == server && GetNetHeader(reader, type) && type == NetPacketType::STATE)
+            HandleState(reader);
+    }
+    return GetFrame().frame != before;
+}
+
+void NetClient::HandleState(ByteReader& reader)
+{
+    uint32_t confirmed = reader.GetU32();
+    NetFrameHeader header;
+    if (!DecodeFrameHeader(reader, header))
+        return;
+    pending.erase(std::remove_if(pending.begin(), pending.end(),
+        [&](const PendingInput& input) { return static_cast<int32_t>(input.seq - confirmed) <= 0; }), pending.end());
+
+    // Late or repeated frames carry nothing new
+    uint32_t current = GetFrame().frame;
+    if (current != NET_NO_FRAME && static_cast<int32_t>(header.frame - current) <= 0)
+        return;
+    const NetFrame* base = nullptr;
+    if (header.base != NET_NO_FRAME && !(base = FindFrame(header.base)))
+    {
+        ++stats.missingBases;
+        return;
+    }
+    if (!DecodeFrame(reader, header, base, decoded))
+        return;
+
+    newest = decoded.frame % FRAME_HISTORY;
+    std::swap(frames[newest], decoded);
+    ++stats.frames;
+}
+
+void NetClient::SetDirection(Direction dir)
+{
+    if (GetFrame().frame == NET_NO_FRAME)
+        return;
+    // A full window means the server has been silent for a while; the oldest turn goes
+    if (pending.size() >= static_cast<size_t>(NET_INPUT_WINDOW))
+        pending.erase(pending.begin());
+    pending.push_back({ nextSeq++, GetFrame().frame, dir });
+}
+
+void NetClient::SendInput()
+{
+    uint32_t ack = GetFrame().frame;
+    packet.clear();
+    ByteWriter writer(packet);
+    PutNetHeader(writer, NetPacketType::INPUT);
+    writer.PutU16(slot);
+    writer.PutU32(ack);
+    writer.PutU32(pending.empty() ? nextSeq : pending.front().seq);
+    writer.PutU8(static_cast<uint8_t>(pending.size()));
+    for (const PendingInput& input : pending)
+    {
+        int offset = static_cast<int32_t>(input.frame - ack);
+        writer.PutU8(static_cast<uint8_t>(input.direction));
+        writer.PutU8(static_cast<uint8_t>(static_cast<int8_t>(std::max(offset, -128))));
+    }
+    Send(packet);
+}
+
+void NetClient::Send(const std::vector<uint8_t>& bytes)
+{
+    if (sendDelay.count() > 0)
+    {
+        delayed.push_back({ Clock::now() + sendDelay, bytes });
+        return;
+    }
+    if (socket.SendTo(server, bytes.data(), bytes.size()))
+    {
+        ++stats.packetsSent;
+        stats.bytesSent += bytes.size();
+    }
+}
+
+void NetClient::FlushDelayed()
+{
+    Clock::time_point now = Clock::now();
+    while (!delayed.empty() && delayed.front().due <= now)
+    {
+        const std::vector<uint8_t>& bytes = delayed.front().bytes;
+        if (socket.SendTo(server, bytes.data(), bytes.size()))
+        {
+            ++stats.packetsSent;
+            stats.bytesSent += bytes.size();
+        }
+        delayed.pop_front();
+    }
+}
+
+const NetFrame* NetClient::FindFrame(uint32_t frame) const
+{
+    const NetFrame& candidate = frames[frame % FRAME_HISTORY];
+    return candidate.frame == frame ? &candidate : nullptr;
+}
@@ -0,0 +1,86 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <vector>
+#include "NetProtocol.h"
+#include "UdpSocket.h"
+
+struct NetClientStats
+{
+    uint64_t bytesSent = 0, bytesReceived = 0;
+    uint64_t packetsSent = 0, packetsReceived = 0;
+    uint64_t frames = 0;        // Frames decoded
+    uint64_t missingBases = 0;  // Deltas against a frame no longer held, dropped
+};
+
+// One player's connection to a LockstepServer. The owner calls Poll regularly and
+// SendInput after each new frame; that INPUT packet acknowledges the frame and repeats
+// every turn the server has not confirmed yet, so a lost packet costs nothing but latency.
+class NetClient
+{
+public:
+    NetClient() : frames(FRAME_HISTORY) {}
+
+    NetClient(const NetClient&) = delete;
+    NetClient& operator=(const NetClient&) = delete;
+
+    // Joins the server on the loopback port; blocks up to timeoutMs for a free slot
+    bool Connect(uint16_t serverPort, int timeoutMs = 2000);
+    void Disconnect();
+    bool IsConnected() const { return slot != NET_NO_SLOT; }
+
+    // Reads every waiting packet. Returns true if a newer frame than before was decoded.
+    bool Poll();
+    // Queues a turn, stamped with the newest frame; it goes out with the next SendInput
+    void SetDirection(Direction dir);
+    // Acknowledges the newest frame and sends the turns not yet confirmed
+    void SendInput();
+
+    // Holds outgoing packets back this long, to exercise the server's rollback
+    void SetSendDelay(int milliseconds) { sendDelay = std::chrono::milliseconds(milliseconds); }
+
+    // Newest decoded frame; frame == NET_NO_FRAME until the first one arrives
+    const NetFrame& GetFrame() const { return frames[newest]; }
+    uint16_t GetSlot() const { return slot; }
+    int GetTickMillis() const { return tickMillis; }
+    const NetClientStats& GetStats() const { return stats; }
+    UdpSocket& GetSocket() { return socket; }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct PendingInput
+    {
+        uint32_t seq;
+        uint32_t frame;
+        Direction direction;
+    };
+
+    struct DelayedPacket
+    {
+        Clock::time_point due;
+        std::vector<uint8_t> bytes;
+    };
+
+    static const int FRAME_HISTORY = 32;  // Decoded frames kept as possible delta bases
+
+    void HandleState(ByteReader& reader);
+    void Send(const std::vector<uint8_t>& bytes);
+    void FlushDelayed();
+    const NetFrame* FindFrame(uint32_t frame) const;
+
+    UdpSocket socket;
+    NetAddress server;
+    uint16_t slot = NET_NO_SLOT;
+    int tickMillis = 0;
+    std::vector<NetFrame> frames;     // Ring of decoded frames
+    size_t newest = 0;
+    NetFrame decoded;
+    std::vector<PendingInput> pending; // Sent but not yet confirmed by the server
+    uint32_t nextSeq = 1;
+    std::chrono::milliseconds sendDelay{ 0 };
+    std::deque<DelayedPacket> delayed;
+    NetClientStats stats;
+    std::vector<uint8_t> packet, receiveBuffer;
+};
@@ -0,0 +1,381 @@
+#include "NetProtocol.h"
+#include <algorithm>
+#include <cstdlib>
+
+namespace
+{
+// How each snake's body is sent
+enum BodyKind : uint8_t
+{
+    BODY_SAME = 0,  // Identical to the base
+    BODY_MOVED,     // New heads in front of the base body, then cut to a new length
+    BODY_PATH,      // Head cell, then the direction of each following segment
+    BODY_RAW,       // Every cell; only for bodies that are not one connected path
+};
+
+const uint8_t SNAKE_ALIVE = 4;
+const uint8_t SNAKE_SCORED = 32;  // The score follows
+const int SNAKE_DIRECTION_SHIFT = 3;
+
+const uint8_t OBSTACLES_FULL = 0;
+const uint8_t OBSTACLES_CHANGED = 1;
+
+uint32_t ZigZag(int value) { return (static_cast<uint32_t>(value) << 1) ^ static_cast<uint32_t>(value >> 31); }
+int UnZigZag(uint64_t value) { return static_cast<int>(static_cast<uint32_t>(value >> 1) ^ (0u - static_cast<uint32_t>(value & 1))); }
+
+void PutCell(ByteWriter& writer, const Segment& cell)
+{
+    writer.PutVarU64(ZigZag(cell.x));
+    writer.PutVarU64(ZigZag(cell.y));
+}
+
+Segment GetCell(ByteReader& reader)
+{
+    Segment cell;
+    cell.x = UnZigZag(reader.GetVarU64());
+    cell.y = UnZigZag(reader.GetVarU64());
+    return cell;
+}
+
+bool SameCell(const Segment& a, const Segment& b) { return a.x == b.x && a.y == b.y; }
+
+// Direction of the step from `from` to the adjacent cell `to`; false if not adjacent
+bool StepDirection(const Segment& from, const Segment& to, Direction& dir)
+{
+    int dx = to.x - from.x;
+    int dy = to.y - from.y;
+    if (std::abs(dx) + std::abs(dy) != 1)
+        return false;
+    dir = dx > 0 ? Direction::RIGHT : dx < 0 ? Direction::LEFT : dy > 0 ? Direction::DOWN : Direction::UP;
+    return true;
+}
+
+Segment Step(Segment cell, Direction dir)
+{
+    switch (dir)
+    {
+    case Direction::UP:    --cell.y; break;
+    case Direction::DOWN:  ++cell.y; break;
+    case Direction::LEFT:  --cell.x; break;
+    case Direction::RIGHT: ++cell.x; break;
+    }
+    return cell;
+}
+
+// Four directions to a byte, first in the low bits
+void PutDirections(ByteWriter& writer, const std::vector<Direction>& dirs)
+{
+    for (size_t i = 0; i < dirs.size(); i += 4)
+    {
+        uint8_t packed = 0;
+        for (size_t j = i; j < dirs.size() && j < i + 4; ++j)
+            packed |= static_cast<uint8_t>(static_cast<uint8_t>(dirs[j]) << (2 * (j - i)));
+        writer.PutU8(packed);
+    }
+}
+
+bool GetDirections(ByteReader& reader, size_t count, std::vector<Direction>& dirs)
+{
+    const uint8_t* packed = reader.GetBytes((count + 3) / 4);
+    if (!packed)
+        return false;
+    dirs.resize(count);
+    for (size_t i = 0; i < count; ++i)
+        dirs[i] = static_cast<Direction>((packed[i / 4] >> (2 * (i % 4))) & 3);
+    return true;
+}
+
+// The directions that walk `body` from its head to its tail; false if it has a gap
+bool PathDirections(const std::vector<Segment>& body, std::vector<Direction>& dirs)
+{
+    dirs.resize(body.empty() ? 0 : body.size() - 1);
+    for (size_t i = 1; i < body.size(); ++i)
+    {
+        if (!StepDirection(body[i - 1], body[i], dirs[i - 1]))
+            return false;
+    }
+    return true;
+}
+
+// Number of new heads in front of `base` that make up `body`, given that `body` then
+// continues with a prefix of `base`; -1 if it doesn't. `dirs` gets each new head's step
+// from the segment behind it, oldest first.
+int FindMove(const std::vector<Segment>& base, const std::vector<Segment>& body, std::vector<Direction>& dirs)
+{
+    if (base.empty() || body.empty())
+        return -1;
+    for (size_t heads = 0; heads < body.size(); ++heads)
+    {
+        size_t kept = body.size() - heads;
+        if (kept > base.size() || !SameCell(body[heads], base[0]))
+            continue;
+        if (!std::equal(body.begin() + heads, body.end(), base.begin(), SameCell))
+            continue;
+        dirs.resize(heads);
+        for (size_t i = 0; i < heads; ++i)
+        {
+            if (!StepDirection(body[heads - i], body[heads - i - 1], dirs[i]))
+                return -1;
+        }
+        return static_cast<int>(heads);
+    }
+    return -1;
+}
+
+void PutBody(ByteWriter& writer, const NetSnake* base, const NetSnake& snake, uint8_t tag, std::vector<Direction>& dirs)
+{
+    if (base && base->body.size() == snake.body.size() &&
+        std::equal(snake.body.begin(), snake.body.end(), base->body.begin(), SameCell))
+    {
+        writer.PutU8(tag | BODY_SAME);
+        return;
+    }
+
+    int heads = base ? FindMove(base->body, snake.body, dirs) : -1;
+    if (heads >= 0)
+    {
+        writer.PutU8(tag | BODY_MOVED);
+        writer.PutVarU64(static_cast<uint64_t>(heads));
+        PutDirections(writer, dirs);
+        writer.PutVarU64(snake.body.size());
+        return;
+    }
+
+    if (PathDirections(snake.body, dirs))
+    {
+        writer.PutU8(tag | BODY_PATH);
+        writer.PutVarU64(snake.body.size());
+        if (!snake.body.empty())
+        {
+            PutCell(writer, snake.body[0]);
+            PutDirections(writer, dirs);
+        }
+        return;
+    }
+
+    writer.PutU8(tag | BODY_RAW);
+    writer.PutVarU64(snake.body.size());
+    for (const Segment& cell : snake.body)
+        PutCell(writer, cell);
+}
+
+bool GetBody(ByteReader& reader, uint8_t kind, const NetSnake* base, std::vector<Segment>& body, size_t maxLength,
+    std::vector<Direction>& dirs)
+{
+    switch (kind)
+    {
+    case BODY_SAME:
+        if (!base)
+            return false;
+        body = base->body;
+        return true;
+
+    case BODY_MOVED:
+    {
+        uint64_t heads = reader.GetVarU64();
+        if (!base || base->body.empty() || heads > maxLength || !GetDirections(reader, static_cast<size_t>(heads), dirs))
+            return false;
+        uint64_t length = reader.GetVarU64();
+        if (length > heads + base->body.size() || length <= heads)
+            return false;
+        body.resize(static_cast<size_t>(length));
+        Segment cell = base->body[0];
+        for (size_t i = 0; i < heads; ++i)
+        {
+            cell = Step(cell, dirs[i]);
+            body[heads - 1 - i] = cell;
+        }
+        std::copy(base->body.begin(), base->body.begin() + (length - heads), body.begin() + heads);
+        return true;
+    }
+
+    case BODY_PATH:
+    {
+        uint64_t length = reader.GetVarU64();
+        if (length > maxLength)
+            return false;
+        body.resize(static_cast<size_t>(length));
+        if (length == 0)
+            return true;
+        body[0] = GetCell(reader);
+        if (!GetDirections(reader, static_cast<size_t>(length - 1), dirs))
+            return false;
+        for (size_t i = 1; i < length; ++i)
+            body[i] = Step(body[i - 1], dirs[i - 1]);
+        return true;
+    }
+
+    default:
+    {
+        uint64_t length = reader.GetVarU64();
+        if (length > maxLength)
+            return false;
+        body.resize(static_cast<size_t>(length));
+        for (Segment& cell : body)
+            cell = GetCell(reader);
+        return true;
+    }
+    }
+}
+}
+
+void PutNetHeader(ByteWriter& writer, NetPacketType type)
+{
+    writer.PutU16(NET_MAGIC);
+    writer.PutU8(NET_VERSION);
+    writer.PutU8(static_cast<uint8_t>(type));
+}
+
+bool GetNetHeader(ByteReader& reader, NetPacketType& type)
+{
+    if (reader.GetU16() != NET_MAGIC || reader.GetU8() != NET_VERSION)
+        return false;
+    type = static_cast<NetPacketType>(reader.GetU8());
+    return reader.Ok();
+}
+
+void NetFrame::CopyFrom(const SnakeGame& game, uint32_t frameNumber, uint32_t matchNumber)
+{
+    frame = frameNumber;
+    match = matchNumber;
+    gridWidth = game.GetGridWidth();
+    gridHeight = game.GetGridHeight();
+    gameOver = game.IsGameOver();
+    food = game.GetFood();
+
+    snakes.resize(game.GetSnakeCount());
+    for (int i = 0; i < game.GetSnakeCount(); ++i)
+    {
+        const SnakePlayer& player = game.GetSnake(i);
+        NetSnake& snake = snakes[i];
+        snake.body.resize(player.body.Size());
+        if (!snake.body.empty())
+            player.body.CopyTo(snake.body.data());
+        snake.direction = player.direction;
+        snake.score = player.score;
+        snake.alive = player.alive;
+    }
+
+    obstacles.resize(game.GetObstacleCount());
+    for (int i = 0; i < game.GetObstacleCount(); ++i)
+        obstacles[i] = { game.GetObstacle(i).x, game.GetObstacle(i).y };
+}
+
+void EncodeFrame(const NetFrame* base, const NetFrame& frame, ByteWriter& writer)
+{
+    writer.PutU32(frame.frame);
+    writer.PutU32(base ? base->frame : NET_NO_FRAME);
+    writer.PutVarU64(frame.match);
+    writer.PutU8(frame.gameOver ? 1 : 0);
+    writer.PutVarU64(static_cast<uint64_t>(frame.gridWidth));
+    writer.PutVarU64(static_cast<uint64_t>(frame.gridHeight));
+    PutCell(writer, frame.food);
+
+    std::vector<Direction> dirs;
+    writer.PutVarU64(frame.snakes.size());
+    for (size_t i = 0; i < frame.snakes.size(); ++i)
+    {
+        const NetSnake& snake = frame.snakes[i];
+        const NetSnake* baseSnake = base && i < base->snakes.size() ? &base->snakes[i] : nullptr;
+        bool scored = !baseSnake || baseSnake->score != snake.score;
+        uint8_t tag = static_cast<uint8_t>((snake.alive ? SNAKE_ALIVE : 0) | (scored ? SNAKE_SCORED : 0) |
+            (static_cast<uint8_t>(snake.direction) << SNAKE_DIRECTION_SHIFT));
+        PutBody(writer, baseSnake, snake, tag, dirs);
+        if (scored)
+            writer.PutVarU64(static_cast<uint64_t>(snake.score));
+    }
+
+    // Obstacles change a few at a time, so a delta lists the moved ones by index gap
+    writer.PutVarU64(frame.obstacles.size());
+    if (!base || base->obstacles.size() != frame.obstacles.size())
+    {
+        writer.PutU8(OBSTACLES_FULL);
+        for (const Segment& cell : frame.obstacles)
+            PutCell(writer, cell);
+        return;
+    }
+    writer.PutU8(OBSTACLES_CHANGED);
+    size_t changed = 0;
+    for (size_t i = 0; i < frame.obstacles.size(); ++i)
+        changed += SameCell(frame.obstacles[i], base->obstacles[i]) ? 0 : 1;
+    writer.PutVarU64(changed);
+    size_t previous = 0;
+    for (size_t i = 0; i < frame.obstacles.size(); ++i)
+    {
+        if (SameCell(frame.obstacles[i], base->obstacles[i]))
+            continue;
+        writer.PutVarU64(i - previous);
+        PutCell(writer, frame.obstacles[i]);
+        previous = i;
+    }
+}
+
+bool DecodeFrameHeader(ByteReader& reader, NetFrameHeader& header)
+{
+    header.frame = reader.GetU32();
+    header.base = reader.GetU32();
+    return reader.Ok();
+}
+
+bool DecodeFrame(ByteReader& reader, const NetFrameHeader& header, const NetFrame* base, NetFrame& frame)
+{
+    if ((header.base == NET_NO_FRAME) != (base == nullptr) || (base && base->frame != header.base))
+        return false;
+    frame.frame = header.frame;
+    frame.match = static_cast<uint32_t>(reader.GetVarU64());
+    frame.gameOver = reader.GetU8() != 0;
+    frame.gridWidth = static_cast<int>(reader.GetVarU64());
+    frame.gridHeight = static_cast<int>(reader.GetVarU64());
+    frame.food = GetCell(reader);
+    if (!reader.Ok() || frame.gridWidth <= 0 || frame.gridHeight <= 0)
+        return false;
+
+    // A body covers the board at most once, plus a head that left it
+    size_t cellCount = static_cast<size_t>(frame.gridWidth) * frame.gridHeight;
+    uint64_t snakeCount = reader.GetVarU64();
+    if (!reader.Ok() || snakeCount > cellCount)
+        return false;
+    std::vector<Direction> dirs;
+    frame.snakes.resize(static_cast<size_t>(snakeCount));
+    for (size_t i = 0; i < frame.snakes.size(); ++i)
+    {
+        NetSnake& snake = frame.snakes[i];
+        const NetSnake* baseSnake = base && i < base->snakes.size() ? &base->snakes[i] : nullptr;
+        uint8_t tag = reader.GetU8();
+        snake.alive = (tag & SNAKE_ALIVE) != 0;
+        snake.direction = static_cast<Direction>((tag >> SNAKE_DIRECTION_SHIFT) & 3);
+        if (!GetBody(reader, tag & 3, baseSnake, snake.body, cellCount + 1, dirs))
+            return false;
+        if (tag & SNAKE_SCORED)
+            snake.score = static_cast<int>(reader.GetVarU64());
+        else if (baseSnake)
+            snake.score = baseSnake->score;
+        else
+            return false;
+    }
+
+    uint64_t obstacleCount = reader.GetVarU64();
+    uint8_t mode = reader.GetU8();
+    if (!reader.Ok() || obstacleCount > cellCount)
+        return false;
+    frame.obstacles.resize(static_cast<size_t>(obstacleCount));
+    if (mode == OBSTACLES_FULL)
+    {
+        for (Segment& cell : frame.obstacles)
+            cell = GetCell(reader);
+        return reader.Ok();
+    }
+    if (!base || base->obstacles.size() != frame.obstacles.size())
+        return false;
+    frame.obstacles = base->obstacles;
+    uint64_t changed = reader.GetVarU64();
+    uint64_t index = 0;
+    for (uint64_t i = 0; i < changed && reader.Ok(); ++i)
+    {
+        index += reader.GetVarU64();
+        if (index >= obstacleCount)
+            return false;
+        frame.obstacles[static_cast<size_t>(index)] = GetCell(reader);
+    }
+    return reader.Ok();
+}
@@ -0,0 +1,72 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "ByteStream.h"
+#include "SnakeGame.h"
+
+// Wire format shared by LockstepServer and NetClient. Every packet starts with the
+// magic, the protocol version and its NetPacketType; integers are little-endian and
+// "var" fields are LEB128.
+const uint16_t NET_MAGIC = 0x4E53;  // "SN"
+const uint8_t NET_VERSION = 1;
+const size_t NET_MAX_PACKET = 65000;     // Under the UDP limit; loopback has no smaller MTU
+const uint32_t NET_NO_FRAME = 0xFFFFFFFF;
+const uint16_t NET_NO_SLOT = 0xFFFF;
+const int NET_INPUT_WINDOW = 16;         // Most inputs one INPUT packet carries
+
+enum class NetPacketType : uint8_t
+{
+    JOIN = 1,       // Client: u32 nonce
+    WELCOME,        // Server: u32 nonce, u16 slot (NET_NO_SLOT when full), u16 width, u16 height, u16 tick ms
+    INPUT,          // Client: u16 slot, u32 ack frame, u32 first seq, u8 count, count x (u8 dir, i8 frame - ack frame)
+    STATE,          // Server: u32 newest input seq taken, then an encoded frame
+    LEAVE,          // Client: u16 slot
+    STATS_REQUEST,  // Anyone
+    STATS,          // Server: LockstepServerStats, see LockstepServer.cpp
+};
+
+void PutNetHeader(ByteWriter& writer, NetPacketType type);
+// False unless the magic and version match
+bool GetNetHeader(ByteReader& reader, NetPacketType& type);
+
+struct NetSnake
+{
+    std::vector<Segment> body;  // Head first; empty once a dead snake has left the board
+    Direction direction = Direction::RIGHT;
+    int score = 0;
+    bool alive = false;
+};
+
+// What clients see of a game at one server frame. Frames are numbered by the server
+// across matches, so a frame number names exactly one state even after a reset.
+struct NetFrame
+{
+    uint32_t frame = NET_NO_FRAME;
+    uint32_t match = 0;         // Counts resets; a new match starts from a new seed
+    int gridWidth = 0;
+    int gridHeight = 0;
+    bool gameOver = false;
+    Segment food = { 0, 0 };
+    std::vector<NetSnake> snakes;
+    std::vector<Segment> obstacles;
+
+    void CopyFrom(const SnakeGame& game, uint32_t frameNumber, uint32_t matchNumber);
+};
+
+// Encodes `frame` as changes from `base`, which the receiver must still hold; a null
+// base writes a keyframe. A snake that only moved costs its new head directions at two
+// bits each, an unchanged one a single byte, so a tick's delta stays small however
+// long the snakes get. States rewritten by a rollback still decode correctly: whatever
+// no longer lines up with the base is sent in full.
+void EncodeFrame(const NetFrame* base, const NetFrame& frame, ByteWriter& writer);
+
+// Decoding takes two steps, since the base is looked up from the frame header
+struct NetFrameHeader
+{
+    uint32_t frame = NET_NO_FRAME;
+    uint32_t base = NET_NO_FRAME;  // NET_NO_FRAME for a keyframe
+};
+bool DecodeFrameHeader(ByteReader& reader, NetFrameHeader& header);
+// `base` must be the frame named by header.base (null for a keyframe). Returns false
+// on malformed data, leaving `frame` unspecified.
+bool DecodeFrame(ByteReader& reader, const NetFrameHeader& header, const NetFrame* base, NetFrame& frame);
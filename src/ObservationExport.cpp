@@ -0,0 +1,474 @@
+#include "ObservationExport.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <new>
+
+#if defined(__linux__)
+#include <climits>
+#include <ctime>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#else
+#include <thread>
+#endif
+
+namespace
+{
+const char RING_MAGIC[4] = { 'S', 'N', 'K', 'O' };
+const uint32_t RING_VERSION = 1;
+const size_t RING_HEADER_SIZE = 64;
+const size_t FRAME_HEADER_SIZE = 64;
+const size_t PLANE_ALIGNMENT = 64;
+// Costs in bytes of planes cleared, measured with bench_observations: a scattered byte
+// store costs about as much as clearing 48, copying a byte up to twice as much as
+// clearing one, and diffing a snake or obstacle against the last tick (FindDeltas and
+// Remember) about as much as clearing 768. Publish weighs its ways of filling a slot
+// with these.
+const size_t STORE_COST = 48;
+const size_t COPY_COST = 2;
+const size_t DIFF_COST = 768;
+const size_t DELTA_RATE_SCALE = 16;
+
+static_assert(ATOMIC_LLONG_LOCK_FREE == 2 && ATOMIC_INT_LOCK_FREE == 2,
+    "the ring's atomics must be lock-free to work across processes");
+
+struct RingHeader
+{
+    char magic[4];
+    uint32_t version;
+    uint32_t width;
+    uint32_t height;
+    uint32_t capacity;
+    uint32_t frameSize;
+    uint32_t planeSize;
+    uint32_t reserved;
+    std::atomic<uint64_t> published;
+    std::atomic<uint32_t> wakeCounter;  // Bumped with every frame; readers sleep on it
+    std::atomic<uint32_t> sleepers;
+    std::atomic<uint32_t> closed;
+    uint32_t reserved2;
+    uint64_t reserved3;
+};
+static_assert(sizeof(RingHeader) == RING_HEADER_SIZE, "ring header layout");
+
+struct FrameHeader
+{
+    std::atomic<uint64_t> sequence;  // Frame number + 1, or 0 while the slot is rewritten
+    uint64_t tick;
+    uint64_t seed;
+    int32_t score;
+    uint32_t length;
+    uint8_t done;
+    uint8_t won;
+    uint8_t reserved[30];
+};
+static_assert(sizeof(FrameHeader) == FRAME_HEADER_SIZE, "frame header layout");
+
+#if defined(__linux__)
+// Without FUTEX_PRIVATE_FLAG, since the word is shared with other processes
+void FutexWait(std::atomic<uint32_t>& word, uint32_t expected, std::chrono::nanoseconds timeout)
+{
+    timespec relative;
+    relative.tv_sec = static_cast<time_t>(timeout.count() / 1000000000);
+    relative.tv_nsec = static_cast<long>(timeout.count() % 1000000000);
+    ::syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAIT, expected, &relative, nullptr, 0);
+}
+
+void FutexWakeAll(std::atomic<uint32_t>& word)
+{
+    ::syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+}
+#else
+void FutexWait(std::atomic<uint32_t>& word, uint32_t expected, std::chrono::nanoseconds timeout)
+{
+    (void)word;
+    (void)expected;
+    std::this_thread::sleep_for(std::min<std::chrono::nanoseconds>(timeout, std::chrono::milliseconds(1)));
+}
+
+void FutexWakeAll(std::atomic<uint32_t>& word) { (void)word; }
+#endif
+
+size_t PlaneSizeFor(int width, int height)
+{
+    size_t cells = static_cast<size_t>(width) * height;
+    return (cells + PLANE_ALIGNMENT - 1) / PLANE_ALIGNMENT * PLANE_ALIGNMENT;
+}
+
+bool SameCell(const Segment& a, const Segment& b) { return a.x == b.x && a.y == b.y; }
+}
+
+bool ObservationExporter::Create(const char* name, int width, int height, int newCapacity, bool replaceStale)
+{
+    Close();
+    // A reader needs one slot to finish with while the next is written
+    if (width <= 0 || height <= 0 || newCapacity < 2)
+        return false;
+
+    size_t newPlaneSize = PlaneSizeFor(width, height);
+    size_t newFrameSize = FRAME_HEADER_SIZE + OBSERVATION_PLANES * newPlaneSize;
+    if (!memory.Create(name, RING_HEADER_SIZE + static_cast<size_t>(newCapacity) * newFrameSize, replaceStale))
+        return false;
+
+    RingHeader* header = new (memory.Data()) RingHeader();
+    std::memcpy(header->magic, RING_MAGIC, sizeof(RING_MAGIC));
+    header->version = RING_VERSION;
+    header->width = static_cast<uint32_t>(width);
+    header->height = static_cast<uint32_t>(height);
+    header->capacity = static_cast<uint32_t>(newCapacity);
+    header->frameSize = static_cast<uint32_t>(newFrameSize);
+    header->planeSize = static_cast<uint32_t>(newPlaneSize);
+
+    gridWidth = width;
+    gridHeight = height;
+    capacity = newCapacity;
+    planeSize = newPlaneSize;
+    frameSize = newFrameSize;
+    history.assign(capacity, std::vector<Delta>());
+    windowDeltas = 0;
+    deltaRate = 0;
+    lastResync = 0;
+    tracking = false;
+    stats = ObservationExportStats();
+    return true;
+}
+
+void ObservationExporter::Close()
+{
+    if (!IsOpen())
+        return;
+    RingHeader* header = reinterpret_cast<RingHeader*>(memory.Data());
+    header->closed.store(1);
+    header->wakeCounter.fetch_add(1);
+    FutexWakeAll(header->wakeCounter);
+    memory.Close();
+}
+
+bool ObservationExporter::Publish(const SnakeGame& game)
+{
+    if (!IsOpen() || game.GetGridWidth() != gridWidth || game.GetGridHeight() != gridHeight)
+        return false;
+
+    // Frame n replaces frame n - capacity, in the slot and in the delta history, so the
+    // history then holds exactly the ticks that slot has missed
+    uint64_t frame = stats.published;
+    int slot = static_cast<int>(frame % capacity);
+    std::vector<Delta>& deltas = history[slot];
+    windowDeltas -= deltas.size();
+    deltas.clear();
+
+    // The diff is paid before a byte is written, so it is skipped, and the board drawn,
+    // when drawing costs less than the diff plus the cheapest steady-state update for
+    // the deltas recent ticks averaged. Drawing then never loses to the incremental path.
+    size_t planeBytes = OBSERVATION_PLANES * planeSize;
+    size_t rasterCost = planeBytes + DrawnCells(game) * STORE_COST;
+    size_t items = game.GetSnakeCount() + game.GetObstacleCount();
+    size_t expectedDeltas = items * deltaRate / DELTA_RATE_SCALE;
+    size_t expectedCost = DIFF_COST * items + std::min(COPY_COST * planeBytes + expectedDeltas * STORE_COST,
+        capacity * expectedDeltas * STORE_COST);
+    bool diff = incremental && expectedCost < rasterCost;
+    bool follows = diff && FindDeltas(game, deltas);
+    if (follows && items > 0)
+        deltaRate = (deltaRate * 7 + deltas.size() * DELTA_RATE_SCALE / items) / 8;
+    if (!follows)
+    {
+        deltas.clear();
+        lastResync = frame;
+    }
+    windowDeltas += deltas.size();
+    if (diff)
+        Remember(game);
+    else
+        tracking = false;
+
+    uint8_t* data = Frame(slot);
+    FrameHeader* header = reinterpret_cast<FrameHeader*>(data);
+    uint8_t* planes = data + FRAME_HEADER_SIZE;
+    header->sequence.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    // Replaying needs every tick since this slot's frame; copying needs the last tick
+    bool canReplay = follows && frame >= static_cast<uint64_t>(capacity) && lastResync + capacity <= frame;
+    size_t replayCost = windowDeltas * STORE_COST;
+    size_t copyCost = COPY_COST * planeBytes + deltas.size() * STORE_COST;
+    if (canReplay && replayCost <= copyCost && replayCost <= rasterCost)
+    {
+        // Oldest first: the slot after this one holds the tick after the one it missed
+        for (int i = 1; i <= capacity; ++i)
+            Apply(history[(slot + i) % capacity], planes);
+        ++stats.replayed;
+    }
+    else if (follows && copyCost < rasterCost)
+    {
+        std::memcpy(planes, Frame((slot + capacity - 1) % capacity) + FRAME_HEADER_SIZE, planeBytes);
+        Apply(deltas, planes);
+        ++stats.copied;
+    }
+    else
+    {
+        Rasterize(game, planes);
+        ++stats.rasterized;
+    }
+
+    header->tick = game.GetTick();
+    header->seed = game.GetSeed();
+    header->score = game.GetScore();
+    header->length = static_cast<uint32_t>(game.GetBody().Size());
+    header->done = game.IsGameOver() ? 1 : 0;
+    header->won = game.IsGameWon() ? 1 : 0;
+    header->sequence.store(frame + 1, std::memory_order_release);
+    ++stats.published;
+
+    RingHeader* ring = reinterpret_cast<RingHeader*>(memory.Data());
+    ring->published.store(frame + 1, std::memory_order_release);
+    ring->wakeCounter.fetch_add(1);
+    if (ring->sleepers.load() > 0)
+        FutexWakeAll(ring->wakeCounter);
+    return true;
+}
+
+bool ObservationExporter::FindDeltas(const SnakeGame& game, std::vector<Delta>& deltas) const
+{
+    if (!tracking || game.GetSeed() != seed || game.GetTick() != tick + 1 ||
+        game.GetSnakeCount() != static_cast<int>(snakes.size()) ||
+        game.GetObstacleCount() != static_cast<int>(obstacles.size()))
+        return false;
+
+    // A snake moves one cell a tick: its head is new, and its tail is gone unless it
+    // ate. One that did not move (the board filled before its turn) is unchanged, and
+    // one that left the board takes every segment with it, which only a raster shows.
+    for (int i = 0; i < game.GetSnakeCount(); ++i)
+    {
+        int grown = game.GetSnake(i).body.Size() - snakes[i].length;
+        if (grown != 0 && grown != 1)
+            return false;
+    }
+
+    // Clears before sets, so a cell that one item leaves as another enters ends up set
+    for (int i = 0; i < game.GetSnakeCount(); ++i)
+    {
+        const SnakeBody& body = game.GetSnake(i).body;
+        const SnakeMark& mark = snakes[i];
+        if (mark.length == 0 || (body.Size() == mark.length && SameCell(body.Head(), mark.head)))
+            continue;
+        if (body.Size() == mark.length)
+            AddDelta(deltas, mark.tail, ObservationPlane::BODY, 0);
+        AddDelta(deltas, mark.head, ObservationPlane::HEAD, 0);
+    }
+    bool foodMoved = !SameCell(game.GetFood(), food);
+    if (foodMoved)
+        AddDelta(deltas, food, ObservationPlane::FOOD, 0);
+    for (int i = 0; i < game.GetObstacleCount(); ++i)
+    {
+        const MovingBlock& obstacle = game.GetObstacle(i);
+        if (obstacle.x != obstacles[i].x || obstacle.y != obstacles[i].y)
+            AddDelta(deltas, obstacles[i], ObservationPlane::OBSTACLE, 0);
+    }
+
+    for (int i = 0; i < game.GetSnakeCount(); ++i)
+    {
+        const SnakeBody& body = game.GetSnake(i).body;
+        const SnakeMark& mark = snakes[i];
+        if (mark.length == 0 || (body.Size() == mark.length && SameCell(body.Head(), mark.head)))
+            continue;
+        AddDelta(deltas, body.Head(), ObservationPlane::BODY, 1);
+        AddDelta(deltas, body.Head(), ObservationPlane::HEAD, 1);
+    }
+    if (foodMoved)
+        AddDelta(deltas, game.GetFood(), ObservationPlane::FOOD, 1);
+    for (int i = 0; i < game.GetObstacleCount(); ++i)
+    {
+        const MovingBlock& obstacle = game.GetObstacle(i);
+        if (obstacle.x != obstacles[i].x || obstacle.y != obstacles[i].y)
+            AddDelta(deltas, Segment{ obstacle.x, obstacle.y }, ObservationPlane::OBSTACLE, 1);
+    }
+    return true;
+}
+
+void ObservationExporter::AddDelta(std::vector<Delta>& deltas, const Segment& cell, ObservationPlane plane, uint8_t value) const
+{
+    // A head that ran off the board has no cell to mark
+    if (cell.x < 0 || cell.y < 0 || cell.x >= gridWidth || cell.y >= gridHeight)
+        return;
+    size_t offset = static_cast<int>(plane) * planeSize + cell.y * gridWidth + cell.x;
+    deltas.push_back({ static_cast<uint32_t>(offset), value });
+}
+
+void ObservationExporter::Remember(const SnakeGame& game)
+{
+    tracking = true;
+    seed = game.GetSeed();
+    tick = game.GetTick();
+    snakes.resize(game.GetSnakeCount());
+    for (int i = 0; i < game.GetSnakeCount(); ++i)
+    {
+        const SnakeBody& body = game.GetSnake(i).body;
+        SnakeMark& mark = snakes[i];
+        mark.length = body.Size();
+        if (mark.length > 0)
+        {
+            mark.head = body.Head();
+            mark.tail = body.Tail();
+        }
+    }
+    food = game.GetFood();
+    obstacles.resize(game.GetObstacleCount());
+    for (int i = 0; i < game.GetObstacleCount(); ++i)
+        obstacles[i] = { game.GetObstacle(i).x, game.GetObstacle(i).y };
+}
+
+void ObservationExporter::Rasterize(const SnakeGame& game, uint8_t* planes) const
+{
+    std::memset(planes, 0, OBSERVATION_PLANES * planeSize);
+    uint8_t* body = planes + static_cast<int>(ObservationPlane::BODY) * planeSize;
+    uint8_t* head = planes + static_cast<int>(ObservationPlane::HEAD) * planeSize;
+    uint8_t* food = planes + static_cast<int>(ObservationPlane::FOOD) * planeSize;
+    uint8_t* obstacle = planes + static_cast<int>(ObservationPlane::OBSTACLE) * planeSize;
+    auto inBounds = [this](const Segment& cell)
+    {
+        return cell.x >= 0 && cell.y >= 0 && cell.x < gridWidth && cell.y < gridHeight;
+    };
+
+    for (int i = 0; i < game.GetSnakeCount(); ++i)
+    {
+        const SnakeBody& snake = game.GetSnake(i).body;
+        if (snake.Size() == 0)
+            continue;
+        for (const Segment& segment : snake)
+        {
+            if (inBounds(segment))
+                body[segment.y * gridWidth + segment.x] = 1;
+        }
+        if (inBounds(snake.Head()))
+            head[snake.Head().y * gridWidth + snake.Head().x] = 1;
+    }
+    if (inBounds(game.GetFood()))
+        food[game.GetFood().y * gridWidth + game.GetFood().x] = 1;
+    for (int i = 0; i < game.GetObstacleCount(); ++i)
+        obstacle[game.GetObstacle(i).y * gridWidth + game.GetObstacle(i).x] = 1;
+}
+
+size_t ObservationExporter::DrawnCells(const SnakeGame& game) const
+{
+    size_t cells = 1 + game.GetObstacleCount();
+    for (int i = 0; i < game.GetSnakeCount(); ++i)
+        cells += game.GetSnake(i).body.Size() + 1;
+    return cells;
+}
+
+void ObservationExporter::Apply(const std::vector<Delta>& deltas, uint8_t* planes) const
+{
+    for (const Delta& delta : deltas)
+        planes[delta.offset] = delta.value;
+}
+
+bool ObservationReader::Open(const char* name)
+{
+    Close();
+    if (!memory.Open(name) || memory.Size() < RING_HEADER_SIZE)
+    {
+        Close();
+        return false;
+    }
+
+    const RingHeader* header = reinterpret_cast<const RingHeader*>(memory.Data());
+    size_t expectedPlaneSize = PlaneSizeFor(static_cast<int>(header->width), static_cast<int>(header->height));
+    if (std::memcmp(header->magic, RING_MAGIC, sizeof(RING_MAGIC)) != 0 || header->version != RING_VERSION ||
+        header->width == 0 || header->height == 0 || header->capacity < 2 || header->planeSize != expectedPlaneSize ||
+        header->frameSize != FRAME_HEADER_SIZE + OBSERVATION_PLANES * expectedPlaneSize ||
+        memory.Size() < RING_HEADER_SIZE + static_cast<size_t>(header->capacity) * header->frameSize)
+    {
+        Close();
+        return false;
+    }
+
+    gridWidth = static_cast<int>(header->width);
+    gridHeight = static_cast<int>(header->height);
+    capacity = static_cast<int>(header->capacity);
+    planeSize = header->planeSize;
+    frameSize = header->frameSize;
+    return true;
+}
+
+uint64_t ObservationReader::GetPublished() const
+{
+    return reinterpret_cast<const RingHeader*>(memory.Data())->published.load(std::memory_order_acquire);
+}
+
+bool ObservationReader::IsWriterClosed() const
+{
+    return reinterpret_cast<const RingHeader*>(memory.Data())->closed.load() != 0;
+}
+
+uint64_t ObservationReader::Wait(uint64_t seen, int timeoutMs) const
+{
+    using Clock = std::chrono::steady_clock;
+    RingHeader* header = reinterpret_cast<RingHeader*>(memory.Data());
+    Clock::time_point deadline = Clock::now() + std::chrono::milliseconds(timeoutMs);
+    for (;;)
+    {
+        uint64_t published = header->published.load(std::memory_order_acquire);
+        if (published > seen || header->closed.load() != 0)
+            return published;
+        Clock::time_point now = Clock::now();
+        if (now >= deadline)
+            return published;
+
+        // Registering before reading the counter means the writer either sees a sleeper
+        // and wakes it, or bumps the counter first and the wait returns at once
+        header->sleepers.fetch_add(1);
+        uint32_t wake = header->wakeCounter.load();
+        if (header->published.load() <= seen && header->closed.load() == 0)
+            FutexWait(header->wakeCounter, wake, deadline - now);
+        header->sleepers.fetch_sub(1);
+    }
+}
+
+const uint8_t* ObservationReader::Frame(uint64_t frame) const
+{
+    return memory.Data() + RING_HEADER_SIZE + static_cast<size_t>(frame % capacity) * frameSize;
+}
+
+bool ObservationReader::Read(uint64_t frame, ObservationView& view) const
+{
+    const uint8_t* data = Frame(frame);
+    const FrameHeader* header = reinterpret_cast<const FrameHeader*>(data);
+    if (header->sequence.load(std::memory_order_acquire) != frame + 1)
+        return false;
+
+    view.frame = frame;
+    view.tick = header->tick;
+    view.seed = header->seed;
+    view.score = header->score;
+    view.length = static_cast<int>(header->length);
+    view.done = header->done != 0;
+    view.won = header->won != 0;
+    for (int plane = 0; plane < OBSERVATION_PLANES; ++plane)
+        view.planes[plane] = data + FRAME_HEADER_SIZE + plane * planeSize;
+    return true;
+}
+
+bool ObservationReader::Validate(const ObservationView& view) const
+{
+    std::atomic_thread_fence(std::memory_order_acquire);
+    const FrameHeader* header = reinterpret_cast<const FrameHeader*>(Frame(view.frame));
+    return header->sequence.load(std::memory_order_relaxed) == view.frame + 1;
+}
+
+bool ObservationReader::Copy(uint64_t frame, ObservationView& view, std::vector<uint8_t>& planes) const
+{
+    if (!Read(frame, view))
+        return false;
+    size_t cells = static_cast<size_t>(gridWidth) * gridHeight;
+    planes.resize(OBSERVATION_PLANES * cells);
+    for (int plane = 0; plane < OBSERVATION_PLANES; ++plane)
+        std::memcpy(&planes[plane * cells], view.planes[plane], cells);
+    if (!Validate(view))
+        return false;
+    for (int plane = 0; plane < OBSERVATION_PLANES; ++plane)
+        view.planes[plane] = &planes[plane * cells];
+    return true;
+}
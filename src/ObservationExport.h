@@ -0,0 +1,169 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "SharedMemory.h"
+#include "SnakeGame.h"
+
+// Per-tick observations of one game in a shared-memory ring, for trainers that run in
+// another process and read the board in place instead of deserializing it.
+//
+//   Header  64 bytes: "SNKO" magic, version, grid width and height, ring capacity in
+//           frames, frame size, plane size, then the frames published so far, the wake
+//           counter sleeping readers wait on, the number of sleepers and a closed flag
+//   Frames  capacity slots of frame size bytes; frame n lives in slot n % capacity. A
+//           64-byte header (sequence, tick, seed, score, length, done, won) is followed
+//           by four row-major planes of width * height bytes, 64-byte aligned, holding
+//           1 where the cell has the plane's item and 0 elsewhere: body (every segment
+//           of every snake), head, food and obstacle. Score and length are snake 0's.
+//
+// The writer never waits for readers, so a reader more than a ring behind loses frames.
+// A slot's sequence is 0 while it is rewritten and n + 1 once it holds frame n: readers
+// check it before and after using the planes in place (see ObservationReader::Validate).
+enum class ObservationPlane { BODY, HEAD, FOOD, OBSTACLE };
+const int OBSERVATION_PLANES = 4;
+
+struct ObservationExportStats
+{
+    uint64_t published = 0;
+    uint64_t rasterized = 0;  // Cleared and drawn, which new games always are
+    uint64_t replayed = 0;    // Brought up to date by replaying the ring's deltas
+    uint64_t copied = 0;      // Copied from the previous slot plus this tick's deltas
+};
+
+// Writes a game's observations into a named ring. As a listener it publishes after
+// every tick; the driver publishes once more after each Reset for the opening frame.
+//
+// The exporter diffs each tick against the last one it published (head, tail, food and
+// obstacle moves, a handful of cells) and brings the slot up to date from those
+// deltas, whichever of three ways costs least: replaying the deltas of every tick since
+// the slot was last written, copying the previous slot and applying this tick's, or
+// clearing the planes and drawing the board. Drawing wins on small boards and with many
+// obstacles, where it also skips the diff; replaying wins as the board grows. Frames that
+// do not follow on from the last one (a new game, a snake leaving the board) are drawn.
+class ObservationExporter : public SnakeGameListener
+{
+public:
+    static const int DEFAULT_CAPACITY = 16;
+
+    ObservationExporter() = default;
+    ~ObservationExporter() { Close(); }
+
+    ObservationExporter(const ObservationExporter&) = delete;
+    ObservationExporter& operator=(const ObservationExporter&) = delete;
+
+    // Fails if the name is taken; see SharedMemory::Create for replaceStale
+    bool Create(const char* name, int gridWidth, int gridHeight, int capacity = DEFAULT_CAPACITY,
+        bool replaceStale = false);
+    // Marks the ring closed, wakes sleeping readers and removes the name
+    void Close();
+    bool IsOpen() const { return memory.IsOpen(); }
+
+    // Writes the game's current state as the next frame; false if the grid size differs
+    bool Publish(const SnakeGame& game);
+    void OnTick(const SnakeGame& game) override { Publish(game); }
+
+    // Off rasterizes every frame; for benchmarks and for cross-checking the deltas
+    void SetIncremental(bool enabled) { incremental = enabled; }
+    const ObservationExportStats& GetStats() const { return stats; }
+
+private:
+    struct Delta
+    {
+        uint32_t offset;  // Byte offset into the frame's planes
+        uint8_t value;
+    };
+
+    struct SnakeMark
+    {
+        Segment head, tail;
+        int length;
+    };
+
+    // Lists the cell changes since the last published tick, clears before sets, or
+    // returns false when this state does not follow on from it
+    bool FindDeltas(const SnakeGame& game, std::vector<Delta>& deltas) const;
+    void AddDelta(std::vector<Delta>& deltas, const Segment& cell, ObservationPlane plane, uint8_t value) const;
+    void Remember(const SnakeGame& game);
+    void Rasterize(const SnakeGame& game, uint8_t* planes) const;
+    // Cells Rasterize sets for this state
+    size_t DrawnCells(const SnakeGame& game) const;
+    void Apply(const std::vector<Delta>& deltas, uint8_t* planes) const;
+    uint8_t* Frame(int slot) const { return memory.Data() + HEADER_SIZE + static_cast<size_t>(slot) * frameSize; }
+
+    static const size_t HEADER_SIZE = 64;
+
+    SharedMemory memory;
+    int gridWidth = 0, gridHeight = 0;
+    int capacity = 0;
+    size_t planeSize = 0, frameSize = 0;
+    bool incremental = true;
+
+    std::vector<std::vector<Delta>> history;  // Deltas of the last capacity frames, by slot
+    size_t windowDeltas = 0;                  // Their total
+    size_t deltaRate = 0;                     // Deltas per snake and obstacle a tick, in
+                                              // sixteenths, averaged over ticks that followed on
+    uint64_t lastResync = 0;                  // Newest frame that did not follow on
+
+    // The last published state, which the next tick is diffed against
+    bool tracking = false;
+    uint64_t seed = 0, tick = 0;
+    std::vector<SnakeMark> snakes;
+    Segment food = { 0, 0 };
+    std::vector<Segment> obstacles;
+
+    ObservationExportStats stats;
+};
+
+// One frame as the reader sees it; the planes point into the shared ring
+struct ObservationView
+{
+    uint64_t frame = 0;
+    uint64_t tick = 0;
+    uint64_t seed = 0;
+    int score = 0;
+    int length = 0;
+    bool done = false;
+    bool won = false;
+    const uint8_t* planes[OBSERVATION_PLANES] = {};
+
+    const uint8_t* Plane(ObservationPlane plane) const { return planes[static_cast<int>(plane)]; }
+};
+
+// Reads a ring written by an ObservationExporter in another process (or thread).
+// Waiting sleeps on a futex on Linux; elsewhere it polls every millisecond.
+class ObservationReader
+{
+public:
+    bool Open(const char* name);
+    void Close() { memory.Close(); }
+    bool IsOpen() const { return memory.IsOpen(); }
+
+    int GetGridWidth() const { return gridWidth; }
+    int GetGridHeight() const { return gridHeight; }
+    int GetCapacity() const { return capacity; }
+    // Frames published so far; the newest is GetPublished() - 1
+    uint64_t GetPublished() const;
+    bool IsWriterClosed() const;
+
+    // Sleeps until more than `seen` frames are published, the writer closes or the
+    // timeout passes, and returns the number published
+    uint64_t Wait(uint64_t seen, int timeoutMs) const;
+    // Points the view at frame n in place; false if it is not published yet or has been
+    // overwritten. Call Validate once done with the planes.
+    bool Read(uint64_t frame, ObservationView& view) const;
+    // True if the writer has not started overwriting the frame since Read, so whatever
+    // was read from the view is consistent
+    bool Validate(const ObservationView& view) const;
+    // Read, copy the planes out back to back (OBSERVATION_PLANES * width * height
+    // bytes) and Validate; the view's planes then point into `planes`
+    bool Copy(uint64_t frame, ObservationView& view, std::vector<uint8_t>& planes) const;
+
+private:
+    const uint8_t* Frame(uint64_t frame) const;
+
+    SharedMemory memory;
+    int gridWidth = 0, gridHeight = 0;
+    int capacity = 0;
+    size_t planeSize = 0, frameSize = 0;
+};
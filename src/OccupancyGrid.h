@@ -0,0 +1,69 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+#include "SnakeBody.h"
+
+// Per-cell occupancy for the play area, kept in sync with the snake and the obstacles
+// so collision tests are a single lookup instead of a walk over the body.
+// Each cell byte holds the number of body segments on it (low bits) plus an obstacle flag.
+class OccupancyGrid
+{
+public:
+    OccupancyGrid() : width(0), height(0) {}
+
+    void Init(int gridWidth, int gridHeight)
+    {
+        width = gridWidth;
+        height = gridHeight;
+        cells.assign(static_cast<size_t>(width) * height, 0);
+    }
+
+    void Clear() { std::fill(cells.begin(), cells.end(), static_cast<uint8_t>(0)); }
+
+    bool InBounds(int x, int y) const { return x >= 0 && x < width && y >= 0 && y < height; }
+
+    // Out-of-bounds segments (a head that just left the board) are ignored
+    void AddBody(const Segment& segment)
+    {
+        if (InBounds(segment.x, segment.y))
+            ++cells[Index(segment.x, segment.y)];
+    }
+
+    void RemoveBody(const Segment& segment)
+    {
+        if (InBounds(segment.x, segment.y))
+            --cells[Index(segment.x, segment.y)];
+    }
+
+    int BodyCount(int x, int y) const { return InBounds(x, y) ? (cells[Index(x, y)] & BODY_MASK) : 0; }
+    bool HasBody(int x, int y) const { return BodyCount(x, y) > 0; }
+
+    void SetObstacle(int x, int y, bool present)
+    {
+        if (!InBounds(x, y))
+            return;
+        if (present)
+            cells[Index(x, y)] |= OBSTACLE_BIT;
+        else
+            cells[Index(x, y)] &= static_cast<uint8_t>(~OBSTACLE_BIT);
+    }
+
+    bool HasObstacle(int x, int y) const { return InBounds(x, y) && (cells[Index(x, y)] & OBSTACLE_BIT) != 0; }
+
+    // Raw cell bytes, row-major, for snapshots
+    const uint8_t* Data() const { return cells.data(); }
+    uint8_t* Data() { return cells.data(); }
+    size_t CellCount() const { return cells.size(); }
+    int Width() const { return width; }
+    int Height() const { return height; }
+
+private:
+    static const uint8_t OBSTACLE_BIT = 0x80;
+    static const uint8_t BODY_MASK = 0x7F;
+
+    size_t Index(int x, int y) const { return static_cast<size_t>(y) * width + x; }
+
+    std::vector<uint8_t> cells;
+    int width, height;
+};
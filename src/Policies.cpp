@@ -0,0 +1,49 @@
+#include "Policies.h"
+#include <cstdlib>
+
+bool IsOppositeDirection(Direction a, Direction b)
+{
+    return (a == Direction::UP && b == Direction::DOWN) || (a == Direction::DOWN && b == Direction::UP) ||
+        (a == Direction::LEFT && b == Direction::RIGHT) || (a == Direction::RIGHT && b == Direction::LEFT);
+}
+
+Segment StepCell(Segment cell, Direction dir)
+{
+    switch (dir)
+    {
+    case Direction::UP:    cell.y--; break;
+    case Direction::DOWN:  cell.y++; break;
+    case Direction::LEFT:  cell.x--; break;
+    case Direction::RIGHT: cell.x++; break;
+    }
+    return cell;
+}
+
+Direction GreedyPolicy(const SnakeGame& game)
+{
+    const Segment& head = game.GetBody().Head();
+    const Segment& food = game.GetFood();
+    const OccupancyGrid& occupancy = game.GetOccupancy();
+    const Direction order[4] = { Direction::UP, Direction::DOWN, Direction::LEFT, Direction::RIGHT };
+
+    Direction best = game.GetDirection();
+    int bestDistance = -1;
+    for (Direction dir : order)
+    {
+        if (IsOppositeDirection(dir, game.GetDirection()))
+            continue;
+        Segment next = StepCell(head, dir);
+        if (!occupancy.InBounds(next.x, next.y) || occupancy.HasObstacle(next.x, next.y))
+            continue;
+        const Segment& tail = game.GetBody().Tail();
+        if (occupancy.HasBody(next.x, next.y) && !(next.x == tail.x && next.y == tail.y))
+            continue;
+        int distance = std::abs(next.x - food.x) + std::abs(next.y - food.y);
+        if (bestDistance < 0 || distance < bestDistance)
+        {
+            best = dir;
+            bestDistance = distance;
+        }
+    }
+    return best;
+}
@@ -0,0 +1,10 @@
+#pragma once
+#include "SnakeGame.h"
+
+bool IsOppositeDirection(Direction a, Direction b);
+// The neighbouring cell one step in dir (may be off the board)
+Segment StepCell(Segment cell, Direction dir);
+
+// Moves towards the food, skipping moves that hit a wall, the body or the obstacle.
+// Stateless, so it can be shared by every worker of a batch run.
+Direction GreedyPolicy(const SnakeGame& game);
@@ -0,0 +1,182 @@
+#include "Profiler.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+const int Profiler::CAPACITY;
+
+namespace
+{
+const std::chrono::steady_clock::time_point EPOCH = std::chrono::steady_clock::now();
+
+double Percentile(std::vector<double>& sorted, double fraction)
+{
+    size_t index = static_cast<size_t>(fraction * (sorted.size() - 1) + 0.5);
+    return sorted[std::min(index, sorted.size() - 1)];
+}
+
+// Phase names are string literals, but the same literal may live at different
+// addresses in different translation units
+bool SameName(const char* a, const char* b)
+{
+    return a == b || std::strcmp(a, b) == 0;
+}
+
+// Names are literals from this code base; only quotes and backslashes need escaping
+void WriteJsonString(std::FILE* file, const char* text)
+{
+    std::fputc('"', file);
+    for (const char* c = text; *c; ++c)
+    {
+        if (*c == '"' || *c == '\\')
+            std::fputc('\\', file);
+        std::fputc(*c, file);
+    }
+    std::fputc('"', file);
+}
+}
+
+thread_local bool Profiler::threadMuted = false;
+
+Profiler::Profiler() : next(0), active(false)
+{
+}
+
+Profiler& Profiler::Get()
+{
+    static Profiler profiler;
+    return profiler;
+}
+
+uint64_t Profiler::NowNs()
+{
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - EPOCH).count());
+}
+
+uint32_t Profiler::ThreadIndex()
+{
+    static std::atomic<uint32_t> threadCount(0);
+    thread_local uint32_t index = threadCount.fetch_add(1, std::memory_order_relaxed);
+    return index;
+}
+
+void Profiler::Start()
+{
+    if (events.empty())
+        events.resize(CAPACITY);
+    active.store(true, std::memory_order_release);
+}
+
+void Profiler::Clear()
+{
+    next.store(0, std::memory_order_relaxed);
+}
+
+void Profiler::Record(const char* name, uint64_t startNs, uint64_t endNs)
+{
+    uint64_t slot = next.fetch_add(1, std::memory_order_relaxed);
+    Event& event = events[slot & (CAPACITY - 1)];
+    event.name = name;
+    event.startNs = startNs;
+    event.durationNs = endNs - startNs;
+    event.thread = ThreadIndex();
+}
+
+void Profiler::CopyEvents(std::vector<Event>& out) const
+{
+    uint64_t end = next.load(std::memory_order_acquire);
+    uint64_t begin = end > static_cast<uint64_t>(CAPACITY) ? end - CAPACITY : 0;
+    out.clear();
+    for (uint64_t i = begin; i < end; ++i)
+        out.push_back(events[i & (CAPACITY - 1)]);
+
+    // Scopes are recorded when they end, so nested and concurrent scopes arrive out of
+    // start order; sort so consumers see a timeline
+    std::sort(out.begin(), out.end(), [](const Event& a, const Event& b) { return a.startNs < b.startNs; });
+}
+
+void Profiler::ComputePhaseStats(const std::vector<Event>& events, std::vector<PhaseStats>& out)
+{
+    out.clear();
+    std::vector<const char*> names;
+    for (const Event& event : events)
+    {
+        bool known = false;
+        for (const char* name : names)
+            known = known || SameName(name, event.name);
+        if (!known)
+            names.push_back(event.name);
+    }
+
+    std::vector<double> durations;
+    for (const char* name : names)
+    {
+        durations.clear();
+        for (const Event& event : events)
+        {
+            if (SameName(name, event.name))
+                durations.push_back(event.durationNs * 1e-6);
+        }
+        std::sort(durations.begin(), durations.end());
+        out.push_back({ name, static_cast<int>(durations.size()), Percentile(durations, 0.5), Percentile(durations, 0.99),
+            durations.back() });
+    }
+}
+
+Profiler::TickJitter Profiler::ComputeJitter(const std::vector<Event>& events, const char* name)
+{
+    TickJitter jitter;
+    std::vector<double> intervals;
+    const Event* previous = nullptr;
+    for (const Event& event : events)
+    {
+        if (!SameName(name, event.name))
+            continue;
+        if (previous)
+            intervals.push_back((event.startNs - previous->startNs) * 1e-6);
+        previous = &event;
+    }
+    if (intervals.empty())
+        return jitter;
+
+    double sum = 0.0;
+    for (double interval : intervals)
+        sum += interval;
+    jitter.intervals = static_cast<int>(intervals.size());
+    jitter.meanMs = sum / intervals.size();
+
+    double squares = 0.0;
+    for (double& interval : intervals)
+    {
+        double deviation = interval - jitter.meanMs;
+        squares += deviation * deviation;
+        interval = std::fabs(deviation);
+    }
+    jitter.stddevMs = std::sqrt(squares / intervals.size());
+    std::sort(intervals.begin(), intervals.end());
+    jitter.p99DeviationMs = Percentile(intervals, 0.99);
+    return jitter;
+}
+
+bool Profiler::WriteChromeTrace(const std::vector<Event>& events, const char* path)
+{
+    std::FILE* file = std::fopen(path, "w");
+    if (!file)
+        return false;
+
+    // Complete ("X") events with microsecond timestamps, one process, one track per thread
+    std::fprintf(file, "{\"traceEvents\":[\n");
+    for (size_t i = 0; i < events.size(); ++i)
+    {
+        const Event& event = events[i];
+        std::fprintf(file, "{\"name\":");
+        WriteJsonString(file, event.name);
+        std::fprintf(file, ",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%u}%s\n", event.startNs * 1e-3,
+            event.durationNs * 1e-3, event.thread, i + 1 < events.size() ? "," : "");
+    }
+    std::fprintf(file, "],\"displayTimeUnit\":\"ms\"}\n");
+    return std::fclose(file) == 0;
+}
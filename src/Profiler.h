@@ -0,0 +1,120 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+// Scoped CPU timers for the frame loop and the simulation. Finished scopes go into a
+// fixed-size ring buffer allocated by the first Start(), so recording never allocates
+// and old events are simply overwritten. The buffer can be summarised per phase for the
+// Performance window or written out as Chrome trace-event JSON (about:tracing, Perfetto).
+//
+// Instrument code with SNAKE_PROFILE_SCOPE("Name"), using a string literal, or with a
+// SNAKE_PROFILE_BEGIN(id, "Name") / SNAKE_PROFILE_END(id) pair for a span that is not a
+// block. Without SNAKE_PROFILER defined the macros expand to nothing; the CMake build
+// defines it only where the game is built. With it defined, a scope costs one acquire
+// load (a plain load on x86) while the profiler is stopped, which is the default; the
+// game starts it, the headless tools leave it stopped.
+class Profiler
+{
+public:
+    static const int CAPACITY = 1 << 16;  // Events kept; a power of two
+
+    struct Event
+    {
+        const char* name;
+        uint64_t startNs;  // Since the profiler was created
+        uint64_t durationNs;
+        uint32_t thread;   // Small per-thread index, in order of first use
+    };
+
+    struct PhaseStats
+    {
+        const char* name;
+        int count;
+        double p50Ms, p99Ms, maxMs;
+    };
+
+    // Spread of the real time between consecutive ticks
+    struct TickJitter
+    {
+        int intervals = 0;
+        double meanMs = 0.0;
+        double stddevMs = 0.0;
+        double p99DeviationMs = 0.0;  // 99th percentile of |interval - mean|
+    };
+
+    static Profiler& Get();
+    static uint64_t NowNs();
+    static uint32_t ThreadIndex();
+
+    // The first call allocates the event ring; recording threads see it through the
+    // release of `active`
+    void Start();
+    void Stop() { active.store(false, std::memory_order_relaxed); }
+    bool IsActive() const { return active.load(std::memory_order_acquire) && !threadMuted; }
+    // Stops or resumes recording on the calling thread only, e.g. while it plays search
+    // rollouts whose game ticks would otherwise read as the real game's
+    static void SetThreadMuted(bool muted) { threadMuted = muted; }
+    void Clear();
+
+    void Record(const char* name, uint64_t startNs, uint64_t endNs);
+
+    // Copies the buffered events, oldest first, into `out` (reused between calls).
+    // Events still being written by another thread may be copied half-written; the
+    // summaries and traces tolerate that.
+    void CopyEvents(std::vector<Event>& out) const;
+
+    // Per-name duration percentiles over the given events, in order of first appearance
+    static void ComputePhaseStats(const std::vector<Event>& events, std::vector<PhaseStats>& out);
+    // Start-to-start intervals of the events with the given name
+    static TickJitter ComputeJitter(const std::vector<Event>& events, const char* name);
+    static bool WriteChromeTrace(const std::vector<Event>& events, const char* path);
+
+private:
+    Profiler();
+
+    std::vector<Event> events;
+    std::atomic<uint64_t> next;
+    std::atomic<bool> active;
+    static thread_local bool threadMuted;
+};
+
+// Records the lifetime of the enclosing block; see SNAKE_PROFILE_SCOPE
+class ProfileScope
+{
+public:
+    explicit ProfileScope(const char* scopeName)
+        : name(scopeName), startNs(Profiler::Get().IsActive() ? Profiler::NowNs() : NOT_RECORDING)
+    {
+    }
+    ~ProfileScope() { End(); }
+
+    // Records the scope now instead of at the end of the block
+    void End()
+    {
+        if (startNs != NOT_RECORDING)
+            Profiler::Get().Record(name, startNs, Profiler::NowNs());
+        startNs = NOT_RECORDING;
+    }
+
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+
+private:
+    static const uint64_t NOT_RECORDING = ~0ULL;
+
+    const char* name;
+    uint64_t startNs;
+};
+
+#define SNAKE_PROFILE_CONCAT_INNER(a, b) a##b
+#define SNAKE_PROFILE_CONCAT(a, b) SNAKE_PROFILE_CONCAT_INNER(a, b)
+#ifdef SNAKE_PROFILER
+#define SNAKE_PROFILE_SCOPE(name) ProfileScope SNAKE_PROFILE_CONCAT(profileScope, __LINE__)(name)
+#define SNAKE_PROFILE_BEGIN(id, name) ProfileScope id(name)
+#define SNAKE_PROFILE_END(id) id.End()
+#else
+#define SNAKE_PROFILE_SCOPE(name) ((void)0)
+#define SNAKE_PROFILE_BEGIN(id, name) ((void)0)
+#define SNAKE_PROFILE_END(id) ((void)0)
+#endif
@@ -0,0 +1,64 @@
+#pragma once
+#include <cstdint>
+
+// PCG32 (XSH-RR) generator: small, fast and fully specified with integer math, so a
+// given seed produces the same sequence on every compiler and platform.
+class Pcg32
+{
+public:
+    explicit Pcg32(uint64_t seed = 0, uint64_t stream = 0) { Seed(seed, stream); }
+
+    void Seed(uint64_t seed, uint64_t stream = 0)
+    {
+        state = 0;
+        increment = (stream << 1) | 1u;
+        Next();
+        state += seed;
+        Next();
+    }
+
+    uint32_t Next()
+    {
+        uint64_t old = state;
+        state = old * 6364136223846793005ULL + increment;
+        uint32_t xorShifted = static_cast<uint32_t>(((old >> 18) ^ old) >> 27);
+        uint32_t rotation = static_cast<uint32_t>(old >> 59);
+        return (xorShifted >> rotation) | (xorShifted << ((32 - rotation) & 31));
+    }
+
+    uint64_t NextU64()
+    {
+        uint64_t high = Next();
+        return (high << 32) | Next();
+    }
+
+    // Raw generator state, for snapshots and replays
+    uint64_t GetState() const { return state; }
+    uint64_t GetIncrement() const { return increment; }
+    void SetState(uint64_t newState, uint64_t newIncrement)
+    {
+        state = newState;
+        increment = newIncrement | 1u;
+    }
+
+    // Unbiased value in [0, bound) using Lemire's multiply-and-reject method
+    uint32_t NextBounded(uint32_t bound)
+    {
+        uint64_t product = static_cast<uint64_t>(Next()) * bound;
+        uint32_t low = static_cast<uint32_t>(product);
+        if (low < bound)
+        {
+            uint32_t threshold = (0u - bound) % bound;
+            while (low < threshold)
+            {
+                product = static_cast<uint64_t>(Next()) * bound;
+                low = static_cast<uint32_t>(product);
+            }
+        }
+        return static_cast<uint32_t>(product >> 32);
+    }
+
+private:
+    uint64_t state;
+    uint64_t increment;
+};
@@ -0,0 +1,361 @@
+#include "Replay.h"
+#include "ByteStream.h"
+
+namespace
+{
+const uint32_t REPLAY_MAGIC = 0x524B4E53;  // "SNKR"
+const uint32_t INDEX_MAGIC = 0x494B4E53;   // "SNKI"
+// Version 1 had no obstacle count (always one); versions 1 and 2 were recorded before
+// direction inputs were queued and play back with SnakeGame::SetBufferedInput(false)
+const uint16_t REPLAY_VERSION = 3;
+const size_t HEADER_SIZE = 32;
+const size_t FOOTER_SIZE = 16;
+const size_t INDEX_ENTRY_SIZE = 16;
+const uint8_t TAG_INPUT = 1;
+const uint8_t TAG_KEYFRAME = 2;
+const uint8_t TAG_END = 3;
+}
+
+const uint32_t ReplayWriter::DEFAULT_KEYFRAME_INTERVAL;
+
+ReplayWriter::~ReplayWriter()
+{
+    if (file)
+        std::fclose(file);
+}
+
+bool ReplayWriter::Begin(const char* path, const SnakeGame& game, uint32_t interval)
+{
+    if (file || game.GetTick() != 0 || !game.IsBufferedInput() || game.GetSnakeCount() != 1)
+        return false;
+
+    file = std::fopen(path, "wb");
+    if (!file)
+        return false;
+
+    buffer.clear();
+    index.clear();
+    flushedBytes = 0;
+    baseTick = 0;
+    keyframeInterval = interval > 0 ? interval : DEFAULT_KEYFRAME_INTERVAL;
+    failed = false;
+
+    ByteWriter writer(buffer);
+    writer.PutU32(REPLAY_MAGIC);
+    writer.PutU16(REPLAY_VERSION);
+    writer.PutU16(0);
+    writer.PutU32(static_cast<uint32_t>(game.GetGridWidth()));
+    writer.PutU32(static_cast<uint32_t>(game.GetGridHeight()));
+    writer.PutU64(game.GetSeed());
+    writer.PutU32(keyframeInterval);
+    writer.PutU32(static_cast<uint32_t>(game.GetObstacleCount()));
+
+    AppendKeyframe(game);
+    return true;
+}
+
+void ReplayWriter::OnDirectionInput(const SnakeGame& game, Direction dir)
+{
+    if (!file)
+        return;
+    ByteWriter writer(buffer);
+    writer.PutU8(TAG_INPUT);
+    writer.PutVarU64(((game.GetTick() - baseTick) << 2) | static_cast<uint64_t>(dir));
+    baseTick = game.GetTick();
+    if (buffer.size() >= FLUSH_THRESHOLD)
+        Flush();
+}
+
+void ReplayWriter::OnTick(const SnakeGame& game)
+{
+    if (file && game.GetTick() % keyframeInterval == 0)
+        AppendKeyframe(game);
+}
+
+void ReplayWriter::AppendKeyframe(const SnakeGame& game)
+{
+    game.SaveState(stateScratch);
+    index.push_back({ game.GetTick(), flushedBytes + buffer.size() });
+
+    ByteWriter writer(buffer);
+    writer.PutU8(TAG_KEYFRAME);
+    writer.PutVarU64(game.GetTick());
+    writer.PutVarU64(stateScratch.size());
+    writer.PutBytes(stateScratch.data(), stateScratch.size());
+    baseTick = game.GetTick();
+    if (buffer.size() >= FLUSH_THRESHOLD)
+        Flush();
+}
+
+bool ReplayWriter::Flush()
+{
+    if (!buffer.empty() && std::fwrite(buffer.data(), 1, buffer.size(), file) != buffer.size())
+        failed = true;
+    flushedBytes += buffer.size();
+    buffer.clear();
+    return !failed;
+}
+
+bool ReplayWriter::Finish(const SnakeGame& game)
+{
+    if (!file)
+        return false;
+
+    ByteWriter writer(buffer);
+    writer.PutU8(TAG_END);
+    writer.PutVarU64(game.GetTick());
+    writer.PutVarU64(static_cast<uint64_t>(game.GetScore()));
+    writer.PutU8(static_cast<uint8_t>((game.IsGameOver() ? 1 : 0) | (game.IsGameWon() ? 2 : 0)));
+
+    uint64_t indexOffset = flushedBytes + buffer.size();
+    for (const auto& entry : index)
+    {
+        writer.PutU64(entry.tick);
+        writer.PutU64(entry.offset);
+    }
+    writer.PutU64(indexOffset);
+    writer.PutU32(static_cast<uint32_t>(index.size()));
+    writer.PutU32(INDEX_MAGIC);
+
+    bool ok = Flush();
+    ok = std::fclose(file) == 0 && ok;
+    file = nullptr;
+    return ok;
+}
+
+bool ReplayReader::Open(const char* path)
+{
+    Close();
+    if (!mapping.Open(path) || mapping.Size() < HEADER_SIZE + FOOTER_SIZE)
+    {
+        Close();
+        return false;
+    }
+
+    ByteReader header(mapping.Data(), HEADER_SIZE);
+    uint32_t magic = header.GetU32();
+    uint16_t version = header.GetU16();
+    if (magic != REPLAY_MAGIC || version < 1 || version > REPLAY_VERSION)
+    {
+        Close();
+        return false;
+    }
+    header.GetU16();
+    gridWidth = static_cast<int>(header.GetU32());
+    gridHeight = static_cast<int>(header.GetU32());
+    seed = header.GetU64();
+    keyframeInterval = header.GetU32();
+    obstacleCount = version >= 2 ? static_cast<int>(header.GetU32()) : 1;
+    bufferedInput = version >= 3;
+
+    ByteReader footer(mapping.Data() + mapping.Size() - FOOTER_SIZE, FOOTER_SIZE);
+    recordsEnd = footer.GetU64();
+    indexCount = footer.GetU32();
+    if (footer.GetU32() != INDEX_MAGIC || recordsEnd < HEADER_SIZE ||
+        recordsEnd + indexCount * INDEX_ENTRY_SIZE + FOOTER_SIZE != mapping.Size() || indexCount == 0)
+    {
+        Close();
+        return false;
+    }
+
+    // The END record is the last record; find it by scanning forward from the last keyframe
+    ReplayKeyframe last = GetKeyframe(static_cast<int>(indexCount - 1));
+    ByteReader records(mapping.Data(), static_cast<size_t>(recordsEnd));
+    records.Seek(static_cast<size_t>(last.offset));
+    bool foundEnd = false;
+    while (records.Ok() && !records.AtEnd() && !foundEnd)
+    {
+        uint8_t tag = records.GetU8();
+        if (tag == TAG_INPUT)
+            records.GetVarU64();
+        else if (tag == TAG_KEYFRAME)
+        {
+            records.GetVarU64();
+            records.GetBytes(static_cast<size_t>(records.GetVarU64()));
+        }
+        else if (tag == TAG_END)
+        {
+            finalTick = records.GetVarU64();
+            finalScore = static_cast<int>(records.GetVarU64());
+            finalWon = (records.GetU8() & 2) != 0;
+            foundEnd = records.Ok();
+        }
+        else
+            break;
+    }
+    if (!foundEnd)
+    {
+        Close();
+        return false;
+    }
+    return true;
+}
+
+void ReplayReader::Close()
+{
+    mapping.Close();
+    gridWidth = gridHeight = 0;
+    obstacleCount = 1;
+    recordsEnd = indexCount = finalTick = 0;
+    finalScore = 0;
+    finalWon = false;
+}
+
+ReplayKeyframe ReplayReader::GetKeyframe(int i) const
+{
+    ByteReader reader(mapping.Data() + recordsEnd + static_cast<size_t>(i) * INDEX_ENTRY_SIZE, INDEX_ENTRY_SIZE);
+    ReplayKeyframe keyframe;
+    keyframe.tick = reader.GetU64();
+    keyframe.offset = reader.GetU64();
+    return keyframe;
+}
+
+void ReplayReader::AdvanceTo(SnakeGame& game, uint64_t tick)
+{
+    while (game.GetTick() < tick && !game.IsGameOver())
+    {
+        // A game that ticked was started, either by an input or by StartGame
+        if (game.IsWaitingForStart())
+            game.StartGame();
+        game.Step();
+    }
+}
+
+bool ReplayReader::LoadKeyframe(SnakeGame& game, uint64_t offset, uint64_t& tick, size_t& next) const
+{
+    ByteReader reader(mapping.Data(), static_cast<size_t>(recordsEnd));
+    reader.Seek(static_cast<size_t>(offset));
+    if (reader.GetU8() != TAG_KEYFRAME)
+        return false;
+    tick = reader.GetVarU64();
+    size_t size = static_cast<size_t>(reader.GetVarU64());
+    const uint8_t* state = reader.GetBytes(size);
+    if (!reader.Ok() || !game.LoadState(state, size))
+        return false;
+    next = reader.Offset();
+    return true;
+}
+
+bool ReplayReader::Seek(SnakeGame& game, uint64_t tick) const
+{
+    if (!mapping.IsOpen() || game.GetGridWidth() != gridWidth || game.GetGridHeight() != gridHeight)
+        return false;
+    if (tick > finalTick)
+        tick = finalTick;
+    game.SetBufferedInput(bufferedInput);
+
+    // Binary search for the last keyframe at or before the target tick
+    int low = 0, high = static_cast<int>(indexCount) - 1;
+    while (low < high)
+    {
+        int mid = (low + high + 1) / 2;
+        if (GetKeyframe(mid).tick <= tick)
+            low = mid;
+        else
+            high = mid - 1;
+    }
+
+    uint64_t base;
+    size_t next;
+    if (!LoadKeyframe(game, GetKeyframe(low).offset, base, next))
+        return false;
+
+    ByteReader reader(mapping.Data(), static_cast<size_t>(recordsEnd));
+    reader.Seek(next);
+    while (reader.Ok() && !reader.AtEnd())
+    {
+        uint8_t tag = reader.GetU8();
+        if (tag != TAG_INPUT)
+            break;  // The next keyframe or the end lies beyond the target
+        uint64_t value = reader.GetVarU64();
+        base += value >> 2;
+        if (base >= tick)
+            break;
+        AdvanceTo(game, base);
+        game.SetDirection(static_cast<Direction>(value & 3));
+    }
+    AdvanceTo(game, tick);
+    return reader.Ok() && game.GetTick() == tick;
+}
+
+ReplayVerifyResult ReplayReader::Verify(SnakeGame& game) const
+{
+    ReplayVerifyResult result;
+    if (!mapping.IsOpen() || game.GetGridWidth() != gridWidth || game.GetGridHeight() != gridHeight)
+    {
+        result.error = "grid size does not match the replay";
+        return result;
+    }
+
+    game.SetObstacleCount(obstacleCount);
+    game.SetBufferedInput(bufferedInput);
+    game.Reset(seed);
+    std::vector<uint8_t> expected;
+    std::vector<uint8_t> actual;
+    // Keyframes go through a scratch game so ones written by an older state version
+    // compare in the current encoding
+    SnakeGame reference(gridWidth, gridHeight);
+
+    ByteReader reader(mapping.Data(), static_cast<size_t>(recordsEnd));
+    reader.Seek(HEADER_SIZE);
+    uint64_t base = 0;
+    bool ended = false;
+    while (reader.Ok() && !reader.AtEnd() && !ended)
+    {
+        uint8_t tag = reader.GetU8();
+        if (tag == TAG_INPUT)
+        {
+            uint64_t value = reader.GetVarU64();
+            base += value >> 2;
+            AdvanceTo(game, base);
+            game.SetDirection(static_cast<Direction>(value & 3));
+        }
+        else if (tag == TAG_KEYFRAME)
+        {
+            base = reader.GetVarU64();
+            size_t size = static_cast<size_t>(reader.GetVarU64());
+            const uint8_t* state = reader.GetBytes(size);
+            if (!reader.Ok())
+                break;
+            if (!reference.LoadState(state, size))
+            {
+                result.error = "unreadable keyframe";
+                result.ticks = base;
+                return result;
+            }
+            reference.SaveState(expected);
+            AdvanceTo(game, base);
+            game.SaveState(actual);
+            if (actual != expected)
+            {
+                result.error = "simulation diverged from a keyframe";
+                result.ticks = base;
+                return result;
+            }
+            ++result.keyframesChecked;
+        }
+        else if (tag == TAG_END)
+        {
+            uint64_t endTick = reader.GetVarU64();
+            AdvanceTo(game, endTick);
+            ended = true;
+        }
+        else
+        {
+            result.error = "unknown record";
+            return result;
+        }
+    }
+
+    result.ticks = game.GetTick();
+    result.score = game.GetScore();
+    if (!reader.Ok() || !ended)
+        result.error = "truncated record stream";
+    else if (result.ticks != finalTick)
+        result.error = "final tick does not match";
+    else if (result.score != finalScore)
+        result.error = "final score does not match";
+    else
+        result.ok = true;
+    return result;
+}
@@ -0,0 +1,122 @@
+#pragma once
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+#include "MappedFile.h"
+#include "SnakeGame.h"
+
+// Replay file layout (all integers little-endian):
+//
+//   Header   "SNKR" magic, version, grid size, game seed, keyframe interval, obstacle count
+//   Records  tag byte + payload, in tick order:
+//              INPUT     varint((tick - baseTick) << 2 | direction)
+//              KEYFRAME  varint tick, varint size, SnakeGame::SaveState bytes
+//              END       varint final tick, varint score, flags byte
+//            baseTick is the tick of the previous INPUT or KEYFRAME record.
+//   Index    count, then (tick, file offset) per keyframe
+//   Footer   index offset, index count, "SNKI" magic
+//
+// A reader jumps to any tick by restoring the nearest keyframe at or before it and
+// re-simulating only the inputs recorded since.
+struct ReplayKeyframe
+{
+    uint64_t tick;
+    uint64_t offset;  // File offset of the KEYFRAME record
+};
+
+// Records one game. Attach with SnakeGame::AddListener after Begin; inputs and
+// periodic keyframes are appended to an in-memory buffer that is flushed in blocks.
+class ReplayWriter : public SnakeGameListener
+{
+public:
+    static const uint32_t DEFAULT_KEYFRAME_INTERVAL = 1024;
+
+    ReplayWriter() = default;
+    ~ReplayWriter();
+
+    ReplayWriter(const ReplayWriter&) = delete;
+    ReplayWriter& operator=(const ReplayWriter&) = delete;
+
+    // The game must be freshly reset (tick 0) so the replay can be re-simulated from its
+    // seed, and must queue its inputs (the default), which is what new replays assume.
+    // Only single-snake games can be recorded, since only snake 0's inputs are heard.
+    bool Begin(const char* path, const SnakeGame& game, uint32_t keyframeInterval = DEFAULT_KEYFRAME_INTERVAL);
+    // Writes the end record, index and footer, then closes the file
+    bool Finish(const SnakeGame& game);
+    bool IsOpen() const { return file != nullptr; }
+
+    void OnDirectionInput(const SnakeGame& game, Direction dir) override;
+    void OnTick(const SnakeGame& game) override;
+
+private:
+    static const size_t FLUSH_THRESHOLD = 64 * 1024;
+
+    void AppendKeyframe(const SnakeGame& game);
+    bool Flush();
+
+    std::FILE* file = nullptr;
+    std::vector<uint8_t> buffer;
+    std::vector<uint8_t> stateScratch;
+    std::vector<ReplayKeyframe> index;
+    uint64_t flushedBytes = 0;
+    uint64_t baseTick = 0;
+    uint32_t keyframeInterval = DEFAULT_KEYFRAME_INTERVAL;
+    bool failed = false;
+};
+
+struct ReplayVerifyResult
+{
+    bool ok = false;
+    uint64_t ticks = 0;
+    int score = 0;
+    int keyframesChecked = 0;
+    const char* error = "";
+};
+
+// Memory-mapped reader. The game passed to Seek/Verify must have the replay's grid size.
+class ReplayReader
+{
+public:
+    bool Open(const char* path);
+    void Close();
+
+    int GetGridWidth() const { return gridWidth; }
+    int GetGridHeight() const { return gridHeight; }
+    uint64_t GetSeed() const { return seed; }
+    uint32_t GetKeyframeInterval() const { return keyframeInterval; }
+    int GetObstacleCount() const { return obstacleCount; }
+    // False for replays recorded before inputs were queued
+    bool IsBufferedInput() const { return bufferedInput; }
+    uint64_t GetFinalTick() const { return finalTick; }
+    int GetFinalScore() const { return finalScore; }
+    bool IsGameWon() const { return finalWon; }
+    int GetKeyframeCount() const { return static_cast<int>(indexCount); }
+    ReplayKeyframe GetKeyframe(int i) const;
+
+    // Puts the game in the state it had after `tick` ticks (clamped to the final tick).
+    // Seek and Verify switch the game to the replay's input mode.
+    bool Seek(SnakeGame& game, uint64_t tick) const;
+    // Re-simulates the whole game from its seed and obstacle count, checking every keyframe
+    // and the final score
+    ReplayVerifyResult Verify(SnakeGame& game) const;
+
+private:
+    enum class RecordType : uint8_t { INPUT = 1, KEYFRAME = 2, END = 3 };
+
+    // Steps the game up to the given tick, starting it if it is still waiting for input
+    static void AdvanceTo(SnakeGame& game, uint64_t tick);
+    bool LoadKeyframe(SnakeGame& game, uint64_t offset, uint64_t& tick, size_t& next) const;
+
+    MappedFile mapping;
+    int gridWidth = 0;
+    int gridHeight = 0;
+    uint64_t seed = 0;
+    uint32_t keyframeInterval = 0;
+    int obstacleCount = 1;
+    bool bufferedInput = true;
+    uint64_t recordsEnd = 0;  // Offset of the index
+    uint64_t indexCount = 0;
+    uint64_t finalTick = 0;
+    int finalScore = 0;
+    bool finalWon = false;
+};
@@ -0,0 +1,307 @@
+#include "SessionHost.h"
+#include <algorithm>
+#include <cmath>
+#include "Random.h"
+#include "ThreadPool.h"
+
+const int SessionHost::BLOCK_SESSIONS;
+const int SessionHost::LATENESS_CAP_MICROS;
+
+float SessionSpeedFactor(SessionSpeed speed)
+{
+    switch (speed)
+    {
+    case SessionSpeed::SLOW: return 1.5f;
+    case SessionSpeed::NORMAL: return 1.0f;
+    case SessionSpeed::FAST: return 0.5f;
+    }
+    return 1.0f;
+}
+
+SessionHost::SessionHost(const SessionHostConfig& newConfig) : config(newConfig), origin(Clock::now())
+{
+    int threads = config.threads > 0 ? config.threads : ThreadPool::HardwareThreads();
+    for (int i = 0; i < threads; ++i)
+        shards.emplace_back(new Shard());
+}
+
+SessionHost::~SessionHost()
+{
+    Stop();
+}
+
+void SessionHost::Start()
+{
+    if (running.load(std::memory_order_relaxed))
+        return;
+    running.store(true, std::memory_order_release);
+    for (auto& shard : shards)
+        shard->worker = std::thread(&SessionHost::Run, this, std::ref(*shard));
+}
+
+void SessionHost::Stop()
+{
+    if (!running.load(std::memory_order_relaxed))
+        return;
+    running.store(false, std::memory_order_release);
+    for (auto& shard : shards)
+    {
+        // Taking the lock orders the flag before a worker's check for it
+        {
+            std::lock_guard<std::mutex> lock(shard->mutex);
+        }
+        shard->wake.notify_one();
+        shard->worker.join();
+    }
+    // The sessions are ours again; commands sent after a worker's last pick-up still count
+    for (auto& shard : shards)
+        ApplyCommands(*shard);
+}
+
+SessionId SessionHost::Open(uint64_t seed, SessionSpeed speed)
+{
+    // Least loaded by open sessions; ties go to the lowest shard
+    size_t index = 0, fewest = ~size_t(0);
+    for (size_t i = 0; i < shards.size(); ++i)
+    {
+        std::lock_guard<std::mutex> lock(shards[i]->mutex);
+        if (shards[i]->open < fewest)
+        {
+            fewest = shards[i]->open;
+            index = i;
+        }
+    }
+
+    Shard& shard = *shards[index];
+    uint32_t slot, generation;
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        if (!shard.freeSlots.empty())
+        {
+            slot = shard.freeSlots.back();
+            shard.freeSlots.pop_back();
+        }
+        else
+        {
+            slot = static_cast<uint32_t>(shard.generations.size());
+            shard.generations.push_back(0);
+        }
+        generation = ++shard.generations[slot];
+        ++shard.open;
+        Command command = { Command::Type::OPEN, speed, Direction::RIGHT, slot, seed };
+        shard.commands.push_back(command);
+    }
+    shard.wake.notify_one();
+    return (static_cast<uint64_t>(generation) << 32) | (static_cast<uint64_t>(slot) * shards.size() + index);
+}
+
+bool SessionHost::Close(SessionId id)
+{
+    Command command = { Command::Type::CLOSE, SessionSpeed::NORMAL, Direction::RIGHT, 0, 0 };
+    return Send(id, command);
+}
+
+bool SessionHost::SetDirection(SessionId id, Direction dir)
+{
+    Command command = { Command::Type::DIRECTION, SessionSpeed::NORMAL, dir, 0, 0 };
+    return Send(id, command);
+}
+
+bool SessionHost::Send(SessionId id, Command command)
+{
+    uint32_t index = static_cast<uint32_t>(id);
+    uint32_t generation = static_cast<uint32_t>(id >> 32);
+    Shard& shard = *shards[index % shards.size()];
+    command.slot = static_cast<uint32_t>(index / shards.size());
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        if (command.slot >= shard.generations.size() || shard.generations[command.slot] != generation ||
+            generation % 2 == 0)
+            return false;
+        if (command.type == Command::Type::CLOSE)
+        {
+            ++shard.generations[command.slot];
+            shard.freeSlots.push_back(command.slot);
+            --shard.open;
+        }
+        shard.commands.push_back(command);
+    }
+    shard.wake.notify_one();
+    return true;
+}
+
+void SessionHost::ResetStats()
+{
+    Command command = { Command::Type::RESET_STATS, SessionSpeed::NORMAL, Direction::RIGHT, 0, 0 };
+    for (auto& shard : shards)
+    {
+        {
+            std::lock_guard<std::mutex> lock(shard->mutex);
+            shard->commands.push_back(command);
+        }
+        shard->wake.notify_one();
+    }
+}
+
+size_t SessionHost::GetSessionCount() const
+{
+    size_t total = 0;
+    for (const auto& shard : shards)
+    {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        total += shard->open;
+    }
+    return total;
+}
+
+uint64_t SessionHost::GetTicks() const
+{
+    uint64_t total = 0;
+    for (const auto& shard : shards)
+        total += shard->ticks.load(std::memory_order_relaxed);
+    return total;
+}
+
+SessionHostStats SessionHost::GetStats() const
+{
+    SessionHostStats stats;
+    stats.sessions = GetSessionCount();
+    for (const auto& shard : shards)
+    {
+        stats.ticks += shard->ticks.load(std::memory_order_relaxed);
+        stats.games += shard->games;
+        stats.skippedTicks += shard->skippedTicks;
+        stats.busySeconds += shard->busySeconds;
+        stats.lateness.Merge(shard->lateness);
+        stats.maxLatenessMicros = std::max(stats.maxLatenessMicros, shard->maxLateness);
+    }
+    return stats;
+}
+
+const SnakeGame* SessionHost::GetGame(SessionId id) const
+{
+    uint32_t index = static_cast<uint32_t>(id);
+    Shard& shard = *shards[index % shards.size()];
+    uint32_t slot = static_cast<uint32_t>(index / shards.size());
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        if (slot >= shard.generations.size() || shard.generations[slot] != static_cast<uint32_t>(id >> 32) ||
+            slot / BLOCK_SESSIONS >= shard.blocks.size())
+            return nullptr;
+    }
+    return shard.blocks[slot / BLOCK_SESSIONS][slot % BLOCK_SESSIONS].game.get();
+}
+
+uint64_t SessionHost::NowMicros() const
+{
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - origin).count());
+}
+
+void SessionHost::Run(Shard& shard)
+{
+    while (running.load(std::memory_order_acquire))
+    {
+        Clock::time_point start = Clock::now();
+        ApplyCommands(shard);
+        shard.wheel.Advance(NowMicros() / 1000, [this, &shard](uint32_t slot, uint64_t) { Tick(shard, slot); });
+        shard.busySeconds += std::chrono::duration<double>(Clock::now() - start).count();
+
+        // Sleep until the next session is due or a command arrives
+        uint64_t next = shard.wheel.NextDue();
+        std::unique_lock<std::mutex> lock(shard.mutex);
+        auto woken = [this, &shard] { return !shard.commands.empty() || !running.load(std::memory_order_relaxed); };
+        if (next == TimerWheel::NEVER)
+            shard.wake.wait(lock, woken);
+        else
+            shard.wake.wait_until(lock, origin + std::chrono::milliseconds(next), woken);
+    }
+}
+
+void SessionHost::ApplyCommands(Shard& shard)
+{
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        shard.applying.swap(shard.commands);
+    }
+    for (const Command& command : shard.applying)
+        Apply(shard, command);
+    shard.applying.clear();
+}
+
+void SessionHost::Apply(Shard& shard, const Command& command)
+{
+    switch (command.type)
+    {
+    case Command::Type::OPEN:
+    {
+        // Slots are handed out in order, so a new one is at most one block past the end
+        if (command.slot / BLOCK_SESSIONS >= shard.blocks.size())
+            shard.blocks.emplace_back(new Session[BLOCK_SESSIONS]);
+        Session& session = At(shard, command.slot);
+        if (!session.game)
+        {
+            session.game.reset(new SnakeGame(config.gridWidth, config.gridHeight));
+            session.game->SetObstacleCount(config.obstacles);
+        }
+        session.game->Reset(command.seed);
+        session.game->StartGame();
+
+        // Whole milliseconds, the wheel's resolution; at least one
+        double seconds = session.game->GetMoveDelay() * SessionSpeedFactor(command.speed);
+        uint32_t intervalMillis = std::max(static_cast<uint32_t>(std::lround(seconds * 1000.0)), 1u);
+        session.interval = intervalMillis * 1000;
+        Pcg32 phase(command.seed);
+        uint64_t nowMillis = (NowMicros() + 999) / 1000;
+        session.due = (nowMillis + 1 + phase.NextBounded(intervalMillis)) * 1000;
+        shard.wheel.Schedule(command.slot, session.due / 1000);
+        break;
+    }
+    case Command::Type::CLOSE:
+        shard.wheel.Cancel(command.slot);
+        break;
+    case Command::Type::DIRECTION:
+        At(shard, command.slot).game->SetDirection(command.direction);
+        break;
+    case Command::Type::RESET_STATS:
+        shard.ticks.store(0, std::memory_order_relaxed);
+        shard.games = shard.skippedTicks = 0;
+        shard.busySeconds = 0.0;
+        shard.lateness.counts.clear();
+        shard.maxLateness = 0;
+        break;
+    }
+}
+
+void SessionHost::Tick(Shard& shard, uint32_t slot)
+{
+    Session& session = At(shard, slot);
+    uint64_t now = NowMicros();
+    uint64_t late = now > session.due ? now - session.due : 0;
+    shard.lateness.Add(static_cast<int>(std::min<uint64_t>(late, LATENESS_CAP_MICROS)));
+    shard.maxLateness = std::max(shard.maxLateness, late);
+
+    SnakeGame& game = *session.game;
+    if (config.policy)
+        game.SetDirection(config.policy(game));
+    game.Step();
+    shard.ticks.store(shard.ticks.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    if (game.IsGameOver())
+    {
+        ++shard.games;
+        if (!config.restartFinished)
+            return;
+        game.Reset();
+        game.StartGame();
+    }
+
+    // A deadline already passed fires again within the same Advance, so a session a
+    // few ticks behind catches up; one further behind drops the ticks it missed
+    session.due += session.interval;
+    uint64_t behind = now > session.due ? (now - session.due) / session.interval : 0;
+    if (behind > static_cast<uint64_t>(config.maxLateTicks))
+    {
+        session.due += behind * session.interval;
+        shard.skippedTicks += behind;
+    }
+    shard.wheel.Schedule(slot, session.due / 1000);
+}
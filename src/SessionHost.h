@@ -0,0 +1,153 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "BatchRunner.h"
+#include "SnakeGame.h"
+#include "TimerWheel.h"
+
+// Tick rates offered in the game's Control Panel
+enum class SessionSpeed { SLOW, NORMAL, FAST };
+// Real seconds per simulated second at each speed, as main.cpp's GameSpeedFactor
+float SessionSpeedFactor(SessionSpeed speed);
+
+// Identifies an open session: the low 32 bits are slot * shards + shard, the high 32 the
+// slot's generation, so a handle stops working once its session is closed
+using SessionId = uint64_t;
+const SessionId NO_SESSION = ~0ULL;
+
+struct SessionHostConfig
+{
+    int threads = 0;              // Shards, one worker thread each; 0 = all hardware threads
+    int gridWidth = 20;
+    int gridHeight = 20;
+    int obstacles = 1;
+    SnakePolicy policy;           // Steers every session before each tick; empty leaves them to SetDirection
+    bool restartFinished = true;  // A finished game starts over with a seed drawn from the last one
+    int maxLateTicks = 8;         // A session further behind than this skips ticks instead of catching up
+};
+
+struct SessionHostStats
+{
+    uint64_t sessions = 0;
+    uint64_t ticks = 0;
+    uint64_t games = 0;         // Games that ended
+    uint64_t skippedTicks = 0;  // Dropped by sessions more than maxLateTicks behind
+    double busySeconds = 0.0;   // Worker time spent ticking, summed over the shards
+    // How long after its deadline each tick ran, in microseconds (capped at
+    // LATENESS_CAP_MICROS), and the largest lateness seen
+    Distribution lateness;
+    uint64_t maxLatenessMicros = 0;
+};
+
+// Hosts many independent games in one process, each ticking at its own rate (the game's
+// move delay scaled by the session's speed), for bot arenas and soak tests.
+//
+// Sessions are spread over shards, each with a worker thread that owns its sessions
+// outright. A shard keeps its sessions in blocks of BLOCK_SESSIONS that are allocated
+// once and reused, slot and game alike, when sessions close and new ones open. Every
+// session's next tick is a timer on the shard's TimerWheel in milliseconds, so a worker
+// only touches the sessions that are due and sleeps until the next one is; nothing
+// scans all sessions. Ticks run at fixed deadlines (the previous deadline plus the
+// interval), so a late tick does not push the following ones back.
+//
+// Open, Close and SetDirection may be called from any thread: they are validated and
+// queued under the shard's lock and applied by the worker before its next batch of ticks.
+class SessionHost
+{
+public:
+    static const int BLOCK_SESSIONS = 1024;
+    static const int LATENESS_CAP_MICROS = 100000;
+
+    explicit SessionHost(const SessionHostConfig& config = SessionHostConfig());
+    ~SessionHost();
+
+    SessionHost(const SessionHost&) = delete;
+    SessionHost& operator=(const SessionHost&) = delete;
+
+    void Start();
+    // Joins the workers, then applies the commands they had not picked up yet
+    void Stop();
+    bool IsRunning() const { return running.load(std::memory_order_relaxed); }
+
+    // Starts a game on the least loaded shard; its first tick falls at a point within its
+    // first interval picked from the seed, so sessions opened together are spread out
+    SessionId Open(uint64_t seed, SessionSpeed speed = SessionSpeed::NORMAL);
+    bool Close(SessionId id);
+    bool SetDirection(SessionId id, Direction dir);
+
+    int GetShardCount() const { return static_cast<int>(shards.size()); }
+    size_t GetSessionCount() const;
+    // Ticks run so far; may be read while running
+    uint64_t GetTicks() const;
+    // Totals over the shards; only while stopped
+    SessionHostStats GetStats() const;
+    // Zeroes the statistics, in order with the other commands; soak tests call it once
+    // the sessions are up and running
+    void ResetStats();
+    // The session's game, or nullptr if the handle is stale; only while stopped, and for
+    // sessions opened before the last Stop (commands wait for a worker to apply them)
+    const SnakeGame* GetGame(SessionId id) const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Command
+    {
+        enum class Type : uint8_t { OPEN, CLOSE, DIRECTION, RESET_STATS };
+        Type type;
+        SessionSpeed speed;
+        Direction direction;
+        uint32_t slot;
+        uint64_t seed;
+    };
+
+    struct Session
+    {
+        std::unique_ptr<SnakeGame> game;  // Kept when the session closes, for the next one in the slot
+        uint64_t due = 0;                 // Deadline of the next tick, in microseconds since the host started
+        uint32_t interval = 0;            // Microseconds between ticks
+    };
+
+    struct Shard
+    {
+        // Shared with the threads that send commands
+        std::mutex mutex;
+        std::condition_variable wake;
+        std::vector<Command> commands;
+        std::vector<uint32_t> generations;  // Per slot; odd while a session is open in it
+        std::vector<uint32_t> freeSlots;
+        size_t open = 0;
+
+        // The worker's, or the caller's while the host is stopped
+        std::vector<Command> applying;
+        std::vector<std::unique_ptr<Session[]>> blocks;
+        TimerWheel wheel;
+        std::thread worker;
+        std::atomic<uint64_t> ticks{ 0 };
+        uint64_t games = 0, skippedTicks = 0;
+        double busySeconds = 0.0;
+        Distribution lateness;
+        uint64_t maxLateness = 0;
+    };
+
+    void Run(Shard& shard);
+    // Takes the shard's queued commands and applies them
+    void ApplyCommands(Shard& shard);
+    void Apply(Shard& shard, const Command& command);
+    void Tick(Shard& shard, uint32_t slot);
+    Session& At(Shard& shard, uint32_t slot) { return shard.blocks[slot / BLOCK_SESSIONS][slot % BLOCK_SESSIONS]; }
+    // Validates the handle under the shard's lock and queues the command
+    bool Send(SessionId id, Command command);
+    uint64_t NowMicros() const;
+
+    SessionHostConfig config;
+    std::vector<std::unique_ptr<Shard>> shards;
+    Clock::time_point origin;
+    std::atomic<bool> running{ false };
+};
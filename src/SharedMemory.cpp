@@ -0,0 +1,171 @@
+#include "SharedMemory.h"
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+// POSIX names need one leading slash; Windows names go in the session namespace
+std::string NativeName(const char* name)
+{
+#ifdef _WIN32
+    return std::string("Local\\") + name;
+#else
+    return name[0] == '/' ? std::string(name) : std::string("/") + name;
+#endif
+}
+}
+
+#ifdef _WIN32
+
+bool SharedMemory::Create(const char* newName, size_t newSize, bool)
+{
+    Close();
+    std::string native = NativeName(newName);
+    uint64_t size64 = newSize;
+    // Paging-file mappings start zero-filled and vanish with the last handle
+    HANDLE mapping = ::CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE,
+        static_cast<DWORD>(size64 >> 32), static_cast<DWORD>(size64), native.c_str());
+    if (mapping == nullptr)
+        return false;
+    if (::GetLastError() == ERROR_ALREADY_EXISTS)
+    {
+        // Another live process holds the name, so there is nothing stale to replace
+        ::CloseHandle(mapping);
+        return false;
+    }
+
+    void* view = ::MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, newSize);
+    if (view == nullptr)
+    {
+        ::CloseHandle(mapping);
+        return false;
+    }
+    mappingHandle = mapping;
+    data = static_cast<uint8_t*>(view);
+    size = newSize;
+    owner = true;
+    name = native;
+    return true;
+}
+
+bool SharedMemory::Open(const char* openName)
+{
+    Close();
+    std::string native = NativeName(openName);
+    HANDLE mapping = ::OpenFileMappingA(FILE_MAP_ALL_ACCESS, FALSE, native.c_str());
+    if (mapping == nullptr)
+        return false;
+
+    void* view = ::MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, 0);
+    MEMORY_BASIC_INFORMATION info;
+    if (view == nullptr || ::VirtualQuery(view, &info, sizeof(info)) == 0)
+    {
+        if (view)
+            ::UnmapViewOfFile(view);
+        ::CloseHandle(mapping);
+        return false;
+    }
+    mappingHandle = mapping;
+    data = static_cast<uint8_t*>(view);
+    size = info.RegionSize;  // Rounded up to whole pages
+    owner = false;
+    name = native;
+    return true;
+}
+
+void SharedMemory::Close()
+{
+    if (data)
+        ::UnmapViewOfFile(data);
+    if (mappingHandle)
+        ::CloseHandle(static_cast<HANDLE>(mappingHandle));
+    data = nullptr;
+    size = 0;
+    owner = false;
+    name.clear();
+    mappingHandle = nullptr;
+}
+
+#else
+
+bool SharedMemory::Create(const char* newName, size_t newSize, bool replaceStale)
+{
+    Close();
+    std::string native = NativeName(newName);
+    // The name outlives a crashed creator, but it may as well be a live one's: only drop
+    // it when asked. Readers of a dropped region keep their mapping
+    if (replaceStale)
+        ::shm_unlink(native.c_str());
+    // O_EXCL fails with EEXIST on a taken name
+    int fd = ::shm_open(native.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (fd < 0)
+        return false;
+    if (::ftruncate(fd, static_cast<off_t>(newSize)) != 0)
+    {
+        ::close(fd);
+        ::shm_unlink(native.c_str());
+        return false;
+    }
+
+    void* view = ::mmap(nullptr, newSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (view == MAP_FAILED)
+    {
+        ::shm_unlink(native.c_str());
+        return false;
+    }
+    data = static_cast<uint8_t*>(view);
+    size = newSize;
+    owner = true;
+    name = native;
+    return true;
+}
+
+bool SharedMemory::Open(const char* openName)
+{
+    Close();
+    std::string native = NativeName(openName);
+    int fd = ::shm_open(native.c_str(), O_RDWR, 0);
+    if (fd < 0)
+        return false;
+
+    struct stat info;
+    if (::fstat(fd, &info) != 0 || info.st_size == 0)
+    {
+        ::close(fd);
+        return false;
+    }
+    void* view = ::mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (view == MAP_FAILED)
+        return false;
+    data = static_cast<uint8_t*>(view);
+    size = static_cast<size_t>(info.st_size);
+    owner = false;
+    name = native;
+    return true;
+}
+
+void SharedMemory::Close()
+{
+    if (data)
+        ::munmap(data, size);
+    if (owner)
+        ::shm_unlink(name.c_str());
+    data = nullptr;
+    size = 0;
+    owner = false;
+    name.clear();
+}
+
+#endif
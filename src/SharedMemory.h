@@ -0,0 +1,39 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Named read-write memory shared between processes (POSIX shm_open on Linux and macOS,
+// a paging-file mapping on Windows). The creator owns the name: closing it removes the
+// name, while processes that opened it keep their mapping until they close it.
+class SharedMemory
+{
+public:
+    SharedMemory() = default;
+    ~SharedMemory() { Close(); }
+
+    SharedMemory(const SharedMemory&) = delete;
+    SharedMemory& operator=(const SharedMemory&) = delete;
+
+    // Creates a zero-filled region. Fails if the name is taken, as it may belong to a live
+    // creator. replaceStale first removes a region under the name on POSIX, where a
+    // crashed creator leaves it behind; only pass it when no other creator can be running.
+    // On Windows a taken name always has a live holder and is never replaced.
+    bool Create(const char* name, size_t size, bool replaceStale = false);
+    // Maps an existing region whole
+    bool Open(const char* name);
+    void Close();
+
+    uint8_t* Data() const { return data; }
+    size_t Size() const { return size; }
+    bool IsOpen() const { return data != nullptr; }
+
+private:
+    uint8_t* data = nullptr;
+    size_t size = 0;
+    bool owner = false;
+    std::string name;
+#ifdef _WIN32
+    void* mappingHandle = nullptr;
+#endif
+};
@@ -0,0 +1,147 @@
+#include "SimulationThread.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <utility>
+
+namespace
+{
+const std::chrono::microseconds SPIN_MARGIN(2000);  // Yield instead of sleeping this close to a tick
+const std::chrono::microseconds IDLE_POLL(4000);    // Command polling while the game is not ticking
+}
+
+const size_t SimulationThread::COMMAND_CAPACITY;
+
+SimulationThread::~SimulationThread()
+{
+    Stop();
+}
+
+void SimulationThread::Start(SnakeGame& target)
+{
+    Stop();
+    game = &target;
+
+    // Publish the starting state from this thread so GetCurrent is valid right away
+    Publish(Clock::now());
+    Acquire();
+    running.store(true, std::memory_order_release);
+    worker = std::thread(&SimulationThread::Run, this);
+}
+
+void SimulationThread::Stop()
+{
+    if (!worker.joinable())
+        return;
+    running.store(false, std::memory_order_release);
+    worker.join();
+
+    // The game is ours again; commands sent after the thread's last drain still count
+    Command command;
+    while (commands.Pop(command))
+        Apply(command);
+    Publish(Clock::now());
+    Acquire();
+}
+
+bool SimulationThread::SetDirection(Direction dir)
+{
+    Command command = { Command::Type::DIRECTION, dir, false, Clock::now() };
+    return commands.Push(command);
+}
+
+bool SimulationThread::SetPaused(bool paused)
+{
+    Command command = { Command::Type::PAUSE, Direction::RIGHT, paused, Clock::now() };
+    return commands.Push(command);
+}
+
+bool SimulationThread::Acquire()
+{
+    if (!states.HasNew())
+        return false;
+    // The outgoing state becomes the previous one; the previous one's storage goes back
+    // to the writer. Swapping moves the containers without copying them.
+    std::swap(previous, states.ReadSlot());
+    states.Acquire();
+    return true;
+}
+
+float SimulationThread::GetInterpolation(Clock::time_point now) const
+{
+    const SnakeRenderState& current = GetCurrent();
+    if (current.tickSeconds <= 0.0f)
+        return 1.0f;
+    float elapsed = std::chrono::duration<float>(now - current.tickTime).count();
+    return std::min(std::max(elapsed / current.tickSeconds, 0.0f), 1.0f);
+}
+
+void SimulationThread::Run()
+{
+    // Real time the game has been advanced to
+    Clock::time_point clock = Clock::now();
+    auto advanceTo = [&](Clock::time_point time)
+    {
+        if (time <= clock)
+            return;
+        float seconds = std::chrono::duration<float>(time - clock).count();
+        clock = time;
+        game->Update(seconds / speedFactor.load(std::memory_order_relaxed));
+    };
+
+    while (running.load(std::memory_order_acquire))
+    {
+        uint64_t tickBefore = game->GetTick();
+        bool changed = false;
+
+        // Catch the game up to each command's send time first, so inputs are stamped
+        // with the point between ticks at which they were made
+        Command command;
+        while (commands.Pop(command))
+        {
+            advanceTo(command.time);
+            Apply(command);
+            changed = true;
+        }
+        advanceTo(Clock::now());
+        if (changed || game->GetTick() != tickBefore)
+            Publish(clock);
+
+        if (game->IsGameOver() || game->IsGamePaused() || game->IsWaitingForStart())
+        {
+            // Nothing is due; only a command can change that
+            std::this_thread::sleep_for(IDLE_POLL);
+            continue;
+        }
+        float remaining = (game->GetMoveDelay() - game->GetMoveTimer()) * speedFactor.load(std::memory_order_relaxed);
+        WaitUntil(clock + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<float>(remaining)));
+    }
+}
+
+void SimulationThread::Apply(const Command& command)
+{
+    if (command.type == Command::Type::DIRECTION)
+        game->SetDirection(command.direction);
+    else
+        game->SetPaused(command.paused);
+}
+
+void SimulationThread::Publish(Clock::time_point clock)
+{
+    SNAKE_PROFILE_SCOPE("SimulationThread::Publish");
+    float speed = speedFactor.load(std::memory_order_relaxed);
+    SnakeRenderState& state = states.WriteSlot();
+    state.CopyFrom(*game);
+    // The last tick ran when the timer last wrapped, which was its leftover time ago
+    state.tickTime = clock - std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<float>(game->GetMoveTimer() * speed));
+    state.tickSeconds = game->GetMoveDelay() * speed;
+    states.Publish();
+}
+
+void SimulationThread::WaitUntil(Clock::time_point deadline)
+{
+    if (Clock::now() < deadline - SPIN_MARGIN)
+        std::this_thread::sleep_until(deadline - SPIN_MARGIN);
+    while (Clock::now() < deadline)
+        std::this_thread::yield();
+}
@@ -0,0 +1,78 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include "SnakeRenderState.h"
+#include "SpscQueue.h"
+#include "TripleBuffer.h"
+
+// Runs a game's ticks on a thread of its own, so the tick rate no longer depends on how
+// long the render loop takes to build and present a frame.
+//
+// After each tick the thread copies the game into a SnakeRenderState and publishes it
+// through a triple buffer; the render thread picks up the newest one each frame and
+// keeps the one before it for interpolation. Direction and pause commands go the other
+// way through a single-producer, single-consumer queue, each stamped with the time it
+// was sent. The game is advanced to that time before the command is applied, so input
+// latency is measured as if the game had been updated on the render thread.
+//
+// The thread sleeps until just before each tick is due and spins through the last
+// SPIN_MARGIN, since a plain sleep can overshoot by a whole scheduler quantum.
+class SimulationThread
+{
+public:
+    SimulationThread() = default;
+    ~SimulationThread();
+
+    SimulationThread(const SimulationThread&) = delete;
+    SimulationThread& operator=(const SimulationThread&) = delete;
+
+    // Starts ticking the game. Until Stop returns the thread owns it: the caller must not
+    // touch it apart from reading its grid size, and listeners run on the new thread.
+    void Start(SnakeGame& game);
+    // Joins the thread, then applies any commands it had not picked up yet
+    void Stop();
+    bool IsRunning() const { return worker.joinable(); }
+
+    // Real seconds per simulated second; may be changed while running
+    void SetSpeedFactor(float factor) { speedFactor.store(factor, std::memory_order_relaxed); }
+
+    // Called from one thread only; false if the command queue is full
+    bool SetDirection(Direction dir);
+    bool SetPaused(bool paused);
+
+    // Called from one thread only: takes the newest published state if there is one, and
+    // moves the state it replaces to GetPrevious(). Returns false if nothing was new.
+    bool Acquire();
+    const SnakeRenderState& GetCurrent() const { return states.ReadSlot(); }
+    const SnakeRenderState& GetPrevious() const { return previous; }
+    // Fraction of a tick that has passed since the current state's tick, in [0, 1]
+    float GetInterpolation(std::chrono::steady_clock::time_point now) const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Command
+    {
+        enum class Type : uint8_t { DIRECTION, PAUSE };
+        Type type;
+        Direction direction;
+        bool paused;
+        Clock::time_point time;
+    };
+
+    static const size_t COMMAND_CAPACITY = 64;
+
+    void Run();
+    void Apply(const Command& command);
+    void Publish(Clock::time_point clock);
+    static void WaitUntil(Clock::time_point deadline);
+
+    SnakeGame* game = nullptr;
+    std::thread worker;
+    std::atomic<bool> running{ false };
+    std::atomic<float> speedFactor{ 1.0f };
+    SpscQueue<Command, COMMAND_CAPACITY> commands;
+    TripleBuffer<SnakeRenderState> states;
+    SnakeRenderState previous;
+};
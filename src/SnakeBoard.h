@@ -0,0 +1,323 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+#include "BitOps.h"
+#include "Policies.h"
+#include "Random.h"
+#include "SnakeGame.h"
+
+// Single-snake game on a board whose size is fixed at compile time, for batch runs and
+// search bots on the standard small boards. Body and obstacles are bitboards of
+// WORDS 64-bit words, so every bounds check folds to a constant compare, a collision
+// is one AND over the board, the free-cell count is a popcount per word and food is
+// placed by selecting the n-th free bit.
+//
+// The rules are SnakeGame's for one snake: the same moves, growth, collisions, win,
+// obstacle pace and wrap-around, with obstacle 0 starting at (5, 5) on the game
+// generator and the rest on streams of their own. Only the choice of cell differs:
+// SnakeGame picks from its free-cell list, whose order depends on the game's history,
+// while this picks in row-major order, so the same seed plays a different game.
+// SnakeGame remains the engine for every other board size, the multiplayer rules,
+// input queueing, replays and the UI.
+template <int W, int H>
+class SnakeBoard
+{
+    static_assert(W >= 8 && H >= 8, "the start layout needs at least an 8x8 board");
+    static_assert(W * H <= 65536, "cells are stored as 16-bit indices");
+
+public:
+    static constexpr int WIDTH = W;
+    static constexpr int HEIGHT = H;
+    static constexpr int CELLS = W * H;
+    static constexpr int WORDS = (CELLS + 63) / 64;
+
+    explicit SnakeBoard(uint64_t seed = 0) { Reset(seed); }
+
+    // Moving obstacles placed by the next Reset, as in SnakeGame (default 1)
+    void SetObstacleCount(int count) { obstacleCount = count < 0 ? 0 : count; }
+
+    void Reset(uint64_t newSeed);
+    // Next game, seeded from this one's generator
+    void Reset() { Reset(rng.NextU64()); }
+
+    // Turn taken by the next Step; a reversal of the heading is ignored. There is one
+    // pending turn rather than SnakeGame's queue, so the last call before a Step wins.
+    void SetDirection(Direction dir)
+    {
+        if (!IsOppositeDirection(dir, direction))
+            pending = dir;
+    }
+    void Step();
+
+    bool IsGameOver() const { return gameOver; }
+    bool IsGameWon() const { return gameWon; }
+    int GetScore() const { return score; }
+    uint64_t GetTick() const { return tick; }
+    uint64_t GetSeed() const { return seed; }
+    Direction GetDirection() const { return direction; }
+    int GetLength() const { return length; }
+    Segment GetHead() const { return ToSegment(ring[headSlot]); }
+    Segment GetTail() const { return ToSegment(ring[Slot(length - 1)]); }
+    Segment GetFood() const { return ToSegment(food); }
+    int GetObstacleCount() const { return static_cast<int>(obstacles.size()); }
+    Segment GetObstacle(int index) const { return ToSegment(obstacles[index].cell); }
+
+    static constexpr bool InBounds(int x, int y) { return x >= 0 && y >= 0 && x < W && y < H; }
+    bool HasBody(int x, int y) const { return InBounds(x, y) && Test(body, Cell(x, y)); }
+    bool HasObstacle(int x, int y) const { return InBounds(x, y) && Test(obstacleBits, Cell(x, y)); }
+    // Cells that are neither body nor obstacle
+    int GetFreeCount() const;
+
+private:
+    using Bits = std::array<uint64_t, WORDS>;
+
+    struct Obstacle
+    {
+        uint16_t cell;
+        uint8_t moveTimer;
+        Pcg32 generator;  // Unused by obstacle 0, which draws from the game generator
+    };
+
+    static const uint64_t OBSTACLE_PLACEMENT_STREAM = 0x6F627374;  // SnakeGame's, so counts behave alike
+    static const int OBSTACLE_CLEARANCE = 4;
+    static const int PLACEMENT_ATTEMPTS = 16;
+    static const int OBSTACLE_TICKS = 2;
+
+    static constexpr int Cell(int x, int y) { return y * W + x; }
+    static constexpr Segment ToSegment(int cell) { return { cell % W, cell / W }; }
+    // Valid cells of each word; only the last word can be partial
+    static constexpr uint64_t WordMask(int word)
+    {
+        return (word < WORDS - 1 || CELLS % 64 == 0) ? ~uint64_t(0) : (uint64_t(1) << (CELLS % 64)) - 1;
+    }
+    static bool Test(const Bits& bits, int cell) { return (bits[cell >> 6] >> (cell & 63)) & 1; }
+    static void Set(Bits& bits, int cell) { bits[cell >> 6] |= uint64_t(1) << (cell & 63); }
+    static void Clear(Bits& bits, int cell) { bits[cell >> 6] &= ~(uint64_t(1) << (cell & 63)); }
+
+    int Slot(int index) const { return (headSlot + index) % CELLS; }
+    bool ObstacleOnBody() const;
+    // The n-th free cell in row-major order; n must be below GetFreeCount()
+    int SelectFree(int n) const;
+    void PlaceObstacles();
+    void MoveObstacles();
+    void SpawnFood();
+
+    Bits body;
+    Bits obstacleBits;
+    std::array<uint16_t, CELLS> ring;  // Body cells, head at headSlot
+    int headSlot = 0;
+    int length = 0;
+    std::vector<Obstacle> obstacles;
+    int obstacleCount = 1;
+    uint16_t food = 0;
+    Direction direction = Direction::RIGHT;
+    Direction pending = Direction::RIGHT;
+    Pcg32 rng;
+    uint64_t seed = 0;
+    uint64_t tick = 0;
+    int score = 0;
+    bool gameOver = false;
+    bool gameWon = false;
+};
+
+template <int W, int H> constexpr int SnakeBoard<W, H>::WIDTH;
+template <int W, int H> constexpr int SnakeBoard<W, H>::HEIGHT;
+template <int W, int H> constexpr int SnakeBoard<W, H>::CELLS;
+template <int W, int H> constexpr int SnakeBoard<W, H>::WORDS;
+
+template <int W, int H>
+void SnakeBoard<W, H>::Reset(uint64_t newSeed)
+{
+    seed = newSeed;
+    rng.Seed(seed);
+    body.fill(0);
+    obstacleBits.fill(0);
+    headSlot = 0;
+    length = 3;
+    for (int i = 0; i < length; ++i)
+    {
+        ring[i] = static_cast<uint16_t>(Cell(W / 2 - i, H / 2));
+        Set(body, ring[i]);
+    }
+    direction = pending = Direction::RIGHT;
+    tick = 0;
+    score = 0;
+    gameOver = gameWon = false;
+    PlaceObstacles();
+    SpawnFood();
+}
+
+template <int W, int H>
+void SnakeBoard<W, H>::Step()
+{
+    if (gameOver)
+        return;
+    direction = pending;
+    Segment head = StepCell(GetHead(), direction);
+    ++tick;
+    if (!InBounds(head.x, head.y))
+    {
+        gameOver = true;
+        return;
+    }
+
+    int cell = Cell(head.x, head.y);
+    bool bodyHit;
+    headSlot = (headSlot + CELLS - 1) % CELLS;
+    if (cell == food)
+    {
+        // Food only spawns on free cells, so growing never lands on the body
+        ++length;
+        ring[headSlot] = static_cast<uint16_t>(cell);
+        Set(body, cell);
+        score += 10;
+        bodyHit = false;
+        SpawnFood();
+    }
+    else
+    {
+        // The tail leaves before the head arrives, so following it is safe
+        Clear(body, ring[Slot(length)]);
+        ring[headSlot] = static_cast<uint16_t>(cell);
+        bodyHit = Test(body, cell);
+        Set(body, cell);
+    }
+
+    // An obstacle on any body cell, whether the head ran into it or it moved onto the
+    // body last tick and is still there, ends the game just as in SnakeGame
+    if (bodyHit || ObstacleOnBody())
+        gameOver = true;
+    if (!gameOver)
+        MoveObstacles();
+}
+
+template <int W, int H>
+int SnakeBoard<W, H>::GetFreeCount() const
+{
+    int count = 0;
+    for (int w = 0; w < WORDS; ++w)
+        count += BitOps::PopCount(~(body[w] | obstacleBits[w]) & WordMask(w));
+    return count;
+}
+
+template <int W, int H>
+bool SnakeBoard<W, H>::ObstacleOnBody() const
+{
+    uint64_t overlap = 0;
+    for (int w = 0; w < WORDS; ++w)
+        overlap |= body[w] & obstacleBits[w];
+    return overlap != 0;
+}
+
+template <int W, int H>
+int SnakeBoard<W, H>::SelectFree(int n) const
+{
+    for (int w = 0; w < WORDS; ++w)
+    {
+        uint64_t free = ~(body[w] | obstacleBits[w]) & WordMask(w);
+        int count = BitOps::PopCount(free);
+        if (n < count)
+            return w * 64 + BitOps::SelectBit(free, n);
+        n -= count;
+    }
+    return -1;
+}
+
+template <int W, int H>
+void SnakeBoard<W, H>::PlaceObstacles()
+{
+    obstacles.clear();
+    if (obstacleCount > 0)
+    {
+        obstacles.push_back({ static_cast<uint16_t>(Cell(5, 5)), 0, Pcg32() });
+        Set(obstacleBits, Cell(5, 5));
+    }
+
+    Pcg32 placement(seed, OBSTACLE_PLACEMENT_STREAM);
+    Segment head = GetHead();
+    int freeCount;
+    while (static_cast<int>(obstacles.size()) < obstacleCount && (freeCount = GetFreeCount()) > 1)
+    {
+        int cell = 0;
+        for (int attempt = 0; attempt < PLACEMENT_ATTEMPTS; ++attempt)
+        {
+            cell = SelectFree(static_cast<int>(placement.NextBounded(static_cast<uint32_t>(freeCount))));
+            if (std::abs(cell % W - head.x) + std::abs(cell / W - head.y) >= OBSTACLE_CLEARANCE)
+                break;
+        }
+        uint64_t stream = obstacles.size();
+        obstacles.push_back({ static_cast<uint16_t>(cell), 0, Pcg32(seed, stream) });
+        Set(obstacleBits, cell);
+    }
+}
+
+template <int W, int H>
+void SnakeBoard<W, H>::MoveObstacles()
+{
+    // Moves apply in index order and a move onto another obstacle is skipped, as in
+    // SnakeGame; a move onto the body is caught by the next tick's overlap test
+    for (size_t i = 0; i < obstacles.size(); ++i)
+    {
+        Obstacle& obstacle = obstacles[i];
+        if (++obstacle.moveTimer < OBSTACLE_TICKS)
+            continue;
+        obstacle.moveTimer = 0;
+
+        Pcg32& generator = i == 0 ? rng : obstacle.generator;
+        Segment target = StepCell(ToSegment(obstacle.cell), static_cast<Direction>(generator.NextBounded(4)));
+        target.x = target.x < 0 ? W - 1 : target.x >= W ? 0 : target.x;
+        target.y = target.y < 0 ? H - 1 : target.y >= H ? 0 : target.y;
+        int cell = Cell(target.x, target.y);
+        if (Test(obstacleBits, cell))
+            continue;
+        Clear(obstacleBits, obstacle.cell);
+        Set(obstacleBits, cell);
+        obstacle.cell = static_cast<uint16_t>(cell);
+    }
+}
+
+template <int W, int H>
+void SnakeBoard<W, H>::SpawnFood()
+{
+    int freeCount = GetFreeCount();
+    if (freeCount == 0)
+    {
+        gameWon = true;
+        gameOver = true;
+        return;
+    }
+    food = static_cast<uint16_t>(SelectFree(static_cast<int>(rng.NextBounded(static_cast<uint32_t>(freeCount)))));
+}
+
+// GreedyPolicy for a SnakeBoard: towards the food, skipping walls, obstacles and the
+// body except its tail, with the same preference order
+template <int W, int H>
+Direction BoardGreedyPolicy(const SnakeBoard<W, H>& board)
+{
+    const Direction order[4] = { Direction::UP, Direction::DOWN, Direction::LEFT, Direction::RIGHT };
+    Segment head = board.GetHead();
+    Segment food = board.GetFood();
+    Segment tail = board.GetTail();
+
+    Direction best = board.GetDirection();
+    int bestDistance = -1;
+    for (Direction dir : order)
+    {
+        if (IsOppositeDirection(dir, board.GetDirection()))
+            continue;
+        Segment next = StepCell(head, dir);
+        if (!board.InBounds(next.x, next.y) || board.HasObstacle(next.x, next.y))
+            continue;
+        if (board.HasBody(next.x, next.y) && !(next.x == tail.x && next.y == tail.y))
+            continue;
+        int distance = std::abs(next.x - food.x) + std::abs(next.y - food.y);
+        if (bestDistance < 0 || distance < bestDistance)
+        {
+            best = dir;
+            bestDistance = distance;
+        }
+    }
+    return best;
+}
@@ -0,0 +1,139 @@
+#pragma once
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <iterator>
+#include <vector>
+
+struct Segment {
+    int x, y;
+};
+
+// Fixed-capacity circular buffer holding the snake from head (index 0) to tail.
+// Storage is allocated once in Init() or Reserve(), so moving and growing never allocate.
+class SnakeBody
+{
+public:
+    class ConstIterator
+    {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = Segment;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const Segment*;
+        using reference = const Segment&;
+
+        ConstIterator(const SnakeBody* body, int index) : body(body), index(index) {}
+
+        reference operator*() const { return (*body)[index]; }
+        pointer operator->() const { return &(*body)[index]; }
+        ConstIterator& operator++() { ++index; return *this; }
+        ConstIterator operator++(int) { ConstIterator tmp = *this; ++index; return tmp; }
+        bool operator==(const ConstIterator& other) const { return index == other.index; }
+        bool operator!=(const ConstIterator& other) const { return index != other.index; }
+
+    private:
+        const SnakeBody* body;
+        int index;
+    };
+
+    SnakeBody() : head(0), count(0) {}
+
+    void Init(int capacity)
+    {
+        cells.assign(capacity, Segment{ 0, 0 });
+        head = 0;
+        count = 0;
+    }
+
+    void Clear()
+    {
+        head = 0;
+        count = 0;
+    }
+
+    // Adds a new head in front of the current one
+    void PushFront(Segment segment)
+    {
+        assert(count < Capacity());
+        if (--head < 0)
+            head = Capacity() - 1;
+        cells[head] = segment;
+        ++count;
+    }
+
+    // Appends a segment behind the current tail (used to lay out the initial snake)
+    void PushBack(Segment segment)
+    {
+        assert(count < Capacity());
+        ++count;
+        cells[Wrap(head + count - 1)] = segment;
+    }
+
+    void PopBack()
+    {
+        assert(count > 0);
+        --count;
+    }
+
+    // Copies the live segments, head first, into out[0 .. Size())
+    void CopyTo(Segment* out) const
+    {
+        int firstRun = std::min(count, Capacity() - head);
+        std::memcpy(out, &cells[head], sizeof(Segment) * firstRun);
+        std::memcpy(out + firstRun, cells.data(), sizeof(Segment) * (count - firstRun));
+    }
+
+    // Replaces the body with segments[0 .. segmentCount), head first
+    void Assign(const Segment* segments, int segmentCount)
+    {
+        assert(segmentCount <= Capacity());
+        head = 0;
+        count = segmentCount;
+        std::memcpy(cells.data(), segments, sizeof(Segment) * segmentCount);
+    }
+
+    // Grows the storage to at least `capacity` slots, keeping the segments. For bodies
+    // created after their game, which sizes them before they first move.
+    void Reserve(int capacity)
+    {
+        if (capacity <= Capacity())
+            return;
+        std::vector<Segment> grown(capacity);
+        if (count > 0)
+            CopyTo(grown.data());
+        cells.swap(grown);
+        head = 0;
+    }
+
+    // Copies another body's live segments, head first. Storage grows (doubling) only when
+    // the other body is longer than this capacity, so repeated copies of a growing snake
+    // allocate rarely and a short snake on a big board never pays for the whole board.
+    void CopyFrom(const SnakeBody& other)
+    {
+        if (Capacity() < other.count)
+            cells.resize(std::max(other.count, Capacity() * 2));
+        other.CopyTo(cells.data());
+        head = 0;
+        count = other.count;
+    }
+
+    // Index 0 is the head, Size() - 1 is the tail
+    const Segment& operator[](int index) const { return cells[Wrap(head + index)]; }
+    const Segment& Head() const { return cells[head]; }
+    const Segment& Tail() const { return (*this)[count - 1]; }
+
+    int Size() const { return count; }
+    int Capacity() const { return static_cast<int>(cells.size()); }
+    bool Empty() const { return count == 0; }
+
+    ConstIterator begin() const { return ConstIterator(this, 0); }
+    ConstIterator end() const { return ConstIterator(this, count); }
+
+private:
+    int Wrap(int index) const { return index >= Capacity() ? index - Capacity() : index; }
+
+    std::vector<Segment> cells;
+    int head;   // Slot holding the head segment
+    int count;  // Number of live segments
+};
@@ -1,215 +1,920 @@
 #include "SnakeGame.h"
+#include "ByteStream.h"
+#include "Profiler.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <cassert>
 #include <cstdlib>
-#include <ctime>
-#include <imgui.h>
+#include <cstring>
 
-SnakeGame::SnakeGame(int gridWidth, int gridHeight)
-    : gridWidth(gridWidth), gridHeight(gridHeight), score(0),
-    gameOver(false), paused(false), waitingForStart(true), moveTimer(0.0f), moveDelay(0.1f),
-    currentDir(Direction::RIGHT), nextDir(Direction::RIGHT), obstacleDelay(0.3f)
+namespace
 {
-    srand(static_cast<unsigned>(time(0)));
+const uint32_t STATE_MAGIC = 0x534E4B53;  // "SNKS"
+// Version 1 had exactly one obstacle and no count; versions 1 and 2 stored a single
+// pending direction where version 3 stores the input queue; version 4 appends the
+// snakes after the first
+const uint16_t STATE_VERSION = 4;
 
-    // Initialize snake with 3 segments
-    snake.push_back({ gridWidth / 2, gridHeight / 2 });
-    snake.push_back({ gridWidth / 2 - 1, gridHeight / 2 });
-    snake.push_back({ gridWidth / 2 - 2, gridHeight / 2 });
+const uint64_t OBSTACLE_PLACEMENT_STREAM = 0x6F627374;  // "obst"; obstacle i moves on stream i
+const int OBSTACLE_CLEARANCE = 4;   // Minimum Manhattan distance from the head at spawn
+const int PLACEMENT_ATTEMPTS = 16;  // Random picks before a spawn cell near the head is accepted
+const uint64_t SNAKE_PLACEMENT_STREAM = 0x736E616B;  // "snak"
+const int SNAKE_PLACEMENT_ATTEMPTS = 64;  // Random picks before the board counts as full
+const int SPAWN_LENGTH = 3;
 
-    // Initialize moving obstacle
-    obstacle.x = 5;
-    obstacle.y = 5;
-    obstacle.direction = Direction::RIGHT;
-    obstacle.moveTimer = 0.0f;
+// Fixed part of a native snapshot. It is followed by the obstacle generators, one
+// SnapshotSnake per snake, the bodies (each head first, one after another), the
+// free-cell slot map (W*H ints), the free-cell members (W*H ints), the obstacles, the
+// pending obstacle contacts and the occupancy bytes (W*H), each region sized for the
+// whole board, obstacle pool and snake count so offsets never change. Bodies only
+// overlap at the heads, so W*H segments plus one per snake always hold them all.
+struct SnapshotHeader
+{
+    uint64_t seed;
+    uint64_t rngState, rngIncrement;
+    uint64_t tick;
+    int32_t gridWidth, gridHeight;
+    int32_t freeCount;
+    int32_t obstacleCount, contactCount;
+    int32_t snakeCount, aliveCount;
+    Segment food;
+    float moveTimer;
+    uint8_t gameOver, gameWon, paused, waitingForStart;
+};
 
-    SpawnFood();
-}
+struct SnapshotSnake
+{
+    int32_t bodyCount;
+    int32_t score;
+    Direction direction;
+    InputQueue inputs;
+    uint8_t alive;
+};
 
-void SnakeGame::Update(float deltaTime)
+struct SnapshotLayout
 {
-    if (gameOver || paused || waitingForStart) return;
+    size_t rngs, snakes, body, slots, members, obstacles, contacts, occupancy, total;
 
-    moveTimer += deltaTime;
-    if (moveTimer >= moveDelay)
+    SnapshotLayout(int cellCount, int obstacleCount, int snakeCount)
     {
-        moveTimer = 0.0f;
-        currentDir = nextDir;
-        MoveSnake();
-        CheckCollisions();
+        rngs = (sizeof(SnapshotHeader) + 7) / 8 * 8;
+        snakes = rngs + sizeof(Pcg32) * obstacleCount;
+        body = snakes + (sizeof(SnapshotSnake) * snakeCount + 7) / 8 * 8;
+        slots = body + sizeof(Segment) * (static_cast<size_t>(cellCount) + snakeCount);
+        members = slots + sizeof(int) * cellCount;
+        obstacles = members + sizeof(int) * cellCount;
+        contacts = obstacles + sizeof(MovingBlock) * obstacleCount;
+        occupancy = contacts + sizeof(int) * obstacleCount;
+        total = occupancy + static_cast<size_t>(cellCount);
     }
+};
 
-    // Update obstacle movement
-    UpdateMovingBlock();
+bool IsReversal(Direction from, Direction to)
+{
+    return (from == Direction::UP && to == Direction::DOWN) ||
+        (from == Direction::DOWN && to == Direction::UP) ||
+        (from == Direction::LEFT && to == Direction::RIGHT) ||
+        (from == Direction::RIGHT && to == Direction::LEFT);
+}
+
+// A snake after the first, decoded by LoadState before anything is committed
+struct LoadedSnake
+{
+    int score = 0;
+    Direction direction = Direction::RIGHT;
+    InputQueue inputs;
+    int bodySize = 0;
+    const uint8_t* bodyData = nullptr;
+};
+
+void PutBody(ByteWriter& writer, const SnakeBody& body)
+{
+    writer.PutU32(static_cast<uint32_t>(body.Size()));
+    for (const auto& segment : body)
+    {
+        writer.PutU32(static_cast<uint32_t>(segment.x));
+        writer.PutU32(static_cast<uint32_t>(segment.y));
+    }
 }
 
-void SnakeGame::Render(ImDrawList* drawList, ImVec2 canvasPos, float cellSize)
+// What LoadState finds on each cell of a saved board while checking its free list
+const uint8_t CELL_BODY = 1;
+const uint8_t CELL_OBSTACLE = 2;
+const uint8_t CELL_LISTED_FREE = 4;
+
+// Marks a saved body's cells; false if a segment off the board is not the head, the only
+// one that can have just left it
+bool MarkBody(const uint8_t* data, int size, int gridWidth, int gridHeight, std::vector<uint8_t>& cells)
 {
-    ImU32 snakeColor = ImGui::GetColorU32(ImVec4(0.0f, 1.0f, 0.0f, 1.0f));
-    ImU32 foodColor = ImGui::GetColorU32(ImVec4(1.0f, 0.0f, 0.0f, 1.0f));
-    ImU32 obstacleColor = ImGui::GetColorU32(ImVec4(1.0f, 0.5f, 0.0f, 1.0f));  // Orange
-    ImU32 gridColor = ImGui::GetColorU32(ImVec4(0.3f, 0.3f, 0.3f, 1.0f));
+    ByteReader reader(data, static_cast<size_t>(size) * 8);
+    for (int i = 0; i < size; ++i)
+    {
+        int x = static_cast<int>(reader.GetU32());
+        int y = static_cast<int>(reader.GetU32());
+        if (x < 0 || x >= gridWidth || y < 0 || y >= gridHeight)
+        {
+            if (i > 0)
+                return false;
+            continue;
+        }
+        cells[static_cast<size_t>(y) * gridWidth + x] |= CELL_BODY;
+    }
+    return true;
+}
 
-    // Draw grid
-    for (int i = 0; i <= gridWidth; ++i)
+Segment Advance(Segment cell, Direction dir, int distance)
+{
+    switch (dir)
     {
-        ImVec2 start(canvasPos.x + i * cellSize, canvasPos.y);
-        ImVec2 end(canvasPos.x + i * cellSize, canvasPos.y + gridHeight * cellSize);
-        drawList->AddLine(start, end, gridColor, 1.0f);
+    case Direction::UP:    cell.y -= distance; break;
+    case Direction::DOWN:  cell.y += distance; break;
+    case Direction::LEFT:  cell.x -= distance; break;
+    case Direction::RIGHT: cell.x += distance; break;
     }
-    for (int i = 0; i <= gridHeight; ++i)
+    return cell;
+}
+}
+
+SnakeGame::SnakeGame(int gridWidth, int gridHeight, uint64_t seed)
+    : rng(seed), seed(seed), snakes(1), gridWidth(gridWidth), gridHeight(gridHeight), aliveCount(0),
+    gameOver(false), paused(false), gameWon(false), waitingForStart(true), tick(0), moveTimer(0.0f),
+    moveDelay(0.1f), obstacleTicks(2), obstacleCount(1), snakeCount(1), obstaclePool(nullptr), bufferedInput(true)
+{
+    // The body can never outgrow the board, so size the ring buffer once here. Other
+    // snakes get the same storage when they are first placed.
+    snakes[0].body.Init(gridWidth * gridHeight);
+    occupancy.Init(gridWidth, gridHeight);
+    freeCells.Init(gridWidth * gridHeight);
+
+    Reset(seed);
+}
+
+void SnakeGame::Update(float deltaTime)
+{
+    if (gameOver || paused || waitingForStart) return;
+    SNAKE_PROFILE_SCOPE("SnakeGame::Update");
+
+    // Run as many whole ticks as the accumulated time allows and carry the remainder
+    moveTimer += deltaTime;
+    int ticksRun = 0;
+    while (moveTimer >= moveDelay && !gameOver)
     {
-        ImVec2 start(canvasPos.x, canvasPos.y + i * cellSize);
-        ImVec2 end(canvasPos.x + gridWidth * cellSize, canvasPos.y + i * cellSize);
-        drawList->AddLine(start, end, gridColor, 1.0f);
+        moveTimer -= moveDelay;
+        Step();
+
+        // Drop the backlog after a long stall (debugger, window drag) instead of fast-forwarding
+        if (++ticksRun >= MAX_TICKS_PER_UPDATE)
+        {
+            if (moveTimer >= moveDelay)
+                moveTimer = 0.0f;
+            break;
+        }
     }
+}
 
-    // Draw snake
-    for (const auto& segment : snake)
+void SnakeGame::Step()
+{
+    if (gameOver || waitingForStart) return;
+    SNAKE_PROFILE_SCOPE("SnakeGame::Step");
+
+    for (SnakeGameListener* listener : listeners)
+        listener->OnBeforeTick(*this);
+
+    for (SnakePlayer& player : snakes)
     {
-        ImVec2 min(canvasPos.x + segment.x * cellSize, canvasPos.y + segment.y * cellSize);
-        ImVec2 max(min.x + cellSize, min.y + cellSize);
-        drawList->AddRectFilled(min, max, snakeColor);
+        // Filling the board ends the game before the remaining snakes move
+        if (gameOver)
+            break;
+        if (!player.alive)
+            continue;
+        ApplyNextInput(player);
+        MoveSnake(player);
     }
+    CheckCollisions();
+    ++tick;
 
-    // Draw food
-    ImVec2 foodMin(canvasPos.x + food.x * cellSize, canvasPos.y + food.y * cellSize);
-    ImVec2 foodMax(foodMin.x + cellSize, foodMin.y + cellSize);
-    drawList->AddRectFilled(foodMin, foodMax, foodColor);
+    // Update obstacle movement
+    if (!gameOver)
+        UpdateObstacles();
 
-    // Draw moving obstacle (orange block)
-    ImVec2 obstacleMin(canvasPos.x + obstacle.x * cellSize, canvasPos.y + obstacle.y * cellSize);
-    ImVec2 obstacleMax(obstacleMin.x + cellSize, obstacleMin.y + cellSize);
-    drawList->AddRectFilled(obstacleMin, obstacleMax, obstacleColor);
-    // Add border to obstacle to make it more visible
-    drawList->AddRect(obstacleMin, obstacleMax, ImGui::GetColorU32(ImVec4(1.0f, 1.0f, 0.0f, 1.0f)), 0.0f, 15, 2.0f);
+    for (SnakeGameListener* listener : listeners)
+        listener->OnTick(*this);
 }
 
-void SnakeGame::SetDirection(Direction dir)
+void SnakeGame::SetDirection(int snake, Direction dir)
 {
+    if (snake == 0)
+    {
+        for (SnakeGameListener* listener : listeners)
+            listener->OnDirectionInput(*this, dir);
+    }
+    SnakePlayer& player = snakes[snake];
+    InputQueue& inputs = player.inputs;
+
     // If waiting for start, start the game on first arrow input
     if (waitingForStart)
     {
         waitingForStart = false;
-        currentDir = dir;
-        nextDir = dir;
+        player.direction = dir;
+        inputs.Clear();
         return;
     }
 
-    // Prevent snake from reversing into itself
-    if ((currentDir == Direction::UP && dir == Direction::DOWN) ||
-        (currentDir == Direction::DOWN && dir == Direction::UP) ||
-        (currentDir == Direction::LEFT && dir == Direction::RIGHT) ||
-        (currentDir == Direction::RIGHT && dir == Direction::LEFT))
+    InputQueue::Entry input = { dir, tick, moveTimer };
+    if (!bufferedInput)
+    {
+        // Prevent snake from reversing into itself; the newest input replaces any pending one
+        if (IsReversal(player.direction, dir))
+            return;
+        inputs.Clear();
+        if (dir != player.direction)
+            inputs.PushBack(input);
+        return;
+    }
+
+    // Check against the last queued direction rather than the current one, so Right,
+    // Up, Left within one tick is two turns and never a reversal
+    Direction last = inputs.Empty() ? player.direction : inputs.Back().direction;
+    if (dir == last || IsReversal(last, dir))
+        return;
+    if (inputs.Full())
+    {
+        ++player.inputLatency.dropped;
+        return;
+    }
+    inputs.PushBack(input);
+}
+
+void SnakeGame::ApplyNextInput(SnakePlayer& player)
+{
+    InputQueue& inputs = player.inputs;
+    if (inputs.Empty())
         return;
 
-    nextDir = dir;
+    // The input waited from its arrival until the end of the tick that applies it
+    const InputQueue::Entry& input = inputs.Front();
+    int ticks = static_cast<int>(tick - input.tick) + 1;
+    float seconds = std::max(ticks * moveDelay - input.timer, 0.0f);
+    player.direction = input.direction;
+    inputs.PopFront();
+
+    InputLatencyStats& stats = player.inputLatency;
+    ++stats.applied;
+    stats.lastTicks = ticks;
+    stats.lastSeconds = seconds;
+    stats.maxTicks = std::max(stats.maxTicks, ticks);
+    stats.maxSeconds = std::max(stats.maxSeconds, seconds);
+    stats.totalTicks += ticks;
+    stats.totalSeconds += seconds;
+}
+
+void SnakeGame::Reset(uint64_t newSeed)
+{
+    seed = newSeed;
+    rng.Seed(seed);
+    ResetBoard();
 }
 
 void SnakeGame::Reset()
 {
-    snake.clear();
-    snake.push_back({ gridWidth / 2, gridHeight / 2 });
-    snake.push_back({ gridWidth / 2 - 1, gridHeight / 2 });
-    snake.push_back({ gridWidth / 2 - 2, gridHeight / 2 });
+    // Derive the next game's seed from this one so every game can be replayed from its seed
+    Reset(rng.NextU64());
+}
+
+void SnakeGame::ResetBoard()
+{
+    occupancy.Clear();
+    freeCells.Fill();
+    PlaceSnakes();
 
-    score = 0;
     gameOver = false;
+    gameWon = false;
     paused = false;
     waitingForStart = true;  // Reset waiting for start flag
+    tick = 0;
     moveTimer = 0.0f;
-    currentDir = Direction::RIGHT;
-    nextDir = Direction::RIGHT;
-
-    // Reset obstacle
-    obstacle.x = 5;
-    obstacle.y = 5;
-    obstacle.direction = Direction::RIGHT;
-    obstacle.moveTimer = 0.0f;
 
+    PlaceObstacles();
     SpawnFood();
 }
 
-void SnakeGame::StartGame()
+void SnakeGame::PlaceSnakes()
 {
-    waitingForStart = false;
+    // Every body is sized for the whole board the first time its snake is placed and keeps
+    // that storage across games, so neither Step nor Restore ever allocates
+    snakes.resize(snakeCount);
+    for (SnakePlayer& player : snakes)
+    {
+        player.body.Reserve(gridWidth * gridHeight);
+        player.body.Clear();
+        player.direction = Direction::RIGHT;
+        player.inputs.Clear();
+        player.inputLatency = InputLatencyStats();
+        player.score = 0;
+        player.alive = true;
+    }
+
+    SnakeBody& body = snakes[0].body;
+    body.PushBack({ gridWidth / 2, gridHeight / 2 });
+    body.PushBack({ gridWidth / 2 - 1, gridHeight / 2 });
+    body.PushBack({ gridWidth / 2 - 2, gridHeight / 2 });
+    for (const auto& segment : body)
+        AddBodySegment(segment);
+
+    // Each other snake needs its body and the two cells ahead of its head free. The
+    // placement stream is separate from the game generator, so the food of a
+    // single-snake game is unaffected.
+    Pcg32 placement(seed, SNAKE_PLACEMENT_STREAM);
+    int placed = 1;
+    for (; placed < snakeCount; ++placed)
+    {
+        bool found = false;
+        for (int attempt = 0; attempt < SNAKE_PLACEMENT_ATTEMPTS && !found && !freeCells.Empty(); ++attempt)
+        {
+            int cell = freeCells.At(static_cast<int>(placement.NextBounded(static_cast<uint32_t>(freeCells.Size()))));
+            Direction heading = static_cast<Direction>(placement.NextBounded(4));
+            Segment head = { cell % gridWidth, cell / gridWidth };
+            found = true;
+            for (int offset = 1 - SPAWN_LENGTH; offset <= 2 && found; ++offset)
+            {
+                Segment check = Advance(head, heading, offset);
+                found = occupancy.InBounds(check.x, check.y) && !occupancy.HasBody(check.x, check.y);
+            }
+            if (!found)
+                continue;
+
+            SnakePlayer& player = snakes[placed];
+            player.direction = heading;
+            for (int i = 0; i < SPAWN_LENGTH; ++i)
+            {
+                player.body.PushBack(Advance(head, heading, -i));
+                AddBodySegment(player.body.Tail());
+            }
+        }
+        if (!found)
+            break;
+    }
+    snakes.resize(placed);
+    aliveCount = placed;
+    deaths.reserve(snakes.size());
 }
 
-void SnakeGame::SpawnFood()
+void SnakeGame::PlaceObstacles()
 {
-    bool validPosition = false;
-    while (!validPosition)
+    obstacles.clear();
+    obstacleRngs.clear();
+    obstacleContacts.clear();
+    if (obstacleCount > 0)
     {
-        food.x = rand() % gridWidth;
-        food.y = rand() % gridHeight;
+        obstacles.push_back({ 5, 5, Direction::RIGHT, 0 });
+        obstacleRngs.emplace_back();
+        SetObstacleCell(5, 5, true);
+    }
 
-        validPosition = true;
-        for (const auto& segment : snake)
+    // The rest go on random free cells, always leaving one for the food. Placement has its
+    // own stream so the game generator (and so the food) is unaffected by the count
+    Pcg32 placement(seed, OBSTACLE_PLACEMENT_STREAM);
+    const Segment& head = snakes[0].body.Head();
+    while (static_cast<int>(obstacles.size()) < obstacleCount && freeCells.Size() > 1)
+    {
+        int cell = 0;
+        for (int attempt = 0; attempt < PLACEMENT_ATTEMPTS; ++attempt)
         {
-            if (segment.x == food.x && segment.y == food.y)
-            {
-                validPosition = false;
+            cell = freeCells.At(static_cast<int>(placement.NextBounded(static_cast<uint32_t>(freeCells.Size()))));
+            if (std::abs(cell % gridWidth - head.x) + std::abs(cell / gridWidth - head.y) >= OBSTACLE_CLEARANCE)
                 break;
-            }
         }
-        // Also make sure food doesn't spawn on obstacle
-        if (obstacle.x == food.x && obstacle.y == food.y)
-            validPosition = false;
+        uint64_t stream = obstacles.size();
+        obstacles.push_back({ cell % gridWidth, cell / gridWidth, Direction::RIGHT, 0 });
+        obstacleRngs.emplace_back(seed, stream);
+        SetObstacleCell(cell % gridWidth, cell / gridWidth, true);
     }
+    obstacleTargets.resize(obstacles.size());
+    // An obstacle is listed at most once between collision checks
+    obstacleContacts.reserve(obstacles.size());
+    FindObstacleContacts();
+}
+
+void SnakeGame::StartGame()
+{
+    waitingForStart = false;
 }
 
-void SnakeGame::UpdateMovingBlock()
+void SnakeGame::SaveState(std::vector<uint8_t>& out) const
 {
-    obstacle.moveTimer += 0.032f;  // Approximately 60 FPS
+    out.clear();
+    ByteWriter writer(out);
+    writer.PutU32(STATE_MAGIC);
+    writer.PutU16(STATE_VERSION);
+    writer.PutU32(static_cast<uint32_t>(gridWidth));
+    writer.PutU32(static_cast<uint32_t>(gridHeight));
+    writer.PutU64(seed);
+    writer.PutU64(rng.GetState());
+    writer.PutU64(rng.GetIncrement());
+    writer.PutU64(tick);
+    const SnakePlayer& player = snakes[0];
+    writer.PutU32(static_cast<uint32_t>(player.score));
+    writer.PutU8(static_cast<uint8_t>((gameOver ? 1 : 0) | (gameWon ? 2 : 0) | (paused ? 4 : 0) | (waitingForStart ? 8 : 0)));
+    writer.PutU8(static_cast<uint8_t>(player.direction));
+    writer.PutU8(static_cast<uint8_t>(player.inputs.Size()));
+    for (int i = 0; i < player.inputs.Size(); ++i)
+        writer.PutU8(static_cast<uint8_t>(player.inputs[i].direction));
+    writer.PutU32(static_cast<uint32_t>(food.x));
+    writer.PutU32(static_cast<uint32_t>(food.y));
+    writer.PutU32(static_cast<uint32_t>(obstacles.size()));
+    for (size_t i = 0; i < obstacles.size(); ++i)
+    {
+        writer.PutU32(static_cast<uint32_t>(obstacles[i].x));
+        writer.PutU32(static_cast<uint32_t>(obstacles[i].y));
+        writer.PutU8(static_cast<uint8_t>(obstacles[i].direction));
+        writer.PutU32(static_cast<uint32_t>(obstacles[i].moveTimer));
+        if (i > 0)
+        {
+            writer.PutU64(obstacleRngs[i].GetState());
+            writer.PutU64(obstacleRngs[i].GetIncrement());
+        }
+    }
+
+    // Body from head to tail; the head may sit one cell outside the board after a wall hit
+    PutBody(writer, player.body);
+
+    // Free cells in slot order, which decides where future food lands
+    writer.PutU32(static_cast<uint32_t>(freeCells.Size()));
+    const int* freeData = freeCells.Data();
+    for (int i = 0; i < freeCells.Size(); ++i)
+        writer.PutU32(static_cast<uint32_t>(freeData[i]));
 
-    if (obstacle.moveTimer >= obstacleDelay)
+    // Every snake's alive flag, then the rest of each snake after the first
+    writer.PutU32(static_cast<uint32_t>(snakes.size()));
+    for (const SnakePlayer& other : snakes)
+        writer.PutU8(other.alive ? 1 : 0);
+    for (size_t i = 1; i < snakes.size(); ++i)
     {
-        obstacle.moveTimer = 0.0f;
+        const SnakePlayer& other = snakes[i];
+        writer.PutU32(static_cast<uint32_t>(other.score));
+        writer.PutU8(static_cast<uint8_t>(other.direction));
+        writer.PutU8(static_cast<uint8_t>(other.inputs.Size()));
+        for (int j = 0; j < other.inputs.Size(); ++j)
+            writer.PutU8(static_cast<uint8_t>(other.inputs[j].direction));
+        PutBody(writer, other.body);
+    }
+}
 
-        // Randomly choose a new direction for the obstacle
-        int randomDir = rand() % 4;
-        obstacle.direction = static_cast<Direction>(randomDir);
+bool SnakeGame::LoadState(const uint8_t* data, size_t size)
+{
+    ByteReader reader(data, size);
+    if (reader.GetU32() != STATE_MAGIC)
+        return false;
+    uint16_t version = reader.GetU16();
+    if (version < 1 || version > STATE_VERSION)
+        return false;
+    if (reader.GetU32() != static_cast<uint32_t>(gridWidth) || reader.GetU32() != static_cast<uint32_t>(gridHeight))
+        return false;
 
-        // Move obstacle in the chosen direction
-        int newX = obstacle.x;
-        int newY = obstacle.y;
+    uint64_t newSeed = reader.GetU64();
+    uint64_t rngState = reader.GetU64();
+    uint64_t rngIncrement = reader.GetU64();
+    uint64_t newTick = reader.GetU64();
+    int newScore = static_cast<int>(reader.GetU32());
+    uint8_t flags = reader.GetU8();
+    Direction newCurrentDir = static_cast<Direction>(reader.GetU8() & 3);
+    // Queued inputs keep their directions; they count as arriving on the loaded tick
+    InputQueue newInputs;
+    if (version >= 3)
+    {
+        int inputCount = reader.GetU8();
+        if (inputCount > InputQueue::CAPACITY)
+            return false;
+        for (int i = 0; i < inputCount; ++i)
+            newInputs.PushBack({ static_cast<Direction>(reader.GetU8() & 3), newTick, 0.0f });
+    }
+    else
+    {
+        Direction newNextDir = static_cast<Direction>(reader.GetU8() & 3);
+        if (newNextDir != newCurrentDir)
+            newInputs.PushBack({ newNextDir, newTick, 0.0f });
+    }
+    Segment newFood;
+    newFood.x = static_cast<int>(reader.GetU32());
+    newFood.y = static_cast<int>(reader.GetU32());
 
-        switch (obstacle.direction)
+    int newObstacleCount = version >= 2 ? static_cast<int>(reader.GetU32()) : 1;
+    if (!reader.Ok() || newObstacleCount < 0 || newObstacleCount > gridWidth * gridHeight)
+        return false;
+    std::vector<MovingBlock> newObstacles(newObstacleCount);
+    std::vector<Pcg32> newObstacleRngs(newObstacleCount);
+    for (int i = 0; i < newObstacleCount; ++i)
+    {
+        MovingBlock& obstacle = newObstacles[i];
+        obstacle.x = static_cast<int>(reader.GetU32());
+        obstacle.y = static_cast<int>(reader.GetU32());
+        obstacle.direction = static_cast<Direction>(reader.GetU8() & 3);
+        obstacle.moveTimer = static_cast<int>(reader.GetU32());
+        if (i > 0)
         {
-        case Direction::UP:
-            newY--;
-            break;
-        case Direction::DOWN:
-            newY++;
-            break;
-        case Direction::LEFT:
-            newX--;
-            break;
-        case Direction::RIGHT:
-            newX++;
-            break;
+            uint64_t state = reader.GetU64();
+            newObstacleRngs[i].SetState(state, reader.GetU64());
         }
+        if (!reader.Ok() || !occupancy.InBounds(obstacle.x, obstacle.y))
+            return false;
+    }
 
-        // Keep obstacle within grid boundaries (wrap around or bounce)
-        if (newX < 0)
-            newX = gridWidth - 1;  // Wrap to right side
-        else if (newX >= gridWidth)
-            newX = 0;  // Wrap to left side
+    int bodySize = static_cast<int>(reader.GetU32());
+    if (!reader.Ok() || bodySize < 0 || bodySize > snakes[0].body.Capacity())
+        return false;
+    const uint8_t* bodyData = reader.GetBytes(static_cast<size_t>(bodySize) * 8);
+
+    int freeCount = static_cast<int>(reader.GetU32());
+    if (!reader.Ok() || freeCount < 0 || freeCount > gridWidth * gridHeight)
+        return false;
+    std::vector<int> freeList(freeCount);
+    for (int i = 0; i < freeCount; ++i)
+    {
+        freeList[i] = static_cast<int>(reader.GetU32());
+        if (freeList[i] < 0 || freeList[i] >= gridWidth * gridHeight)
+            return false;
+    }
+    if (!reader.Ok())
+        return false;
 
-        if (newY < 0)
-            newY = gridHeight - 1;  // Wrap to bottom
-        else if (newY >= gridHeight)
-            newY = 0;  // Wrap to top
+    // Earlier versions had one snake, alive until a collision ended the game
+    std::vector<LoadedSnake> others;
+    std::vector<uint8_t> alive(1, (flags & 1) == 0 || (flags & 2) != 0);
+    if (version >= 4)
+    {
+        uint32_t newSnakeCount = reader.GetU32();
+        if (!reader.Ok() || newSnakeCount < 1 || newSnakeCount > static_cast<uint32_t>(gridWidth * gridHeight))
+            return false;
+        alive.resize(newSnakeCount);
+        for (uint8_t& flag : alive)
+            flag = reader.GetU8();
+        others.resize(newSnakeCount - 1);
+        for (size_t i = 0; i < others.size(); ++i)
+        {
+            LoadedSnake& other = others[i];
+            other.score = static_cast<int>(reader.GetU32());
+            other.direction = static_cast<Direction>(reader.GetU8() & 3);
+            int inputCount = reader.GetU8();
+            if (inputCount > InputQueue::CAPACITY)
+                return false;
+            for (int j = 0; j < inputCount; ++j)
+                other.inputs.PushBack({ static_cast<Direction>(reader.GetU8() & 3), newTick, 0.0f });
+            other.bodySize = static_cast<int>(reader.GetU32());
+            if (!reader.Ok() || other.bodySize < 0 || other.bodySize > gridWidth * gridHeight ||
+                (other.bodySize == 0 && alive[i + 1]))
+                return false;
+            other.bodyData = reader.GetBytes(static_cast<size_t>(other.bodySize) * 8);
+        }
+        if (!reader.Ok())
+            return false;
+    }
+    // Only a dead snake leaves the board
+    if (bodySize == 0 && alive[0])
+        return false;
 
-        // Update obstacle position
-        obstacle.x = newX;
-        obstacle.y = newY;
+    // The free list must hold every cell no body or obstacle covers, each once: anything
+    // else lets food spawn on a snake or later inserts run past the end of the set
+    if (!occupancy.InBounds(newFood.x, newFood.y))
+        return false;
+    std::vector<uint8_t> cells(static_cast<size_t>(gridWidth) * gridHeight, 0);
+    if (!MarkBody(bodyData, bodySize, gridWidth, gridHeight, cells))
+        return false;
+    for (const LoadedSnake& other : others)
+    {
+        if (!MarkBody(other.bodyData, other.bodySize, gridWidth, gridHeight, cells))
+            return false;
+    }
+    for (const MovingBlock& obstacle : newObstacles)
+    {
+        uint8_t& cell = cells[CellIndex(obstacle.x, obstacle.y)];
+        if (cell & CELL_OBSTACLE)
+            return false;
+        cell |= CELL_OBSTACLE;
     }
+    int uncovered = static_cast<int>(std::count(cells.begin(), cells.end(), static_cast<uint8_t>(0)));
+    if (freeCount != uncovered)
+        return false;
+    for (int cell : freeList)
+    {
+        if (cells[cell] != 0)
+            return false;
+        cells[cell] = CELL_LISTED_FREE;
+    }
+
+    // Everything decoded; commit
+    seed = newSeed;
+    rng.SetState(rngState, rngIncrement);
+    tick = newTick;
+    gameOver = (flags & 1) != 0;
+    gameWon = (flags & 2) != 0;
+    paused = (flags & 4) != 0;
+    waitingForStart = (flags & 8) != 0;
+    snakes.resize(alive.size());
+    SnakePlayer& player = snakes[0];
+    player.score = newScore;
+    player.direction = newCurrentDir;
+    player.inputs = newInputs;
+    for (size_t i = 1; i < snakes.size(); ++i)
+    {
+        const LoadedSnake& other = others[i - 1];
+        snakes[i].score = other.score;
+        snakes[i].direction = other.direction;
+        snakes[i].inputs = other.inputs;
+    }
+    aliveCount = 0;
+    for (size_t i = 0; i < snakes.size(); ++i)
+    {
+        snakes[i].alive = alive[i] != 0;
+        aliveCount += alive[i] != 0 ? 1 : 0;
+    }
+    deaths.reserve(snakes.size());
+    food = newFood;
+    obstacles.swap(newObstacles);
+    obstacleRngs.swap(newObstacleRngs);
+    obstacleTargets.resize(obstacles.size());
+    obstacleContacts.reserve(obstacles.size());
+    moveTimer = 0.0f;
+
+    occupancy.Clear();
+    LoadBody(player.body, bodyData, bodySize);
+    for (size_t i = 1; i < snakes.size(); ++i)
+        LoadBody(snakes[i].body, others[i - 1].bodyData, others[i - 1].bodySize);
+    for (const MovingBlock& obstacle : obstacles)
+        occupancy.SetObstacle(obstacle.x, obstacle.y, true);
+    freeCells.Assign(freeList.data(), freeCount);
+    FindObstacleContacts();
+    return true;
+}
+
+void SnakeGame::LoadBody(SnakeBody& body, const uint8_t* data, int size)
+{
+    // Snakes a save adds get board-sized storage like placed ones
+    body.Reserve(gridWidth * gridHeight);
+    body.Clear();
+    ByteReader reader(data, static_cast<size_t>(size) * 8);
+    for (int i = 0; i < size; ++i)
+    {
+        Segment segment;
+        segment.x = static_cast<int>(reader.GetU32());
+        segment.y = static_cast<int>(reader.GetU32());
+        body.PushBack(segment);
+        occupancy.AddBody(segment);
+    }
+}
+
+size_t SnakeGame::GetSnapshotSize() const
+{
+    return SnapshotLayout(gridWidth * gridHeight, GetObstacleCount(), GetSnakeCount()).total;
+}
+
+void SnakeGame::Snapshot(void* buffer) const
+{
+    assert(reinterpret_cast<uintptr_t>(buffer) % alignof(SnapshotHeader) == 0);
+    uint8_t* bytes = static_cast<uint8_t*>(buffer);
+    SnapshotLayout layout(gridWidth * gridHeight, GetObstacleCount(), GetSnakeCount());
+
+    SnapshotHeader* header = reinterpret_cast<SnapshotHeader*>(bytes);
+    header->seed = seed;
+    header->rngState = rng.GetState();
+    header->rngIncrement = rng.GetIncrement();
+    header->tick = tick;
+    header->gridWidth = gridWidth;
+    header->gridHeight = gridHeight;
+    header->freeCount = freeCells.Size();
+    header->obstacleCount = GetObstacleCount();
+    header->contactCount = static_cast<int32_t>(obstacleContacts.size());
+    header->snakeCount = GetSnakeCount();
+    header->aliveCount = aliveCount;
+    header->food = food;
+    header->moveTimer = moveTimer;
+    header->gameOver = gameOver;
+    header->gameWon = gameWon;
+    header->paused = paused;
+    header->waitingForStart = waitingForStart;
+
+    // Only the live parts of the variable regions are written
+    SnapshotSnake* records = reinterpret_cast<SnapshotSnake*>(bytes + layout.snakes);
+    Segment* segments = reinterpret_cast<Segment*>(bytes + layout.body);
+    for (const SnakePlayer& player : snakes)
+    {
+        SnapshotSnake& record = *records++;
+        record.bodyCount = player.body.Size();
+        record.score = player.score;
+        record.direction = player.direction;
+        record.inputs = player.inputs;
+        record.alive = player.alive;
+        player.body.CopyTo(segments);
+        segments += player.body.Size();
+    }
+    std::memcpy(bytes + layout.slots, freeCells.SlotData(), sizeof(int) * occupancy.CellCount());
+    std::memcpy(bytes + layout.members, freeCells.Data(), sizeof(int) * freeCells.Size());
+    std::memcpy(bytes + layout.rngs, obstacleRngs.data(), sizeof(Pcg32) * obstacleRngs.size());
+    std::memcpy(bytes + layout.obstacles, obstacles.data(), sizeof(MovingBlock) * obstacles.size());
+    std::memcpy(bytes + layout.contacts, obstacleContacts.data(), sizeof(int) * obstacleContacts.size());
+    std::memcpy(bytes + layout.occupancy, occupancy.Data(), occupancy.CellCount());
+}
+
+void SnakeGame::Restore(const void* buffer)
+{
+    const uint8_t* bytes = static_cast<const uint8_t*>(buffer);
+    SnapshotLayout layout(gridWidth * gridHeight, GetObstacleCount(), GetSnakeCount());
+
+    const SnapshotHeader* header = reinterpret_cast<const SnapshotHeader*>(bytes);
+    assert(header->gridWidth == gridWidth && header->gridHeight == gridHeight);
+    assert(header->obstacleCount == GetObstacleCount());
+    assert(header->snakeCount == GetSnakeCount());
+    seed = header->seed;
+    rng.SetState(header->rngState, header->rngIncrement);
+    tick = header->tick;
+    aliveCount = header->aliveCount;
+    food = header->food;
+    moveTimer = header->moveTimer;
+    gameOver = header->gameOver != 0;
+    gameWon = header->gameWon != 0;
+    paused = header->paused != 0;
+    waitingForStart = header->waitingForStart != 0;
+
+    const SnapshotSnake* records = reinterpret_cast<const SnapshotSnake*>(bytes + layout.snakes);
+    const Segment* segments = reinterpret_cast<const Segment*>(bytes + layout.body);
+    for (SnakePlayer& player : snakes)
+    {
+        const SnapshotSnake& record = *records++;
+        player.score = record.score;
+        player.direction = record.direction;
+        player.inputs = record.inputs;
+        player.alive = record.alive != 0;
+        player.body.Assign(segments, record.bodyCount);
+        segments += record.bodyCount;
+    }
+    freeCells.AssignRaw(reinterpret_cast<const int*>(bytes + layout.members), header->freeCount,
+        reinterpret_cast<const int*>(bytes + layout.slots));
+    std::memcpy(obstacleRngs.data(), bytes + layout.rngs, sizeof(Pcg32) * obstacleRngs.size());
+    std::memcpy(obstacles.data(), bytes + layout.obstacles, sizeof(MovingBlock) * obstacles.size());
+    obstacleContacts.resize(header->contactCount);
+    std::memcpy(obstacleContacts.data(), bytes + layout.contacts, sizeof(int) * obstacleContacts.size());
+    std::memcpy(occupancy.Data(), bytes + layout.occupancy, occupancy.CellCount());
+}
+
+void SnakeGame::ReseedGenerators(uint64_t newSeed)
+{
+    rng.Seed(newSeed);
+    for (size_t i = 1; i < obstacleRngs.size(); ++i)
+        obstacleRngs[i].Seed(newSeed, i);
+}
+
+void SnakeGame::ArrangeSnake(const Segment* segments, int count, Direction heading)
+{
+    SnakePlayer& player = snakes[0];
+    assert(count > 0 && count <= player.body.Capacity());
+    player.body.Assign(segments, count);
+
+    occupancy.Clear();
+    freeCells.Fill();
+    for (const SnakePlayer& other : snakes)
+    {
+        for (const auto& segment : other.body)
+            AddBodySegment(segment);
+    }
+    for (const MovingBlock& obstacle : obstacles)
+        SetObstacleCell(obstacle.x, obstacle.y, true);
+    FindObstacleContacts();
+
+    player.direction = heading;
+    player.inputs.Clear();
+    if (!player.alive)
+    {
+        player.alive = true;
+        ++aliveCount;
+    }
+    gameOver = false;
+    gameWon = false;
+    SpawnFood();
+}
+
+void SnakeGame::AddListener(SnakeGameListener* listener)
+{
+    if (std::find(listeners.begin(), listeners.end(), listener) == listeners.end())
+        listeners.push_back(listener);
+}
+
+void SnakeGame::RemoveListener(SnakeGameListener* listener)
+{
+    listeners.erase(std::remove(listeners.begin(), listeners.end(), listener), listeners.end());
+}
+
+void SnakeGame::SpawnFood()
+{
+    // No room left for food: the snake has filled the board
+    if (freeCells.Empty())
+    {
+        gameWon = true;
+        gameOver = true;
+        return;
+    }
+
+    int cell = freeCells.At(static_cast<int>(rng.NextBounded(static_cast<uint32_t>(freeCells.Size()))));
+    food.x = cell % gridWidth;
+    food.y = cell / gridWidth;
 }
 
-void SnakeGame::MoveSnake()
+void SnakeGame::UpdateObstacles()
 {
-    Segment newHead = snake[0];
+    int count = GetObstacleCount();
+    if (count == 0)
+        return;
+
+    // Obstacle 0 shares the game generator, so it is always drawn here and in order.
+    // Every other obstacle only touches its own state and stream, so chunks of them can
+    // be planned concurrently
+    obstacleTargets[0] = PlanObstacleMove(obstacles[0], rng);
+    if (obstaclePool && count >= PARALLEL_OBSTACLES)
+    {
+        obstaclePool->ParallelFor(count - 1, OBSTACLE_GRAIN,
+            [this](int begin, int end, int) { PlanObstacleMoves(begin + 1, end + 1); });
+    }
+    else
+        PlanObstacleMoves(1, count);
 
-    switch (currentDir)
+    // Moves are applied in index order, which keeps the free-cell order (and so the food)
+    // deterministic. A move onto another obstacle is skipped; a move onto the body is
+    // remembered and decides the next collision check
+    for (int i = 0; i < count; ++i)
+    {
+        int target = obstacleTargets[i];
+        if (target < 0)
+            continue;
+        int x = target % gridWidth;
+        int y = target / gridWidth;
+        if (occupancy.HasObstacle(x, y))
+            continue;
+
+        MovingBlock& obstacle = obstacles[i];
+        SetObstacleCell(obstacle.x, obstacle.y, false);
+        obstacle.x = x;
+        obstacle.y = y;
+        SetObstacleCell(x, y, true);
+        if (occupancy.HasBody(x, y))
+            obstacleContacts.push_back(i);
+    }
+}
+
+void SnakeGame::PlanObstacleMoves(int begin, int end)
+{
+    for (int i = begin; i < end; ++i)
+        obstacleTargets[i] = PlanObstacleMove(obstacles[i], obstacleRngs[i]);
+}
+
+int SnakeGame::PlanObstacleMove(MovingBlock& obstacle, Pcg32& generator) const
+{
+    // Counted in ticks so the obstacle pace no longer depends on the frame rate
+    if (++obstacle.moveTimer < obstacleTicks)
+        return -1;
+    obstacle.moveTimer = 0;
+
+    // Randomly choose a new direction for the obstacle
+    int randomDir = static_cast<int>(generator.NextBounded(4));
+    obstacle.direction = static_cast<Direction>(randomDir);
+
+    // Move obstacle in the chosen direction
+    int newX = obstacle.x;
+    int newY = obstacle.y;
+
+    switch (obstacle.direction)
+    {
+    case Direction::UP:
+        newY--;
+        break;
+    case Direction::DOWN:
+        newY++;
+        break;
+    case Direction::LEFT:
+        newX--;
+        break;
+    case Direction::RIGHT:
+        newX++;
+        break;
+    }
+
+    // Keep obstacle within grid boundaries (wrap around or bounce)
+    if (newX < 0)
+        newX = gridWidth - 1;  // Wrap to right side
+    else if (newX >= gridWidth)
+        newX = 0;  // Wrap to left side
+
+    if (newY < 0)
+        newY = gridHeight - 1;  // Wrap to bottom
+    else if (newY >= gridHeight)
+        newY = 0;  // Wrap to top
+
+    return CellIndex(newX, newY);
+}
+
+void SnakeGame::MoveSnake(SnakePlayer& player)
+{
+    SnakeBody& snake = player.body;
+    Segment newHead = snake.Head();
+
+    switch (player.direction)
     {
     case Direction::UP:    newHead.y--; break;
     case Direction::DOWN:  newHead.y++; break;
@@ -217,48 +922,181 @@ void SnakeGame::MoveSnake()
     case Direction::RIGHT: newHead.x++; break;
     }
 
-    snake.insert(snake.begin(), newHead);
-
     // Check if food is eaten
     if (newHead.x == food.x && newHead.y == food.y)
     {
-        score += 10;
+        player.score += 10;
+        snake.PushFront(newHead);
+        AddBodySegment(newHead);
         SpawnFood();
     }
     else
     {
-        snake.pop_back();
+        // Drop the tail before adding the head so a full-board snake still fits the buffer
+        RemoveBodySegment(snake.Tail());
+        snake.PopBack();
+        snake.PushFront(newHead);
+        AddBodySegment(newHead);
     }
 }
 
 void SnakeGame::CheckCollisions()
 {
-    Segment head = snake[0];
+    // Every head is checked after all snakes have moved, so the move order decides
+    // nothing: two heads on one cell both die, as does a head on any other body
+    deaths.clear();
+    bool obstacleHit = false;
+    for (int i = 0; i < GetSnakeCount(); ++i)
+    {
+        const SnakePlayer& player = snakes[i];
+        if (!player.alive)
+            continue;
+        const Segment& head = player.body.Head();
+
+        // Wall collision - game over when hitting boundaries
+        if (!occupancy.InBounds(head.x, head.y))
+        {
+            deaths.push_back(i);
+            continue;
+        }
+
+        // Obstacle collision - the head moved onto an obstacle
+        if (occupancy.HasObstacle(head.x, head.y))
+        {
+            obstacleHit = true;
+            deaths.push_back(i);
+            continue;
+        }
+
+        // Body collision - the head shares its cell with another segment, its own or
+        // another snake's
+        bool bodyHit = occupancy.BodyCount(head.x, head.y) > 1;
+        assert(bodyHit == HeadHitsBodyLinear(player));
+        if (bodyHit)
+            deaths.push_back(i);
+    }
 
-    // Wall collision - game over when hitting boundaries
-    if (head.x < 0 || head.x >= gridWidth || head.y < 0 || head.y >= gridHeight)
+    // An obstacle that moved onto ANY segment kills that segment's snake. Since the last
+    // check the bodies only gained their heads, and the obstacles that moved onto a body
+    // are listed, so the whole pool never needs scanning
+    KillObstacleContacts(obstacleHit);
+    assert(obstacleHit == ObstacleHitsBodyLinear());
+    if (deaths.empty())
+        return;
+
+    for (int index : deaths)
+        snakes[index].alive = false;
+    aliveCount -= static_cast<int>(deaths.size());
+    if (aliveCount == 0)
     {
+        // The last snakes stay where they died
         gameOver = true;
         return;
     }
+    for (int index : deaths)
+    {
+        SnakeBody& body = snakes[index].body;
+        for (const auto& segment : body)
+            RemoveBodySegment(segment);
+        body.Clear();
+    }
+}
 
-    // Obstacle collision - game over when hitting moving obstacle (check ALL snake segments)
-    for (size_t i = 0; i < snake.size(); ++i)
+void SnakeGame::KillObstacleContacts(bool& obstacleHit)
+{
+    for (int index : obstacleContacts)
     {
-        if (snake[i].x == obstacle.x && snake[i].y == obstacle.y)
+        const MovingBlock& obstacle = obstacles[index];
+        if (!occupancy.HasBody(obstacle.x, obstacle.y))
+            continue;
+        obstacleHit = true;
+        // Contacts end a snake's game, so this walk over the bodies is rare
+        for (int i = 0; i < GetSnakeCount(); ++i)
         {
-            gameOver = true;
-            return;
+            const SnakeBody& body = snakes[i].body;
+            if (!snakes[i].alive || std::find(deaths.begin(), deaths.end(), i) != deaths.end())
+                continue;
+            bool covered = std::any_of(body.begin(), body.end(),
+                [&](const Segment& segment) { return segment.x == obstacle.x && segment.y == obstacle.y; });
+            if (covered)
+                deaths.push_back(i);
         }
     }
+    obstacleContacts.clear();
+}
 
-    // Self collision - game over when hitting own body
-    for (size_t i = 1; i < snake.size(); ++i)
+void SnakeGame::FindObstacleContacts()
+{
+    obstacleContacts.clear();
+    for (int i = 0; i < GetObstacleCount(); ++i)
     {
-        if (head.x == snake[i].x && head.y == snake[i].y)
+        if (occupancy.HasBody(obstacles[i].x, obstacles[i].y))
+            obstacleContacts.push_back(i);
+    }
+}
+
+void SnakeGame::AddBodySegment(const Segment& segment)
+{
+    occupancy.AddBody(segment);
+    if (occupancy.InBounds(segment.x, segment.y))
+        freeCells.Remove(CellIndex(segment.x, segment.y));
+}
+
+void SnakeGame::RemoveBodySegment(const Segment& segment)
+{
+    occupancy.RemoveBody(segment);
+    ReleaseCellIfFree(segment.x, segment.y);
+}
+
+void SnakeGame::SetObstacleCell(int x, int y, bool present)
+{
+    occupancy.SetObstacle(x, y, present);
+    if (present && occupancy.InBounds(x, y))
+        freeCells.Remove(CellIndex(x, y));
+    else
+        ReleaseCellIfFree(x, y);
+}
+
+void SnakeGame::ReleaseCellIfFree(int x, int y)
+{
+    if (occupancy.InBounds(x, y) && !occupancy.HasBody(x, y) && !occupancy.HasObstacle(x, y))
+        freeCells.Insert(CellIndex(x, y));
+}
+
+#ifndef NDEBUG
+bool SnakeGame::ObstacleHitsBodyLinear() const
+{
+    // Every live snake's segments against the obstacle list, leaving the occupancy grid
+    // the fast path reads out of it. Obstacles are marked on a board of their own so the
+    // walk stays linear with thousands of them; heads that just left the board can't be hit
+    std::vector<bool> obstacleCells(static_cast<size_t>(gridWidth) * gridHeight, false);
+    for (const MovingBlock& obstacle : obstacles)
+        obstacleCells[CellIndex(obstacle.x, obstacle.y)] = true;
+    for (const SnakePlayer& player : snakes)
+    {
+        if (!player.alive)
+            continue;
+        for (const auto& segment : player.body)
         {
-            gameOver = true;
-            return;
+            if (occupancy.InBounds(segment.x, segment.y) && obstacleCells[CellIndex(segment.x, segment.y)])
+                return true;
+        }
+    }
+    return false;
+}
+
+bool SnakeGame::HeadHitsBodyLinear(const SnakePlayer& player) const
+{
+    const Segment& head = player.body.Head();
+    for (const SnakePlayer& other : snakes)
+    {
+        // A snake's own head is the one being tested
+        for (int i = &other == &player ? 1 : 0; i < other.body.Size(); ++i)
+        {
+            if (head.x == other.body[i].x && head.y == other.body[i].y)
+                return true;
         }
     }
+    return false;
 }
+#endif
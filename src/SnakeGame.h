@@ -1,52 +1,215 @@
 #pragma once
+#include <cstdint>
 #include <vector>
 #include <queue>
-#include <imgui.h>
+#include "Random.h"
+#include "SnakeGameListener.h"
+#include "SnakeBody.h"
+#include "OccupancyGrid.h"
+#include "FreeCellSet.h"
+#include "InputQueue.h"
 
 enum class Direction { UP, DOWN, LEFT, RIGHT };
 
-struct Segment {
-    int x, y;
-};
-
 struct MovingBlock {
     int x, y;
     Direction direction;
-    float moveTimer;
+    int moveTimer;  // Ticks since the last move
+};
+
+class ThreadPool;
+
+// How long direction inputs waited for the tick that moved the snake, over the current
+// game. Ticks count the tick that applied the input, so one tick is the shortest wait;
+// times are in simulated seconds as passed to Update.
+struct InputLatencyStats
+{
+    uint64_t applied = 0;
+    uint64_t dropped = 0;  // Arrived with the queue full
+    int lastTicks = 0, maxTicks = 0;
+    float lastSeconds = 0.0f, maxSeconds = 0.0f;
+    double totalTicks = 0.0, totalSeconds = 0.0;
+
+    double MeanTicks() const { return applied ? totalTicks / applied : 0.0; }
+    double MeanSeconds() const { return applied ? totalSeconds / applied : 0.0; }
+};
+
+// One snake on the board: its body, heading, pending turns and score. Snake 0 is the
+// player; multiplayer games add more, each steered through SetDirection(index, dir).
+struct SnakePlayer
+{
+    SnakeBody body;
+    Direction direction = Direction::RIGHT;
+    InputQueue inputs;     // Direction changes not yet applied
+    InputLatencyStats inputLatency;
+    int score = 0;
+    bool alive = true;
 };
 
 class SnakeGame
 {
 public:
-    SnakeGame(int gridWidth = 20, int gridHeight = 20);
+    SnakeGame(int gridWidth = 20, int gridHeight = 20, uint64_t seed = 0);
     ~SnakeGame() = default;
 
+    // Real-time driver: accumulates deltaTime and runs zero or more whole ticks
     void Update(float deltaTime);
-    void Render(ImDrawList* drawList, ImVec2 canvasPos, float cellSize);
-    void SetDirection(Direction dir);
+    // Advances exactly one tick; the same seed and inputs always give the same game
+    void Step();
+    // Queues a direction change; each tick takes at most one, so a quick Up-Left
+    // between two ticks turns twice. Inputs that reverse or repeat the last queued
+    // direction are ignored, as are inputs that arrive with the queue full.
+    void SetDirection(Direction dir) { SetDirection(0, dir); }
+    // Same for any snake; listeners only hear about snake 0's inputs
+    void SetDirection(int snake, Direction dir);
+    // Starts a new game; without a seed, one is drawn from the current generator
     void Reset();
+    void Reset(uint64_t seed);
     void StartGame();
 
+    // Full simulation state (everything Step depends on) as a portable byte string
+    void SaveState(std::vector<uint8_t>& out) const;
+    // Returns false and leaves the game untouched if the data doesn't match this board
+    bool LoadState(const uint8_t* data, size_t size);
+
+    // Native-layout copy of the full state, including the generator, for search bots.
+    // The buffer is caller-owned, at least GetSnapshotSize() bytes and 8-byte aligned;
+    // neither call allocates. Restore requires a snapshot of a game with the same grid.
+    size_t GetSnapshotSize() const;
+    void Snapshot(void* buffer) const;
+    void Restore(const void* buffer);
+
+    // Reseeds the generators behind food and obstacle moves from `seed`, leaving the rest
+    // of the state alone. Search bots call it on their copies so that playouts sample
+    // the randomness instead of reading the real game's future out of the snapshot.
+    void ReseedGenerators(uint64_t seed);
+
+    // Replaces snake 0's body (head first) and re-spawns food; for benchmarks and scripted setups
+    void ArrangeSnake(const Segment* segments, int count, Direction heading);
+
+    // Moving obstacles placed by the next Reset (default 1, capped so food always fits).
+    // Obstacle 0 starts at (5, 5) and draws its moves from the game generator, so
+    // one-obstacle games play exactly as before; the others start on random free cells
+    // away from the snake and each draws from its own PCG stream.
+    void SetObstacleCount(int count) { obstacleCount = count < 0 ? 0 : count; }
+    // Once there are enough obstacles, their moves are drawn in parallel chunks on the
+    // pool; the result is identical to the serial update. nullptr goes back to serial.
+    void SetObstaclePool(ThreadPool* pool) { obstaclePool = pool; }
+    // Snakes placed by the next Reset (default 1). Snake 0 starts in the middle as always;
+    // the others start three cells long on random free cells, drawn from a stream of
+    // their own, and are left out once the board has no room for them. Every snake
+    // moves each tick in index order, then all heads are checked together: a head on
+    // any body (its own or another's), on another head, on an obstacle or off the board
+    // kills that snake. Dead snakes leave the board; the game is over when none is alive.
+    void SetSnakeCount(int count) { snakeCount = count < 1 ? 1 : count; }
+    // Off restores the pre-queue rule for replaying old recordings: a single pending
+    // direction, checked against the current heading and replaced by each new input
+    void SetBufferedInput(bool enabled) { bufferedInput = enabled; }
+    bool IsBufferedInput() const { return bufferedInput; }
+
+    void AddListener(SnakeGameListener* listener);
+    void RemoveListener(SnakeGameListener* listener);
+
     bool IsGameOver() const { return gameOver; }
+    bool IsGameWon() const { return gameWon; }
     bool IsGamePaused() const { return paused; }
     void SetPaused(bool state) { paused = state; }
-    int GetScore() const { return score; }
+    int GetScore() const { return snakes[0].score; }
+    uint64_t GetTick() const { return tick; }
+    uint64_t GetSeed() const { return seed; }
     bool IsWaitingForStart() const { return waitingForStart; }
 
+    // Read-only board state for renderers, bots and headless tools. The single-snake
+    // getters describe snake 0.
+    const SnakeBody& GetBody() const { return snakes[0].body; }
+    int GetSnakeCount() const { return static_cast<int>(snakes.size()); }
+    int GetAliveCount() const { return aliveCount; }
+    const SnakePlayer& GetSnake(int index) const { return snakes[index]; }
+    const OccupancyGrid& GetOccupancy() const { return occupancy; }
+    const Segment& GetFood() const { return food; }
+    int GetObstacleCount() const { return static_cast<int>(obstacles.size()); }
+    const MovingBlock* GetObstacles() const { return obstacles.data(); }
+    const MovingBlock& GetObstacle(int index = 0) const { return obstacles[index]; }
+    Direction GetDirection() const { return snakes[0].direction; }
+    const InputQueue& GetPendingInputs() const { return snakes[0].inputs; }
+    const InputLatencyStats& GetInputLatency() const { return snakes[0].inputLatency; }
+    int GetGridWidth() const { return gridWidth; }
+    int GetGridHeight() const { return gridHeight; }
+    float GetMoveDelay() const { return moveDelay; }
+    // Simulated time accumulated towards the next tick, in [0, GetMoveDelay())
+    float GetMoveTimer() const { return moveTimer; }
+
 private:
+    friend struct SnakeGameBench;  // bench/bench_micro.cpp times the tick phases one by one
+
+    static const int MAX_TICKS_PER_UPDATE = 8;
+    static const int PARALLEL_OBSTACLES = 4096;  // Fewer than this are moved on the calling thread
+    static const int OBSTACLE_GRAIN = 1024;
+
+    void ResetBoard();
+    void PlaceSnakes();
+    void PlaceObstacles();
     void SpawnFood();
-    void MoveSnake();
-    void UpdateMovingBlock();
+    void MoveSnake(SnakePlayer& player);
+    void UpdateObstacles();
+    // Steps the move timers of obstacles [begin, end) and stores the cell each one wants
+    void PlanObstacleMoves(int begin, int end);
+    int PlanObstacleMove(MovingBlock& obstacle, Pcg32& generator) const;
+    void ApplyNextInput(SnakePlayer& player);
     void CheckCollisions();
+    // Adds the snakes whose bodies listed obstacles moved onto to the tick's deaths
+    void KillObstacleContacts(bool& obstacleHit);
+    void LoadBody(SnakeBody& body, const uint8_t* data, int size);
+    void FindObstacleContacts();
+
+    // Keep the occupancy grid and the free-cell index in sync with the board
+    void AddBodySegment(const Segment& segment);
+    void RemoveBodySegment(const Segment& segment);
+    void SetObstacleCell(int x, int y, bool present);
+    void ReleaseCellIfFree(int x, int y);
+    int CellIndex(int x, int y) const { return y * gridWidth + x; }
+#ifndef NDEBUG
+    // Reference linear scans used to cross-check the incremental collision tests in debug builds
+    bool ObstacleHitsBodyLinear() const;
+    bool HeadHitsBodyLinear(const SnakePlayer& player) const;
+#endif
 
-    std::vector<Segment> snake;
+    Pcg32 rng;              // Per-instance randomness for food and obstacle 0
+    uint64_t seed;          // Seed of the current game
+    std::vector<SnakeGameListener*> listeners;
+    std::vector<SnakePlayer> snakes;  // At least one; snake 0 is the player
+    OccupancyGrid occupancy;
+    FreeCellSet freeCells;  // Cells with neither body nor obstacle, for food placement
     Segment food;
-    MovingBlock obstacle;
-    Direction currentDir, nextDir;
+    std::vector<MovingBlock> obstacles;  // Pool sized on reset; no two share a cell
+    std::vector<Pcg32> obstacleRngs;     // Move stream per obstacle; entry 0 is unused
+    std::vector<int> obstacleTargets;    // Cell each obstacle moves to this tick, -1 to stay
+    std::vector<int> obstacleContacts;   // Obstacles that moved onto the body since the last check
+    std::vector<int> deaths;  // Snakes that died in the current tick's collision check
     int gridWidth, gridHeight;
-    int score;
+    int aliveCount;
     bool gameOver, paused;
+    bool gameWon;          // Set when the snake fills every free cell
     bool waitingForStart;  // Flag to wait for first arrow input
+    uint64_t tick;         // Ticks simulated since the last reset
     float moveTimer, moveDelay;
-    float obstacleDelay;   // Delay for obstacle movement
+    int obstacleTicks;     // Ticks between obstacle moves
+    int obstacleCount;     // Obstacles placed by the next reset
+    int snakeCount;        // Snakes placed by the next reset
+    ThreadPool* obstaclePool;
+    bool bufferedInput;
+};
+
+// Snapshot storage sized and aligned for one board; allocates only on construction
+class SnakeSnapshot
+{
+public:
+    SnakeSnapshot() = default;
+    explicit SnakeSnapshot(const SnakeGame& game) : storage((game.GetSnapshotSize() + 7) / 8) {}
+
+    void* Data() { return storage.data(); }
+    const void* Data() const { return storage.data(); }
+
+private:
+    std::vector<uint64_t> storage;
 };
@@ -0,0 +1,20 @@
+#pragma once
+
+class SnakeGame;
+enum class Direction;
+
+// Observer for recorders and tools that need to follow a game without polling it.
+// Callbacks run synchronously on the thread that drives the game.
+class SnakeGameListener
+{
+public:
+    virtual ~SnakeGameListener() = default;
+
+    // Every SetDirection call, before it is applied, tagged with GetTick()
+    virtual void OnDirectionInput(const SnakeGame& game, Direction dir) { (void)game; (void)dir; }
+    // At the start of each tick, before the queued direction is taken; a driver such as
+    // the autopilot may call SetDirection on the game from here
+    virtual void OnBeforeTick(const SnakeGame& game) { (void)game; }
+    // After each simulated tick; GetTick() already counts it
+    virtual void OnTick(const SnakeGame& game) { (void)game; }
+};
@@ -0,0 +1,44 @@
+#include "SnakeRenderState.h"
+#include <cstring>
+
+namespace
+{
+// Copying the grid costs a byte per cell, the lists at least eight bytes per entry
+const size_t GRID_BYTES_PER_ENTRY = 8;
+}
+
+SnakeGameStatus SnakeGameStatus::Of(const SnakeGame& game)
+{
+    SnakeGameStatus status;
+    status.seed = game.GetSeed();
+    status.tick = game.GetTick();
+    status.score = game.GetScore();
+    status.direction = game.GetDirection();
+    status.gameOver = game.IsGameOver();
+    status.gameWon = game.IsGameWon();
+    status.paused = game.IsGamePaused();
+    status.waitingForStart = game.IsWaitingForStart();
+    status.pendingInputs = game.GetPendingInputs().Size();
+    status.inputLatency = game.GetInputLatency();
+    return status;
+}
+
+void SnakeRenderState::CopyFrom(const SnakeGame& game)
+{
+    gridWidth = game.GetGridWidth();
+    gridHeight = game.GetGridHeight();
+    body.CopyFrom(game.GetBody());
+    obstacles.assign(game.GetObstacles(), game.GetObstacles() + game.GetObstacleCount());
+    food = game.GetFood();
+    status = SnakeGameStatus::Of(game);
+
+    const OccupancyGrid& source = game.GetOccupancy();
+    size_t entries = static_cast<size_t>(body.Size()) + obstacles.size();
+    hasOccupancy = source.CellCount() <= entries * GRID_BYTES_PER_ENTRY;
+    if (hasOccupancy)
+    {
+        if (occupancy.Width() != gridWidth || occupancy.Height() != gridHeight)
+            occupancy.Init(gridWidth, gridHeight);
+        std::memcpy(occupancy.Data(), source.Data(), source.CellCount());
+    }
+}
@@ -0,0 +1,46 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <vector>
+#include "SnakeGame.h"
+
+// The scalar state the UI shows: score, flags and input statistics
+struct SnakeGameStatus
+{
+    uint64_t seed = 0;
+    uint64_t tick = 0;
+    int score = 0;
+    Direction direction = Direction::RIGHT;
+    bool gameOver = false;
+    bool gameWon = false;
+    bool paused = false;
+    bool waitingForStart = true;
+    int pendingInputs = 0;
+    InputLatencyStats inputLatency;
+
+    static SnakeGameStatus Of(const SnakeGame& game);
+};
+
+// Copy of everything the renderer and the UI read from a game, so one thread can keep
+// ticking the game while another draws. Copies reuse the storage of the previous copy.
+// The occupancy grid is only copied when it is no bigger than the body and obstacle
+// lists; otherwise HasOccupancy() is false and the renderer walks the lists instead.
+struct SnakeRenderState
+{
+    int gridWidth = 0;
+    int gridHeight = 0;
+    SnakeBody body;
+    OccupancyGrid occupancy;
+    bool hasOccupancy = false;
+    std::vector<MovingBlock> obstacles;
+    Segment food = { 0, 0 };
+    SnakeGameStatus status;
+
+    // When the tick this state ends with ran, and the real time between ticks then;
+    // set by whoever publishes the state
+    std::chrono::steady_clock::time_point tickTime;
+    float tickSeconds = 0.0f;
+
+    void CopyFrom(const SnakeGame& game);
+    bool HasOccupancy() const { return hasOccupancy; }
+};
@@ -0,0 +1,485 @@
+#include "SnakeRenderer.h"
+#include "SnakeGame.h"
+#include "SnakeRenderState.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+constexpr float SnakeRenderer::MIN_CELL_SIZE;
+constexpr float SnakeRenderer::MAX_CELL_SIZE;
+
+namespace
+{
+const float MIN_GRID_SPACING = 8.0f;  // Pixels between drawn grid lines before they are thinned out
+const int MAX_BATCH_QUADS = 65535 / 4;  // Quads per PrimReserve, so one batch fits 16-bit indices
+
+void WriteQuad(ImDrawVert* out, ImVec2 min, ImVec2 max, ImVec2 uv, ImU32 color)
+{
+    out[0].pos = min;                   out[0].uv = uv; out[0].col = color;
+    out[1].pos = ImVec2(max.x, min.y);  out[1].uv = uv; out[1].col = color;
+    out[2].pos = max;                   out[2].uv = uv; out[2].col = color;
+    out[3].pos = ImVec2(min.x, max.y);  out[3].uv = uv; out[3].col = color;
+}
+
+// Reserves room for quadCount quads and writes their indices; returns where the
+// vertices go. PrimReserve may start a new command with a vertex offset, so the base
+// index is read afterwards.
+ImDrawVert* ReserveQuads(ImDrawList* drawList, int quadCount)
+{
+    drawList->PrimReserve(quadCount * 6, quadCount * 4);
+    unsigned int base = drawList->_VtxCurrentIdx;
+    ImDrawIdx* indices = drawList->_IdxWritePtr;
+    for (int i = 0; i < quadCount; ++i, base += 4, indices += 6)
+    {
+        indices[0] = static_cast<ImDrawIdx>(base);
+        indices[1] = static_cast<ImDrawIdx>(base + 1);
+        indices[2] = static_cast<ImDrawIdx>(base + 2);
+        indices[3] = static_cast<ImDrawIdx>(base);
+        indices[4] = static_cast<ImDrawIdx>(base + 2);
+        indices[5] = static_cast<ImDrawIdx>(base + 3);
+    }
+    ImDrawVert* vertices = drawList->_VtxWritePtr;
+    drawList->_IdxWritePtr = indices;
+    drawList->_VtxWritePtr += quadCount * 4;
+    drawList->_VtxCurrentIdx += quadCount * 4;
+    return vertices;
+}
+
+// Keeps the view on the board; a board smaller than the canvas is centred
+float ClampCenter(float center, float viewCells, int boardCells)
+{
+    if (viewCells >= boardCells)
+        return boardCells * 0.5f;
+    return std::min(std::max(center, viewCells * 0.5f), boardCells - viewCells * 0.5f);
+}
+
+// Only a one-cell step is drawn sliding; anything else (a reset, a long seek) jumps
+bool IsStep(const Segment& from, const Segment& to)
+{
+    return std::abs(to.x - from.x) + std::abs(to.y - from.y) == 1;
+}
+
+ImVec2 Slide(const Segment& from, const Segment& to, float alpha)
+{
+    return ImVec2(from.x + (to.x - from.x) * alpha, from.y + (to.y - from.y) * alpha);
+}
+}
+
+float SnakeRenderer::FitCellSize(const SnakeGame& game, ImVec2 canvasSize)
+{
+    float fit = std::min(canvasSize.x / game.GetGridWidth(), canvasSize.y / game.GetGridHeight());
+    return std::min(std::max(fit, MIN_CELL_SIZE), MAX_CELL_SIZE);
+}
+
+void SnakeRenderer::Render(const SnakeGame& game, ImDrawList* drawList, ImVec2 canvasPos, ImVec2 canvasSize)
+{
+    Scene scene;
+    scene.gridWidth = game.GetGridWidth();
+    scene.gridHeight = game.GetGridHeight();
+    scene.body = &game.GetBody();
+    scene.occupancy = &game.GetOccupancy();
+    scene.food = game.GetFood();
+    scene.obstacles = game.GetObstacles();
+    scene.obstacleCount = game.GetObstacleCount();
+    RenderScene(scene, drawList, canvasPos, canvasSize);
+}
+
+void SnakeRenderer::Render(const SnakeRenderState& state, const SnakeRenderState* previous, float alpha,
+    ImDrawList* drawList, ImVec2 canvasPos, ImVec2 canvasSize)
+{
+    Scene scene;
+    scene.gridWidth = state.gridWidth;
+    scene.gridHeight = state.gridHeight;
+    scene.body = &state.body;
+    scene.occupancy = state.HasOccupancy() ? &state.occupancy : nullptr;
+    scene.food = state.food;
+    scene.obstacles = state.obstacles.data();
+    scene.obstacleCount = static_cast<int>(state.obstacles.size());
+    if (previous && previous->status.seed == state.status.seed && previous->status.tick + 1 == state.status.tick &&
+        !previous->body.Empty())
+    {
+        scene.previousBody = &previous->body;
+        scene.previousObstacles = previous->obstacles.data();
+        scene.previousObstacleCount = static_cast<int>(previous->obstacles.size());
+        scene.alpha = std::min(std::max(alpha, 0.0f), 1.0f);
+    }
+    RenderScene(scene, drawList, canvasPos, canvasSize);
+}
+
+void SnakeRenderer::RenderScene(const Scene& scene, ImDrawList* drawList, ImVec2 canvasPos, ImVec2 canvasSize)
+{
+    const int gridWidth = scene.gridWidth;
+    const int gridHeight = scene.gridHeight;
+    const SnakeBody& body = *scene.body;
+    const Segment& food = scene.food;
+
+    ImU32 snakeColor = ImGui::GetColorU32(ImVec4(0.0f, 1.0f, 0.0f, 1.0f));
+    ImU32 foodColor = ImGui::GetColorU32(ImVec4(1.0f, 0.0f, 0.0f, 1.0f));
+    ImU32 obstacleColor = ImGui::GetColorU32(ImVec4(1.0f, 0.5f, 0.0f, 1.0f));  // Orange
+    ImU32 obstacleBorderColor = ImGui::GetColorU32(ImVec4(1.0f, 1.0f, 0.0f, 1.0f));
+    ImU32 gridColor = ImGui::GetColorU32(ImVec4(0.3f, 0.3f, 0.3f, 1.0f));
+
+    lastStats = SnakeRenderStats();
+
+    // Head and tail in cells, fractional while they slide between ticks. The body drawn
+    // on whole cells then starts behind the head, and the sliding tail covers the cell
+    // it is leaving.
+    ImVec2 headPos(static_cast<float>(body.Head().x), static_cast<float>(body.Head().y));
+    ImVec2 tailPos;
+    bool slideHead = false, slideTail = false;
+    if (scene.previousBody && scene.alpha < 1.0f && body.Size() >= 2)
+    {
+        const Segment& fromHead = scene.previousBody->Head();
+        if (IsStep(fromHead, body.Head()))
+        {
+            headPos = Slide(fromHead, body.Head(), scene.alpha);
+            slideHead = true;
+        }
+        const Segment& fromTail = scene.previousBody->Tail();
+        if (IsStep(fromTail, body.Tail()))
+        {
+            tailPos = Slide(fromTail, body.Tail(), scene.alpha);
+            slideTail = true;
+        }
+    }
+    const int firstSegment = slideHead ? 1 : 0;
+
+    // Camera
+    camera.cellSize = std::min(std::max(camera.cellSize, MIN_CELL_SIZE), MAX_CELL_SIZE);
+    const float cellSize = camera.cellSize;
+    if (camera.followHead)
+        camera.center = ImVec2(headPos.x + 0.5f, headPos.y + 0.5f);
+    camera.center.x = ClampCenter(camera.center.x, canvasSize.x / cellSize, gridWidth);
+    camera.center.y = ClampCenter(camera.center.y, canvasSize.y / cellSize, gridHeight);
+
+    // Screen position of cell (0, 0) and the range of cells that touch the canvas
+    ImVec2 origin(std::floor(canvasPos.x + canvasSize.x * 0.5f - camera.center.x * cellSize),
+        std::floor(canvasPos.y + canvasSize.y * 0.5f - camera.center.y * cellSize));
+    int minX = std::max(0, static_cast<int>(std::floor((canvasPos.x - origin.x) / cellSize)));
+    int minY = std::max(0, static_cast<int>(std::floor((canvasPos.y - origin.y) / cellSize)));
+    int maxX = std::min(gridWidth, static_cast<int>(std::ceil((canvasPos.x + canvasSize.x - origin.x) / cellSize)));
+    int maxY = std::min(gridHeight, static_cast<int>(std::ceil((canvasPos.y + canvasSize.y - origin.y) / cellSize)));
+    if (minX >= maxX || minY >= maxY)
+        return;
+
+    auto cellMin = [&](float x, float y) { return ImVec2(origin.x + x * cellSize, origin.y + y * cellSize); };
+    auto isVisible = [&](int x, int y) { return x >= minX && x < maxX && y >= minY && y < maxY; };
+
+    int vertexCountBefore = drawList->VtxBuffer.Size;
+    int indexCountBefore = drawList->IdxBuffer.Size;
+    int commandCountBefore = drawList->CmdBuffer.Size;
+    unsigned int lastCommandElements = commandCountBefore > 0 ? drawList->CmdBuffer[commandCountBefore - 1].ElemCount : 0;
+
+    drawList->PushClipRect(canvasPos, ImVec2(canvasPos.x + canvasSize.x, canvasPos.y + canvasSize.y), true);
+
+    // Grid lines: every line at normal zoom, every 2nd, 4th, ... line once they crowd
+    // together, plus the board edges
+    int lineStep = 1;
+    while (lineStep * cellSize < MIN_GRID_SPACING)
+        lineStep *= 2;
+
+    CollectObstacles(scene, minX, minY, maxX, maxY);
+
+    if (batched)
+    {
+        const ImVec2 whiteUv = drawList->_Data->TexUvWhitePixel;
+        GridKey key;
+        key.originX = origin.x;
+        key.originY = origin.y;
+        key.cellSize = cellSize;
+        key.minX = minX;
+        key.minY = minY;
+        key.maxX = maxX;
+        key.maxY = maxY;
+        key.lineStep = lineStep;
+        key.gridWidth = gridWidth;
+        key.gridHeight = gridHeight;
+        key.color = gridColor;
+        key.whiteUv = whiteUv;
+        EmitGrid(drawList, key);
+
+        quads.clear();
+        AddBodyRuns(scene, firstSegment, origin, cellSize, minX, minY, maxX, maxY, snakeColor);
+        // Sliding ends; quads off the canvas are clipped
+        if (slideHead)
+        {
+            ImVec2 headMin = cellMin(headPos.x, headPos.y);
+            quads.push_back({ headMin, ImVec2(headMin.x + cellSize, headMin.y + cellSize), snakeColor });
+        }
+        if (slideTail)
+        {
+            ImVec2 tailMin = cellMin(tailPos.x, tailPos.y);
+            quads.push_back({ tailMin, ImVec2(tailMin.x + cellSize, tailMin.y + cellSize), snakeColor });
+        }
+        if (isVisible(food.x, food.y))
+        {
+            ImVec2 foodMin = cellMin(food.x, food.y);
+            quads.push_back({ foodMin, ImVec2(foodMin.x + cellSize, foodMin.y + cellSize), foodColor });
+        }
+        // Obstacles: a border-coloured cell with the orange fill inset over it, instead of
+        // an outline, so each one stays two quads in the batch
+        float inset = std::min(2.0f, cellSize * 0.25f);
+        for (const ImVec2& obstacle : visibleObstacles)
+        {
+            ImVec2 obstacleMin = cellMin(obstacle.x, obstacle.y);
+            ImVec2 obstacleMax(obstacleMin.x + cellSize, obstacleMin.y + cellSize);
+            quads.push_back({ obstacleMin, obstacleMax, obstacleBorderColor });
+            quads.push_back({ ImVec2(obstacleMin.x + inset, obstacleMin.y + inset),
+                ImVec2(obstacleMax.x - inset, obstacleMax.y - inset), obstacleColor });
+        }
+        EmitQuads(drawList, quads.data(), static_cast<int>(quads.size()), whiteUv);
+    }
+    else
+    {
+        // Draw grid
+        float top = origin.y + minY * cellSize, bottom = origin.y + maxY * cellSize;
+        float left = origin.x + minX * cellSize, right = origin.x + maxX * cellSize;
+        for (int i = (minX + lineStep - 1) / lineStep * lineStep; i <= maxX; i += lineStep)
+            drawList->AddLine(ImVec2(origin.x + i * cellSize, top), ImVec2(origin.x + i * cellSize, bottom), gridColor, 1.0f);
+        for (int i = (minY + lineStep - 1) / lineStep * lineStep; i <= maxY; i += lineStep)
+            drawList->AddLine(ImVec2(left, origin.y + i * cellSize), ImVec2(right, origin.y + i * cellSize), gridColor, 1.0f);
+        if (maxX == gridWidth && gridWidth % lineStep != 0)
+            drawList->AddLine(ImVec2(right, top), ImVec2(right, bottom), gridColor, 1.0f);
+        if (maxY == gridHeight && gridHeight % lineStep != 0)
+            drawList->AddLine(ImVec2(left, bottom), ImVec2(right, bottom), gridColor, 1.0f);
+
+        // Draw snake: walk the body while it is shorter than the visible area, otherwise scan
+        // the visible cells and draw each horizontal run of body cells as one rectangle
+        int visibleCells = (maxX - minX) * (maxY - minY);
+        if (!scene.occupancy || body.Size() <= visibleCells)
+        {
+            for (int i = firstSegment; i < body.Size(); ++i)
+            {
+                const Segment& segment = body[i];
+                if (!isVisible(segment.x, segment.y))
+                    continue;
+                ImVec2 min = cellMin(segment.x, segment.y);
+                drawList->AddRectFilled(min, ImVec2(min.x + cellSize, min.y + cellSize), snakeColor);
+            }
+        }
+        else
+        {
+            const OccupancyGrid& occupancy = *scene.occupancy;
+            for (int y = minY; y < maxY; ++y)
+            {
+                int x = minX;
+                while (x < maxX)
+                {
+                    if (!occupancy.HasBody(x, y))
+                    {
+                        ++x;
+                        continue;
+                    }
+                    int runStart = x;
+                    while (x < maxX && occupancy.HasBody(x, y))
+                        ++x;
+                    ImVec2 min = cellMin(runStart, y);
+                    drawList->AddRectFilled(min, ImVec2(origin.x + x * cellSize, min.y + cellSize), snakeColor);
+                }
+            }
+        }
+
+        if (slideHead)
+        {
+            ImVec2 headMin = cellMin(headPos.x, headPos.y);
+            drawList->AddRectFilled(headMin, ImVec2(headMin.x + cellSize, headMin.y + cellSize), snakeColor);
+        }
+        if (slideTail)
+        {
+            ImVec2 tailMin = cellMin(tailPos.x, tailPos.y);
+            drawList->AddRectFilled(tailMin, ImVec2(tailMin.x + cellSize, tailMin.y + cellSize), snakeColor);
+        }
+
+        // Draw food
+        if (isVisible(food.x, food.y))
+        {
+            ImVec2 foodMin = cellMin(food.x, food.y);
+            drawList->AddRectFilled(foodMin, ImVec2(foodMin.x + cellSize, foodMin.y + cellSize), foodColor);
+        }
+
+        // Draw moving obstacles (orange blocks)
+        for (const ImVec2& obstacle : visibleObstacles)
+        {
+            ImVec2 obstacleMin = cellMin(obstacle.x, obstacle.y);
+            ImVec2 obstacleMax(obstacleMin.x + cellSize, obstacleMin.y + cellSize);
+            drawList->AddRectFilled(obstacleMin, obstacleMax, obstacleColor);
+            // Add border to obstacle to make it more visible
+            drawList->AddRect(obstacleMin, obstacleMax, obstacleBorderColor, 0.0f, 15, 2.0f);
+        }
+    }
+
+    drawList->PopClipRect();
+
+    lastStats.vertices = drawList->VtxBuffer.Size - vertexCountBefore;
+    lastStats.indices = drawList->IdxBuffer.Size - indexCountBefore;
+    lastStats.drawCalls = 0;
+    for (int i = std::max(commandCountBefore - 1, 0); i < drawList->CmdBuffer.Size; ++i)
+    {
+        unsigned int earlier = i == commandCountBefore - 1 ? lastCommandElements : 0;
+        if (drawList->CmdBuffer[i].ElemCount > earlier)
+            ++lastStats.drawCalls;
+    }
+}
+
+void SnakeRenderer::CollectObstacles(const Scene& scene, int minX, int minY, int maxX, int maxY)
+{
+    // Same trade-off as the body: walk the pool while it is smaller than the visible
+    // area, otherwise look the visible cells up in the occupancy grid. Only the walk
+    // slides obstacles; obstacle i is the same block in both states.
+    visibleObstacles.clear();
+    int count = scene.obstacleCount;
+    if (!scene.occupancy || count <= (maxX - minX) * (maxY - minY))
+    {
+        bool slide = scene.previousObstacles && scene.previousObstacleCount == count && scene.alpha < 1.0f;
+        for (int i = 0; i < count; ++i)
+        {
+            const MovingBlock& obstacle = scene.obstacles[i];
+            if (obstacle.x < minX || obstacle.x >= maxX || obstacle.y < minY || obstacle.y >= maxY)
+                continue;
+            Segment to = { obstacle.x, obstacle.y };
+            Segment from = slide ? Segment{ scene.previousObstacles[i].x, scene.previousObstacles[i].y } : to;
+            visibleObstacles.push_back(IsStep(from, to) ? Slide(from, to, scene.alpha)
+                : ImVec2(static_cast<float>(to.x), static_cast<float>(to.y)));
+        }
+        return;
+    }
+
+    const OccupancyGrid& occupancy = *scene.occupancy;
+    for (int y = minY; y < maxY; ++y)
+    {
+        for (int x = minX; x < maxX; ++x)
+        {
+            if (occupancy.HasObstacle(x, y))
+                visibleObstacles.push_back(ImVec2(static_cast<float>(x), static_cast<float>(y)));
+        }
+    }
+}
+
+bool SnakeRenderer::GridKey::operator==(const GridKey& other) const
+{
+    return originX == other.originX && originY == other.originY && cellSize == other.cellSize && minX == other.minX &&
+        minY == other.minY && maxX == other.maxX && maxY == other.maxY && lineStep == other.lineStep &&
+        gridWidth == other.gridWidth && gridHeight == other.gridHeight &&
+        color == other.color && whiteUv.x == other.whiteUv.x && whiteUv.y == other.whiteUv.y;
+}
+
+void SnakeRenderer::EmitGrid(ImDrawList* drawList, const GridKey& key)
+{
+    // Lines become 1-pixel quads centred where AddLine would have drawn them. They only
+    // move when the camera, zoom or canvas does, so most frames reuse the cached quads.
+    if (!gridValid || !(key == gridKey))
+    {
+        gridKey = key;
+        gridValid = true;
+        gridVertices.clear();
+
+        float top = key.originY + key.minY * key.cellSize, bottom = key.originY + key.maxY * key.cellSize;
+        float left = key.originX + key.minX * key.cellSize, right = key.originX + key.maxX * key.cellSize;
+        auto addLine = [&](ImVec2 min, ImVec2 max)
+        {
+            gridVertices.resize(gridVertices.size() + 4);
+            WriteQuad(&gridVertices[gridVertices.size() - 4], min, max, key.whiteUv, key.color);
+        };
+        auto addColumn = [&](float x) { addLine(ImVec2(x - 0.5f, top - 0.5f), ImVec2(x + 0.5f, bottom + 0.5f)); };
+        auto addRow = [&](float y) { addLine(ImVec2(left - 0.5f, y - 0.5f), ImVec2(right + 0.5f, y + 0.5f)); };
+
+        int firstColumn = (key.minX + key.lineStep - 1) / key.lineStep * key.lineStep;
+        for (int i = firstColumn; i <= key.maxX; i += key.lineStep)
+            addColumn(key.originX + i * key.cellSize);
+        int firstRow = (key.minY + key.lineStep - 1) / key.lineStep * key.lineStep;
+        for (int i = firstRow; i <= key.maxY; i += key.lineStep)
+            addRow(key.originY + i * key.cellSize);
+        if (key.maxX == key.gridWidth && key.gridWidth % key.lineStep != 0)
+            addColumn(right);
+        if (key.maxY == key.gridHeight && key.gridHeight % key.lineStep != 0)
+            addRow(bottom);
+    }
+
+    EmitQuads(drawList, gridVertices.data(), static_cast<int>(gridVertices.size() / 4));
+}
+
+void SnakeRenderer::AddBodyRuns(const Scene& scene, int first, ImVec2 origin, float cellSize, int minX, int minY, int maxX,
+    int maxY, ImU32 color)
+{
+    const SnakeBody& body = *scene.body;
+    auto addCells = [&](int x0, int y0, int x1, int y1)
+    {
+        // Inclusive cell range, clipped to the visible cells
+        x0 = std::max(x0, minX);
+        y0 = std::max(y0, minY);
+        x1 = std::min(x1, maxX - 1);
+        y1 = std::min(y1, maxY - 1);
+        if (x0 > x1 || y0 > y1)
+            return;
+        quads.push_back({ ImVec2(origin.x + x0 * cellSize, origin.y + y0 * cellSize),
+            ImVec2(origin.x + (x1 + 1) * cellSize, origin.y + (y1 + 1) * cellSize), color });
+    };
+
+    int visibleCells = (maxX - minX) * (maxY - minY);
+    if (!scene.occupancy || body.Size() <= visibleCells)
+    {
+        // Walk the body from `first`, merging each straight run of segments into one quad
+        int size = body.Size();
+        int i = first;
+        while (i < size)
+        {
+            const Segment& start = body[i];
+            int end = i;
+            if (i + 1 < size)
+            {
+                int dx = body[i + 1].x - start.x, dy = body[i + 1].y - start.y;
+                if (std::abs(dx) + std::abs(dy) == 1)
+                {
+                    while (end + 1 < size && body[end + 1].x - body[end].x == dx && body[end + 1].y - body[end].y == dy)
+                        ++end;
+                }
+            }
+            const Segment& last = body[end];
+            addCells(std::min(start.x, last.x), std::min(start.y, last.y), std::max(start.x, last.x), std::max(start.y, last.y));
+            i = end + 1;
+        }
+    }
+    else
+    {
+        // Scan the visible cells, one quad per horizontal run. This covers the head's
+        // cell too, so a sliding head is drawn over it.
+        const OccupancyGrid& occupancy = *scene.occupancy;
+        for (int y = minY; y < maxY; ++y)
+        {
+            int x = minX;
+            while (x < maxX)
+            {
+                if (!occupancy.HasBody(x, y))
+                {
+                    ++x;
+                    continue;
+                }
+                int runStart = x;
+                while (x < maxX && occupancy.HasBody(x, y))
+                    ++x;
+                addCells(runStart, y, x - 1, y);
+            }
+        }
+    }
+}
+
+void SnakeRenderer::EmitQuads(ImDrawList* drawList, const ImDrawVert* vertices, int quadCount)
+{
+    for (int first = 0; first < quadCount; first += MAX_BATCH_QUADS)
+    {
+        int count = std::min(quadCount - first, MAX_BATCH_QUADS);
+        ImDrawVert* out = ReserveQuads(drawList, count);
+        std::memcpy(out, vertices + first * 4, sizeof(ImDrawVert) * 4 * count);
+    }
+}
+
+void SnakeRenderer::EmitQuads(ImDrawList* drawList, const Quad* source, int quadCount, ImVec2 whiteUv)
+{
+    for (int first = 0; first < quadCount; first += MAX_BATCH_QUADS)
+    {
+        int count = std::min(quadCount - first, MAX_BATCH_QUADS);
+        ImDrawVert* out = ReserveQuads(drawList, count);
+        for (int i = 0; i < count; ++i, out += 4)
+            WriteQuad(out, source[first + i].min, source[first + i].max, whiteUv, source[first + i].color);
+    }
+}
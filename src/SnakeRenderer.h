@@ -0,0 +1,117 @@
+#pragma once
+#include <imgui.h>
+#include <vector>
+#include "SnakeBody.h"
+
+class SnakeGame;
+class OccupancyGrid;
+struct MovingBlock;
+struct SnakeRenderState;
+
+// View onto the board: zoom in pixels per cell and the board point (in cells) shown at
+// the middle of the canvas
+struct SnakeCamera
+{
+    float cellSize = 20.0f;
+    bool followHead = true;  // Re-centre on the head every frame
+    ImVec2 center = ImVec2(0.0f, 0.0f);
+};
+
+// Draw list output of one Render call
+struct SnakeRenderStats
+{
+    int vertices = 0;
+    int indices = 0;
+    int drawCalls = 0;  // Non-empty draw commands the play area touched
+};
+
+// ImGui adapter for the simulation core: draws a SnakeGame into an ImDrawList.
+// SnakeGame itself has no ImGui dependency so the rules can run headless.
+//
+// Only the cells inside the canvas are emitted, so the cost of a frame follows the
+// canvas size rather than the board size: grid lines thin out at low zoom, and a body
+// longer than the visible cell count is drawn by scanning the visible cells instead of
+// walking every segment.
+//
+// In batched mode (the default) the grid is built once as quads and re-emitted with a
+// single vertex copy until the view changes, and the body is written straight into the
+// draw list after one PrimReserve, with each straight run of segments merged into one
+// quad. Batches stay under 64k vertices so 16-bit indices never overflow.
+//
+// A published SnakeRenderState can be drawn blended with the state of the tick before:
+// the head slides into its new cell, the tail slides out of its old one and obstacles
+// glide between cells, while the rest of the body stays on whole cells.
+class SnakeRenderer
+{
+public:
+    static constexpr float MIN_CELL_SIZE = 1.0f;
+    static constexpr float MAX_CELL_SIZE = 64.0f;
+
+    void Render(const SnakeGame& game, ImDrawList* drawList, ImVec2 canvasPos, ImVec2 canvasSize);
+    // Draws `state` as it looked `alpha` (0..1) of the way from `previous`. Without a
+    // previous state, or when it is not the tick just before, the state is drawn as is.
+    void Render(const SnakeRenderState& state, const SnakeRenderState* previous, float alpha, ImDrawList* drawList,
+        ImVec2 canvasPos, ImVec2 canvasSize);
+
+    SnakeCamera& GetCamera() { return camera; }
+    const SnakeCamera& GetCamera() const { return camera; }
+    // Zoom that shows the whole board in a canvas of the given size
+    static float FitCellSize(const SnakeGame& game, ImVec2 canvasSize);
+
+    // Switch back to one AddLine/AddRectFilled call per primitive, for comparison
+    void SetBatched(bool enabled) { batched = enabled; }
+    bool IsBatched() const { return batched; }
+    const SnakeRenderStats& GetLastStats() const { return lastStats; }
+
+private:
+    // What one Render call draws, from a live game or from published states
+    struct Scene
+    {
+        int gridWidth = 0, gridHeight = 0;
+        const SnakeBody* body = nullptr;
+        const OccupancyGrid* occupancy = nullptr;  // Null: walk the body and obstacle lists
+        Segment food = { 0, 0 };
+        const MovingBlock* obstacles = nullptr;
+        int obstacleCount = 0;
+        // Interpolation from the tick before; previousBody is null when there is none
+        const SnakeBody* previousBody = nullptr;
+        const MovingBlock* previousObstacles = nullptr;
+        int previousObstacleCount = 0;
+        float alpha = 1.0f;
+    };
+
+    // Everything the cached grid geometry depends on
+    struct GridKey
+    {
+        float originX = 0.0f, originY = 0.0f, cellSize = 0.0f;
+        int minX = 0, minY = 0, maxX = 0, maxY = 0, lineStep = 0;
+        int gridWidth = 0, gridHeight = 0;
+        ImU32 color = 0;
+        ImVec2 whiteUv;
+
+        bool operator==(const GridKey& other) const;
+    };
+
+    struct Quad
+    {
+        ImVec2 min, max;
+        ImU32 color;
+    };
+
+    void RenderScene(const Scene& scene, ImDrawList* drawList, ImVec2 canvasPos, ImVec2 canvasSize);
+    void EmitGrid(ImDrawList* drawList, const GridKey& key);
+    void CollectObstacles(const Scene& scene, int minX, int minY, int maxX, int maxY);
+    void AddBodyRuns(const Scene& scene, int first, ImVec2 origin, float cellSize, int minX, int minY, int maxX, int maxY, ImU32 color);
+    static void EmitQuads(ImDrawList* drawList, const ImDrawVert* vertices, int quadCount);
+    static void EmitQuads(ImDrawList* drawList, const Quad* quads, int quadCount, ImVec2 whiteUv);
+
+    SnakeCamera camera;
+    bool batched = true;
+    SnakeRenderStats lastStats;
+
+    GridKey gridKey;
+    bool gridValid = false;
+    std::vector<ImDrawVert> gridVertices;  // Four per line quad, in screen space
+    std::vector<Quad> quads;               // Per-frame scratch for the body, food and obstacles
+    std::vector<ImVec2> visibleObstacles;  // Per-frame scratch: obstacles inside the view, in cells
+};
@@ -0,0 +1,490 @@
+#include "SoftwareRasterizer.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include "ThreadPool.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SNAKE_RASTER_SSE2
+#include <emmintrin.h>
+#endif
+
+const int SoftwareRasterizer::TILE_SIZE;
+const int SoftwareRasterizer::SETUP_CHUNK;
+
+namespace
+{
+const int SUBPIXEL = 256;                 // Sub-pixel steps per pixel in the edge equations
+const float COORDINATE_LIMIT = 524288.0f; // Vertices are clamped to +-2^19 pixels so edge products fit in 64 bits
+
+int64_t FloorDiv(int64_t numerator, int64_t denominator)
+{
+    int64_t quotient = numerator / denominator;
+    return (numerator % denominator != 0 && (numerator < 0) != (denominator < 0)) ? quotient - 1 : quotient;
+}
+
+int64_t CeilDiv(int64_t numerator, int64_t denominator)
+{
+    return -FloorDiv(-numerator, denominator);
+}
+
+int64_t ToSubpixel(float coordinate)
+{
+    float clamped = std::min(std::max(coordinate, -COORDINATE_LIMIT), COORDINATE_LIMIT);
+    return static_cast<int64_t>(std::lround(clamped * SUBPIXEL));
+}
+
+// x / 255 rounded, exact for x <= 255 * 255 + 127
+inline uint32_t Div255(uint32_t x)
+{
+    x += 128;
+    return (x + (x >> 8)) >> 8;
+}
+
+inline uint32_t Channel(uint32_t color, int shift)
+{
+    return (color >> shift) & 0xFF;
+}
+
+uint32_t Modulate(uint32_t a, uint32_t b)
+{
+    uint32_t result = 0;
+    for (int shift = 0; shift < 32; shift += 8)
+        result |= Div255(Channel(a, shift) * Channel(b, shift)) << shift;
+    return result;
+}
+
+uint32_t SampleNearest(const RasterTexture& texture, float u, float v)
+{
+    int x = static_cast<int>(std::floor(u * texture.width));
+    int y = static_cast<int>(std::floor(v * texture.height));
+    x = std::min(std::max(x, 0), texture.width - 1);
+    y = std::min(std::max(y, 0), texture.height - 1);
+    return texture.pixels[static_cast<size_t>(y) * texture.width + x];
+}
+
+// Source alpha over the destination for colour, and alpha accumulating as
+// a + d * (1 - a), as the DX9 backend's separate alpha blend does
+inline uint32_t BlendPixel(uint32_t dst, uint32_t src)
+{
+    uint32_t alpha = src >> 24;
+    uint32_t inverse = 255 - alpha;
+    uint32_t result = 0;
+    for (int shift = 0; shift < 24; shift += 8)
+        result |= Div255(Channel(src, shift) * alpha + Channel(dst, shift) * inverse) << shift;
+    return result | (Div255(alpha * 255 + Channel(dst, 24) * inverse) << 24);
+}
+
+void FillSpan(uint32_t* dst, int count, uint32_t color)
+{
+    int i = 0;
+#ifdef SNAKE_RASTER_SSE2
+    __m128i fill = _mm_set1_epi32(static_cast<int>(color));
+    for (; i + 4 <= count; i += 4)
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), fill);
+#endif
+    for (; i < count; ++i)
+        dst[i] = color;
+}
+
+// BlendPixel over a run of pixels with one source colour; the SSE2 path computes the same
+// sums in 16-bit lanes, two pixels per register
+void BlendSpan(uint32_t* dst, int count, uint32_t color)
+{
+    uint32_t alpha = color >> 24;
+    if (alpha == 0)
+        return;
+    if (alpha == 255)
+    {
+        FillSpan(dst, count, color);
+        return;
+    }
+
+    int i = 0;
+#ifdef SNAKE_RASTER_SSE2
+    // Per channel: source * factor + 128 rounding, the factor being alpha (255 for alpha)
+    short source[4];
+    for (int c = 0; c < 4; ++c)
+        source[c] = static_cast<short>(Channel(color, c * 8) * (c == 3 ? 255 : alpha) + 128);
+    __m128i sourceTerm = _mm_setr_epi16(source[0], source[1], source[2], source[3], source[0], source[1], source[2], source[3]);
+    __m128i inverse = _mm_set1_epi16(static_cast<short>(255 - alpha));
+    __m128i zero = _mm_setzero_si128();
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i));
+        __m128i low = _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(pixels, zero), inverse), sourceTerm);
+        __m128i high = _mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(pixels, zero), inverse), sourceTerm);
+        low = _mm_srli_epi16(_mm_add_epi16(low, _mm_srli_epi16(low, 8)), 8);
+        high = _mm_srli_epi16(_mm_add_epi16(high, _mm_srli_epi16(high, 8)), 8);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_packus_epi16(low, high));
+    }
+#endif
+    for (; i < count; ++i)
+        dst[i] = BlendPixel(dst[i], color);
+}
+
+inline uint32_t ToChannel(float value)
+{
+    return static_cast<uint32_t>(std::min(std::max(value + 0.5f, 0.0f), 255.0f));
+}
+
+uint32_t FetchIndex(const RasterDrawCall& call, size_t index)
+{
+    return call.indexSize == 4 ? static_cast<const uint32_t*>(call.indices)[index]
+                               : static_cast<const uint16_t*>(call.indices)[index];
+}
+
+// The colour of a triangle or rectangle whose corners share one colour and one texel
+uint32_t FlatColor(const RasterDrawCall& call, const RasterVertex& vertex)
+{
+    return call.texture ? Modulate(vertex.color, SampleNearest(*call.texture, vertex.u, vertex.v)) : vertex.color;
+}
+
+bool SameColorAndTexel(const RasterDrawCall& call, const RasterVertex& a, const RasterVertex& b)
+{
+    return a.color == b.color && (!call.texture || (a.u == b.u && a.v == b.v));
+}
+}
+
+void RasterImage::Resize(int newWidth, int newHeight)
+{
+    width = newWidth;
+    height = newHeight;
+    pixels.resize(static_cast<size_t>(width) * height);
+}
+
+void RasterImage::Clear(uint32_t color)
+{
+    std::fill(pixels.begin(), pixels.end(), color);
+}
+
+void SoftwareRasterizer::Draw(const RasterDrawCall* calls, int callCount, RasterImage& target)
+{
+    lastStats = RasterStats();
+    auto start = std::chrono::steady_clock::now();
+
+    callFirstTriangle.assign(1, 0);
+    for (int i = 0; i < callCount; ++i)
+        callFirstTriangle.push_back(callFirstTriangle.back() + calls[i].indexCount / 3);
+    chunkCount = static_cast<int>((callFirstTriangle.back() + SETUP_CHUNK - 1) / SETUP_CHUNK);
+
+    tilesX = (target.width + TILE_SIZE - 1) / TILE_SIZE;
+    tilesY = (target.height + TILE_SIZE - 1) / TILE_SIZE;
+    int tileCount = tilesX * tilesY;
+    // Chunks and their bins are kept from frame to frame, with their capacity; those past
+    // this frame's count are left alone
+    if (static_cast<int>(chunks.size()) < chunkCount)
+        chunks.resize(chunkCount);
+    for (int i = 0; i < chunkCount; ++i)
+        chunks[i].bins.resize(tileCount);
+
+    if (pool)
+    {
+        pool->ParallelFor(chunkCount, 1, [&](int begin, int end, int)
+        {
+            for (int i = begin; i < end; ++i)
+                Setup(calls, i, target);
+        });
+    }
+    else
+    {
+        for (int i = 0; i < chunkCount; ++i)
+            Setup(calls, i, target);
+    }
+    auto setupEnd = std::chrono::steady_clock::now();
+
+    tilePixels.assign(tileCount, 0);
+    if (pool)
+    {
+        pool->ParallelFor(tileCount, 1, [&](int begin, int end, int)
+        {
+            for (int i = begin; i < end; ++i)
+                RasterizeTile(i, target);
+        });
+    }
+    else
+    {
+        for (int i = 0; i < tileCount; ++i)
+            RasterizeTile(i, target);
+    }
+    auto rasterEnd = std::chrono::steady_clock::now();
+
+    for (int i = 0; i < chunkCount; ++i)
+    {
+        lastStats.primitives += chunks[i].triangles.size();
+        for (const auto& bin : chunks[i].bins)
+            lastStats.binnedPrimitives += bin.size();
+    }
+    for (uint64_t pixels : tilePixels)
+        lastStats.pixels += pixels;
+    lastStats.setupSeconds = std::chrono::duration<double>(setupEnd - start).count();
+    lastStats.rasterSeconds = std::chrono::duration<double>(rasterEnd - setupEnd).count();
+}
+
+void SoftwareRasterizer::Setup(const RasterDrawCall* calls, int chunkIndex, const RasterImage& target)
+{
+    Chunk& chunk = chunks[chunkIndex];
+    chunk.triangles.clear();
+    chunk.shadings.clear();
+    for (auto& bin : chunk.bins)
+        bin.clear();
+
+    uint64_t first = static_cast<uint64_t>(chunkIndex) * SETUP_CHUNK;
+    uint64_t last = std::min(first + SETUP_CHUNK, callFirstTriangle.back());
+    int call = static_cast<int>(std::upper_bound(callFirstTriangle.begin(), callFirstTriangle.end(), first) -
+        callFirstTriangle.begin()) - 1;
+    for (uint64_t triangle = first; triangle < last; ++triangle)
+    {
+        while (triangle >= callFirstTriangle[call + 1])
+            ++call;
+        const RasterDrawCall& drawCall = calls[call];
+        size_t index = static_cast<size_t>(triangle - callFirstTriangle[call]) * 3;
+        uint32_t vertices[3];
+        const RasterVertex* corners[3];
+        for (int i = 0; i < 3; ++i)
+        {
+            vertices[i] = FetchIndex(drawCall, index + i);
+            corners[i] = &drawCall.vertices[vertices[i]];
+        }
+
+        // ImGui writes a rectangle as (a, b, c), (a, c, d); when both halves are in this
+        // chunk and it is axis-aligned it is set up once, as a rectangle
+        if (triangle + 1 < last && triangle + 1 < callFirstTriangle[call + 1] &&
+            FetchIndex(drawCall, index + 3) == vertices[0] && FetchIndex(drawCall, index + 4) == vertices[2])
+        {
+            const RasterVertex* fourth = &drawCall.vertices[FetchIndex(drawCall, index + 5)];
+            if (SetupRect(drawCall, corners, *fourth, chunk, target))
+            {
+                ++triangle;
+                continue;
+            }
+        }
+        SetupTriangle(drawCall, corners, chunk, target);
+    }
+}
+
+bool SoftwareRasterizer::SetupRect(const RasterDrawCall& call, const RasterVertex* corners[3], const RasterVertex& fourth,
+    Chunk& chunk, const RasterImage& target)
+{
+    const RasterVertex* rect[4] = { corners[0], corners[1], corners[2], &fourth };
+    int64_t x[4], y[4];
+    for (int i = 0; i < 4; ++i)
+    {
+        if (!SameColorAndTexel(call, *rect[0], *rect[i]))
+            return false;
+        x[i] = ToSubpixel(rect[i]->x + call.offsetX);
+        y[i] = ToSubpixel(rect[i]->y + call.offsetY);
+    }
+    bool alongX = y[0] == y[1] && x[1] == x[2] && y[2] == y[3] && x[3] == x[0];
+    bool alongY = x[0] == x[1] && y[1] == y[2] && x[2] == x[3] && y[3] == y[0];
+    if (!alongX && !alongY)
+        return false;
+
+    // The pixels the two triangles would cover under the top-left rule: centres on the
+    // left and top edges are in, those on the right and bottom edges out
+    int64_t half = SUBPIXEL / 2;
+    Triangle triangle;
+    triangle.rect = true;
+    triangle.shading = -1;
+    triangle.color = FlatColor(call, *rect[0]);
+    int64_t minX = CeilDiv(std::min(x[0], x[2]) - half, SUBPIXEL);
+    int64_t minY = CeilDiv(std::min(y[0], y[2]) - half, SUBPIXEL);
+    int64_t maxX = FloorDiv(std::max(x[0], x[2]) - half - 1, SUBPIXEL) + 1;
+    int64_t maxY = FloorDiv(std::max(y[0], y[2]) - half - 1, SUBPIXEL) + 1;
+    if ((triangle.color >> 24) != 0 && ClipBounds(call, target, minX, minY, maxX, maxY, triangle))
+        Add(triangle, chunk);
+    return true;
+}
+
+bool SoftwareRasterizer::ClipBounds(const RasterDrawCall& call, const RasterImage& target, int64_t minX, int64_t minY,
+    int64_t maxX, int64_t maxY, Triangle& triangle)
+{
+    auto clip = [](float value, int limit)
+    {
+        return static_cast<int64_t>(std::min(std::max(value, 0.0f), static_cast<float>(limit)));
+    };
+    minX = std::max(minX, clip(call.clipMinX, target.width));
+    minY = std::max(minY, clip(call.clipMinY, target.height));
+    maxX = std::min(maxX, clip(call.clipMaxX, target.width));
+    maxY = std::min(maxY, clip(call.clipMaxY, target.height));
+    if (minX >= maxX || minY >= maxY)
+        return false;
+    triangle.minX = static_cast<int>(minX);
+    triangle.minY = static_cast<int>(minY);
+    triangle.maxX = static_cast<int>(maxX);
+    triangle.maxY = static_cast<int>(maxY);
+    return true;
+}
+
+void SoftwareRasterizer::Add(const Triangle& triangle, Chunk& chunk)
+{
+    uint32_t index = static_cast<uint32_t>(chunk.triangles.size());
+    chunk.triangles.push_back(triangle);
+    for (int ty = triangle.minY / TILE_SIZE; ty <= (triangle.maxY - 1) / TILE_SIZE; ++ty)
+    {
+        for (int tx = triangle.minX / TILE_SIZE; tx <= (triangle.maxX - 1) / TILE_SIZE; ++tx)
+            chunk.bins[ty * tilesX + tx].push_back(index);
+    }
+}
+
+void SoftwareRasterizer::SetupTriangle(const RasterDrawCall& call, const RasterVertex* corners[3], Chunk& chunk,
+    const RasterImage& target)
+{
+    int64_t x[3], y[3];
+    for (int i = 0; i < 3; ++i)
+    {
+        x[i] = ToSubpixel(corners[i]->x + call.offsetX);
+        y[i] = ToSubpixel(corners[i]->y + call.offsetY);
+    }
+    // Counter-clockwise in edge terms, so the inside is where every edge is positive
+    int64_t area = (x[1] - x[0]) * (y[2] - y[0]) - (y[1] - y[0]) * (x[2] - x[0]);
+    if (area == 0)
+        return;
+    if (area < 0)
+    {
+        std::swap(x[1], x[2]);
+        std::swap(y[1], y[2]);
+        std::swap(corners[1], corners[2]);
+        area = -area;
+    }
+
+    // Pixels whose centres can be inside, cut to the clip rectangle and the image
+    int64_t half = SUBPIXEL / 2;
+    Triangle triangle;
+    triangle.rect = false;
+    if (!ClipBounds(call, target, CeilDiv(std::min({ x[0], x[1], x[2] }) - half, SUBPIXEL),
+            CeilDiv(std::min({ y[0], y[1], y[2] }) - half, SUBPIXEL),
+            FloorDiv(std::max({ x[0], x[1], x[2] }) - half, SUBPIXEL) + 1,
+            FloorDiv(std::max({ y[0], y[1], y[2] }) - half, SUBPIXEL) + 1, triangle))
+        return;
+
+    for (int i = 0; i < 3; ++i)
+    {
+        int from = (i + 1) % 3, to = (i + 2) % 3;
+        triangle.a[i] = y[from] - y[to];
+        triangle.b[i] = x[to] - x[from];
+        triangle.c[i] = x[from] * y[to] - y[from] * x[to];
+        // Top-left rule: pixel centres exactly on an edge belong to the triangle on its
+        // left or top side only
+        bool topLeft = triangle.a[i] > 0 || (triangle.a[i] == 0 && triangle.b[i] > 0);
+        if (!topLeft)
+            triangle.c[i] -= 1;
+    }
+
+    // One colour and one texel make a solid triangle: the texel is looked up once here
+    if (SameColorAndTexel(call, *corners[0], *corners[1]) && SameColorAndTexel(call, *corners[0], *corners[2]))
+    {
+        triangle.color = FlatColor(call, *corners[0]);
+        triangle.shading = -1;
+        if ((triangle.color >> 24) == 0)
+            return;
+    }
+    else
+    {
+        Shading shading;
+        shading.invArea = 1.0f / static_cast<float>(area);
+        for (int i = 0; i < 3; ++i)
+        {
+            uint32_t color = corners[i]->color;
+            shading.r[i] = static_cast<float>(Channel(color, 0));
+            shading.g[i] = static_cast<float>(Channel(color, 8));
+            shading.b[i] = static_cast<float>(Channel(color, 16));
+            shading.alpha[i] = static_cast<float>(Channel(color, 24));
+            shading.u[i] = corners[i]->u;
+            shading.v[i] = corners[i]->v;
+        }
+        if (shading.alpha[0] == 0.0f && shading.alpha[1] == 0.0f && shading.alpha[2] == 0.0f)
+            return;
+        shading.texture = call.texture;
+        triangle.color = 0;
+        triangle.shading = static_cast<int>(chunk.shadings.size());
+        chunk.shadings.push_back(shading);
+    }
+    Add(triangle, chunk);
+}
+
+void SoftwareRasterizer::RasterizeTile(int tile, RasterImage& target)
+{
+    int tileX = (tile % tilesX) * TILE_SIZE;
+    int tileY = (tile / tilesX) * TILE_SIZE;
+    int tileMaxX = std::min(tileX + TILE_SIZE, target.width);
+    int tileMaxY = std::min(tileY + TILE_SIZE, target.height);
+    uint64_t pixels = 0;
+
+    for (int chunkIndex = 0; chunkIndex < chunkCount; ++chunkIndex)
+    {
+        const Chunk& chunk = chunks[chunkIndex];
+        for (uint32_t index : chunk.bins[tile])
+        {
+            const Triangle& triangle = chunk.triangles[index];
+            int minX = std::max(triangle.minX, tileX), maxX = std::min(triangle.maxX, tileMaxX);
+            int minY = std::max(triangle.minY, tileY), maxY = std::min(triangle.maxY, tileMaxY);
+            if (triangle.rect)
+            {
+                for (int y = minY; y < maxY; ++y)
+                    BlendSpan(&target.pixels[static_cast<size_t>(y) * target.width + minX], maxX - minX, triangle.color);
+                pixels += static_cast<uint64_t>(maxX - minX) * (maxY - minY);
+                continue;
+            }
+            const Shading* shading = triangle.shading >= 0 ? &chunk.shadings[triangle.shading] : nullptr;
+            // The top-left bias is not part of the barycentric weights
+            int64_t unbias[3];
+            for (int i = 0; i < 3; ++i)
+                unbias[i] = (triangle.a[i] > 0 || (triangle.a[i] == 0 && triangle.b[i] > 0)) ? 0 : 1;
+
+            for (int y = minY; y < maxY; ++y)
+            {
+                // Each edge bounds the span from one side: e(px) = k + step * px must stay >= 0
+                int64_t centerY = static_cast<int64_t>(y) * SUBPIXEL + SUBPIXEL / 2;
+                int64_t begin = minX, end = maxX - 1;
+                int64_t rowEdge[3];
+                bool empty = false;
+                for (int i = 0; i < 3 && !empty; ++i)
+                {
+                    int64_t step = triangle.a[i] * SUBPIXEL;
+                    int64_t k = triangle.a[i] * (SUBPIXEL / 2) + triangle.b[i] * centerY + triangle.c[i];
+                    rowEdge[i] = k;
+                    if (step > 0)
+                        begin = std::max(begin, CeilDiv(-k, step));
+                    else if (step < 0)
+                        end = std::min(end, FloorDiv(k, -step));
+                    else if (k < 0)
+                        empty = true;
+                }
+                if (empty || begin > end)
+                    continue;
+
+                uint32_t* row = &target.pixels[static_cast<size_t>(y) * target.width];
+                int count = static_cast<int>(end - begin + 1);
+                pixels += static_cast<uint64_t>(count);
+                if (!shading)
+                {
+                    BlendSpan(row + begin, count, triangle.color);
+                    continue;
+                }
+
+                // Barycentric weights from the exact edge values, so a pixel's colour does
+                // not depend on where its span starts
+                for (int64_t px = begin; px <= end; ++px)
+                {
+                    float weight[3];
+                    for (int i = 0; i < 3; ++i)
+                    {
+                        int64_t edge = rowEdge[i] + triangle.a[i] * SUBPIXEL * px + unbias[i];
+                        weight[i] = static_cast<float>(edge) * shading->invArea;
+                    }
+                    auto mix = [&weight](const float* values)
+                    {
+                        return values[0] * weight[0] + values[1] * weight[1] + values[2] * weight[2];
+                    };
+                    uint32_t color = ToChannel(mix(shading->r)) | (ToChannel(mix(shading->g)) << 8) |
+                        (ToChannel(mix(shading->b)) << 16) | (ToChannel(mix(shading->alpha)) << 24);
+                    if (shading->texture)
+                        color = Modulate(color, SampleNearest(*shading->texture, mix(shading->u), mix(shading->v)));
+                    row[px] = BlendPixel(row[px], color);
+                }
+            }
+        }
+    }
+    tilePixels[tile] = pixels;
+}
@@ -0,0 +1,133 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class ThreadPool;
+
+// Vertex layout of ImDrawVert (position, texture coordinate, colour), so ImGui's vertex
+// buffers are drawn where they are
+struct RasterVertex
+{
+    float x, y;
+    float u, v;
+    uint32_t color;  // RGBA with red in the low byte, as ImU32
+};
+
+// RGBA8 pixels, red in the low byte of each word as in ImU32 colours
+struct RasterImage
+{
+    int width = 0;
+    int height = 0;
+    std::vector<uint32_t> pixels;
+
+    void Resize(int newWidth, int newHeight);
+    void Clear(uint32_t color);
+    uint32_t At(int x, int y) const { return pixels[static_cast<size_t>(y) * width + x]; }
+};
+
+// Texture pixels the caller keeps alive, laid out as RasterImage's
+struct RasterTexture
+{
+    const uint32_t* pixels = nullptr;
+    int width = 0;
+    int height = 0;
+};
+
+// Triangles from an indexed vertex list, drawn through a clip rectangle
+struct RasterDrawCall
+{
+    const RasterVertex* vertices = nullptr;
+    const void* indices = nullptr;
+    int indexSize = 2;   // Bytes per index, 2 or 4
+    int indexCount = 0;  // Three per triangle
+    float offsetX = 0.0f, offsetY = 0.0f;  // Added to every vertex position
+    // In pixels, truncated to whole pixels like a scissor rectangle
+    float clipMinX = 0.0f, clipMinY = 0.0f, clipMaxX = 0.0f, clipMaxY = 0.0f;
+    const RasterTexture* texture = nullptr;  // Null draws vertex colours alone
+};
+
+struct RasterStats
+{
+    uint64_t primitives = 0;        // Triangles and rectangles set up, leaving out those clipped away or empty
+    uint64_t binnedPrimitives = 0;  // Primitive and tile pairs
+    uint64_t pixels = 0;        // Pixels written (the fill)
+    double setupSeconds = 0.0;  // Triangle setup and binning
+    double rasterSeconds = 0.0;
+};
+
+// Draws triangle lists into a RasterImage on the CPU, blending like ImGui's DX9 backend
+// (source alpha over the image, texture colour times vertex colour), so the play area and
+// any other ImGui output can be rendered, timed and compared without a GPU.
+//
+// A frame runs in two parallel passes. Setup takes the triangles in fixed-size chunks:
+// each triangle gets integer edge equations with 8 bits of sub-pixel precision and a
+// bounding box cut to its clip rectangle, and is binned into the TILE_SIZE tiles the box
+// touches. Then each tile is rasterized on its own, walking its bins chunk by chunk so
+// triangles blend in submission order. Coverage follows the top-left rule, so triangles
+// sharing an edge never both write a pixel, and nothing depends on the tile or thread a
+// pixel is drawn on: any thread count gives the same image.
+//
+// Triangles of one colour and one texel, which is everything the play area draws, are
+// filled a row span at a time with SSE2 where available; the triangle pairs ImGui writes
+// for axis-aligned rectangles are set up as rectangles, whose rows need no edge tests.
+// Other triangles are shaded per pixel, interpolating colour and texture coordinate and
+// sampling the nearest texel.
+class SoftwareRasterizer
+{
+public:
+    static const int TILE_SIZE = 64;
+    static const int SETUP_CHUNK = 2048;  // Triangles per setup task
+
+    // pool may be null to run on the calling thread alone
+    explicit SoftwareRasterizer(ThreadPool* pool = nullptr) : pool(pool) {}
+
+    void Draw(const RasterDrawCall* calls, int callCount, RasterImage& target);
+    const RasterStats& GetLastStats() const { return lastStats; }
+
+private:
+    struct Triangle
+    {
+        // Edge i is the one facing vertex i: a * x + b * y + c >= 0 inside, in sub-pixels,
+        // with the top-left bias folded into c
+        int64_t a[3], b[3], c[3];
+        int minX, minY, maxX, maxY;  // Pixels, max exclusive
+        uint32_t color;              // Every pixel's colour when shading < 0
+        int shading;                 // Index into the chunk's shadings, or -1
+        bool rect;                   // An axis-aligned rectangle filling its bounds; no edges
+    };
+
+    struct Shading
+    {
+        float invArea;
+        float r[3], g[3], b[3], alpha[3], u[3], v[3];
+        const RasterTexture* texture;
+    };
+
+    struct Chunk
+    {
+        std::vector<Triangle> triangles;
+        std::vector<Shading> shadings;
+        std::vector<std::vector<uint32_t>> bins;  // Per tile, indices into triangles
+    };
+
+    void Setup(const RasterDrawCall* calls, int chunk, const RasterImage& target);
+    void SetupTriangle(const RasterDrawCall& call, const RasterVertex* corners[3], Chunk& chunk, const RasterImage& target);
+    // Sets up the triangle pair (a, b, c), (a, c, d) as one rectangle; false if it is not
+    // an axis-aligned one of a single colour and texel
+    bool SetupRect(const RasterDrawCall& call, const RasterVertex* corners[3], const RasterVertex& fourth, Chunk& chunk,
+        const RasterImage& target);
+    // Cuts pixel bounds to the call's clip rectangle and the image; false if none are left
+    static bool ClipBounds(const RasterDrawCall& call, const RasterImage& target, int64_t minX, int64_t minY,
+        int64_t maxX, int64_t maxY, Triangle& triangle);
+    void Add(const Triangle& triangle, Chunk& chunk);
+    void RasterizeTile(int tile, RasterImage& target);
+
+    ThreadPool* pool;
+    RasterStats lastStats;
+    std::vector<Chunk> chunks;
+    int chunkCount = 0;  // Chunks in use this frame
+    std::vector<uint64_t> callFirstTriangle;  // Prefix sums of the calls' triangle counts
+    std::vector<uint64_t> tilePixels;
+    int tilesX = 0, tilesY = 0;
+};
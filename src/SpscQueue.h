@@ -0,0 +1,51 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+
+// Bounded queue between one producer thread and one consumer thread. Push and Pop never
+// block or allocate; Push fails when the queue is full. The indices only grow, so
+// `write - read` is the fill level even after they wrap.
+template <typename T, size_t Capacity>
+class SpscQueue
+{
+    static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+public:
+    SpscQueue() : writeIndex(0), readIndex(0) {}
+
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+    // Producer only
+    bool Push(const T& value)
+    {
+        size_t write = writeIndex.load(std::memory_order_relaxed);
+        if (write - readIndex.load(std::memory_order_acquire) == Capacity)
+            return false;
+        slots[write & (Capacity - 1)] = value;
+        writeIndex.store(write + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer only
+    bool Pop(T& value)
+    {
+        size_t read = readIndex.load(std::memory_order_relaxed);
+        if (read == writeIndex.load(std::memory_order_acquire))
+            return false;
+        value = slots[read & (Capacity - 1)];
+        readIndex.store(read + 1, std::memory_order_release);
+        return true;
+    }
+
+private:
+    static const size_t CACHE_LINE = 64;
+
+    T slots[Capacity];
+    // Each index on its own cache line, so the two threads don't invalidate each other's
+    char padding0[CACHE_LINE];
+    std::atomic<size_t> writeIndex;
+    char padding1[CACHE_LINE - sizeof(std::atomic<size_t>)];
+    std::atomic<size_t> readIndex;
+    char padding2[CACHE_LINE - sizeof(std::atomic<size_t>)];
+};
@@ -0,0 +1,128 @@
+#include "ThreadPool.h"
+#include <algorithm>
+
+ThreadPool::ThreadPool(int threadCount)
+    : queues(threadCount > 0 ? threadCount : HardwareThreads())
+{
+    for (int i = 1; i < GetThreadCount(); ++i)
+        threads.emplace_back(&ThreadPool::WorkerLoop, this, i);
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(jobMutex);
+        stopping = true;
+    }
+    jobReady.notify_all();
+    for (auto& thread : threads)
+        thread.join();
+}
+
+int ThreadPool::HardwareThreads()
+{
+    unsigned count = std::thread::hardware_concurrency();
+    return count > 0 ? static_cast<int>(count) : 1;
+}
+
+void ThreadPool::ParallelFor(int count, int grain, const RangeFunction& body)
+{
+    if (count <= 0)
+        return;
+
+    // Seed every worker with an equal contiguous share
+    int workers = GetThreadCount();
+    for (int i = 0; i < workers; ++i)
+    {
+        std::lock_guard<std::mutex> lock(queues[i].mutex);
+        queues[i].begin = static_cast<int>(static_cast<long long>(count) * i / workers);
+        queues[i].end = static_cast<int>(static_cast<long long>(count) * (i + 1) / workers);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(jobMutex);
+        job = &body;
+        jobGrain = std::max(1, grain);
+        workersBusy = workers - 1;
+        ++jobGeneration;
+    }
+    jobReady.notify_all();
+
+    RunWorker(0);
+
+    std::unique_lock<std::mutex> lock(jobMutex);
+    jobDone.wait(lock, [this] { return workersBusy == 0; });
+    job = nullptr;
+}
+
+void ThreadPool::WorkerLoop(int worker)
+{
+    unsigned seenGeneration = 0;
+    for (;;)
+    {
+        {
+            std::unique_lock<std::mutex> lock(jobMutex);
+            jobReady.wait(lock, [&] { return stopping || jobGeneration != seenGeneration; });
+            if (stopping)
+                return;
+            seenGeneration = jobGeneration;
+        }
+
+        RunWorker(worker);
+
+        {
+            std::lock_guard<std::mutex> lock(jobMutex);
+            --workersBusy;
+        }
+        jobDone.notify_one();
+    }
+}
+
+void ThreadPool::RunWorker(int worker)
+{
+    int begin, end;
+    while (TakeOwn(worker, begin, end) || Steal(worker, begin, end))
+        (*job)(begin, end, worker);
+}
+
+bool ThreadPool::TakeOwn(int worker, int& begin, int& end)
+{
+    WorkQueue& queue = queues[worker];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.begin >= queue.end)
+        return false;
+    begin = queue.begin;
+    end = std::min(queue.end, queue.begin + jobGrain);
+    queue.begin = end;
+    return true;
+}
+
+bool ThreadPool::Steal(int thief, int& begin, int& end)
+{
+    int workers = GetThreadCount();
+    for (int offset = 1; offset < workers; ++offset)
+    {
+        WorkQueue& victim = queues[(thief + offset) % workers];
+        int stolenBegin, stolenEnd;
+        {
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            int remaining = victim.end - victim.begin;
+            if (remaining <= 0)
+                continue;
+            // Take the back half, leaving the victim the part it is about to work on
+            stolenBegin = victim.end - (remaining + 1) / 2;
+            stolenEnd = victim.end;
+            victim.end = stolenBegin;
+        }
+
+        // Keep the first chunk and park the rest in our own queue for others to steal
+        WorkQueue& own = queues[thief];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        begin = stolenBegin;
+        end = std::min(stolenEnd, stolenBegin + jobGrain);
+        own.begin = end;
+        own.end = stolenEnd;
+        return true;
+    }
+    return false;
+}
@@ -0,0 +1,58 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads running data-parallel loops with work stealing.
+// ParallelFor splits [0, count) into one contiguous range per worker; a worker takes
+// grain-sized chunks from the front of its own range and, once that is empty, steals
+// the back half of the first non-empty range it finds, trying the other workers in turn
+// starting after itself. The calling thread acts as worker 0.
+class ThreadPool
+{
+public:
+    // body(begin, end, worker) processes items [begin, end) on worker index `worker`
+    using RangeFunction = std::function<void(int begin, int end, int worker)>;
+
+    // threadCount <= 0 uses every hardware thread
+    explicit ThreadPool(int threadCount = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    int GetThreadCount() const { return static_cast<int>(queues.size()); }
+
+    // Blocks until every item has been processed. Not reentrant.
+    void ParallelFor(int count, int grain, const RangeFunction& body);
+
+    static int HardwareThreads();
+
+private:
+    struct alignas(64) WorkQueue
+    {
+        std::mutex mutex;
+        int begin = 0;
+        int end = 0;
+    };
+
+    void WorkerLoop(int worker);
+    void RunWorker(int worker);
+    bool TakeOwn(int worker, int& begin, int& end);
+    bool Steal(int thief, int& begin, int& end);
+
+    std::vector<WorkQueue> queues;
+    std::vector<std::thread> threads;
+
+    std::mutex jobMutex;
+    std::condition_variable jobReady;
+    std::condition_variable jobDone;
+    const RangeFunction* job = nullptr;
+    int jobGrain = 1;
+    unsigned jobGeneration = 0;
+    int workersBusy = 0;
+    bool stopping = false;
+};
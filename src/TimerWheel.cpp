@@ -0,0 +1,136 @@
+#include "TimerWheel.h"
+#include "BitOps.h"
+
+const uint64_t TimerWheel::NEVER;
+const uint32_t TimerWheel::NONE;
+
+TimerWheel::TimerWheel(uint64_t start) : now(start)
+{
+    for (uint32_t& head : heads)
+        head = NONE;
+    for (auto& level : occupied)
+    {
+        for (uint64_t& word : level)
+            word = 0;
+    }
+}
+
+void TimerWheel::Reserve(uint32_t count)
+{
+    if (timers.size() < count)
+        timers.resize(count);
+}
+
+void TimerWheel::Schedule(uint32_t id, uint64_t due)
+{
+    if (id >= timers.size())
+        timers.resize(static_cast<size_t>(id) + 1);
+    if (timers[id].bucket >= 0)
+        Unlink(id);
+    timers[id].due = due;
+    Insert(id);
+}
+
+void TimerWheel::Cancel(uint32_t id)
+{
+    if (IsScheduled(id))
+        Unlink(id);
+}
+
+void TimerWheel::Insert(uint32_t id)
+{
+    Timer& timer = timers[id];
+    // Overdue timers go in the current slot, which the next Advance fires first
+    uint64_t due = timer.due > now ? timer.due : now;
+    int level = 0;
+    for (uint64_t differing = (due ^ now) >> LEVEL_BITS; differing != 0; differing >>= LEVEL_BITS)
+        ++level;
+    int slot = Digit(due, level);
+    int bucket = level * SLOTS + slot;
+
+    timer.bucket = bucket;
+    timer.prev = NONE;
+    timer.next = heads[bucket];
+    if (timer.next != NONE)
+        timers[timer.next].prev = id;
+    heads[bucket] = id;
+    occupied[level][slot / 64] |= uint64_t(1) << (slot % 64);
+    ++count;
+}
+
+void TimerWheel::Unlink(uint32_t id)
+{
+    Timer& timer = timers[id];
+    int bucket = timer.bucket;
+    if (timer.prev != NONE)
+        timers[timer.prev].next = timer.next;
+    else
+        heads[bucket] = timer.next;
+    if (timer.next != NONE)
+        timers[timer.next].prev = timer.prev;
+    if (heads[bucket] == NONE)
+    {
+        int slot = bucket % SLOTS;
+        occupied[bucket / SLOTS][slot / 64] &= ~(uint64_t(1) << (slot % 64));
+    }
+    timer.bucket = -1;
+    timer.next = timer.prev = NONE;
+    --count;
+}
+
+void TimerWheel::MoveTo(uint64_t time)
+{
+    now = time;
+    if (Digit(now, 0) != 0)
+        return;
+    // Level n's block starts here when the n lowest digits of the time are all zero
+    int top = 1;
+    while (top + 1 < LEVELS && Digit(now, top) == 0)
+        ++top;
+    // Highest first, since a block re-filed from level n may land in level n - 1's slot
+    for (int level = top; level >= 1; --level)
+    {
+        int bucket = level * SLOTS + Digit(now, level);
+        uint32_t id = heads[bucket];
+        while (id != NONE)
+        {
+            uint32_t next = timers[id].next;
+            Unlink(id);
+            Insert(id);
+            id = next;
+        }
+    }
+}
+
+int TimerWheel::FindSlot(int level, int from) const
+{
+    for (int word = from / 64; word < SLOTS / 64; ++word)
+    {
+        uint64_t bits = occupied[level][word];
+        if (word == from / 64)
+            bits &= ~uint64_t(0) << (from % 64);
+        if (bits != 0)
+            return word * 64 + BitOps::CountTrailingZeros(bits);
+    }
+    return -1;
+}
+
+uint64_t TimerWheel::NextDue() const
+{
+    if (count == 0)
+        return NEVER;
+    int slot = FindSlot(0, Digit(now, 0));
+    if (slot >= 0)
+        return (now & ~SLOT_MASK) | static_cast<uint64_t>(slot);
+    for (int level = 1; level < LEVELS; ++level)
+    {
+        // Timers up here are due in a later block than the current one
+        slot = FindSlot(level, Digit(now, level) + 1);
+        if (slot < 0)
+            continue;
+        int shift = (level + 1) * LEVEL_BITS;
+        uint64_t above = shift < 64 ? (now >> shift) << shift : 0;
+        return above | (static_cast<uint64_t>(slot) << (level * LEVEL_BITS));
+    }
+    return NEVER;
+}
@@ -0,0 +1,114 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Hierarchical timing wheel for many timers that are re-armed every time they fire.
+// Time is an integer count of wheel ticks (the caller picks the unit), and timers are
+// identified by small integers the caller chooses, such as indices into its own arrays.
+//
+// Eight levels of 256 slots cover the whole 64-bit range. A timer sits on the level of
+// the highest byte in which its due time differs from the wheel's current time: level 0
+// holds the timers due in the current 256-tick rotation, one slot per tick, and level n
+// holds those due in later blocks of 256^n ticks. Each time the current time crosses
+// into a new block, that block's slot is emptied and its timers are re-filed one level
+// down, so a timer is touched at most once per level on its way to firing. Scheduling
+// and cancelling are O(1); slots are intrusive doubly linked lists threaded through the
+// timer array, and a bitmap per level lets Advance and NextDue skip empty slots.
+class TimerWheel
+{
+public:
+    static const uint64_t NEVER = ~0ULL;
+
+    explicit TimerWheel(uint64_t now = 0);
+
+    // Sizes the timer array for ids below `timers`; Schedule grows it on demand otherwise
+    void Reserve(uint32_t timers);
+    // Arms the timer for `due`, moving it if it is armed already. A due time that has
+    // already passed fires at the next Advance.
+    void Schedule(uint32_t id, uint64_t due);
+    void Cancel(uint32_t id);
+    bool IsScheduled(uint32_t id) const { return id < timers.size() && timers[id].bucket >= 0; }
+    uint64_t GetDue(uint32_t id) const { return timers[id].due; }
+    size_t GetCount() const { return count; }
+    // The first tick not yet processed by Advance
+    uint64_t GetNow() const { return now; }
+
+    // No later than the earliest due time, and exact when that timer is in the current
+    // rotation; NEVER if nothing is armed
+    uint64_t NextDue() const;
+
+    // Processes every tick up to and including `time`, calling fire(id, due) for each
+    // timer due by then, in due order. The callback may schedule and cancel timers; one
+    // it re-arms for a time that has already passed fires again in this call.
+    template <typename Fire>
+    void Advance(uint64_t time, Fire fire);
+
+private:
+    static const int LEVEL_BITS = 8;
+    static const int SLOTS = 1 << LEVEL_BITS;
+    static const int LEVELS = 8;
+    static const uint64_t SLOT_MASK = SLOTS - 1;
+    static const uint32_t NONE = ~0U;
+
+    struct Timer
+    {
+        uint64_t due = 0;
+        uint32_t next = NONE, prev = NONE;
+        int32_t bucket = -1;  // level * SLOTS + slot, -1 while not armed
+    };
+
+    static int Digit(uint64_t time, int level) { return static_cast<int>((time >> (level * LEVEL_BITS)) & SLOT_MASK); }
+
+    void Insert(uint32_t id);
+    void Unlink(uint32_t id);
+    // Sets the current time and, at the start of a block, re-files the slots of the
+    // blocks that start there, so no timer waits on a level above where it belongs
+    void MoveTo(uint64_t time);
+    // First occupied slot at or after `from` on the level, or -1
+    int FindSlot(int level, int from) const;
+
+    std::vector<Timer> timers;
+    uint32_t heads[LEVELS * SLOTS];
+    uint64_t occupied[LEVELS][SLOTS / 64];
+    uint64_t now;
+    size_t count = 0;
+};
+
+template <typename Fire>
+void TimerWheel::Advance(uint64_t time, Fire fire)
+{
+    while (now <= time)
+    {
+        // Straight to the next occupied slot of this rotation; failing that, to the start
+        // of the next block that holds timers, as every block before it is empty
+        int next = FindSlot(0, Digit(now, 0));
+        if (next < 0)
+        {
+            uint64_t end = (now | SLOT_MASK) + 1;
+            uint64_t due = NextDue();
+            if (due < end)
+                due = end;
+            MoveTo(due > time ? time + 1 : due);
+            continue;
+        }
+        uint64_t at = (now & ~SLOT_MASK) | static_cast<uint64_t>(next);
+        if (at > time)
+        {
+            MoveTo(time + 1);
+            break;
+        }
+        now = at;
+
+        // Timers the callback re-arms for the past land back in this slot and fire too
+        uint32_t* head = &heads[next];
+        while (*head != NONE)
+        {
+            uint32_t id = *head;
+            uint64_t due = timers[id].due;
+            Unlink(id);
+            fire(id, due);
+        }
+        MoveTo(now + 1);
+    }
+}
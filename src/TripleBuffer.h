@@ -0,0 +1,52 @@
+#pragma once
+#include <atomic>
+
+// Hands the newest value from one writer thread to one reader thread without locks.
+// Each side owns one of three slots and the third sits in the middle: Publish swaps the
+// writer's filled slot into the middle, Acquire swaps the middle slot out to the reader
+// if it is newer than what the reader has. Neither side ever waits, the writer never
+// touches a slot the reader is using, and values the reader was too slow for are skipped.
+template <typename T>
+class TripleBuffer
+{
+public:
+    TripleBuffer() : back(0), front(1), middle(2) {}
+
+    TripleBuffer(const TripleBuffer&) = delete;
+    TripleBuffer& operator=(const TripleBuffer&) = delete;
+
+    // Writer: fill this slot, then Publish it. The slot keeps whatever an earlier value
+    // left in it, so containers in T can reuse their storage.
+    T& WriteSlot() { return slots[back]; }
+
+    void Publish()
+    {
+        back = middle.exchange(back | FRESH, std::memory_order_acq_rel) & INDEX_MASK;
+    }
+
+    // Reader: true if a value newer than ReadSlot() has been published
+    bool HasNew() const { return (middle.load(std::memory_order_relaxed) & FRESH) != 0; }
+
+    // Takes the newest value into ReadSlot(); returns false if there was none
+    bool Acquire()
+    {
+        if (!HasNew())
+            return false;
+        front = middle.exchange(front, std::memory_order_acq_rel) & INDEX_MASK;
+        return true;
+    }
+
+    // The reader may also modify or swap out the contents; they go back to the writer
+    // as storage on the next Acquire
+    T& ReadSlot() { return slots[front]; }
+    const T& ReadSlot() const { return slots[front]; }
+
+private:
+    static const int INDEX_MASK = 3;
+    static const int FRESH = 4;  // Set in `middle` by Publish, cleared by Acquire
+
+    T slots[3];
+    int back;                 // Writer's slot
+    int front;                // Reader's slot
+    std::atomic<int> middle;  // Slot index plus FRESH
+};
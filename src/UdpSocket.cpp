@@ -0,0 +1,166 @@
+#include "UdpSocket.h"
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <arpa/inet.h>
+#include <cerrno>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+#ifdef _WIN32
+typedef SOCKET NativeSocket;
+typedef int SocketLength;
+
+// Winsock is started once for the process and left running until exit
+bool StartNetworking()
+{
+    static const bool started = []
+    {
+        WSADATA data;
+        return ::WSAStartup(MAKEWORD(2, 2), &data) == 0;
+    }();
+    return started;
+}
+
+void CloseNative(NativeSocket socket) { ::closesocket(socket); }
+
+bool MakeNonBlocking(NativeSocket socket)
+{
+    u_long enabled = 1;
+    return ::ioctlsocket(socket, FIONBIO, &enabled) == 0;
+}
+
+bool WouldBlock() { return ::WSAGetLastError() == WSAEWOULDBLOCK; }
+#else
+typedef int NativeSocket;
+typedef socklen_t SocketLength;
+
+bool StartNetworking() { return true; }
+
+void CloseNative(NativeSocket socket) { ::close(socket); }
+
+bool MakeNonBlocking(NativeSocket socket)
+{
+    int flags = ::fcntl(socket, F_GETFL, 0);
+    return flags >= 0 && ::fcntl(socket, F_SETFL, flags | O_NONBLOCK) == 0;
+}
+
+bool WouldBlock() { return errno == EAGAIN || errno == EWOULDBLOCK; }
+#endif
+
+sockaddr_in ToNative(const NetAddress& address)
+{
+    sockaddr_in native = {};
+    native.sin_family = AF_INET;
+    native.sin_addr.s_addr = htonl(address.ip);
+    native.sin_port = htons(address.port);
+    return native;
+}
+}
+
+UdpSocket& UdpSocket::operator=(UdpSocket&& other) noexcept
+{
+    if (this != &other)
+    {
+        Close();
+        handle = other.handle;
+        port = other.port;
+        other.handle = INVALID;
+    }
+    return *this;
+}
+
+bool UdpSocket::Open(uint16_t requestedPort, int bufferBytes)
+{
+    Close();
+    if (!StartNetworking())
+        return false;
+
+    NativeSocket socket = ::socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (socket == static_cast<NativeSocket>(INVALID))
+        return false;
+
+    if (bufferBytes > 0)
+    {
+        const char* size = reinterpret_cast<const char*>(&bufferBytes);
+        ::setsockopt(socket, SOL_SOCKET, SO_RCVBUF, size, sizeof(bufferBytes));
+        ::setsockopt(socket, SOL_SOCKET, SO_SNDBUF, size, sizeof(bufferBytes));
+    }
+
+    sockaddr_in local = ToNative(NetAddress::Loopback(requestedPort));
+    SocketLength length = sizeof(local);
+    if (!MakeNonBlocking(socket) ||
+        ::bind(socket, reinterpret_cast<const sockaddr*>(&local), sizeof(local)) != 0 ||
+        ::getsockname(socket, reinterpret_cast<sockaddr*>(&local), &length) != 0)
+    {
+        CloseNative(socket);
+        return false;
+    }
+
+    handle = static_cast<intptr_t>(socket);
+    port = ntohs(local.sin_port);
+    return true;
+}
+
+void UdpSocket::Close()
+{
+    if (handle != INVALID)
+        CloseNative(static_cast<NativeSocket>(handle));
+    handle = INVALID;
+    port = 0;
+}
+
+bool UdpSocket::SendTo(const NetAddress& to, const uint8_t* data, size_t size)
+{
+    sockaddr_in remote = ToNative(to);
+    auto sent = ::sendto(static_cast<NativeSocket>(handle), reinterpret_cast<const char*>(data),
+        static_cast<int>(size), 0, reinterpret_cast<const sockaddr*>(&remote), sizeof(remote));
+    return sent == static_cast<decltype(sent)>(size);
+}
+
+int UdpSocket::ReceiveFrom(NetAddress& from, uint8_t* buffer, size_t capacity)
+{
+    sockaddr_in remote = {};
+    SocketLength length = sizeof(remote);
+    auto received = ::recvfrom(static_cast<NativeSocket>(handle), reinterpret_cast<char*>(buffer),
+        static_cast<int>(capacity), 0, reinterpret_cast<sockaddr*>(&remote), &length);
+    if (received < 0)
+    {
+#ifdef _WIN32
+        // A datagram longer than the buffer still arrives, truncated
+        if (::WSAGetLastError() == WSAEMSGSIZE)
+            received = static_cast<int>(capacity);
+        else
+#endif
+        return WouldBlock() ? 0 : -1;
+    }
+    from.ip = ntohl(remote.sin_addr.s_addr);
+    from.port = ntohs(remote.sin_port);
+    return static_cast<int>(received);
+}
+
+bool UdpSocket::Wait(int timeoutMs)
+{
+#ifdef _WIN32
+    WSAPOLLFD entry = {};
+    entry.fd = static_cast<NativeSocket>(handle);
+    entry.events = POLLRDNORM;
+    return ::WSAPoll(&entry, 1, timeoutMs) > 0;
+#else
+    pollfd entry = {};
+    entry.fd = static_cast<NativeSocket>(handle);
+    entry.events = POLLIN;
+    return ::poll(&entry, 1, timeoutMs) > 0;
+#endif
+}
@@ -0,0 +1,51 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// IPv4 address and port in host byte order
+struct NetAddress
+{
+    uint32_t ip = 0;
+    uint16_t port = 0;
+
+    bool operator==(const NetAddress& other) const { return ip == other.ip && port == other.port; }
+    bool operator!=(const NetAddress& other) const { return !(*this == other); }
+
+    static NetAddress Loopback(uint16_t port) { return { 0x7F000001, port }; }
+};
+
+// Non-blocking UDP socket bound to the loopback interface (BSD sockets on POSIX,
+// Winsock on Windows). Multiplayer only ever runs on one machine, so nothing is
+// reachable from outside it.
+class UdpSocket
+{
+public:
+    UdpSocket() = default;
+    ~UdpSocket() { Close(); }
+
+    UdpSocket(const UdpSocket&) = delete;
+    UdpSocket& operator=(const UdpSocket&) = delete;
+    UdpSocket(UdpSocket&& other) noexcept : handle(other.handle), port(other.port) { other.handle = INVALID; }
+    UdpSocket& operator=(UdpSocket&& other) noexcept;
+
+    // Binds 127.0.0.1:port; port 0 picks a free one. bufferBytes sizes the kernel send
+    // and receive buffers, which a server with many clients needs above the default.
+    bool Open(uint16_t port = 0, int bufferBytes = 0);
+    void Close();
+    bool IsOpen() const { return handle != INVALID; }
+    uint16_t GetPort() const { return port; }
+
+    // False if the datagram could not be queued (full buffer, or too big)
+    bool SendTo(const NetAddress& to, const uint8_t* data, size_t size);
+    // Takes one waiting datagram. Returns its size, 0 if none is waiting, or -1 on an
+    // error; datagrams longer than `capacity` are truncated.
+    int ReceiveFrom(NetAddress& from, uint8_t* buffer, size_t capacity);
+    // Blocks until a datagram is waiting or timeoutMs passes; true if one is waiting
+    bool Wait(int timeoutMs);
+
+private:
+    static const intptr_t INVALID = -1;
+
+    intptr_t handle = INVALID;
+    uint16_t port = 0;
+};
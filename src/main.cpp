@@ -5,8 +5,25 @@
 #include "imgui_impl_dx9.h"
 #include "imgui_impl_win32.h"
 #include "SnakeGame.h"
+#include "SnakeRenderer.h"
+#include "Replay.h"
+#include "Leaderboard.h"
+#include "Autopilot.h"
+#include "FrameScheduler.h"
+#include "MctsBot.h"
+#include "Profiler.h"
+#include "SimulationThread.h"
 #include <d3d9.h>
+#include <mmsystem.h>
 #include <tchar.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <memory>
+#include <vector>
 
 static LPDIRECT3D9 g_pD3D = nullptr;
 static LPDIRECT3DDEVICE9 g_pd3dDevice = nullptr;
@@ -15,16 +32,369 @@ static UINT g_ResizeWidth = 0, g_ResizeHeight = 0;
 static D3DPRESENT_PARAMETERS g_d3dpp = {};
 
 static SnakeGame* g_game = nullptr;
+static SnakeRenderer g_renderer;
 static int g_gameSpeed = 2;
 static bool g_showHelp = false;
 static bool g_showGameWindow = true;  // Always show game window
 static int g_highScore = 0;
+static ReplayWriter g_replay;  // Records the current game; check it with snake_replay verify
+static const char* REPLAY_PATH = "last_game.snkr";
+static LeaderboardWriter g_leaderboard;  // Every finished game; query it with snake_leaderboard
+static const char* LEADERBOARD_PATH = "leaderboard.snkl";
+static const size_t LEADERBOARD_SHOWN = 5;
+static std::vector<LeaderboardEntry> g_topScores;  // Best games, best first, as shown in the Control Panel
+static bool g_resultRecorded = false;              // The current game's result is on the leaderboard
+static const float AUTOPILOT_RESTART_DELAY = 2.0f;  // Seconds a lost game stays on screen in autopilot mode
+static SimulationThread g_simulation;  // Ticks g_game off the render loop while running
+static FrameScheduler g_frames;        // Skips frames while nothing on screen changes
+static bool g_gameWasTicking = false;  // The game was running at the last frame built
+
+// Steers the game from inside each tick, so it keeps up however many ticks a frame runs
+class AutopilotDriver : public SnakeGameListener
+{
+public:
+    enum Planner { BFS, MCTS };
+
+    void OnBeforeTick(const SnakeGame& game) override
+    {
+        if (enabled)
+            g_game->SetDirection(Plan(game));
+    }
+
+    Direction Plan(const SnakeGame& game)
+    {
+        if (planner == MCTS && mcts)
+        {
+            mcts->SetBudgetMs(mctsBudgetMs.load(std::memory_order_relaxed));
+            return mcts->Plan(game);
+        }
+        return pilot.Plan(game);
+    }
+
+    // Only while the game is stopped; the bot and its threads are made on first use
+    void SetPlanner(int newPlanner)
+    {
+        planner = newPlanner;
+        if (planner == MCTS && !mcts)
+            mcts.reset(new MctsBot());
+    }
+
+    Autopilot pilot;
+    std::unique_ptr<MctsBot> mcts;
+    int planner = BFS;
+    std::atomic<float> mctsBudgetMs{ 10.0f };  // Set from the UI while the game may be ticking
+    bool enabled = false;
+    float restartTimer = 0.0f;
+};
+static const char* PLANNER_NAMES[] = { "BFS autopilot", "MCTS" };
+static AutopilotDriver g_autopilot;
+
+// Board sizes offered in the Control Panel; the large ones rely on the renderer's culling
+static const int BOARD_SIZES[] = { 20, 64, 256, 1024, 4096 };
+static const char* BOARD_SIZE_NAMES[] = { "20 x 20", "64 x 64", "256 x 256", "1024 x 1024", "4096 x 4096" };
+static int g_boardSizeIndex = 0;
+static const int OBSTACLE_COUNTS[] = { 1, 8, 64, 1024, 16384 };
+static const char* OBSTACLE_COUNT_NAMES[] = { "1 obstacle", "8 obstacles", "64 obstacles", "1024 obstacles", "16384 obstacles" };
+static int g_obstacleCountIndex = 0;
+static ImVec2 g_canvasSize(400.0f, 400.0f);  // Play area canvas size of the last frame
+static SnakeRenderStats g_frameStats;        // Draw data totals of the last rendered frame
+
+#ifdef SNAKE_PROFILER
+// Performance window state; the summaries are recomputed a few times a second, since
+// sorting the whole event buffer every frame would show up in the very graph it feeds
+struct PerformanceView
+{
+    bool visible = false;
+    float refreshTimer = 0.0f;
+    std::vector<Profiler::Event> events;
+    std::vector<Profiler::PhaseStats> phases;
+    std::vector<float> frameTimes;  // Milliseconds, oldest first
+    Profiler::TickJitter tickJitter;
+    char status[128] = "";
+};
+static PerformanceView g_performance;
+static const float PERFORMANCE_REFRESH_INTERVAL = 0.5f;
+static const size_t FRAME_GRAPH_LENGTH = 240;
+static const char* TRACE_PATH = "snake_trace.json";
+#endif
 
 bool CreateDeviceD3D(HWND hWnd);
 void CleanupDeviceD3D();
 void ResetDevice();
 LRESULT WINAPI WndProc(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lParam);
 
+// While the simulation thread runs it owns g_game: directions and pauses are sent to
+// it, and any other change stops the thread around it
+template <typename Change>
+void WithGameStopped(Change change)
+{
+    bool threaded = g_simulation.IsRunning();
+    if (threaded)
+        g_simulation.Stop();
+    change();
+    if (threaded)
+        g_simulation.Start(*g_game);
+}
+
+void SendDirection(Direction dir)
+{
+    if (g_simulation.IsRunning())
+        g_simulation.SetDirection(dir);
+    else
+        g_game->SetDirection(dir);
+}
+
+void SendPaused(bool paused)
+{
+    if (g_simulation.IsRunning())
+        g_simulation.SetPaused(paused);
+    else
+        g_game->SetPaused(paused);
+}
+
+// Score and flags for the UI, from the newest published state when the game is threaded
+SnakeGameStatus CurrentStatus()
+{
+    return g_simulation.IsRunning() ? g_simulation.GetCurrent().status : SnakeGameStatus::Of(*g_game);
+}
+
+// Start recording a freshly reset game
+void BeginRecording()
+{
+    g_replay.Begin(REPLAY_PATH, *g_game);
+    g_resultRecorded = false;
+}
+
+// Close the finished game's replay and start recording the next one
+void ResetGame()
+{
+    WithGameStopped([]
+    {
+        if (g_replay.IsOpen())
+            g_replay.Finish(*g_game);
+        g_game->Reset();
+        BeginRecording();
+    });
+}
+
+// Best games so far, and the high score with them
+void LoadLeaderboard()
+{
+    LeaderboardReader reader;
+    if (reader.Open(LEADERBOARD_PATH))
+        reader.Top(LEADERBOARD_SHOWN, g_topScores);
+    if (!g_topScores.empty())
+        g_highScore = static_cast<int>(g_topScores.front().score);
+    g_leaderboard.Open(LEADERBOARD_PATH);
+}
+
+// Closes the replay and logs the result. Autopilot games are not ranked. The shown list
+// is updated in place rather than by rereading the store.
+void FinishGame()
+{
+    if (g_replay.IsOpen())
+        g_replay.Finish(*g_game);
+    g_resultRecorded = true;
+    if (g_autopilot.enabled)
+        return;
+
+    LeaderboardEntry entry;
+    entry.score = static_cast<uint32_t>(g_game->GetScore());
+    entry.length = static_cast<uint32_t>(g_game->GetBody().Size());
+    entry.ticks = g_game->GetTick();
+    entry.seed = g_game->GetSeed();
+    entry.timestamp = static_cast<uint64_t>(time(nullptr));
+    entry.speed = static_cast<uint8_t>(g_gameSpeed);
+    entry.won = g_game->IsGameWon();
+    entry.record = g_leaderboard.GetRecordCount();
+    if (!g_leaderboard.Append(entry))
+        return;
+    auto position = std::find_if(g_topScores.begin(), g_topScores.end(),
+        [&](const LeaderboardEntry& shown) { return entry.RanksAbove(shown); });
+    g_topScores.insert(position, entry);
+    if (g_topScores.size() > LEADERBOARD_SHOWN)
+        g_topScores.pop_back();
+}
+
+// Real seconds per simulated second for the selected speed
+float GameSpeedFactor()
+{
+    return (g_gameSpeed == 1) ? 1.5f : (g_gameSpeed == 2) ? 1.0f : 0.5f;
+}
+
+// Sleeps until a window message arrives or the frame scheduler's next wake-up time
+void WaitForFrame()
+{
+    FrameScheduler::Clock::duration wait = g_frames.TimeToWait(FrameScheduler::Clock::now());
+    if (wait == FrameScheduler::Clock::duration::zero())
+        return;
+    DWORD timeout = INFINITE;
+    if (wait != FrameScheduler::Clock::duration::max())
+    {
+        // Rounded up, so the loop does not wake just short of the frame and spin
+        auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(wait + std::chrono::microseconds(999));
+        timeout = static_cast<DWORD>(ms.count());
+    }
+    ::MsgWaitForMultipleObjectsEx(0, nullptr, timeout, QS_ALLINPUT, MWMO_INPUTAVAILABLE);
+}
+
+// The render loop's waits for the next tick need the 1 ms system timer too; it is only
+// held while the game ticks in the loop, so an idle game leaves the default one alone
+void SetFineTimer(bool enabled)
+{
+    static bool fine = false;
+    if (enabled == fine)
+        return;
+    fine = enabled;
+    if (enabled)
+        timeBeginPeriod(1);
+    else
+        timeEndPeriod(1);
+}
+
+// Everything on the board changes with a tick; the rest is what the panels show
+uint64_t StateStamp(const SnakeGameStatus& status)
+{
+    uint64_t flags = (status.gameOver ? 1 : 0) | (status.gameWon ? 2 : 0) | (status.paused ? 4 : 0) |
+        (status.waitingForStart ? 8 : 0);
+    return (status.seed * 0x9E3779B97F4A7C15ULL) ^ (status.tick << 4) ^ flags;
+}
+
+// Moves the ticks to their own thread or back into the render loop. The thread's waits
+// need the 1 ms system timer; the default 15.6 ms one would make every tick late.
+void SetSimulationThread(bool enabled)
+{
+    if (enabled == g_simulation.IsRunning())
+        return;
+    if (enabled)
+    {
+        timeBeginPeriod(1);
+        g_simulation.SetSpeedFactor(GameSpeedFactor());
+        g_simulation.Start(*g_game);
+    }
+    else
+    {
+        g_simulation.Stop();
+        timeEndPeriod(1);
+    }
+}
+
+// Replace the game with a fresh one on a board of the given size
+void NewBoard(int size)
+{
+    WithGameStopped([size]
+    {
+        if (g_replay.IsOpen())
+            g_replay.Finish(*g_game);
+        uint64_t seed = g_game->GetSeed() + 1;
+        delete g_game;
+        g_game = new SnakeGame(size, size, seed);
+        g_game->SetObstacleCount(OBSTACLE_COUNTS[g_obstacleCountIndex]);
+        g_game->Reset(seed);
+        g_game->AddListener(&g_replay);
+        g_game->AddListener(&g_autopilot);
+        BeginRecording();
+    });
+    g_renderer.GetCamera().cellSize = std::max(SnakeRenderer::FitCellSize(*g_game, g_canvasSize), 4.0f);
+}
+
+#ifdef SNAKE_PROFILER
+// Frame-time graph, per-phase percentiles and tick jitter from the profiler's ring buffer
+void DrawPerformanceWindow(float deltaTime)
+{
+    PerformanceView& view = g_performance;
+    Profiler& profiler = Profiler::Get();
+    if ((view.refreshTimer -= deltaTime) <= 0.0f)
+    {
+        view.refreshTimer = PERFORMANCE_REFRESH_INTERVAL;
+        profiler.CopyEvents(view.events);
+        Profiler::ComputePhaseStats(view.events, view.phases);
+        view.tickJitter = Profiler::ComputeJitter(view.events, "SnakeGame::Step");
+        view.frameTimes.clear();
+        for (const Profiler::Event& event : view.events)
+        {
+            if (std::strcmp(event.name, "Frame") == 0)
+                view.frameTimes.push_back(static_cast<float>(event.durationNs * 1e-6));
+        }
+        if (view.frameTimes.size() > FRAME_GRAPH_LENGTH)
+            view.frameTimes.erase(view.frameTimes.begin(), view.frameTimes.end() - FRAME_GRAPH_LENGTH);
+    }
+
+    ImGui::SetNextWindowPos(ImVec2(870, 10), ImGuiCond_FirstUseEver);
+    ImGui::SetNextWindowSize(ImVec2(430, 440), ImGuiCond_FirstUseEver);
+    ImGui::Begin("Performance", &view.visible);
+
+    bool recording = profiler.IsActive();
+    if (ImGui::Checkbox("Recording", &recording))
+    {
+        if (recording)
+            profiler.Start();
+        else
+            profiler.Stop();
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("Clear"))
+        profiler.Clear();
+
+    // Frame times
+    if (!view.frameTimes.empty())
+    {
+        float maxMs = *std::max_element(view.frameTimes.begin(), view.frameTimes.end());
+        char overlay[64];
+        std::snprintf(overlay, sizeof(overlay), "last %.2f ms, max %.2f ms", view.frameTimes.back(), maxMs);
+        ImGui::PlotLines("##frames", view.frameTimes.data(), static_cast<int>(view.frameTimes.size()), 0, overlay, 0.0f,
+            std::max(maxMs, 33.3f), ImVec2(-1, 80));
+    }
+
+    // Per-phase durations over the buffered events
+    if (ImGui::BeginTable("##phases", 5, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg))
+    {
+        ImGui::TableSetupColumn("Phase");
+        ImGui::TableSetupColumn("Count");
+        ImGui::TableSetupColumn("p50 ms");
+        ImGui::TableSetupColumn("p99 ms");
+        ImGui::TableSetupColumn("max ms");
+        ImGui::TableHeadersRow();
+        for (const Profiler::PhaseStats& phase : view.phases)
+        {
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::Text("%s", phase.name);
+            ImGui::TableNextColumn();
+            ImGui::Text("%d", phase.count);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.3f", phase.p50Ms);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.3f", phase.p99Ms);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.3f", phase.maxMs);
+        }
+        ImGui::EndTable();
+    }
+
+    // Ticks run at frame boundaries, so their spacing wobbles around the target by up to a frame
+    const Profiler::TickJitter& jitter = view.tickJitter;
+    ImGui::Text("TICK RATE (target %.1f ms)", g_game->GetMoveDelay() * GameSpeedFactor() * 1000.0f);
+    if (jitter.intervals > 0)
+        ImGui::Text("mean %.2f ms, stddev %.2f ms, p99 dev %.2f ms", jitter.meanMs, jitter.stddevMs, jitter.p99DeviationMs);
+    else
+        ImGui::TextDisabled("no ticks recorded");
+
+    ImGui::Separator();
+    if (ImGui::Button("Export Chrome trace", ImVec2(-1, 0)))
+    {
+        profiler.CopyEvents(view.events);
+        if (Profiler::WriteChromeTrace(view.events, TRACE_PATH))
+            std::snprintf(view.status, sizeof(view.status), "Wrote %d events to %s", static_cast<int>(view.events.size()), TRACE_PATH);
+        else
+            std::snprintf(view.status, sizeof(view.status), "Cannot write %s", TRACE_PATH);
+    }
+    ImGui::TextDisabled("%s", view.status[0] ? view.status : "Open the file in about:tracing or ui.perfetto.dev");
+
+    ImGui::End();
+}
+#endif
+
 void SetupImGuiStyle()
 {
     ImGuiStyle& style = ImGui::GetStyle();
@@ -81,21 +451,33 @@ int main(int, char**)
     ImGui_ImplWin32_Init(hwnd);
     ImGui_ImplDX9_Init(g_pd3dDevice);
 
-    g_game = new SnakeGame(20, 20);
+    g_game = new SnakeGame(20, 20, static_cast<uint64_t>(time(nullptr)));
+    g_game->AddListener(&g_replay);
+    g_game->AddListener(&g_autopilot);
+    BeginRecording();
+    LoadLeaderboard();
+#ifdef SNAKE_PROFILER
+    Profiler::Get().Start();
+#endif
 
     ImVec4 clear_color = ImVec4(0.05f, 0.05f, 0.1f, 1.0f);
     bool done = false;
 
     while (!done)
     {
+        // A waiting, paused or finished game sleeps here until something happens
+        WaitForFrame();
         MSG msg;
+        SNAKE_PROFILE_BEGIN(pumpScope, "PumpMessages");
         while (::PeekMessage(&msg, nullptr, 0U, 0U, PM_REMOVE))
         {
             ::TranslateMessage(&msg);
             ::DispatchMessage(&msg);
+            g_frames.OnInput();
             if (msg.message == WM_QUIT)
                 done = true;
         }
+        SNAKE_PROFILE_END(pumpScope);
         if (done)
             break;
 
@@ -112,34 +494,97 @@ int main(int, char**)
             g_DeviceLost = false;
         }
 
+        // A state the simulation thread published is worth a frame like input is
+        if (g_simulation.IsRunning())
+            g_simulation.Acquire();
+        g_frames.ObserveState(StateStamp(CurrentStatus()));
+        if (!g_frames.ShouldRender(FrameScheduler::Clock::now()))
+        {
+            g_frames.FrameSkipped();
+            continue;
+        }
+        // Only frames that are built count, so idle wake-ups don't pull the graph to zero
+        SNAKE_PROFILE_SCOPE("Frame");
+
         ImGui_ImplDX9_NewFrame();
         ImGui_ImplWin32_NewFrame();
         ImGui::NewFrame();
 
         ImGuiIO& io = ImGui::GetIO();
+        SnakeGameStatus status = CurrentStatus();
 
         // Process game controls
         if (ImGui::IsKeyPressed(ImGuiKey_UpArrow) || ImGui::IsKeyPressed(ImGuiKey_W))
-            g_game->SetDirection(Direction::UP);
+            SendDirection(Direction::UP);
         if (ImGui::IsKeyPressed(ImGuiKey_DownArrow) || ImGui::IsKeyPressed(ImGuiKey_S))
-            g_game->SetDirection(Direction::DOWN);
+            SendDirection(Direction::DOWN);
         if (ImGui::IsKeyPressed(ImGuiKey_LeftArrow) || ImGui::IsKeyPressed(ImGuiKey_A))
-            g_game->SetDirection(Direction::LEFT);
+            SendDirection(Direction::LEFT);
         if (ImGui::IsKeyPressed(ImGuiKey_RightArrow) || ImGui::IsKeyPressed(ImGuiKey_D))
-            g_game->SetDirection(Direction::RIGHT);
+            SendDirection(Direction::RIGHT);
         if (ImGui::IsKeyPressed(ImGuiKey_Space))
-            g_game->SetPaused(!g_game->IsGamePaused());
+            SendPaused(!status.paused);
         if (ImGui::IsKeyPressed(ImGuiKey_R))
-            g_game->Reset();
+            ResetGame();
+        if (ImGui::IsKeyPressed(ImGuiKey_P))
+            g_autopilot.enabled = !g_autopilot.enabled;
 
+        // Attract mode: the autopilot starts games itself and restarts lost ones
+        if (g_autopilot.enabled)
+        {
+            // A threaded game can't be planned from here; the start heading is always
+            // safe and the pilot takes over from the first tick
+            if (status.waitingForStart)
+                SendDirection(g_simulation.IsRunning() ? status.direction : g_autopilot.Plan(*g_game));
+            if (status.gameOver && (g_autopilot.restartTimer += io.DeltaTime) >= AUTOPILOT_RESTART_DELAY)
+            {
+                g_autopilot.restartTimer = 0.0f;
+                ResetGame();
+            }
+        }
+
+        // ImGui's delta spans however long the loop slept; a game that was not running
+        // then only gets the frame it would have had when it starts
         float deltaTime = io.DeltaTime;
-        float gameSpeed = (g_gameSpeed == 1) ? 1.5f : (g_gameSpeed == 2) ? 1.0f : 0.5f;
-        g_game->Update(deltaTime / gameSpeed);
+        if (!g_gameWasTicking)
+            deltaTime = std::min(deltaTime, 1.0f / 60.0f);
+        if (g_simulation.IsRunning())
+            g_simulation.SetSpeedFactor(GameSpeedFactor());
+        else
+            g_game->Update(deltaTime / GameSpeedFactor());
+        status = CurrentStatus();
+
+        // Redraw every frame while threaded ticks are interpolated; a game ticking in
+        // this loop wakes it for its next tick, and a lost autopilot game for its restart
+        FrameScheduler::Clock::time_point now = FrameScheduler::Clock::now();
+        bool ticking = !status.paused && !status.gameOver && !status.waitingForStart;
+        bool animating = ticking && g_simulation.IsRunning();
+#ifdef SNAKE_PROFILER
+        animating = animating || g_performance.visible;
+#endif
+        g_frames.SetContinuous(animating);
+        if (ticking && !g_simulation.IsRunning())
+        {
+            float seconds = (g_game->GetMoveDelay() - g_game->GetMoveTimer()) * GameSpeedFactor();
+            g_frames.WakeAt(now + std::chrono::duration_cast<FrameScheduler::Clock::duration>(std::chrono::duration<float>(seconds)));
+        }
+        if (g_autopilot.enabled && status.gameOver)
+        {
+            float seconds = std::max(AUTOPILOT_RESTART_DELAY - g_autopilot.restartTimer, 0.0f);
+            g_frames.WakeAt(now + std::chrono::duration_cast<FrameScheduler::Clock::duration>(std::chrono::duration<float>(seconds)));
+        }
+        SetFineTimer(ticking && !g_simulation.IsRunning());
+        g_frames.ObserveState(StateStamp(status));
+        g_gameWasTicking = ticking;
+
+        if (status.score > g_highScore)
+            g_highScore = status.score;
 
-        if (g_game->GetScore() > g_highScore)
-            g_highScore = g_game->GetScore();
+        if (status.gameOver && !g_resultRecorded)
+            WithGameStopped([] { FinishGame(); });
 
         // Control Panel - Left Side
+        SNAKE_PROFILE_BEGIN(uiScope, "BuildUI");
         ImGui::SetNextWindowPos(ImVec2(10, 10), ImGuiCond_FirstUseEver);
         ImGui::SetNextWindowSize(ImVec2(280, 760), ImGuiCond_FirstUseEver);
         ImGui::Begin("Control Panel", nullptr, ImGuiWindowFlags_NoMove);
@@ -151,24 +596,40 @@ int main(int, char**)
         // Score Display
         ImGui::TextColored(ImVec4(1.0f, 1.0f, 0.0f, 1.0f), "SCORE");
         ImGui::SameLine();
-        ImGui::TextColored(ImVec4(0.0f, 1.0f, 0.0f, 1.0f), "%d", g_game->GetScore());
+        ImGui::TextColored(ImVec4(0.0f, 1.0f, 0.0f, 1.0f), "%d", status.score);
         
         ImGui::TextColored(ImVec4(1.0f, 0.5f, 0.0f, 1.0f), "HIGH SCORE");
         ImGui::SameLine();
         ImGui::TextColored(ImVec4(0.0f, 1.0f, 0.0f, 1.0f), "%d", g_highScore);
 
+        // Best games from the leaderboard store
+        ImGui::Separator();
+        ImGui::Text("LEADERBOARD");
+        if (g_topScores.empty())
+            ImGui::TextDisabled("No finished games yet");
+        for (size_t i = 0; i < g_topScores.size(); ++i)
+        {
+            const LeaderboardEntry& entry = g_topScores[i];
+            ImGui::Text("%zu. %u  (len %u, %llu ticks)%s", i + 1, entry.score, entry.length,
+                static_cast<unsigned long long>(entry.ticks), entry.won ? " WIN" : "");
+        }
+
         // Game State
         ImGui::Separator();
         ImGui::Text("STATE");
-        if (g_game->IsWaitingForStart())
+        if (status.waitingForStart)
         {
             ImGui::TextColored(ImVec4(1.0f, 1.0f, 0.0f, 1.0f), "[WAITING FOR INPUT]");
         }
-        else if (g_game->IsGameOver())
+        else if (status.gameWon)
+        {
+            ImGui::TextColored(ImVec4(0.0f, 1.0f, 1.0f, 1.0f), "[YOU WIN]");
+        }
+        else if (status.gameOver)
         {
             ImGui::TextColored(ImVec4(1.0f, 0.0f, 0.0f, 1.0f), "[GAME OVER]");
         }
-        else if (g_game->IsGamePaused())
+        else if (status.paused)
         {
             ImGui::TextColored(ImVec4(1.0f, 1.0f, 0.0f, 1.0f), "[PAUSED]");
         }
@@ -183,51 +644,144 @@ int main(int, char**)
         ImGui::RadioButton("Slow", &g_gameSpeed, 1);
         ImGui::RadioButton("Normal", &g_gameSpeed, 2);
         ImGui::RadioButton("Fast", &g_gameSpeed, 3);
+        bool threaded = g_simulation.IsRunning();
+        if (ImGui::Checkbox("Simulation thread", &threaded))
+            SetSimulationThread(threaded);
+
+        // Keys are read every frame but only move the snake at the next tick; this is
+        // the wait, converted from simulated to real time at the current speed
+        ImGui::Separator();
+        ImGui::Text("INPUT");
+        const InputLatencyStats& latency = status.inputLatency;
+        float realMs = GameSpeedFactor() * 1000.0f;
+        ImGui::Text("Queued: %d/%d", status.pendingInputs, InputQueue::CAPACITY);
+        ImGui::Text("Latency: %d ticks, %.0f ms", latency.lastTicks, latency.lastSeconds * realMs);
+        ImGui::Text("Avg %.2f ticks, %.0f ms", latency.MeanTicks(), latency.MeanSeconds() * realMs);
+        ImGui::Text("Max %d ticks, %.0f ms", latency.maxTicks, latency.maxSeconds * realMs);
+        if (latency.dropped > 0)
+            ImGui::Text("Dropped: %llu", static_cast<unsigned long long>(latency.dropped));
+
+        // Board and camera
+        ImGui::Separator();
+        ImGui::Text("BOARD");
+        if (ImGui::Combo("##board", &g_boardSizeIndex, BOARD_SIZE_NAMES, IM_ARRAYSIZE(BOARD_SIZE_NAMES)))
+            NewBoard(BOARD_SIZES[g_boardSizeIndex]);
+        if (ImGui::Combo("##obstacles", &g_obstacleCountIndex, OBSTACLE_COUNT_NAMES, IM_ARRAYSIZE(OBSTACLE_COUNT_NAMES)))
+        {
+            WithGameStopped([] { g_game->SetObstacleCount(OBSTACLE_COUNTS[g_obstacleCountIndex]); });
+            ResetGame();
+        }
+        SnakeCamera& camera = g_renderer.GetCamera();
+        ImGui::Checkbox("Follow head", &camera.followHead);
+        ImGui::SliderFloat("Zoom", &camera.cellSize, SnakeRenderer::MIN_CELL_SIZE, SnakeRenderer::MAX_CELL_SIZE, "%.1f px");
+        if (ImGui::Button("Fit board", ImVec2(-1, 0)))
+        {
+            camera.cellSize = SnakeRenderer::FitCellSize(*g_game, g_canvasSize);
+            camera.followHead = false;
+        }
+
+        // Draw list cost of the play area and of the whole previous frame
+        ImGui::Separator();
+        ImGui::Text("RENDER");
+        bool batched = g_renderer.IsBatched();
+        if (ImGui::Checkbox("Batched draw lists", &batched))
+            g_renderer.SetBatched(batched);
+        const SnakeRenderStats& playArea = g_renderer.GetLastStats();
+        ImGui::Text("Play area: %d vtx, %d idx, %d draws", playArea.vertices, playArea.indices, playArea.drawCalls);
+        ImGui::Text("Frame:     %d vtx, %d idx, %d draws", g_frameStats.vertices, g_frameStats.indices, g_frameStats.drawCalls);
+        const FrameSchedulerStats& frames = g_frames.GetStats();
+        ImGui::Text("Frames: %llu drawn, %llu skipped", static_cast<unsigned long long>(frames.rendered),
+            static_cast<unsigned long long>(frames.skipped));
+
+        // Autopilot
+        ImGui::Separator();
+        ImGui::Text("AUTOPILOT");
+        ImGui::Checkbox("Enabled", &g_autopilot.enabled);
+        int planner = g_autopilot.planner;
+        if (ImGui::Combo("Planner", &planner, PLANNER_NAMES, IM_ARRAYSIZE(PLANNER_NAMES)))
+            WithGameStopped([planner] { g_autopilot.SetPlanner(planner); });
+        if (g_autopilot.planner == AutopilotDriver::MCTS)
+        {
+            float budgetMs = g_autopilot.mctsBudgetMs.load(std::memory_order_relaxed);
+            if (ImGui::SliderFloat("Budget", &budgetMs, 1.0f, 50.0f, "%.0f ms/move"))
+                g_autopilot.mctsBudgetMs.store(budgetMs, std::memory_order_relaxed);
+        }
+        // The planners' statistics are written on the simulation thread when it runs
+        if (g_autopilot.enabled && !g_simulation.IsRunning())
+        {
+            if (g_autopilot.planner == AutopilotDriver::MCTS)
+            {
+                const MctsBot& mcts = *g_autopilot.mcts;
+                ImGui::Text("Search: %.0f sims/s, %d threads", mcts.GetSimulationsPerSecond(), mcts.GetThreadCount());
+                ImGui::Text("Sims/move: %llu (avg %.0f)", static_cast<unsigned long long>(mcts.GetLastSimulations()),
+                    mcts.GetAverageSimulations());
+                ImGui::Text("Reused nodes: %llu", static_cast<unsigned long long>(mcts.GetLastReusedNodes()));
+            }
+            else
+            {
+                ImGui::Text("Plan: %.1f us (avg %.1f us)", g_autopilot.pilot.GetLastPlanMicros(), g_autopilot.pilot.GetAveragePlanMicros());
+                ImGui::Text("Full rebuilds: %llu", static_cast<unsigned long long>(g_autopilot.pilot.GetFullRebuilds()));
+            }
+        }
 
         ImGui::Separator();
 
         // Reset Button (replaces NEW GAME)
         if (ImGui::Button("[RESET GAME]", ImVec2(-1, 50)))
         {
-            g_game->Reset();
+            ResetGame();
         }
 
         if (ImGui::Button("[HELP]", ImVec2(-1, 50)))
             g_showHelp = !g_showHelp;
+#ifdef SNAKE_PROFILER
+        if (ImGui::Button("[PERFORMANCE]", ImVec2(-1, 30)))
+            g_performance.visible = !g_performance.visible;
+#endif
 
         ImGui::Separator();
         ImGui::TextDisabled("Controls:");
         ImGui::TextDisabled("Arrows/WASD");
         ImGui::TextDisabled("SPACE: Pause");
         ImGui::TextDisabled("R: Reset");
+        ImGui::TextDisabled("P: Autopilot");
 
         ImGui::End();
 
         // Game Window - Always visible
         {
             ImGui::SetNextWindowPos(ImVec2(310, 10), ImGuiCond_FirstUseEver);
-            ImGui::SetNextWindowSize(ImVec2(550, 500), ImGuiCond_FirstUseEver);
+            ImGui::SetNextWindowSize(ImVec2(550, 560), ImGuiCond_FirstUseEver);
             ImGui::Begin("SNAKE GAME - Play Area", nullptr);
 
             ImDrawList* drawList = ImGui::GetWindowDrawList();
             ImVec2 canvasPos = ImGui::GetCursorScreenPos();
-            float cellSize = 20.0f;
-            ImVec2 canvasSize(400.0f, 400.0f);
+            // The canvas fills the window, leaving room for the status lines below it
+            ImVec2 available = ImGui::GetContentRegionAvail();
+            ImVec2 canvasSize(std::max(available.x, 100.0f), std::max(available.y - 90.0f, 100.0f));
+            g_canvasSize = canvasSize;
 
             ImGui::InvisibleButton("##canvas", canvasSize);
-            g_game->Render(drawList, canvasPos, cellSize);
+            if (g_simulation.IsRunning())
+            {
+                // One tick behind, sliding towards the newest state as the next tick nears
+                float alpha = g_simulation.GetInterpolation(std::chrono::steady_clock::now());
+                g_renderer.Render(g_simulation.GetCurrent(), &g_simulation.GetPrevious(), alpha, drawList, canvasPos, canvasSize);
+            }
+            else
+                g_renderer.Render(*g_game, drawList, canvasPos, canvasSize);
 
             ImGui::Separator();
-            ImGui::Text("SCORE: %d", g_game->GetScore());
+            ImGui::Text("SCORE: %d", status.score);
             ImGui::Text("HIGH SCORE: %d", g_highScore);
             
-            if (g_game->IsWaitingForStart())
+            if (status.waitingForStart)
             {
                 ImGui::TextColored(ImVec4(1.0f, 1.0f, 0.0f, 1.0f), "[PRESS ARROW TO START]");
             }
             else
             {
-                ImGui::Text("STATE: %s", g_game->IsGameOver() ? "[GAME OVER]" : (g_game->IsGamePaused() ? "[PAUSED]" : "[PLAYING]"));
+                ImGui::Text("STATE: %s", status.gameWon ? "[YOU WIN]" : status.gameOver ? "[GAME OVER]" : (status.paused ? "[PAUSED]" : "[PLAYING]"));
             }
 
             ImGui::End();
@@ -247,26 +801,35 @@ int main(int, char**)
                 "Guide your snake to eat the red food and grow longer!\n\n"
                 "RULES:\n"
                 "- Avoid hitting walls\n"
-                "- Avoid the moving ORANGE obstacle block\n"
+                "- Avoid the moving ORANGE obstacle blocks\n"
                 "- Don't collide with your own body\n"
                 "- Each food = 10 points\n\n"
                 "GAME ELEMENTS:\n"
                 "GREEN: Your Snake\n"
                 "RED: Food pellets (+10 points)\n"
-                "ORANGE: Moving obstacle (causes game over)\n\n"
+                "ORANGE: Moving obstacles (cause game over; count set in BOARD)\n\n"
                 "CONTROLS:\n"
                 "UP/DOWN/LEFT/RIGHT : Move Snake\n"
                 "WASD               : Alternative Movement\n"
                 "SPACE              : Pause/Resume Game\n"
-                "R                  : Reset Game\n\n"
+                "R                  : Reset Game\n"
+                "P                  : Toggle Autopilot\n\n"
                 "STRATEGY TIP:\n"
-                "Plan your movements carefully to avoid the moving obstacle!\n"
+                "Plan your movements carefully to avoid the moving obstacles!\n"
                 "Adjust speed to match your reflexes."
             );
             ImGui::End();
         }
 
+#ifdef SNAKE_PROFILER
+        if (g_performance.visible)
+            DrawPerformanceWindow(io.DeltaTime);
+#endif
+
         ImGui::EndFrame();
+        SNAKE_PROFILE_END(uiScope);
+
+        SNAKE_PROFILE_BEGIN(renderScope, "Render");
         g_pd3dDevice->SetRenderState(D3DRS_ZENABLE, FALSE);
         g_pd3dDevice->SetRenderState(D3DRS_ALPHABLENDENABLE, FALSE);
         g_pd3dDevice->SetRenderState(D3DRS_SCISSORTESTENABLE, FALSE);
@@ -275,14 +838,28 @@ int main(int, char**)
         if (g_pd3dDevice->BeginScene() >= 0)
         {
             ImGui::Render();
-            ImGui_ImplDX9_RenderDrawData(ImGui::GetDrawData());
+            ImDrawData* drawData = ImGui::GetDrawData();
+            g_frameStats.vertices = drawData->TotalVtxCount;
+            g_frameStats.indices = drawData->TotalIdxCount;
+            g_frameStats.drawCalls = 0;
+            for (int i = 0; i < drawData->CmdListsCount; ++i)
+                g_frameStats.drawCalls += drawData->CmdLists[i]->CmdBuffer.Size;
+            ImGui_ImplDX9_RenderDrawData(drawData);
             g_pd3dDevice->EndScene();
         }
+        SNAKE_PROFILE_END(renderScope);
+        SNAKE_PROFILE_BEGIN(presentScope, "Present");
         HRESULT result = g_pd3dDevice->Present(nullptr, nullptr, nullptr, nullptr);
+        SNAKE_PROFILE_END(presentScope);
         if (result == D3DERR_DEVICELOST)
             g_DeviceLost = true;
+        g_frames.FrameRendered(FrameScheduler::Clock::now());
     }
 
+    SetSimulationThread(false);
+    SetFineTimer(false);
+    if (g_replay.IsOpen())
+        g_replay.Finish(*g_game);
     delete g_game;
     ImGui_ImplDX9_Shutdown();
     ImGui_ImplWin32_Shutdown();
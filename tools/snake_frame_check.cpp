@@ -0,0 +1,149 @@
+// Check of FrameScheduler's rules, run by ctest. It drives the scheduler with made-up
+// times from a fixed origin, with no window and no clock, and requires
+//   - the first frame, then nothing due and no deadline to wait for,
+//   - SETTLE_FRAMES frames after input, and no more,
+//   - a frame for a new state stamp but none for the same one again,
+//   - the earliest of several wake-up times to win, and to be cleared once drawn,
+//   - TimeToWait to be zero while a frame is due and max() while only input can make one,
+//   - FrameRendered to count the display intervals that went by without a frame.
+
+#include "FrameScheduler.h"
+#include <chrono>
+#include <cstdio>
+
+namespace
+{
+using Clock = FrameScheduler::Clock;
+using std::chrono::milliseconds;
+
+const milliseconds FRAME_INTERVAL(10);
+const Clock::time_point ORIGIN = Clock::time_point() + std::chrono::hours(1);
+
+bool Report(const char* check, bool passed)
+{
+    std::printf(passed ? "ok      %s\n" : "FAILED  %s\n", check);
+    return passed;
+}
+
+// Frames drawn at `now` until none is due, up to `limit`
+int DrainFrames(FrameScheduler& scheduler, Clock::time_point now, int limit)
+{
+    int frames = 0;
+    while (frames < limit && scheduler.ShouldRender(now))
+    {
+        scheduler.FrameRendered(now);
+        ++frames;
+    }
+    return frames;
+}
+
+bool CheckFirstFrame()
+{
+    FrameScheduler scheduler(FRAME_INTERVAL);
+    bool first = scheduler.ShouldRender(ORIGIN) && scheduler.TimeToWait(ORIGIN) == Clock::duration::zero();
+    scheduler.FrameRendered(ORIGIN);
+    bool idle = !scheduler.ShouldRender(ORIGIN + milliseconds(500)) &&
+        scheduler.TimeToWait(ORIGIN + milliseconds(500)) == Clock::duration::max();
+    return Report("the first frame is drawn, then the loop waits for input", first && idle);
+}
+
+bool CheckInputSettles()
+{
+    FrameScheduler scheduler(FRAME_INTERVAL);
+    DrainFrames(scheduler, ORIGIN, 10);
+    scheduler.OnInput();
+    int frames = DrainFrames(scheduler, ORIGIN + milliseconds(5), 10);
+    // More input while settling starts the count again rather than adding to it
+    scheduler.OnInput();
+    scheduler.FrameRendered(ORIGIN + milliseconds(6));
+    scheduler.OnInput();
+    int again = DrainFrames(scheduler, ORIGIN + milliseconds(7), 10);
+    char label[64];
+    std::snprintf(label, sizeof(label), "input gives %d frames", FrameScheduler::SETTLE_FRAMES);
+    return Report(label, frames == FrameScheduler::SETTLE_FRAMES && again == FrameScheduler::SETTLE_FRAMES);
+}
+
+bool CheckStateStamps()
+{
+    FrameScheduler scheduler(FRAME_INTERVAL);
+    DrainFrames(scheduler, ORIGIN, 10);
+    scheduler.ObserveState(42);
+    int first = DrainFrames(scheduler, ORIGIN, 10);
+    scheduler.ObserveState(42);
+    int same = DrainFrames(scheduler, ORIGIN, 10);
+    scheduler.ObserveState(43);
+    int changed = DrainFrames(scheduler, ORIGIN, 10);
+    // Stamp 0 is an ordinary value, not "no stamp yet"
+    scheduler.ObserveState(0);
+    int zero = DrainFrames(scheduler, ORIGIN, 10);
+    return Report("a new state stamp gives one frame, the same stamp none",
+        first == 1 && same == 0 && changed == 1 && zero == 1);
+}
+
+bool CheckWakeTimes()
+{
+    FrameScheduler scheduler(FRAME_INTERVAL);
+    DrainFrames(scheduler, ORIGIN, 10);
+    scheduler.WakeAt(ORIGIN + milliseconds(50));
+    scheduler.WakeAt(ORIGIN + milliseconds(20));
+    scheduler.WakeAt(ORIGIN + milliseconds(80));
+    bool earliest = scheduler.TimeToWait(ORIGIN) == milliseconds(20) &&
+        scheduler.TimeToWait(ORIGIN + milliseconds(15)) == milliseconds(5);
+    bool due = !scheduler.ShouldRender(ORIGIN + milliseconds(19)) && scheduler.ShouldRender(ORIGIN + milliseconds(20)) &&
+        scheduler.TimeToWait(ORIGIN + milliseconds(30)) == Clock::duration::zero();
+    // Drawing the frame the wake-up asked for clears it; later ones must be set again
+    scheduler.FrameRendered(ORIGIN + milliseconds(21));
+    bool cleared = !scheduler.ShouldRender(ORIGIN + milliseconds(100)) &&
+        scheduler.TimeToWait(ORIGIN + milliseconds(100)) == Clock::duration::max();
+    // A frame drawn before the wake-up time (for input) leaves it pending
+    scheduler.WakeAt(ORIGIN + milliseconds(200));
+    scheduler.OnInput();
+    DrainFrames(scheduler, ORIGIN + milliseconds(150), 10);
+    bool kept = scheduler.TimeToWait(ORIGIN + milliseconds(150)) == milliseconds(50);
+    return Report("the earliest wake-up time wins and is cleared once drawn", earliest && due && cleared && kept);
+}
+
+bool CheckContinuous()
+{
+    FrameScheduler scheduler(FRAME_INTERVAL);
+    DrainFrames(scheduler, ORIGIN, 10);
+    scheduler.SetContinuous(true);
+    int frames = DrainFrames(scheduler, ORIGIN, 10);
+    bool zero = scheduler.TimeToWait(ORIGIN) == Clock::duration::zero();
+    scheduler.SetContinuous(false);
+    bool idle = scheduler.TimeToWait(ORIGIN) == Clock::duration::max();
+    return Report("continuous redraw draws every pass without waiting", frames == 10 && zero && idle);
+}
+
+bool CheckSkippedFrames()
+{
+    FrameScheduler scheduler(FRAME_INTERVAL);
+    scheduler.FrameRendered(ORIGIN);
+    scheduler.FrameRendered(ORIGIN + milliseconds(10));  // On time: nothing skipped
+    scheduler.FrameRendered(ORIGIN + milliseconds(15));  // Early: nothing skipped
+    scheduler.FrameRendered(ORIGIN + milliseconds(55));  // Four intervals later: three skipped
+    scheduler.FrameSkipped();
+    scheduler.FrameSkipped();
+    const FrameSchedulerStats& stats = scheduler.GetStats();
+    bool counted = stats.rendered == 4 && stats.skipped == 3 && stats.wakeups == 2;
+
+    // Without an interval there is nothing to count gaps against
+    FrameScheduler unpaced(Clock::duration::zero());
+    unpaced.FrameRendered(ORIGIN);
+    unpaced.FrameRendered(ORIGIN + milliseconds(1000));
+    bool unpacedNone = unpaced.GetStats().skipped == 0;
+    return Report("FrameRendered counts the display frames that went by", counted && unpacedNone);
+}
+}
+
+int main()
+{
+    bool ok = true;
+    ok = CheckFirstFrame() && ok;
+    ok = CheckInputSettles() && ok;
+    ok = CheckStateStamps() && ok;
+    ok = CheckWakeTimes() && ok;
+    ok = CheckContinuous() && ok;
+    ok = CheckSkippedFrames() && ok;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,139 @@
+// Leaderboard utility: prints the best games or every game of a seed from a leaderboard
+// log, and compacts the log by rebuilding its index.
+
+#include "Leaderboard.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <vector>
+
+namespace
+{
+const uint32_t DEFAULT_TOP_CAPACITY = 1024;
+
+void PrintUsage()
+{
+    std::printf(
+        "Usage:\n"
+        "  snake_leaderboard info <file>\n"
+        "  snake_leaderboard top <file> [K]\n"
+        "  snake_leaderboard seed <file> <seed>\n"
+        "  snake_leaderboard compact <file> [--top N]\n");
+}
+
+const char* SpeedName(uint8_t speed)
+{
+    switch (speed)
+    {
+    case 1: return "slow";
+    case 2: return "normal";
+    case 3: return "fast";
+    }
+    return "batch";
+}
+
+void PrintEntries(const std::vector<LeaderboardEntry>& entries, double micros)
+{
+    std::printf("%5s %8s %7s %10s %20s %7s %-19s\n", "rank", "score", "length", "ticks", "seed", "speed", "played");
+    for (size_t i = 0; i < entries.size(); ++i)
+    {
+        const LeaderboardEntry& entry = entries[i];
+        char played[32] = "-";
+        std::time_t timestamp = static_cast<std::time_t>(entry.timestamp);
+        if (const std::tm* local = std::localtime(&timestamp))
+            std::strftime(played, sizeof(played), "%Y-%m-%d %H:%M:%S", local);
+        std::printf("%5zu %8u %7u %10llu %20llu %7s %-19s%s\n", i + 1, entry.score, entry.length,
+            static_cast<unsigned long long>(entry.ticks), static_cast<unsigned long long>(entry.seed),
+            SpeedName(entry.speed), played, entry.won ? " won" : "");
+    }
+    std::printf("%zu entries in %.1f us\n", entries.size(), micros);
+}
+
+int Info(const LeaderboardReader& reader)
+{
+    std::printf("records      %llu\n", static_cast<unsigned long long>(reader.GetRecordCount()));
+    std::printf("indexed      %llu\n", static_cast<unsigned long long>(reader.GetIndexedCount()));
+    std::printf("unindexed    %llu\n", static_cast<unsigned long long>(reader.GetRecordCount() - reader.GetIndexedCount()));
+    std::printf("damaged      %llu\n", static_cast<unsigned long long>(reader.GetCorruptCount()));
+    if (reader.GetIndexedCount() > 0)
+        std::printf("top index    %u entries\n", reader.GetTopCapacity());
+    return 0;
+}
+
+int Top(const LeaderboardReader& reader, size_t k)
+{
+    std::vector<LeaderboardEntry> entries;
+    auto start = std::chrono::steady_clock::now();
+    reader.Top(k, entries);
+    double micros = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+    PrintEntries(entries, micros);
+    if (k > reader.GetTopCapacity())
+        std::printf("note: the index keeps the best %u; compact with a larger --top for more\n", reader.GetTopCapacity());
+    return 0;
+}
+
+int Seed(const LeaderboardReader& reader, uint64_t seed)
+{
+    std::vector<LeaderboardEntry> entries;
+    auto start = std::chrono::steady_clock::now();
+    reader.FindSeed(seed, entries);
+    double micros = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+    PrintEntries(entries, micros);
+    return 0;
+}
+
+int Compact(const char* path, int argc, char** argv)
+{
+    uint32_t topCapacity = DEFAULT_TOP_CAPACITY;
+    for (int i = 0; i + 1 < argc; i += 2)
+    {
+        if (std::strcmp(argv[i], "--top") == 0)
+            topCapacity = static_cast<uint32_t>(std::strtoul(argv[i + 1], nullptr, 10));
+    }
+
+    LeaderboardCompactResult result;
+    auto start = std::chrono::steady_clock::now();
+    if (!CompactLeaderboard(path, topCapacity, result))
+    {
+        std::fprintf(stderr, "compact %s failed: %s\n", path, result.error);
+        return 1;
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::printf("compacted %s: %llu records indexed, top %u, %llu damaged records dropped in %.3f s\n", path,
+        static_cast<unsigned long long>(result.records), result.topCount,
+        static_cast<unsigned long long>(result.dropped), seconds);
+    return 0;
+}
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 3)
+    {
+        PrintUsage();
+        return 1;
+    }
+
+    const char* command = argv[1];
+    const char* path = argv[2];
+    if (std::strcmp(command, "compact") == 0)
+        return Compact(path, argc - 3, argv + 3);
+
+    LeaderboardReader reader;
+    if (!reader.Open(path))
+    {
+        std::fprintf(stderr, "cannot read leaderboard %s\n", path);
+        return 1;
+    }
+    if (std::strcmp(command, "info") == 0)
+        return Info(reader);
+    if (std::strcmp(command, "top") == 0)
+        return Top(reader, argc >= 4 ? std::strtoull(argv[3], nullptr, 10) : 10);
+    if (std::strcmp(command, "seed") == 0 && argc >= 4)
+        return Seed(reader, std::strtoull(argv[3], nullptr, 10));
+
+    PrintUsage();
+    return 1;
+}
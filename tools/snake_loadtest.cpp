@@ -0,0 +1,341 @@
+// Multiplayer load test: connects many bot clients to a LockstepServer (an in-process
+// one by default) and reports the server's tick cost and per-client bandwidth. Bots
+// steer greedily towards the food from the frames they decode, so every INPUT they
+// send is a real turn the server has to place, and --lag-ms delays them enough to
+// land behind their frame and drive the rollback path.
+
+#include "LockstepServer.h"
+#include "NetClient.h"
+#include "Policies.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace
+{
+using Clock = std::chrono::steady_clock;
+
+struct Options
+{
+    uint16_t port = 0;      // 0 = start a server in this process
+    int bots = 200;
+    double seconds = 10.0;
+    int threads = 0;        // Client threads; 0 = all hardware threads
+    int lagMs = 0;          // Extra delay on every packet the bots send
+    int width = 128;
+    int height = 128;
+    int obstacles = 0;
+    int tickMillis = 50;
+    int rollbackFrames = 8;
+};
+
+void PrintUsage()
+{
+    std::printf(
+        "Usage: snake_loadtest [options]\n"
+        "  --port P        Connect to a running snake_server instead of starting one\n"
+        "  --bots N        Bot clients (default 200)\n"
+        "  --seconds S     Run time after every bot has joined (default 10)\n"
+        "  --threads N     Client threads (default: all cores)\n"
+        "  --lag-ms L      Delay every bot packet by L ms to exercise rollback (default 0)\n"
+        "  --width W       Grid width of the in-process server (default 128)\n"
+        "  --height H      Grid height of the in-process server (default 128)\n"
+        "  --obstacles N   Moving obstacles on the in-process server (default 0)\n"
+        "  --tick-ms T     Tick period of the in-process server (default 50)\n"
+        "  --rollback F    Rollback window of the in-process server, in frames (default 8)\n");
+}
+
+bool ParseOptions(int argc, char** argv, Options& options)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        const char* arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (std::strcmp(arg, "--port") == 0 && hasValue)
+            options.port = static_cast<uint16_t>(std::atoi(argv[++i]));
+        else if (std::strcmp(arg, "--bots") == 0 && hasValue)
+            options.bots = std::atoi(argv[++i]);
+        else if (std::strcmp(arg, "--seconds") == 0 && hasValue)
+            options.seconds = std::atof(argv[++i]);
+        else if (std::strcmp(arg, "--threads") == 0 && hasValue)
+            options.threads = std::atoi(argv[++i]);
+        else if (std::strcmp(arg, "--lag-ms") == 0 && hasValue)
+            options.lagMs = std::atoi(argv[++i]);
+        else if (std::strcmp(arg, "--width") == 0 && hasValue)
+            options.width = std::atoi(argv[++i]);
+        else if (std::strcmp(arg, "--height") == 0 && hasValue)
+            options.height = std::atoi(argv[++i]);
+        else if (std::strcmp(arg, "--obstacles") == 0 && hasValue)
+            options.obstacles = std::atoi(argv[++i]);
+        else if (std::strcmp(arg, "--tick-ms") == 0 && hasValue)
+            options.tickMillis = std::atoi(argv[++i]);
+        else if (std::strcmp(arg, "--rollback") == 0 && hasValue)
+            options.rollbackFrames = std::atoi(argv[++i]);
+        else
+            return false;
+    }
+    return options.bots > 0 && options.bots < NET_NO_SLOT && options.seconds > 0.0 && options.threads >= 0 &&
+        options.lagMs >= 0 && options.width >= 8 && options.height >= 8 && options.width <= 0xFFFF &&
+        options.height <= 0xFFFF && options.obstacles >= 0 && options.tickMillis > 0 && options.rollbackFrames >= 0;
+}
+
+// Cells taken by any snake or obstacle in one frame. Bots on a thread mostly look at
+// the same frame, so it is rebuilt only when the frame changes.
+class FrameOccupancy
+{
+public:
+    const std::vector<uint8_t>& Get(const NetFrame& frame)
+    {
+        if (frame.frame == builtFrame)
+            return cells;
+        builtFrame = frame.frame;
+        cells.assign(static_cast<size_t>(frame.gridWidth) * frame.gridHeight, 0);
+        for (const NetSnake& snake : frame.snakes)
+        {
+            for (const Segment& segment : snake.body)
+                Mark(frame, segment);
+        }
+        for (const Segment& obstacle : frame.obstacles)
+            Mark(frame, obstacle);
+        return cells;
+    }
+
+private:
+    void Mark(const NetFrame& frame, Segment cell)
+    {
+        if (cell.x >= 0 && cell.y >= 0 && cell.x < frame.gridWidth && cell.y < frame.gridHeight)
+            cells[static_cast<size_t>(cell.y) * frame.gridWidth + cell.x] = 1;
+    }
+
+    uint32_t builtFrame = NET_NO_FRAME;
+    std::vector<uint8_t> cells;
+};
+
+// GreedyPolicy over a decoded frame instead of a SnakeGame
+void Steer(NetClient& bot, FrameOccupancy& occupancy)
+{
+    const NetFrame& frame = bot.GetFrame();
+    if (bot.GetSlot() >= frame.snakes.size())
+        return;
+    const NetSnake& self = frame.snakes[bot.GetSlot()];
+    if (!self.alive || self.body.empty() || frame.gameOver)
+        return;
+
+    const std::vector<uint8_t>& cells = occupancy.Get(frame);
+    const Direction order[4] = { Direction::UP, Direction::DOWN, Direction::LEFT, Direction::RIGHT };
+    Direction best = self.direction;
+    int bestDistance = -1;
+    for (Direction dir : order)
+    {
+        if (IsOppositeDirection(dir, self.direction))
+            continue;
+        Segment next = StepCell(self.body.front(), dir);
+        if (next.x < 0 || next.y < 0 || next.x >= frame.gridWidth || next.y >= frame.gridHeight ||
+            cells[static_cast<size_t>(next.y) * frame.gridWidth + next.x])
+            continue;
+        int distance = std::abs(next.x - frame.food.x) + std::abs(next.y - frame.food.y);
+        if (bestDistance < 0 || distance < bestDistance)
+        {
+            best = dir;
+            bestDistance = distance;
+        }
+    }
+    if (best != self.direction)
+        bot.SetDirection(best);
+}
+
+bool RequestServerStats(uint16_t port, LockstepServerStats& stats)
+{
+    UdpSocket socket;
+    if (!socket.Open())
+        return false;
+    NetAddress server = NetAddress::Loopback(port);
+    std::vector<uint8_t> request, response(NET_MAX_PACKET);
+    ByteWriter writer(request);
+    PutNetHeader(writer, NetPacketType::STATS_REQUEST);
+
+    for (int attempt = 0; attempt < 10; ++attempt)
+    {
+        socket.SendTo(server, request.data(), request.size());
+        if (!socket.Wait(200))
+            continue;
+        NetAddress from;
+        int size;
+        while ((size = socket.ReceiveFrom(from, response.data(), response.size())) > 0)
+        {
+            ByteReader reader(response.data(), static_cast<size_t>(size));
+            NetPacketType type;
+            if (from != server || !GetNetHeader(reader, type) || type != NetPacketType::STATS)
+                continue;
+            stats.frames = reader.GetU64();
+            stats.matches = reader.GetU32();
+            stats.clients = reader.GetU32();
+            stats.meanTickMicros = reader.GetU32() / 1000.0;
+            stats.p99TickMicros = reader.GetU32() / 1000.0;
+            stats.maxTickMicros = reader.GetU32() / 1000.0;
+            stats.rollbacks = reader.GetU64();
+            stats.resimulatedFrames = reader.GetU64();
+            stats.inputs = reader.GetU64();
+            stats.lateInputs = reader.GetU64();
+            stats.bytesSent = reader.GetU64();
+            stats.bytesReceived = reader.GetU64();
+            stats.packetsSent = reader.GetU64();
+            stats.packetsReceived = reader.GetU64();
+            return reader.Ok();
+        }
+    }
+    return false;
+}
+}
+
+int main(int argc, char** argv)
+{
+    Options options;
+    if (!ParseOptions(argc, argv, options))
+    {
+        PrintUsage();
+        return 1;
+    }
+
+    std::unique_ptr<LockstepServer> server;
+    std::thread serverThread;
+    std::atomic<bool> serverRunning(true);
+    uint16_t port = options.port;
+    if (port == 0)
+    {
+        LockstepServerConfig config;
+        config.gridWidth = options.width;
+        config.gridHeight = options.height;
+        config.slots = options.bots;
+        config.obstacles = options.obstacles;
+        config.tickMillis = options.tickMillis;
+        config.rollbackFrames = options.rollbackFrames;
+        server.reset(new LockstepServer(config));
+        if (!server->Open())
+        {
+            std::fprintf(stderr, "snake_loadtest: cannot open a server socket\n");
+            return 1;
+        }
+        port = server->GetPort();
+        serverThread = std::thread([&]()
+        {
+            while (serverRunning.load(std::memory_order_relaxed))
+                server->Update(10);
+        });
+    }
+
+    int threadCount = std::min(options.threads > 0 ? options.threads : ThreadPool::HardwareThreads(), options.bots);
+    std::vector<std::unique_ptr<NetClient>> bots;
+    for (int i = 0; i < options.bots; ++i)
+    {
+        bots.emplace_back(new NetClient());
+        bots.back()->SetSendDelay(options.lagMs);
+    }
+
+    // Joins happen before the clock starts, so the report covers steady play only
+    std::atomic<int> joined(0), ready(0);
+    std::atomic<bool> playing(false), stop(false);
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threadCount; ++t)
+    {
+        workers.emplace_back([&, t]()
+        {
+            size_t first = bots.size() * t / threadCount, last = bots.size() * (t + 1) / threadCount;
+            for (size_t i = first; i < last; ++i)
+            {
+                if (bots[i]->Connect(port))
+                    joined.fetch_add(1);
+            }
+            ready.fetch_add(1);
+            while (!playing.load())
+                std::this_thread::yield();
+
+            FrameOccupancy occupancy;
+            while (!stop.load(std::memory_order_relaxed))
+            {
+                for (size_t i = first; i < last; ++i)
+                {
+                    NetClient& bot = *bots[i];
+                    if (!bot.IsConnected() || !bot.Poll())
+                        continue;
+                    Steer(bot, occupancy);
+                    bot.SendInput();
+                }
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        });
+    }
+
+    // Connect gives up after its timeout, so every worker gets here
+    while (ready.load() < threadCount)
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    std::vector<NetClientStats> before(bots.size());
+    LockstepServerStats serverBefore;
+    RequestServerStats(port, serverBefore);
+    for (size_t i = 0; i < bots.size(); ++i)
+        before[i] = bots[i]->GetStats();
+    Clock::time_point start = Clock::now();
+    playing.store(true);
+
+    std::this_thread::sleep_for(std::chrono::duration<double>(options.seconds));
+    stop.store(true);
+    for (std::thread& worker : workers)
+        worker.join();
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    LockstepServerStats serverAfter;
+    bool haveStats = RequestServerStats(port, serverAfter);
+
+    NetClientStats total;
+    uint64_t missingBases = 0;
+    for (size_t i = 0; i < bots.size(); ++i)
+    {
+        const NetClientStats& after = bots[i]->GetStats();
+        total.bytesSent += after.bytesSent - before[i].bytesSent;
+        total.bytesReceived += after.bytesReceived - before[i].bytesReceived;
+        total.packetsSent += after.packetsSent - before[i].packetsSent;
+        total.packetsReceived += after.packetsReceived - before[i].packetsReceived;
+        total.frames += after.frames - before[i].frames;
+        missingBases += after.missingBases;
+        bots[i]->Disconnect();
+    }
+    if (server)
+    {
+        serverRunning.store(false);
+        serverThread.join();
+    }
+
+    double perBot = 1.0 / (joined.load() > 0 ? joined.load() : 1);
+    std::printf("bots         %d joined of %d (%d threads, %d ms lag)\n", joined.load(), options.bots, threadCount,
+        options.lagMs);
+    std::printf("elapsed      %.2f s\n", seconds);
+    if (haveStats)
+    {
+        std::printf("server       %u clients  %llu frames  %u matches\n", serverAfter.clients,
+            static_cast<unsigned long long>(serverAfter.frames - serverBefore.frames), serverAfter.matches);
+        std::printf("tick         mean %.1f us  p99 %.1f us  max %.1f us\n", serverAfter.meanTickMicros,
+            serverAfter.p99TickMicros, serverAfter.maxTickMicros);
+        std::printf("inputs       %llu  late %llu  rollbacks %llu  resimulated frames %llu\n",
+            static_cast<unsigned long long>(serverAfter.inputs - serverBefore.inputs),
+            static_cast<unsigned long long>(serverAfter.lateInputs - serverBefore.lateInputs),
+            static_cast<unsigned long long>(serverAfter.rollbacks - serverBefore.rollbacks),
+            static_cast<unsigned long long>(serverAfter.resimulatedFrames - serverBefore.resimulatedFrames));
+    }
+    else
+    {
+        std::printf("server       no STATS reply\n");
+    }
+    std::printf("per client   down %.1f B/s  %.1f pkt/s   up %.1f B/s  %.1f pkt/s\n",
+        total.bytesReceived * perBot / seconds, total.packetsReceived * perBot / seconds,
+        total.bytesSent * perBot / seconds, total.packetsSent * perBot / seconds);
+    std::printf("frames       %.1f decoded/s per client  (%llu deltas against a dropped base)\n",
+        total.frames * perBot / seconds, static_cast<unsigned long long>(missingBases));
+    return 0;
+}
@@ -0,0 +1,415 @@
+// Regression check of the software rasterizer that needs neither ImGui nor a GPU, run by
+// ctest. It renders BoardQuadScene for a seeded game and requires
+//   - the same image on one thread and on a pool of several,
+//   - the golden PPM given on the command line, pixel for pixel,
+//   - ImGui's rectangle pairs, set up as rectangles, to match the same quads drawn as
+//     plain triangles, over random translucent quads through a clip rectangle,
+//   - the image back unchanged from WritePpm/ReadPpm and from WritePng, decoded here.
+// --update rewrites the golden image from the current rasterizer first. The goldens of
+// the ImGui Play Area window are snake_render's, on machines with the ImGui sources.
+
+#include "BoardQuadScene.h"
+#include "ImageFile.h"
+#include "Policies.h"
+#include "Random.h"
+#include "SnakeGame.h"
+#include "SoftwareRasterizer.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+namespace
+{
+const int CANVAS_SIZE = 256;
+const int GRID_SIZE = 32;  // 8 pixels per cell on the canvas, so every grid line is drawn
+const uint64_t SEED = 7;
+const uint64_t TICKS = 300;
+const uint32_t CLEAR_COLOR = 0xFF190C0C;  // main.cpp's clear colour
+const int RANDOM_QUADS = 400;
+const char* PPM_PATH = "snake_raster_check.ppm";
+const char* PNG_PATH = "snake_raster_check.png";
+
+void PrintUsage()
+{
+    std::printf("Usage: snake_raster_check <golden.ppm> [--update]\n");
+}
+
+// Pixels that differ, comparing colour only when the alpha was not stored
+int CountDifferences(const RasterImage& a, const RasterImage& b, bool compareAlpha)
+{
+    if (a.width != b.width || a.height != b.height)
+        return -1;
+    uint32_t mask = compareAlpha ? 0xFFFFFFFFu : 0x00FFFFFFu;
+    int differing = 0;
+    for (size_t i = 0; i < a.pixels.size(); ++i)
+        differing += ((a.pixels[i] ^ b.pixels[i]) & mask) != 0 ? 1 : 0;
+    return differing;
+}
+
+bool Report(const char* check, int differing)
+{
+    if (differing == 0)
+        std::printf("ok      %s\n", check);
+    else if (differing < 0)
+        std::printf("FAILED  %s: image sizes differ\n", check);
+    else
+        std::printf("FAILED  %s: %d pixels differ\n", check, differing);
+    return differing == 0;
+}
+
+void Render(SoftwareRasterizer& rasterizer, const RasterDrawCall* calls, int callCount, RasterImage& image)
+{
+    image.Resize(CANVAS_SIZE, CANVAS_SIZE);
+    image.Clear(CLEAR_COLOR);
+    rasterizer.Draw(calls, callCount, image);
+}
+
+// Random quads on a quarter-pixel grid, partly off the canvas, with random colours and
+// alpha; indexed (a, b, c), (a, c, d) as ImGui writes rectangles when `asRects`, and
+// (a, b, c), (c, d, a) otherwise, which covers the same pixels but is not recognised
+void BuildRandomQuads(bool asRects, std::vector<RasterVertex>& vertices, std::vector<uint32_t>& indices)
+{
+    Pcg32 random(SEED);
+    vertices.clear();
+    indices.clear();
+    for (int i = 0; i < RANDOM_QUADS; ++i)
+    {
+        float x0 = static_cast<int>(random.NextBounded(4 * (CANVAS_SIZE + 40))) / 4.0f - 20.0f;
+        float y0 = static_cast<int>(random.NextBounded(4 * (CANVAS_SIZE + 40))) / 4.0f - 20.0f;
+        float x1 = x0 + static_cast<int>(random.NextBounded(4 * 64)) / 4.0f;
+        float y1 = y0 + static_cast<int>(random.NextBounded(4 * 64)) / 4.0f;
+        uint32_t color = random.Next();
+        uint32_t base = static_cast<uint32_t>(vertices.size());
+        vertices.push_back({ x0, y0, 0.0f, 0.0f, color });
+        vertices.push_back({ x1, y0, 0.0f, 0.0f, color });
+        vertices.push_back({ x1, y1, 0.0f, 0.0f, color });
+        vertices.push_back({ x0, y1, 0.0f, 0.0f, color });
+        const uint32_t rect[6] = { base, base + 1, base + 2, base, base + 2, base + 3 };
+        const uint32_t triangles[6] = { base, base + 1, base + 2, base + 2, base + 3, base };
+        indices.insert(indices.end(), asRects ? rect : triangles, (asRects ? rect : triangles) + 6);
+    }
+}
+
+bool CheckRectsMatchTriangles(SoftwareRasterizer& rasterizer)
+{
+    std::vector<RasterVertex> vertices[2];
+    std::vector<uint32_t> indices[2];
+    RasterImage images[2];
+    for (int i = 0; i < 2; ++i)
+    {
+        BuildRandomQuads(i == 0, vertices[i], indices[i]);
+        RasterDrawCall call;
+        call.vertices = vertices[i].data();
+        call.indices = indices[i].data();
+        call.indexSize = 4;
+        call.indexCount = static_cast<int>(indices[i].size());
+        call.clipMinX = 10.5f;
+        call.clipMinY = 7.25f;
+        call.clipMaxX = CANVAS_SIZE - 15.75f;
+        call.clipMaxY = static_cast<float>(CANVAS_SIZE);
+        Render(rasterizer, &call, 1, images[i]);
+    }
+    return Report("rectangles match their two triangles", CountDifferences(images[0], images[1], true));
+}
+
+// Inflates the fixed-Huffman and stored blocks WritePng's encoder emits; false on
+// anything else or on a malformed stream
+class Inflater
+{
+public:
+    Inflater(const std::vector<uint8_t>& data, size_t begin) : data(data), position(begin) {}
+
+    bool Run(std::vector<uint8_t>& out)
+    {
+        static const uint16_t LENGTH_BASE[29] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43,
+            51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+        static const uint8_t LENGTH_EXTRA[29] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4,
+            4, 4, 4, 5, 5, 5, 5, 0 };
+        static const uint16_t DISTANCE_BASE[30] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257,
+            385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+        static const uint8_t DISTANCE_EXTRA[30] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9,
+            9, 10, 10, 11, 11, 12, 12, 13, 13 };
+
+        bool final = false;
+        while (!final && ok)
+        {
+            final = Bits(1) != 0;
+            int type = Bits(2);
+            if (type == 0)
+            {
+                bitCount = 0;  // Stored blocks start on a byte boundary
+                int length = Bits(16);
+                if ((Bits(16) ^ length) != 0xFFFF)
+                    return false;
+                for (int i = 0; i < length && ok; ++i)
+                    out.push_back(static_cast<uint8_t>(Bits(8)));
+                continue;
+            }
+            if (type != 1)
+                return false;
+            for (;;)
+            {
+                int symbol = Literal();
+                if (!ok || symbol > 285)
+                    return false;
+                if (symbol < 256)
+                {
+                    out.push_back(static_cast<uint8_t>(symbol));
+                    continue;
+                }
+                if (symbol == 256)
+                    break;
+                int length = LENGTH_BASE[symbol - 257] + Bits(LENGTH_EXTRA[symbol - 257]);
+                int code = Code(5);
+                if (code >= 30)
+                    return false;
+                size_t distance = DISTANCE_BASE[code] + Bits(DISTANCE_EXTRA[code]);
+                if (distance > out.size())
+                    return false;
+                for (int i = 0; i < length; ++i)
+                    out.push_back(out[out.size() - distance]);
+            }
+        }
+        end = position;
+        return ok;
+    }
+
+    // First byte after the deflate stream, once Run has succeeded
+    size_t End() const { return end; }
+
+private:
+    // `count` bits, least significant first
+    int Bits(int count)
+    {
+        int value = 0;
+        for (int i = 0; i < count; ++i)
+        {
+            if (bitCount == 0)
+            {
+                if (position >= data.size())
+                {
+                    ok = false;
+                    return 0;
+                }
+                bitBuffer = data[position++];
+                bitCount = 8;
+            }
+            value |= (bitBuffer & 1) << i;
+            bitBuffer >>= 1;
+            --bitCount;
+        }
+        return value;
+    }
+
+    // A Huffman code, most significant bit first
+    int Code(int length)
+    {
+        int code = 0;
+        for (int i = 0; i < length; ++i)
+            code = (code << 1) | Bits(1);
+        return code;
+    }
+
+    // The fixed literal/length code of RFC 1951 section 3.2.6
+    int Literal()
+    {
+        int code = Code(7);
+        if (code <= 0x17)
+            return 256 + code;
+        code = (code << 1) | Bits(1);
+        if (code >= 0x30 && code <= 0xBF)
+            return code - 0x30;
+        if (code >= 0xC0 && code <= 0xC7)
+            return 280 + code - 0xC0;
+        code = (code << 1) | Bits(1);
+        return 144 + code - 0x190;
+    }
+
+    const std::vector<uint8_t>& data;
+    size_t position;
+    size_t end = 0;
+    int bitBuffer = 0;
+    int bitCount = 0;
+    bool ok = true;
+};
+
+uint32_t BigEndian(const uint8_t* bytes)
+{
+    return (static_cast<uint32_t>(bytes[0]) << 24) | (bytes[1] << 16) | (bytes[2] << 8) | bytes[3];
+}
+
+uint32_t Crc32(const uint8_t* bytes, size_t size)
+{
+    uint32_t crc = 0xFFFFFFFFu;
+    for (size_t i = 0; i < size; ++i)
+    {
+        crc ^= bytes[i];
+        for (int k = 0; k < 8; ++k)
+            crc = (crc & 1) ? 0xEDB88320u ^ (crc >> 1) : crc >> 1;
+    }
+    return ~crc;
+}
+
+// Decodes the 8-bit RGBA, unfiltered PNGs WritePng produces, checking every chunk CRC
+// and the zlib checksum
+bool ReadPng(const char* path, RasterImage& image)
+{
+    std::FILE* file = std::fopen(path, "rb");
+    if (!file)
+        return false;
+    std::vector<uint8_t> bytes;
+    uint8_t buffer[4096];
+    size_t got;
+    while ((got = std::fread(buffer, 1, sizeof(buffer), file)) > 0)
+        bytes.insert(bytes.end(), buffer, buffer + got);
+    std::fclose(file);
+
+    const uint8_t signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+    if (bytes.size() < 8 || std::memcmp(bytes.data(), signature, 8) != 0)
+        return false;
+    int width = 0, height = 0;
+    std::vector<uint8_t> compressed;
+    bool ended = false;
+    for (size_t at = 8; !ended;)
+    {
+        if (bytes.size() - at < 12)
+            return false;
+        uint32_t length = BigEndian(&bytes[at]);
+        if (bytes.size() - at - 12 < length)
+            return false;
+        const uint8_t* type = &bytes[at + 4];
+        const uint8_t* body = &bytes[at + 8];
+        if (Crc32(type, length + 4) != BigEndian(body + length))
+            return false;
+        if (std::memcmp(type, "IHDR", 4) == 0)
+        {
+            const uint8_t expected[5] = { 8, 6, 0, 0, 0 };
+            if (length != 13 || std::memcmp(body + 8, expected, 5) != 0)
+                return false;
+            width = static_cast<int>(BigEndian(body));
+            height = static_cast<int>(BigEndian(body + 4));
+        }
+        else if (std::memcmp(type, "IDAT", 4) == 0)
+            compressed.insert(compressed.end(), body, body + length);
+        else if (std::memcmp(type, "IEND", 4) == 0)
+            ended = true;
+        at += 12 + length;
+    }
+    if (width <= 0 || height <= 0 || compressed.size() < 6 || (compressed[0] & 0x0F) != 8 ||
+        ((compressed[0] << 8) | compressed[1]) % 31 != 0)
+        return false;
+
+    std::vector<uint8_t> raw;
+    Inflater inflater(compressed, 2);
+    if (!inflater.Run(raw) || compressed.size() - inflater.End() < 4)
+        return false;
+    uint32_t a = 1, b = 0;
+    for (uint8_t byte : raw)
+    {
+        a = (a + byte) % 65521;
+        b = (b + a) % 65521;
+    }
+    if (((b << 16) | a) != BigEndian(&compressed[inflater.End()]))
+        return false;
+
+    size_t stride = static_cast<size_t>(width) * 4 + 1;
+    if (raw.size() != stride * height)
+        return false;
+    image.Resize(width, height);
+    for (int y = 0; y < height; ++y)
+    {
+        const uint8_t* row = &raw[y * stride];
+        if (row[0] != 0)
+            return false;
+        for (int x = 0; x < width; ++x)
+        {
+            const uint8_t* pixel = row + 1 + x * 4;
+            image.pixels[static_cast<size_t>(y) * width + x] =
+                pixel[0] | (pixel[1] << 8) | (pixel[2] << 16) | (static_cast<uint32_t>(pixel[3]) << 24);
+        }
+    }
+    return true;
+}
+
+bool CheckFileRoundTrips(const RasterImage& image)
+{
+    RasterImage ppm, png;
+    bool ok = true;
+    if (!WritePpm(PPM_PATH, image) || !ReadPpm(PPM_PATH, ppm))
+    {
+        std::printf("FAILED  PPM round trip: cannot write or read %s\n", PPM_PATH);
+        ok = false;
+    }
+    else
+        ok = Report("PPM round trip", CountDifferences(image, ppm, false)) && ok;
+    if (!WritePng(PNG_PATH, image) || !ReadPng(PNG_PATH, png))
+    {
+        std::printf("FAILED  PNG round trip: cannot write or decode %s\n", PNG_PATH);
+        ok = false;
+    }
+    else
+        ok = Report("PNG round trip", CountDifferences(image, png, true)) && ok;
+    std::remove(PPM_PATH);
+    std::remove(PNG_PATH);
+    return ok;
+}
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 2 || argv[1][0] == '-')
+    {
+        PrintUsage();
+        return 1;
+    }
+    const char* goldenPath = argv[1];
+    bool update = argc > 2 && std::strcmp(argv[2], "--update") == 0;
+
+    SnakeGame game(GRID_SIZE, GRID_SIZE, SEED);
+    game.Reset(SEED);
+    game.StartGame();
+    while (!game.IsGameOver() && game.GetTick() < TICKS)
+    {
+        game.SetDirection(GreedyPolicy(game));
+        game.Step();
+    }
+    BoardQuadScene scene;
+    scene.Build(game, CANVAS_SIZE);
+
+    // Several workers even on one core, so tiles and setup chunks really are split
+    int threads = std::max(ThreadPool::HardwareThreads(), 4);
+    ThreadPool pool(threads);
+    SoftwareRasterizer serial, parallel(&pool);
+    RasterImage serialImage, parallelImage;
+    Render(serial, &scene.GetCall(), 1, serialImage);
+    Render(parallel, &scene.GetCall(), 1, parallelImage);
+    std::printf("board %dx%d at tick %llu, %llu primitives on a %dx%d canvas\n", GRID_SIZE, GRID_SIZE,
+        static_cast<unsigned long long>(game.GetTick()),
+        static_cast<unsigned long long>(serial.GetLastStats().primitives), CANVAS_SIZE, CANVAS_SIZE);
+
+    bool ok = true;
+    char label[64];
+    std::snprintf(label, sizeof(label), "1 and %d threads give the same image", threads);
+    ok = Report(label, CountDifferences(serialImage, parallelImage, true)) && ok;
+
+    if (update && !WritePpm(goldenPath, serialImage))
+    {
+        std::fprintf(stderr, "cannot write %s\n", goldenPath);
+        return 1;
+    }
+    RasterImage golden;
+    if (!ReadPpm(goldenPath, golden))
+    {
+        std::printf("FAILED  golden image: cannot read %s\n", goldenPath);
+        ok = false;
+    }
+    else
+        ok = Report("golden image", CountDifferences(serialImage, golden, false)) && ok;
+
+    ok = CheckRectsMatchTriangles(parallel) && ok;
+    ok = CheckFileRoundTrips(serialImage) && ok;
+    return ok ? 0 : 1;
+}
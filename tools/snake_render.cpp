@@ -0,0 +1,177 @@
+// Renders the play area on the CPU: plays a seeded greedy game for a number of ticks, draws
+// the game's Play Area window (title bar, board and status lines) with ImGui and no
+// backend, and rasterizes the draw data with the software rasterizer. The frame is
+// written as PNG or PPM, and can be compared with a golden PPM so the visual path can be
+// regression-tested on machines without a GPU.
+
+#include "DrawDataRasterizer.h"
+#include "ImageFile.h"
+#include "Policies.h"
+#include "SnakeGame.h"
+#include "SnakeRenderer.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+
+namespace
+{
+const uint32_t CLEAR_COLOR = IM_COL32(12, 12, 25, 255);  // main.cpp's clear colour
+
+void PrintUsage()
+{
+    std::printf(
+        "Usage:\n"
+        "  snake_render <out.png|out.ppm> [--seed S] [--width W] [--height H] [--ticks T] [--obstacles N]\n"
+        "                [--size PX] [--threads N] [--compare golden.ppm] [--tolerance N]\n");
+}
+
+bool EndsWith(const char* text, const char* suffix)
+{
+    size_t length = std::strlen(text), suffixLength = std::strlen(suffix);
+    return length >= suffixLength && std::strcmp(text + length - suffixLength, suffix) == 0;
+}
+
+// Pixels differing from the golden image by more than `tolerance` in a colour channel
+int Compare(const RasterImage& image, const RasterImage& golden, int tolerance, int& maxDifference)
+{
+    int differing = 0;
+    maxDifference = 0;
+    for (size_t i = 0; i < image.pixels.size(); ++i)
+    {
+        int worst = 0;
+        for (int shift = 0; shift < 24; shift += 8)
+        {
+            int a = (image.pixels[i] >> shift) & 0xFF, b = (golden.pixels[i] >> shift) & 0xFF;
+            worst = std::max(worst, std::abs(a - b));
+        }
+        maxDifference = std::max(maxDifference, worst);
+        if (worst > tolerance)
+            ++differing;
+    }
+    return differing;
+}
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 2 || argv[1][0] == '-')
+    {
+        PrintUsage();
+        return 1;
+    }
+    const char* outPath = argv[1];
+    uint64_t seed = 1;
+    int width = 20, height = 20, obstacles = 1, size = 560, threads = 0, tolerance = 0;
+    uint64_t ticks = 200;
+    const char* comparePath = nullptr;
+    for (int i = 2; i + 1 < argc; i += 2)
+    {
+        if (std::strcmp(argv[i], "--seed") == 0)
+            seed = std::strtoull(argv[i + 1], nullptr, 10);
+        else if (std::strcmp(argv[i], "--width") == 0)
+            width = std::atoi(argv[i + 1]);
+        else if (std::strcmp(argv[i], "--height") == 0)
+            height = std::atoi(argv[i + 1]);
+        else if (std::strcmp(argv[i], "--ticks") == 0)
+            ticks = std::strtoull(argv[i + 1], nullptr, 10);
+        else if (std::strcmp(argv[i], "--obstacles") == 0)
+            obstacles = std::atoi(argv[i + 1]);
+        else if (std::strcmp(argv[i], "--size") == 0)
+            size = std::max(std::atoi(argv[i + 1]), 64);
+        else if (std::strcmp(argv[i], "--threads") == 0)
+            threads = std::atoi(argv[i + 1]);
+        else if (std::strcmp(argv[i], "--compare") == 0)
+            comparePath = argv[i + 1];
+        else if (std::strcmp(argv[i], "--tolerance") == 0)
+            tolerance = std::atoi(argv[i + 1]);
+    }
+
+    SnakeGame game(width, height, seed);
+    game.SetObstacleCount(obstacles);
+    game.Reset(seed);
+    game.StartGame();
+    while (!game.IsGameOver() && game.GetTick() < ticks)
+    {
+        game.SetDirection(GreedyPolicy(game));
+        game.Step();
+    }
+
+    // Headless ImGui: no backend, the font atlas handed to the rasterizer as a texture
+    std::unique_ptr<ThreadPool> pool(threads != 1 ? new ThreadPool(threads) : nullptr);
+    DrawDataRasterizer rasterizer(pool.get());
+    ImGui::CreateContext();
+    ImGuiIO& io = ImGui::GetIO();
+    io.IniFilename = nullptr;
+    io.DisplaySize = ImVec2(static_cast<float>(size), static_cast<float>(size));
+    io.DeltaTime = 1.0f / 60.0f;
+    unsigned char* fontPixels = nullptr;
+    int fontWidth = 0, fontHeight = 0;
+    io.Fonts->GetTexDataAsRGBA32(&fontPixels, &fontWidth, &fontHeight);
+    ImTextureID fontId = (ImTextureID)(intptr_t)1;
+    io.Fonts->SetTexID(fontId);
+    RasterTexture font;
+    font.pixels = reinterpret_cast<const uint32_t*>(fontPixels);
+    font.width = fontWidth;
+    font.height = fontHeight;
+    rasterizer.SetTexture(fontId, font);
+
+    // The Play Area window as main.cpp lays it out, filling the image
+    ImGui::NewFrame();
+    ImGui::SetNextWindowPos(ImVec2(0.0f, 0.0f));
+    ImGui::SetNextWindowSize(io.DisplaySize);
+    ImGui::Begin("SNAKE GAME - Play Area", nullptr, ImGuiWindowFlags_NoMove | ImGuiWindowFlags_NoResize | ImGuiWindowFlags_NoCollapse);
+    ImVec2 canvasPos = ImGui::GetCursorScreenPos();
+    ImVec2 available = ImGui::GetContentRegionAvail();
+    ImVec2 canvasSize(std::max(available.x, 100.0f), std::max(available.y - 90.0f, 100.0f));
+    ImGui::InvisibleButton("##canvas", canvasSize);
+    SnakeRenderer renderer;
+    renderer.GetCamera().cellSize = std::max(SnakeRenderer::FitCellSize(game, canvasSize), 4.0f);
+    renderer.Render(game, ImGui::GetWindowDrawList(), canvasPos, canvasSize);
+    ImGui::Separator();
+    ImGui::Text("SCORE: %d", game.GetScore());
+    ImGui::Text("STATE: %s", game.IsGameWon() ? "[YOU WIN]" : game.IsGameOver() ? "[GAME OVER]" : "[PLAYING]");
+    ImGui::End();
+    ImGui::Render();
+
+    RasterImage image;
+    image.Resize(size, size);
+    image.Clear(CLEAR_COLOR);
+    rasterizer.Render(*ImGui::GetDrawData(), image);
+    const RasterStats& stats = rasterizer.GetLastStats();
+    std::printf("tick %llu, score %d: %llu primitives, %llu pixels, setup %.3f ms, raster %.3f ms\n",
+        static_cast<unsigned long long>(game.GetTick()), game.GetScore(),
+        static_cast<unsigned long long>(stats.primitives), static_cast<unsigned long long>(stats.pixels),
+        stats.setupSeconds * 1000.0, stats.rasterSeconds * 1000.0);
+    ImGui::DestroyContext();
+
+    bool written = EndsWith(outPath, ".png") ? WritePng(outPath, image) : WritePpm(outPath, image);
+    if (!written)
+    {
+        std::fprintf(stderr, "cannot write %s\n", outPath);
+        return 1;
+    }
+
+    if (comparePath)
+    {
+        RasterImage golden;
+        if (!ReadPpm(comparePath, golden))
+        {
+            std::fprintf(stderr, "cannot read %s\n", comparePath);
+            return 1;
+        }
+        if (golden.width != image.width || golden.height != image.height)
+        {
+            std::printf("size differs: %dx%d, golden %dx%d\n", image.width, image.height, golden.width, golden.height);
+            return 1;
+        }
+        int maxDifference = 0;
+        int differing = Compare(image, golden, tolerance, maxDifference);
+        std::printf("%d pixels differ by more than %d (largest difference %d)\n", differing, tolerance, maxDifference);
+        return differing == 0 ? 0 : 1;
+    }
+    return 0;
+}
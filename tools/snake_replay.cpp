@@ -0,0 +1,164 @@
+// Replay utility: records a headless game, prints replay info, seeks to a tick and
+// verifies a replay by re-simulating it from its seed.
+
+#include "Policies.h"
+#include "Replay.h"
+#include "SnakeGame.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace
+{
+void PrintUsage()
+{
+    std::printf(
+        "Usage:\n"
+        "  snake_replay record <file> [--seed S] [--width W] [--height H] [--keyframe N] [--max-ticks T]\n"
+        "                       [--obstacles N]\n"
+        "  snake_replay info <file>\n"
+        "  snake_replay seek <file> <tick>\n"
+        "  snake_replay verify <file>\n");
+}
+
+const char* DirectionName(Direction dir)
+{
+    switch (dir)
+    {
+    case Direction::UP:    return "up";
+    case Direction::DOWN:  return "down";
+    case Direction::LEFT:  return "left";
+    case Direction::RIGHT: return "right";
+    }
+    return "?";
+}
+
+int Record(const char* path, int argc, char** argv)
+{
+    uint64_t seed = 1;
+    int width = 20, height = 20;
+    uint32_t keyframe = ReplayWriter::DEFAULT_KEYFRAME_INTERVAL;
+    uint64_t maxTicks = 1000000;
+    int obstacles = 1;
+    for (int i = 0; i + 1 < argc; i += 2)
+    {
+        if (std::strcmp(argv[i], "--seed") == 0)
+            seed = std::strtoull(argv[i + 1], nullptr, 10);
+        else if (std::strcmp(argv[i], "--width") == 0)
+            width = std::atoi(argv[i + 1]);
+        else if (std::strcmp(argv[i], "--height") == 0)
+            height = std::atoi(argv[i + 1]);
+        else if (std::strcmp(argv[i], "--keyframe") == 0)
+            keyframe = static_cast<uint32_t>(std::strtoul(argv[i + 1], nullptr, 10));
+        else if (std::strcmp(argv[i], "--max-ticks") == 0)
+            maxTicks = std::strtoull(argv[i + 1], nullptr, 10);
+        else if (std::strcmp(argv[i], "--obstacles") == 0)
+            obstacles = std::atoi(argv[i + 1]);
+    }
+
+    SnakeGame game(width, height, seed);
+    game.SetObstacleCount(obstacles);
+    game.Reset(seed);
+    ReplayWriter writer;
+    if (!writer.Begin(path, game, keyframe))
+    {
+        std::fprintf(stderr, "cannot create %s\n", path);
+        return 1;
+    }
+    game.AddListener(&writer);
+    game.StartGame();
+    while (!game.IsGameOver() && game.GetTick() < maxTicks)
+    {
+        Direction dir = GreedyPolicy(game);
+        if (dir != game.GetDirection())
+            game.SetDirection(dir);
+        game.Step();
+    }
+    game.RemoveListener(&writer);
+    if (!writer.Finish(game))
+    {
+        std::fprintf(stderr, "write to %s failed\n", path);
+        return 1;
+    }
+    std::printf("recorded %s: %llu ticks, score %d\n", path, static_cast<unsigned long long>(game.GetTick()), game.GetScore());
+    return 0;
+}
+
+int Info(const ReplayReader& reader)
+{
+    std::printf("grid         %dx%d\n", reader.GetGridWidth(), reader.GetGridHeight());
+    std::printf("seed         %llu\n", static_cast<unsigned long long>(reader.GetSeed()));
+    std::printf("obstacles    %d\n", reader.GetObstacleCount());
+    std::printf("input        %s\n", reader.IsBufferedInput() ? "queued" : "single pending direction (old format)");
+    std::printf("final tick   %llu\n", static_cast<unsigned long long>(reader.GetFinalTick()));
+    std::printf("final score  %d%s\n", reader.GetFinalScore(), reader.IsGameWon() ? " (won)" : "");
+    std::printf("keyframes    %d (every %u ticks)\n", reader.GetKeyframeCount(), reader.GetKeyframeInterval());
+    return 0;
+}
+
+int Seek(const ReplayReader& reader, uint64_t tick)
+{
+    SnakeGame game(reader.GetGridWidth(), reader.GetGridHeight());
+    auto start = std::chrono::steady_clock::now();
+    bool ok = reader.Seek(game, tick);
+    double micros = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+    if (!ok)
+    {
+        std::fprintf(stderr, "seek to tick %llu failed\n", static_cast<unsigned long long>(tick));
+        return 1;
+    }
+    const Segment& head = game.GetBody().Head();
+    std::printf("tick %llu: score %d, length %d, head (%d,%d) heading %s, food (%d,%d)%s  [%.1f us]\n",
+        static_cast<unsigned long long>(game.GetTick()), game.GetScore(), game.GetBody().Size(), head.x, head.y,
+        DirectionName(game.GetDirection()), game.GetFood().x, game.GetFood().y, game.IsGameOver() ? " GAME OVER" : "", micros);
+    return 0;
+}
+
+int Verify(const ReplayReader& reader)
+{
+    SnakeGame game(reader.GetGridWidth(), reader.GetGridHeight());
+    auto start = std::chrono::steady_clock::now();
+    ReplayVerifyResult result = reader.Verify(game);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (!result.ok)
+    {
+        std::printf("FAIL: %s (tick %llu, score %d, expected score %d)\n", result.error,
+            static_cast<unsigned long long>(result.ticks), result.score, reader.GetFinalScore());
+        return 1;
+    }
+    std::printf("OK: %llu ticks, score %d, %d keyframes matched in %.3f s\n",
+        static_cast<unsigned long long>(result.ticks), result.score, result.keyframesChecked, seconds);
+    return 0;
+}
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 3)
+    {
+        PrintUsage();
+        return 1;
+    }
+
+    const char* command = argv[1];
+    const char* path = argv[2];
+    if (std::strcmp(command, "record") == 0)
+        return Record(path, argc - 3, argv + 3);
+
+    ReplayReader reader;
+    if (!reader.Open(path))
+    {
+        std::fprintf(stderr, "cannot read replay %s\n", path);
+        return 1;
+    }
+    if (std::strcmp(command, "info") == 0)
+        return Info(reader);
+    if (std::strcmp(command, "seek") == 0 && argc >= 4)
+        return Seek(reader, std::strtoull(argv[3], nullptr, 10));
+    if (std::strcmp(command, "verify") == 0)
+        return Verify(reader);
+
+    PrintUsage();
+    return 1;
+}
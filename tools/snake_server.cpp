@@ -0,0 +1,95 @@
+// Multiplayer Snake host: runs a LockstepServer on the loopback interface until
+// interrupted, printing its statistics every few seconds. Links only against
+// snake_net (no ImGui).
+
+#include "LockstepServer.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace
+{
+const int REPORT_SECONDS = 5;
+
+void PrintUsage()
+{
+    std::printf(
+        "Usage: snake_server [options]\n"
+        "  --port P        UDP port on 127.0.0.1 (default 7777)\n"
+        "  --width W       Grid width (default 64)\n"
+        "  --height H      Grid height (default 64)\n"
+        "  --snakes N      Player slots, one snake each (default 16)\n"
+        "  --obstacles N   Moving obstacles (default 0)\n"
+        "  --tick-ms T     Tick period in milliseconds (default 50)\n"
+        "  --rollback F    Frames an input may arrive late and still be replayed (default 8)\n"
+        "  --seed S        Seed of the first match (default 1)\n");
+}
+
+bool ParseOptions(int argc, char** argv, LockstepServerConfig& config)
+{
+    config.port = 7777;
+    for (int i = 1; i < argc; ++i)
+    {
+        const char* arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (std::strcmp(arg, "--port") == 0 && hasValue)
+            config.port = static_cast<uint16_t>(std::atoi(argv[++i]));
+        else if (std::strcmp(arg, "--width") == 0 && hasValue)
+            config.gridWidth = std::atoi(argv[++i]);
+        else if (std::strcmp(arg, "--height") == 0 && hasValue)
+            config.gridHeight = std::atoi(argv[++i]);
+        else if (std::strcmp(arg, "--snakes") == 0 && hasValue)
+            config.slots = std::atoi(argv[++i]);
+        else if (std::strcmp(arg, "--obstacles") == 0 && hasValue)
+            config.obstacles = std::atoi(argv[++i]);
+        else if (std::strcmp(arg, "--tick-ms") == 0 && hasValue)
+            config.tickMillis = std::atoi(argv[++i]);
+        else if (std::strcmp(arg, "--rollback") == 0 && hasValue)
+            config.rollbackFrames = std::atoi(argv[++i]);
+        else if (std::strcmp(arg, "--seed") == 0 && hasValue)
+            config.seed = std::strtoull(argv[++i], nullptr, 10);
+        else
+            return false;
+    }
+    return config.gridWidth >= 8 && config.gridHeight >= 8 && config.gridWidth <= 0xFFFF &&
+        config.gridHeight <= 0xFFFF && config.slots > 0 && config.slots < NET_NO_SLOT && config.obstacles >= 0 &&
+        config.tickMillis > 0 && config.rollbackFrames >= 0;
+}
+}
+
+int main(int argc, char** argv)
+{
+    LockstepServerConfig config;
+    if (!ParseOptions(argc, argv, config))
+    {
+        PrintUsage();
+        return 1;
+    }
+
+    LockstepServer server(config);
+    if (!server.Open())
+    {
+        std::fprintf(stderr, "snake_server: cannot bind 127.0.0.1:%u\n", static_cast<unsigned>(config.port));
+        return 1;
+    }
+    std::printf("listening on 127.0.0.1:%u  (%dx%d, %d slots, %d ms ticks)\n", static_cast<unsigned>(server.GetPort()),
+        config.gridWidth, config.gridHeight, config.slots, config.tickMillis);
+
+    auto nextReport = std::chrono::steady_clock::now() + std::chrono::seconds(REPORT_SECONDS);
+    for (;;)
+    {
+        server.Update();
+        if (std::chrono::steady_clock::now() < nextReport)
+            continue;
+        nextReport += std::chrono::seconds(REPORT_SECONDS);
+
+        const LockstepServerStats& stats = server.GetStats();
+        std::printf("frame %llu  match %u  clients %u  tick mean %.1f us  p99 %.1f us  max %.1f us  "
+            "rollbacks %llu  late %llu\n",
+            static_cast<unsigned long long>(stats.frames), stats.matches, stats.clients, stats.meanTickMicros,
+            stats.p99TickMicros, stats.maxTickMicros, static_cast<unsigned long long>(stats.rollbacks),
+            static_cast<unsigned long long>(stats.lateInputs));
+        std::fflush(stdout);
+    }
+}
@@ -0,0 +1,269 @@
+// Headless Snake simulator: plays N games with the greedy policy (or the autopilot or
+// the MCTS bot) and reports throughput. Links only against the snake_core library (no ImGui).
+
+#include "Autopilot.h"
+#include "BatchRunner.h"
+#include "Leaderboard.h"
+#include "MctsBot.h"
+#include "Policies.h"
+#include "SnakeGame.h"
+#include "ThreadPool.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <memory>
+#include <vector>
+
+namespace
+{
+struct Options
+{
+    int games = 1000;
+    int width = 20;
+    int height = 20;
+    int obstacles = 1;
+    int maxTicks = 100000;  // Per-game cap so a looping policy can't stall the run
+    uint64_t seed = 1;      // Game i is played with seed + i
+    int threads = 0;        // 0 = all hardware threads
+    bool scaling = false;   // Repeat the batch at 1, 2, 4, ... threads
+    bool autopilot = false; // Play with the BFS autopilot instead of the greedy policy
+    double mctsMs = 0.0;    // Play with the MCTS bot at this budget per move; 0 = off
+    int mctsThreads = 0;    // MCTS search threads, 0 = all hardware threads
+    const char* leaderboard = nullptr;  // Log every game's result to this leaderboard
+};
+
+void PrintUsage()
+{
+    std::printf(
+        "Usage: snake_sim [options]\n"
+        "  --games N       Number of games to play (default 1000)\n"
+        "  --width W       Grid width (default 20)\n"
+        "  --height H      Grid height (default 20)\n"
+        "  --obstacles N   Moving obstacles per game (default 1)\n"
+        "  --max-ticks T   Tick limit per game (default 100000)\n"
+        "  --seed S        Seed of the first game; game i uses S + i (default 1)\n"
+        "  --threads N     Worker threads (default: all cores)\n"
+        "  --scaling       Report throughput from 1 thread up to --threads\n"
+        "  --autopilot     Steer with the BFS autopilot instead of the greedy policy\n"
+        "  --mcts MS       Steer with the MCTS bot, searching MS milliseconds per move;\n"
+        "                  games run one at a time, the search gets the threads\n"
+        "  --mcts-threads N  MCTS search threads (default: all cores)\n"
+        "  --leaderboard F Append every game's result to the leaderboard log F\n");
+}
+
+bool ParseOptions(int argc, char** argv, Options& options)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        const char* arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (std::strcmp(arg, "--games") == 0 && hasValue)
+            options.games = std::atoi(argv[++i]);
+        else if (std::strcmp(arg, "--width") == 0 && hasValue)
+            options.width = std::atoi(argv[++i]);
+        else if (std::strcmp(arg, "--height") == 0 && hasValue)
+            options.height = std::atoi(argv[++i]);
+        else if (std::strcmp(arg, "--obstacles") == 0 && hasValue)
+            options.obstacles = std::atoi(argv[++i]);
+        else if (std::strcmp(arg, "--max-ticks") == 0 && hasValue)
+            options.maxTicks = std::atoi(argv[++i]);
+        else if (std::strcmp(arg, "--seed") == 0 && hasValue)
+            options.seed = std::strtoull(argv[++i], nullptr, 10);
+        else if (std::strcmp(arg, "--threads") == 0 && hasValue)
+            options.threads = std::atoi(argv[++i]);
+        else if (std::strcmp(arg, "--scaling") == 0)
+            options.scaling = true;
+        else if (std::strcmp(arg, "--autopilot") == 0)
+            options.autopilot = true;
+        else if (std::strcmp(arg, "--mcts") == 0 && hasValue)
+            options.mctsMs = std::atof(argv[++i]);
+        else if (std::strcmp(arg, "--mcts-threads") == 0 && hasValue)
+            options.mctsThreads = std::atoi(argv[++i]);
+        else if (std::strcmp(arg, "--leaderboard") == 0 && hasValue)
+            options.leaderboard = argv[++i];
+        else
+            return false;
+    }
+    return options.games > 0 && options.width >= 8 && options.height >= 8 && options.obstacles >= 0 &&
+        options.maxTicks > 0 && options.threads >= 0 && !(options.scaling && options.leaderboard) && options.mctsMs >= 0.0 &&
+        options.mctsThreads >= 0 && !(options.autopilot && options.mctsMs > 0.0) && !(options.scaling && options.mctsMs > 0.0);
+}
+
+// One autopilot per worker; kept here so planner time can be summed after the run
+struct AutopilotPool
+{
+    std::vector<std::shared_ptr<Autopilot>> pilots;
+
+    SnakePolicyFactory Factory()
+    {
+        return [this]() -> SnakePolicy
+        {
+            std::shared_ptr<Autopilot> pilot = std::make_shared<Autopilot>();
+            pilots.push_back(pilot);
+            return [pilot](const SnakeGame& game) { return pilot->Plan(game); };
+        };
+    }
+
+    double AverageMicros() const
+    {
+        double seconds = 0.0;
+        uint64_t plans = 0;
+        for (const auto& pilot : pilots)
+        {
+            seconds += pilot->GetTotalPlanSeconds();
+            plans += pilot->GetPlanCount();
+        }
+        return plans > 0 ? seconds * 1e6 / plans : 0.0;
+    }
+};
+
+// MCTS bots, one per game slot, kept for their search statistics
+struct MctsPool
+{
+    MctsConfig config;
+    std::vector<std::shared_ptr<MctsBot>> bots;
+
+    SnakePolicyFactory Factory()
+    {
+        return [this]() -> SnakePolicy
+        {
+            std::shared_ptr<MctsBot> bot = std::make_shared<MctsBot>(config);
+            bots.push_back(bot);
+            return [bot](const SnakeGame& game) { return bot->Plan(game); };
+        };
+    }
+
+    // Simulations per second and per move over every bot
+    void Totals(double& perSecond, double& perMove) const
+    {
+        double simulations = 0.0, seconds = 0.0;
+        uint64_t plans = 0;
+        for (const auto& bot : bots)
+        {
+            double botSimulations = bot->GetAverageSimulations() * bot->GetPlanCount();
+            simulations += botSimulations;
+            if (bot->GetSimulationsPerSecond() > 0.0)
+                seconds += botSimulations / bot->GetSimulationsPerSecond();
+            plans += bot->GetPlanCount();
+        }
+        perSecond = seconds > 0.0 ? simulations / seconds : 0.0;
+        perMove = plans > 0 ? simulations / plans : 0.0;
+    }
+};
+
+// One block append for the whole batch; headless games have no speed setting
+bool AppendToLeaderboard(const char* path, const BatchResult& result)
+{
+    LeaderboardWriter writer;
+    if (!writer.Open(path))
+        return false;
+    uint64_t now = static_cast<uint64_t>(std::time(nullptr));
+    std::vector<LeaderboardEntry> entries(result.gameResults.size());
+    for (size_t i = 0; i < entries.size(); ++i)
+    {
+        const BatchGame& game = result.gameResults[i];
+        entries[i].score = static_cast<uint32_t>(game.score);
+        entries[i].length = static_cast<uint32_t>(game.length);
+        entries[i].ticks = game.ticks;
+        entries[i].seed = game.seed;
+        entries[i].timestamp = now;
+        entries[i].won = game.won;
+    }
+    return writer.Append(entries.data(), entries.size());
+}
+
+BatchResult Run(const BatchConfig& config, const Options& options, ThreadPool& pool, AutopilotPool& autopilots,
+    MctsPool& bots)
+{
+    if (options.mctsMs > 0.0)
+        return RunBatch(config, bots.Factory(), pool);
+    if (options.autopilot)
+        return RunBatch(config, autopilots.Factory(), pool);
+    return RunBatch(config, GreedyPolicy, pool);
+}
+}
+
+int main(int argc, char** argv)
+{
+    Options options;
+    if (!ParseOptions(argc, argv, options))
+    {
+        PrintUsage();
+        return 1;
+    }
+
+    BatchConfig config;
+    config.gridWidth = options.width;
+    config.gridHeight = options.height;
+    config.obstacleCount = options.obstacles;
+    config.gameCount = options.games;
+    config.firstSeed = options.seed;
+    config.maxTicks = options.maxTicks;
+    config.keepGames = options.leaderboard != nullptr;
+
+    int maxThreads = options.threads > 0 ? options.threads : ThreadPool::HardwareThreads();
+
+    if (options.scaling)
+    {
+        std::printf("%8s %12s %14s %9s %11s\n", "threads", "games/sec", "ticks/sec", "speedup", "efficiency");
+        // Powers of two up to the limit, always finishing with the limit itself
+        std::vector<int> threadCounts;
+        for (int threads = 1; threads < maxThreads; threads *= 2)
+            threadCounts.push_back(threads);
+        threadCounts.push_back(maxThreads);
+
+        double baseline = 0.0;
+        for (int threads : threadCounts)
+        {
+            ThreadPool pool(threads);
+            AutopilotPool autopilots;
+            MctsPool bots;
+            BatchResult result = Run(config, options, pool, autopilots, bots);
+            if (threads == 1)
+                baseline = result.TicksPerSecond();
+            double speedup = baseline > 0.0 ? result.TicksPerSecond() / baseline : 0.0;
+            std::printf("%8d %12.1f %14.1f %8.2fx %10.1f%%\n", threads, result.GamesPerSecond(), result.TicksPerSecond(),
+                speedup, 100.0 * speedup / threads);
+        }
+        return 0;
+    }
+
+    // The MCTS bot spreads its search over the threads, so its games go one at a time
+    ThreadPool pool(options.mctsMs > 0.0 ? 1 : maxThreads);
+    AutopilotPool autopilots;
+    MctsPool bots;
+    bots.config.budgetMs = options.mctsMs;
+    bots.config.threads = options.mctsThreads;
+    BatchResult result = Run(config, options, pool, autopilots, bots);
+
+    std::printf("games        %d (%dx%d, %d threads)\n", result.games, options.width, options.height, result.threads);
+    std::printf("ticks        %llu\n", static_cast<unsigned long long>(result.ticks));
+    std::printf("score        mean %.2f  p50 %d  p90 %d  p99 %d  max %d  (wins %d)\n", result.scores.Mean(),
+        result.scores.Percentile(0.5), result.scores.Percentile(0.9), result.scores.Percentile(0.99), result.scores.Max(),
+        result.wins);
+    std::printf("length       mean %.2f  p50 %d  p90 %d  p99 %d  max %d\n", result.lengths.Mean(),
+        result.lengths.Percentile(0.5), result.lengths.Percentile(0.9), result.lengths.Percentile(0.99), result.lengths.Max());
+    std::printf("elapsed      %.3f s\n", result.seconds);
+    std::printf("games/sec    %.1f\n", result.GamesPerSecond());
+    std::printf("ticks/sec    %.1f\n", result.TicksPerSecond());
+    if (options.autopilot)
+        std::printf("planner      %.2f us/tick\n", autopilots.AverageMicros());
+    if (options.mctsMs > 0.0)
+    {
+        double perSecond = 0.0, perMove = 0.0;
+        bots.Totals(perSecond, perMove);
+        std::printf("search       %.0f sims/s  %.1f sims/move  (%.1f ms budget, %d threads)\n", perSecond, perMove,
+            options.mctsMs, bots.bots.empty() ? 0 : bots.bots[0]->GetThreadCount());
+    }
+    if (options.leaderboard)
+    {
+        if (!AppendToLeaderboard(options.leaderboard, result))
+        {
+            std::fprintf(stderr, "cannot append to leaderboard %s\n", options.leaderboard);
+            return 1;
+        }
+        std::printf("leaderboard  %d games appended to %s\n", result.games, options.leaderboard);
+    }
+    return 0;
+}